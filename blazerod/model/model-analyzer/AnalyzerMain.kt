@@ -0,0 +1,127 @@
+package top.fifthlight.blazerod.model.analyzer
+
+import top.fifthlight.blazerod.model.formats.ModelFileLoaders
+import java.io.ByteArrayInputStream
+import java.nio.file.Path
+import javax.imageio.ImageIO
+import kotlin.system.exitProcess
+import kotlin.time.Duration
+import kotlin.time.measureTime
+import kotlin.time.measureTimedValue
+
+private const val USAGE = "Usage: model-analyzer [--repeat <count>] <model file>..."
+
+private class StageTimes(
+    val parse: Duration,
+    val analyze: Duration,
+    val textureDecode: Duration,
+)
+
+private fun Long.formatBytes() = when {
+    this >= 1024L * 1024L -> "%.1f MiB".format(this / (1024.0 * 1024.0))
+    this >= 1024L -> "%.1f KiB".format(this / 1024.0)
+    else -> "$this B"
+}
+
+private fun Duration.formatMillis() = "%.1f ms".format(inWholeMicroseconds / 1000.0)
+
+// Decode with ImageIO, as the game image decoder can't run without the game
+private fun decodeTextures(textures: List<ByteArray>) {
+    for (data in textures) {
+        ImageIO.read(ByteArrayInputStream(data))
+    }
+}
+
+private fun runOnce(path: Path): Pair<ModelReport, StageTimes> {
+    val (result, parseTime) = measureTimedValue { ModelFileLoaders.probeAndLoad(path) }
+    val model = result?.model ?: throw IllegalArgumentException("No supported model in $path")
+    val (report, analyzeTime) = measureTimedValue { ModelAnalyzer.analyze(model) }
+    val textures = ModelAnalyzer.textures(model).mapNotNull { texture ->
+        ModelAnalyzer.encodedData(texture)?.let { buffer -> ByteArray(buffer.remaining()).also { buffer.get(it) } }
+    }
+    val decodeTime = measureTime { decodeTextures(textures) }
+    return Pair(report, StageTimes(parseTime, analyzeTime, decodeTime))
+}
+
+private fun printReport(path: Path, report: ModelReport, times: List<StageTimes>) {
+    println(path)
+    println(
+        "  vertices: ${report.vertexCount}, primitives: ${report.primitiveCount}, joints: ${report.jointCount}, " +
+                "morph targets: ${report.morphTargetCount}"
+    )
+    println(
+        "  textures: ${report.textureCount}, ${report.textureEncodedBytes.formatBytes()} encoded, " +
+                "${report.textureBytes.formatBytes()} decoded"
+    )
+    println(
+        "  estimated GPU memory: ${report.gpuBytes.formatBytes()} (vertex ${report.vertexBufferBytes.formatBytes()}, " +
+                "index ${report.indexBufferBytes.formatBytes()}, " +
+                "morph target ${report.morphTargetBytes.formatBytes()}, " +
+                "texture ${report.textureBytes.formatBytes()})"
+    )
+    val chains = report.ikChainLengths
+    if (chains.isEmpty()) {
+        println("  IK chains: 0")
+    } else {
+        println("  IK chains: ${chains.size}, lengths: ${chains.joinToString(", ")}")
+    }
+    fun stage(name: String, selector: (StageTimes) -> Duration): String {
+        val durations = times.map(selector)
+        return if (durations.size == 1) {
+            "$name ${durations[0].formatMillis()}"
+        } else {
+            val average = durations.fold(Duration.ZERO, Duration::plus) / durations.size
+            "$name ${average.formatMillis()} (min ${durations.min().formatMillis()})"
+        }
+    }
+    println(
+        "  load time: ${stage("parse") { it.parse }}, ${stage("analyze") { it.analyze }}, " +
+                stage("texture decode") { it.textureDecode }
+    )
+}
+
+/**
+ * Print the complexity report and load times of model files. With --repeat, each file is loaded several times after
+ * a warmup run, and the average and minimum times are printed.
+ */
+fun main(args: Array<String>) {
+    var repeat = 1
+    val files = mutableListOf<Path>()
+    var index = 0
+    while (index < args.size) {
+        when (val arg = args[index]) {
+            "--repeat" -> {
+                repeat = args.getOrNull(index + 1)?.toIntOrNull()?.takeIf { it > 0 } ?: run {
+                    System.err.println(USAGE)
+                    exitProcess(2)
+                }
+                index++
+            }
+
+            else -> files.add(Path.of(arg))
+        }
+        index++
+    }
+    if (files.isEmpty()) {
+        System.err.println(USAGE)
+        exitProcess(2)
+    }
+
+    ModelFileLoaders.initialize()
+    var failed = false
+    for (file in files) {
+        try {
+            if (repeat > 1) {
+                runOnce(file)
+            }
+            val runs = (0 until repeat).map { runOnce(file) }
+            printReport(file, runs.first().first, runs.map { it.second })
+        } catch (ex: Exception) {
+            System.err.println("Failed to analyze $file: ${ex.message}")
+            failed = true
+        }
+    }
+    if (failed) {
+        exitProcess(1)
+    }
+}
@@ -0,0 +1,59 @@
+package top.fifthlight.blazerod.model.analyzer
+
+import top.fifthlight.blazerod.model.*
+import top.fifthlight.blazerod.model.util.ModelContent
+import top.fifthlight.blazerod.model.util.VertexStrides
+import java.nio.ByteBuffer
+
+/**
+ * Computes [ModelReport] of a loaded model, without any game or GPU classes. Counts the same content as the model
+ * complexity check, see [ModelContent].
+ */
+object ModelAnalyzer {
+    // Morph target texel sizes: RGBA32F for position and color, RG32F for texture coordinate
+    private const val MORPH_POSITION_BYTES = 16L
+    private const val MORPH_COLOR_BYTES = 16L
+    private const val MORPH_TEXCOORD_BYTES = 8L
+
+    fun analyze(model: Model): ModelReport {
+        val content = ModelContent.of(model)
+        var vertexBufferBytes = 0L
+        var indexBufferBytes = 0L
+        var morphTargetBytes = 0L
+        for (usage in content.meshes) {
+            for (primitive in usage.mesh.primitives) {
+                val vertices = primitive.attributes.position.count.toLong()
+                val stride = VertexStrides.of(normal = primitive.material is Material.Vanilla, skinned = usage.skinned)
+                vertexBufferBytes += vertices * stride
+                primitive.indices?.let { indices ->
+                    // Byte indices are widened to short
+                    val indexSize = if (indices.componentType == Accessor.ComponentType.UNSIGNED_INT) 4 else 2
+                    indexBufferBytes += indices.count.toLong() * indexSize
+                }
+                for (target in primitive.targets) {
+                    target.position?.let { morphTargetBytes += vertices * MORPH_POSITION_BYTES }
+                    target.colors.firstOrNull()?.let { morphTargetBytes += vertices * MORPH_COLOR_BYTES }
+                    target.texcoords.firstOrNull()?.let { morphTargetBytes += vertices * MORPH_TEXCOORD_BYTES }
+                }
+            }
+        }
+
+        return ModelReport(
+            vertexCount = content.vertexCount,
+            primitiveCount = content.primitiveCount,
+            jointCount = content.jointCount,
+            morphTargetCount = content.morphTargetCount,
+            textureCount = content.textures.size,
+            textureEncodedBytes = content.textures.sumOf { it.bufferView?.byteLength?.toLong() ?: 0L },
+            textureBytes = content.textureBytes,
+            vertexBufferBytes = vertexBufferBytes,
+            indexBufferBytes = indexBufferBytes,
+            morphTargetBytes = morphTargetBytes,
+            ikChainLengths = content.ikChainLengths,
+        )
+    }
+
+    fun textures(model: Model) = ModelContent.of(model).textures
+
+    fun encodedData(texture: Texture): ByteBuffer? = ModelContent.encodedData(texture)
+}
@@ -0,0 +1,24 @@
+package top.fifthlight.blazerod.model.analyzer
+
+/**
+ * Rendering cost of a model, as estimated from model data only. GPU sizes follow the layouts used by the renderer.
+ */
+data class ModelReport(
+    val vertexCount: Int,
+    val primitiveCount: Int,
+    val jointCount: Int,
+    val morphTargetCount: Int,
+    val textureCount: Int,
+    // Size of textures in the model file
+    val textureEncodedBytes: Long,
+    // Size of textures after decoding to RGBA8
+    val textureBytes: Long,
+    val vertexBufferBytes: Long,
+    val indexBufferBytes: Long,
+    val morphTargetBytes: Long,
+    // Joint count of each IK chain
+    val ikChainLengths: List<Int>,
+) {
+    val gpuBytes
+        get() = vertexBufferBytes + indexBufferBytes + morphTargetBytes + textureBytes
+}
@@ -0,0 +1,45 @@
+package top.fifthlight.blazerod.model.analyzer.test
+
+import top.fifthlight.blazerod.model.analyzer.ModelAnalyzer
+import top.fifthlight.blazerod.model.gltf.GltfBinaryLoader
+import top.fifthlight.blazerod.model.pmx.PmxLoader
+import java.nio.file.Path
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertTrue
+
+class ModelAnalyzerTest {
+    private fun loadFilePath(attr: String): Path {
+        val property = System.getProperty(attr + "_path")
+        return Path.of(RunfileDummy.getRunfiles().rlocation(property))
+    }
+
+    @Test
+    fun testVrm() {
+        val file = loadFilePath("alicia_solid_vrm")
+        val model = GltfBinaryLoader().load(file).model!!
+        val report = ModelAnalyzer.analyze(model)
+        println("Alicia VRM: $report")
+        assertTrue(report.vertexCount > 0)
+        assertTrue(report.primitiveCount > 0)
+        assertTrue(report.jointCount > 0)
+        assertTrue(report.morphTargetCount > 0)
+        assertTrue(report.textureCount > 0)
+        // Textures in the file are compressed
+        assertTrue(report.textureBytes > report.textureEncodedBytes)
+        assertEquals(
+            report.vertexBufferBytes + report.indexBufferBytes + report.morphTargetBytes + report.textureBytes,
+            report.gpuBytes,
+        )
+    }
+
+    @Test
+    fun testPmxIkChains() {
+        val file = loadFilePath("alicia_solid_pmx")
+        val model = PmxLoader().load(file).model!!
+        val report = ModelAnalyzer.analyze(model)
+        println("Alicia PMX: $report")
+        assertTrue(report.ikChainLengths.isNotEmpty())
+        assertTrue(report.ikChainLengths.all { it > 0 })
+    }
+}
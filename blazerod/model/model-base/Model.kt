@@ -5,6 +5,8 @@ data class Model(
     val defaultScene: Scene? = null,
     val skins: List<Skin>,
     val expressions: List<Expression> = listOf(),
+    val springBone: SpringBone? = null,
+    val physics: Physics? = null,
 ) {
     init {
         require(scenes.isNotEmpty()) { "Bad model: no scene" }
@@ -0,0 +1,78 @@
+package top.fifthlight.blazerod.model
+
+import org.joml.Quaternionf
+import org.joml.Quaternionfc
+import org.joml.Vector3f
+import org.joml.Vector3fc
+
+/**
+ * Rigid body physics of a model, in the style of MMD: rigid bodies attached to nodes, connected with 6-DOF spring
+ * joints. All positions and rotations are in model space, at rest pose.
+ */
+data class Physics(
+    val rigidBodies: List<RigidBody>,
+    val joints: List<Joint>,
+) {
+    data class RigidBody(
+        val name: String? = null,
+        val node: NodeId?,
+        // Collision group of this body, in [0, 16)
+        val collisionGroup: Int = 0,
+        // Bit n set means this body collides with bodies in group n
+        val collisionMask: Int = 0xFFFF,
+        val shape: Shape,
+        val position: Vector3fc = Vector3f(),
+        val rotation: Quaternionfc = Quaternionf(),
+        val mass: Float = 1f,
+        val linearDamping: Float = 0f,
+        val angularDamping: Float = 0f,
+        val restitution: Float = 0f,
+        val friction: Float = .5f,
+        val type: Type,
+    ) {
+        sealed class Shape {
+            data class Sphere(
+                val radius: Float,
+            ) : Shape()
+
+            data class Box(
+                val halfExtents: Vector3fc,
+            ) : Shape()
+
+            // Capsule along Y axis, height not including the caps
+            data class Capsule(
+                val radius: Float,
+                val height: Float,
+            ) : Shape()
+        }
+
+        enum class Type {
+            // Follows the node, not simulated
+            KINEMATIC,
+
+            // Simulated, and drives the node
+            DYNAMIC,
+
+            // Simulated, but only drives the node's rotation
+            DYNAMIC_WITH_NODE_POSITION,
+        }
+    }
+
+    /**
+     * 6-DOF spring joint. Relative translation and rotation (XYZ euler angles) of body B in joint space are limited in
+     * [[positionMin], [positionMax]] and [[rotationMin], [rotationMax]], and pulled back to rest with the springs.
+     */
+    data class Joint(
+        val name: String? = null,
+        val rigidBodyA: Int,
+        val rigidBodyB: Int,
+        val position: Vector3fc = Vector3f(),
+        val rotation: Quaternionfc = Quaternionf(),
+        val positionMin: Vector3fc = Vector3f(),
+        val positionMax: Vector3fc = Vector3f(),
+        val rotationMin: Vector3fc = Vector3f(),
+        val rotationMax: Vector3fc = Vector3f(),
+        val positionStiffness: Vector3fc = Vector3f(),
+        val rotationStiffness: Vector3fc = Vector3f(),
+    )
+}
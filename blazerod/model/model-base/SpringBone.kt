@@ -0,0 +1,58 @@
+package top.fifthlight.blazerod.model
+
+import org.joml.Vector3f
+import org.joml.Vector3fc
+
+data class SpringBone(
+    val colliders: List<Collider>,
+    val colliderGroups: List<ColliderGroup>,
+    val springs: List<Spring>,
+) {
+    data class Collider(
+        val node: NodeId,
+        val shape: Shape,
+    ) {
+        sealed class Shape {
+            abstract val offset: Vector3fc
+            abstract val radius: Float
+
+            data class Sphere(
+                override val offset: Vector3fc = Vector3f(),
+                override val radius: Float = 0f,
+            ) : Shape()
+
+            data class Capsule(
+                override val offset: Vector3fc = Vector3f(),
+                override val radius: Float = 0f,
+                val tail: Vector3fc = Vector3f(),
+            ) : Shape()
+        }
+    }
+
+    data class ColliderGroup(
+        val name: String? = null,
+        val colliders: List<Int>,
+    )
+
+    /**
+     * A chain of joints. Each joint rotates so that the next joint in the chain follows the simulated tail, so the
+     * last joint is only used as tail, unless [tailLength] is set, in which case the last joint is simulated too, with
+     * a virtual tail of that length along its own rest translation (VRM 0.x behavior).
+     */
+    data class Spring(
+        val name: String? = null,
+        val joints: List<Joint>,
+        val colliderGroups: List<Int> = listOf(),
+        val center: NodeId? = null,
+        val tailLength: Float? = null,
+    )
+
+    data class Joint(
+        val node: NodeId,
+        val hitRadius: Float = 0f,
+        val stiffness: Float = 1f,
+        val gravityPower: Float = 0f,
+        val gravityDir: Vector3fc = Vector3f(0f, -1f, 0f),
+        val dragForce: Float = .5f,
+    )
+}
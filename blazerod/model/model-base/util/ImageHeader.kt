@@ -0,0 +1,52 @@
+package top.fifthlight.blazerod.model.util
+
+import top.fifthlight.blazerod.model.Texture
+import java.nio.ByteBuffer
+
+/**
+ * Reads image size from the header of encoded images, without decoding the whole image.
+ */
+object ImageHeader {
+    private fun ByteBuffer.u8(index: Int) = get(position() + index).toInt() and 0xFF
+    private fun ByteBuffer.u16(index: Int) = (u8(index) shl 8) or u8(index + 1)
+    private fun ByteBuffer.u32(index: Int) = (u16(index) shl 16) or u16(index + 2)
+
+    /**
+     * Width and height of the image in remaining bytes of [buffer], or null if the header is not recognized. Probe
+     * all known types if [type] is null.
+     */
+    fun size(buffer: ByteBuffer, type: Texture.TextureType? = null): Pair<Int, Int>? = when (type) {
+        Texture.TextureType.PNG -> pngSize(buffer)
+        Texture.TextureType.JPEG -> jpegSize(buffer)
+        null -> pngSize(buffer) ?: jpegSize(buffer)
+    }
+
+    // Width and height are the first fields of IHDR chunk, which is always the first chunk
+    private fun pngSize(buffer: ByteBuffer): Pair<Int, Int>? {
+        val magic = Texture.TextureType.PNG.magic
+        if (buffer.remaining() < 24 || magic.indices.any { buffer.get(buffer.position() + it) != magic[it] }) {
+            return null
+        }
+        return Pair(buffer.u32(16), buffer.u32(20))
+    }
+
+    // Walk the segments until a start of frame segment
+    private fun jpegSize(buffer: ByteBuffer): Pair<Int, Int>? {
+        if (buffer.remaining() < 4 || buffer.u16(0) != 0xFFD8) {
+            return null
+        }
+        var position = 2
+        while (position + 9 <= buffer.remaining()) {
+            if (buffer.u8(position) != 0xFF) {
+                return null
+            }
+            val marker = buffer.u8(position + 1)
+            // SOF0 - SOF15, except DHT, JPG and DAC
+            if (marker in 0xC0..0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+                return Pair(buffer.u16(position + 7), buffer.u16(position + 5))
+            }
+            position += 2 + buffer.u16(position + 2)
+        }
+        return null
+    }
+}
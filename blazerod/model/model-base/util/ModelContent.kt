@@ -0,0 +1,86 @@
+package top.fifthlight.blazerod.model.util
+
+import top.fifthlight.blazerod.model.Mesh
+import top.fifthlight.blazerod.model.MeshId
+import top.fifthlight.blazerod.model.Model
+import top.fifthlight.blazerod.model.NodeComponent
+import top.fifthlight.blazerod.model.Primitive
+import top.fifthlight.blazerod.model.Texture
+import top.fifthlight.blazerod.model.forEach
+import java.nio.ByteBuffer
+
+/**
+ * Parts of a model uploaded by the renderer. Only the scene shown is counted, which is the default scene or the first
+ * one. Both the model complexity check and the model analyzer count from here, so their numbers agree.
+ */
+class ModelContent private constructor(
+    val meshes: List<MeshUsage>,
+    val ikChainLengths: List<Int>,
+    val jointCount: Int,
+) {
+    class MeshUsage(
+        val mesh: Mesh,
+        val skinned: Boolean,
+    )
+
+    val primitives: List<Primitive> = meshes.flatMap { it.mesh.primitives }
+
+    // Only base color textures are uploaded by the renderer
+    val textures: List<Texture> = primitives.mapNotNull { it.material?.baseColorTexture?.texture }.distinct()
+
+    val vertexCount
+        get() = primitives.sumOf { it.attributes.position.count }
+
+    val primitiveCount
+        get() = primitives.size
+
+    val morphTargetCount
+        get() = primitives.sumOf { it.targets.size }
+
+    // Size of textures after decoding to RGBA8
+    val textureBytes
+        get() = textures.sumOf { decodedBytes(it) }
+
+    companion object {
+        private const val BYTES_PER_PIXEL = 4L
+
+        fun of(model: Model): ModelContent {
+            val scene = model.defaultScene ?: model.scenes.firstOrNull()
+            val meshes = mutableMapOf<MeshId, MeshUsage>()
+            val ikChainLengths = mutableListOf<Int>()
+            scene?.nodes?.forEach { rootNode ->
+                rootNode.forEach { node ->
+                    for (component in node.components) {
+                        when (component) {
+                            is NodeComponent.MeshComponent -> {
+                                val mesh = component.mesh
+                                meshes.putIfAbsent(mesh.id, MeshUsage(mesh, mesh.id in node.meshIdToSkinMap))
+                            }
+
+                            is NodeComponent.IkTargetComponent -> ikChainLengths.add(component.ikTarget.joints.size)
+
+                            else -> Unit
+                        }
+                    }
+                }
+            }
+            return ModelContent(
+                meshes = meshes.values.toList(),
+                ikChainLengths = ikChainLengths,
+                jointCount = model.skins.sumOf { it.joints.size },
+            )
+        }
+
+        fun encodedData(texture: Texture): ByteBuffer? = texture.bufferView?.let { bufferView ->
+            bufferView.buffer.buffer.slice(bufferView.byteOffset, bufferView.byteLength)
+        }
+
+        // Decoded size from image header, without decoding the whole image. Use encoded size if header is unknown.
+        fun decodedBytes(texture: Texture): Long {
+            val buffer = encodedData(texture) ?: return 0
+            val size = ImageHeader.size(buffer, texture.type)
+            return size?.let { (width, height) -> width.toLong() * height * BYTES_PER_PIXEL }
+                ?: buffer.remaining().toLong()
+        }
+    }
+}
@@ -0,0 +1,20 @@
+package top.fifthlight.blazerod.model.util
+
+/**
+ * Vertex sizes of the renderer vertex formats in bytes, for estimating GPU memory without game classes.
+ * BlazerodVertexFormats checks its formats against this table.
+ */
+object VertexStrides {
+    const val POSITION_COLOR_TEXTURE = 32
+    const val POSITION_COLOR_TEXTURE_JOINT_WEIGHT = 48
+    const val POSITION_COLOR_TEXTURE_NORMAL = 32
+    const val POSITION_COLOR_TEXTURE_NORMAL_JOINT_WEIGHT = 64
+
+    // Vanilla materials have normals, see MaterialLoadInfo.getVertexFormat
+    fun of(normal: Boolean, skinned: Boolean) = when {
+        normal && skinned -> POSITION_COLOR_TEXTURE_NORMAL_JOINT_WEIGHT
+        normal -> POSITION_COLOR_TEXTURE_NORMAL
+        skinned -> POSITION_COLOR_TEXTURE_JOINT_WEIGHT
+        else -> POSITION_COLOR_TEXTURE
+    }
+}
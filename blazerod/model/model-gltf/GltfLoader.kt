@@ -34,6 +34,9 @@ internal class GltfLoader(
         private val format = Json {
             ignoreUnknownKeys = true
         }
+
+        // Length of the virtual tail appended to the leaf joints in VRM 0.x
+        private const val VRM0_TAIL_LENGTH = 0.07f
     }
 
     private val uuid = UUID.randomUUID()
@@ -53,6 +56,7 @@ internal class GltfLoader(
     private lateinit var scenes: List<Scene>
     private lateinit var animations: List<Animation>
     private lateinit var expressions: List<Expression>
+    private var springBone: SpringBone? = null
 
     private fun parseDataUri(dataUri: URI): ByteBuffer {
         require(dataUri.scheme.equals("data", ignoreCase = true)) { "Bad scheme: ${dataUri.scheme}" }
@@ -597,6 +601,119 @@ internal class GltfLoader(
         expressions = listOf()
     }
 
+    private fun loadSpringBone() {
+        val vrmV1 = gltf.extensions?.vrmSpringBone
+        if (vrmV1 != null) {
+            springBone = SpringBone(
+                colliders = vrmV1.colliders?.map { collider ->
+                    val shape = collider.shape
+                    SpringBone.Collider(
+                        node = NodeId(uuid, collider.node),
+                        shape = when {
+                            shape.sphere != null -> SpringBone.Collider.Shape.Sphere(
+                                offset = shape.sphere.offset ?: Vector3f(),
+                                radius = shape.sphere.radius ?: 0f,
+                            )
+
+                            shape.capsule != null -> SpringBone.Collider.Shape.Capsule(
+                                offset = shape.capsule.offset ?: Vector3f(),
+                                radius = shape.capsule.radius ?: 0f,
+                                tail = shape.capsule.tail ?: Vector3f(),
+                            )
+
+                            else -> throw GltfLoadException("Bad spring bone collider: no shape")
+                        },
+                    )
+                } ?: listOf(),
+                colliderGroups = vrmV1.colliderGroups?.map { group ->
+                    SpringBone.ColliderGroup(
+                        name = group.name,
+                        colliders = group.colliders,
+                    )
+                } ?: listOf(),
+                springs = vrmV1.springs?.map { spring ->
+                    SpringBone.Spring(
+                        name = spring.name,
+                        joints = spring.joints.map { joint ->
+                            SpringBone.Joint(
+                                node = NodeId(uuid, joint.node),
+                                hitRadius = joint.hitRadius ?: 0f,
+                                stiffness = joint.stiffness ?: 1f,
+                                gravityPower = joint.gravityPower ?: 0f,
+                                gravityDir = joint.gravityDir ?: Vector3f(0f, -1f, 0f),
+                                dragForce = joint.dragForce ?: .5f,
+                            )
+                        },
+                        colliderGroups = spring.colliderGroups ?: listOf(),
+                        center = spring.center?.let { NodeId(uuid, it) },
+                    )
+                } ?: listOf(),
+            )
+            return
+        }
+
+        val vrmV0 = gltf.extensions?.vrmV0?.secondaryAnimation
+        if (vrmV0 != null) {
+            val colliders = mutableListOf<SpringBone.Collider>()
+            val colliderGroups = vrmV0.colliderGroups?.map { group ->
+                SpringBone.ColliderGroup(
+                    colliders = group.colliders?.map { collider ->
+                        val index = colliders.size
+                        colliders.add(
+                            SpringBone.Collider(
+                                node = NodeId(uuid, group.node),
+                                shape = SpringBone.Collider.Shape.Sphere(
+                                    offset = collider.offset?.vector ?: Vector3f(),
+                                    radius = collider.radius ?: 0f,
+                                ),
+                            )
+                        )
+                        index
+                    } ?: listOf(),
+                )
+            } ?: listOf()
+            // VRM 0.x marks only the root bones, and every descendant of them is a joint.
+            // Split the trees into chains: the first child continues the chain, others start new ones.
+            val springs = mutableListOf<SpringBone.Spring>()
+            for (boneGroup in vrmV0.boneGroups ?: listOf()) {
+                fun createJoint(nodeIndex: Int) = SpringBone.Joint(
+                    node = NodeId(uuid, nodeIndex),
+                    hitRadius = boneGroup.hitRadius ?: 0f,
+                    stiffness = boneGroup.stiffness ?: 1f,
+                    gravityPower = boneGroup.gravityPower ?: 0f,
+                    gravityDir = boneGroup.gravityDir?.vector ?: Vector3f(0f, -1f, 0f),
+                    dragForce = boneGroup.dragForce ?: .5f,
+                )
+
+                val pendingRoots = ArrayDeque(boneGroup.bones ?: listOf())
+                while (pendingRoots.isNotEmpty()) {
+                    val joints = mutableListOf<SpringBone.Joint>()
+                    var current: Int? = pendingRoots.removeFirst()
+                    while (current != null) {
+                        joints.add(createJoint(current))
+                        val children = gltf.nodes?.getOrNull(current)?.children ?: listOf()
+                        current = children.firstOrNull()
+                        pendingRoots.addAll(children.drop(1))
+                    }
+                    springs.add(
+                        SpringBone.Spring(
+                            name = boneGroup.comment,
+                            joints = joints,
+                            colliderGroups = boneGroup.colliderGroups ?: listOf(),
+                            center = boneGroup.center?.takeIf { it >= 0 }?.let { NodeId(uuid, it) },
+                            tailLength = VRM0_TAIL_LENGTH,
+                        )
+                    )
+                }
+            }
+            springBone = SpringBone(
+                colliders = colliders,
+                colliderGroups = colliderGroups,
+                springs = springs,
+            )
+        }
+    }
+
     fun load(json: String): ModelFileLoader.LoadResult {
         if (loaded) {
             throw GltfLoadException("Already loaded. Please don't load again.")
@@ -617,6 +734,7 @@ internal class GltfLoader(
         loadScenes()
         loadAnimations()
         loadExpressions()
+        loadSpringBone()
 
         val metadata = gltf.extensions?.vrmV0?.meta?.toMetadata { textures.getOrNull(it) }
             ?: gltf.extensions?.vrmV1?.meta?.toMetadata { textures.getOrNull(it) }
@@ -628,6 +746,7 @@ internal class GltfLoader(
             },
             skins = skins,
             expressions = expressions,
+            springBone = springBone,
         )
 
         return ModelFileLoader.LoadResult(
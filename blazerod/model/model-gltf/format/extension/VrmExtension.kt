@@ -5,6 +5,7 @@ import kotlinx.serialization.Serializable
 import org.joml.Vector3f
 import top.fifthlight.blazerod.model.Metadata
 import top.fifthlight.blazerod.model.Texture
+import top.fifthlight.blazerod.model.gltf.format.Vector3fSerializer
 
 @Serializable
 internal data class VrmV0Extension(
@@ -13,6 +14,7 @@ internal data class VrmV0Extension(
     val firstPerson: FirstPerson? = null,
     val humanoid: Humanoid? = null,
     val blendShapeMaster: BlendShapeMaster? = null,
+    val secondaryAnimation: SecondaryAnimation? = null,
 ) {
     @Serializable
     data class Meta(
@@ -141,6 +143,50 @@ internal data class VrmV0Extension(
             )
         }
     }
+
+    @Serializable
+    data class Vector3(
+        val x: Float = 0f,
+        val y: Float = 0f,
+        val z: Float = 0f,
+    ) {
+        // VRM 0.x stores vectors in Unity's coordinate, so Z axis is flipped
+        val vector
+            get() = Vector3f(x, y, -z)
+    }
+
+    @Serializable
+    data class SecondaryAnimation(
+        val boneGroups: List<BoneGroup>? = null,
+        val colliderGroups: List<ColliderGroup>? = null,
+    ) {
+        @Serializable
+        data class BoneGroup(
+            val comment: String? = null,
+            // The typo is in the VRM 0.x specification
+            @SerialName("stiffiness")
+            val stiffness: Float? = null,
+            val gravityPower: Float? = null,
+            val gravityDir: Vector3? = null,
+            val dragForce: Float? = null,
+            val center: Int? = null,
+            val hitRadius: Float? = null,
+            val bones: List<Int>? = null,
+            val colliderGroups: List<Int>? = null,
+        )
+
+        @Serializable
+        data class ColliderGroup(
+            val node: Int,
+            val colliders: List<Collider>? = null,
+        ) {
+            @Serializable
+            data class Collider(
+                val offset: Vector3? = null,
+                val radius: Float? = null,
+            )
+        }
+    }
 }
 
 @Serializable
@@ -288,3 +334,64 @@ data class VrmV1Extension(
         )
     }
 }
+
+@Serializable
+internal data class VrmSpringBoneExtension(
+    val specVersion: String? = null,
+    val colliders: List<Collider>? = null,
+    val colliderGroups: List<ColliderGroup>? = null,
+    val springs: List<Spring>? = null,
+) {
+    @Serializable
+    data class Collider(
+        val node: Int,
+        val shape: Shape,
+    ) {
+        @Serializable
+        data class Shape(
+            val sphere: Sphere? = null,
+            val capsule: Capsule? = null,
+        ) {
+            @Serializable
+            data class Sphere(
+                @Serializable(with = Vector3fSerializer::class)
+                val offset: Vector3f? = null,
+                val radius: Float? = null,
+            )
+
+            @Serializable
+            data class Capsule(
+                @Serializable(with = Vector3fSerializer::class)
+                val offset: Vector3f? = null,
+                val radius: Float? = null,
+                @Serializable(with = Vector3fSerializer::class)
+                val tail: Vector3f? = null,
+            )
+        }
+    }
+
+    @Serializable
+    data class ColliderGroup(
+        val name: String? = null,
+        val colliders: List<Int>,
+    )
+
+    @Serializable
+    data class Spring(
+        val name: String? = null,
+        val joints: List<Joint>,
+        val colliderGroups: List<Int>? = null,
+        val center: Int? = null,
+    )
+
+    @Serializable
+    data class Joint(
+        val node: Int,
+        val hitRadius: Float? = null,
+        val stiffness: Float? = null,
+        val gravityPower: Float? = null,
+        @Serializable(with = Vector3fSerializer::class)
+        val gravityDir: Vector3f? = null,
+        val dragForce: Float? = null,
+    )
+}
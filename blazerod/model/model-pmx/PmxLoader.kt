@@ -82,6 +82,8 @@ class PmxLoader : ModelFileLoader {
         private val sourceToInheritMap = mutableMapOf<Int, MutableList<PmxBone.InheritData>>()
         private lateinit var morphTargets: List<PmxMorph>
         private lateinit var morphTargetGroups: List<PmxMorphGroup>
+        private var rigidBodies: List<PmxRigidBody> = listOf()
+        private var joints: List<PmxJoint> = listOf()
         private val childBoneMap = mutableMapOf<Int, MutableList<Int>>()
         private val rootBones = mutableListOf<Int>()
 
@@ -188,6 +190,13 @@ class PmxLoader : ModelFileLoader {
             else -> throw PmxLoadException("Bad morph index size: ${globals.boneIndexSize}")
         }
 
+        private fun loadRigidBodyIndex(buffer: ByteBuffer): Int = when (globals.rigidBodyIndexSize) {
+            1 -> buffer.get().toInt()
+            2 -> buffer.getShort().toInt()
+            4 -> buffer.getInt()
+            else -> throw PmxLoadException("Bad rigid body index size: ${globals.rigidBodyIndexSize}")
+        }
+
         private fun loadVertexIndex(buffer: ByteBuffer): Int = when (globals.vertexIndexSize) {
             1 -> buffer.get().toUByte().toInt()
             2 -> buffer.getShort().toUShort().toInt()
@@ -945,6 +954,161 @@ class PmxLoader : ModelFileLoader {
             morphTargetGroups = morphGroups
         }
 
+        private fun loadDisplayFrames(buffer: ByteBuffer) {
+            val displayFrameCount = buffer.getInt()
+            if (displayFrameCount < 0) {
+                throw PmxLoadException("Bad PMX model: display frames count less than zero")
+            }
+            // Just skip, not used
+            repeat(displayFrameCount) {
+                loadString(buffer)
+                loadString(buffer)
+                buffer.get()
+                val frameCount = buffer.getInt()
+                repeat(frameCount) {
+                    when (val type = buffer.get().toInt()) {
+                        0 -> loadBoneIndex(buffer)
+                        1 -> loadMorphIndex(buffer)
+                        else -> throw PmxLoadException("Bad display frame type: $type")
+                    }
+                }
+            }
+        }
+
+        private fun loadRigidBodies(buffer: ByteBuffer) {
+            val rigidBodyCount = buffer.getInt()
+            if (rigidBodyCount < 0) {
+                throw PmxLoadException("Bad PMX model: rigid bodies count less than zero")
+            }
+            rigidBodies = (0 until rigidBodyCount).map {
+                PmxRigidBody(
+                    nameLocal = loadString(buffer),
+                    nameUniversal = loadString(buffer),
+                    boneIndex = loadBoneIndex(buffer).takeIf { it >= 0 },
+                    groupId = buffer.get().toUByte().toInt(),
+                    collisionMask = buffer.getShort().toUShort().toInt(),
+                    shapeType = buffer.get().toInt()
+                        .let { type -> PmxRigidBody.ShapeType.entries.firstOrNull { it.value == type } }
+                        ?: throw PmxLoadException("Unknown rigid body shape type"),
+                    shapeSize = loadVector3f(buffer).mul(MMD_SCALE),
+                    shapePosition = loadVector3f(buffer).transformPosition(),
+                    shapeRotation = loadVector3f(buffer),
+                    mass = buffer.getFloat(),
+                    moveAttenuation = buffer.getFloat(),
+                    rotationDamping = buffer.getFloat(),
+                    repulsion = buffer.getFloat(),
+                    frictionForce = buffer.getFloat(),
+                    physicsMode = buffer.get().toInt()
+                        .let { mode -> PmxRigidBody.PhysicsMode.entries.firstOrNull { it.value == mode } }
+                        ?: throw PmxLoadException("Unknown rigid body physics mode"),
+                )
+            }
+        }
+
+        private fun loadJoints(buffer: ByteBuffer) {
+            val jointCount = buffer.getInt()
+            if (jointCount < 0) {
+                throw PmxLoadException("Bad PMX model: joints count less than zero")
+            }
+            joints = (0 until jointCount).map {
+                PmxJoint(
+                    nameLocal = loadString(buffer),
+                    nameUniversal = loadString(buffer),
+                    type = buffer.get().toInt(),
+                    rigidBodyIndexA = loadRigidBodyIndex(buffer),
+                    rigidBodyIndexB = loadRigidBodyIndex(buffer),
+                    position = loadVector3f(buffer).transformPosition(),
+                    rotation = loadVector3f(buffer),
+                    positionMin = loadVector3f(buffer),
+                    positionMax = loadVector3f(buffer),
+                    rotationMin = loadVector3f(buffer),
+                    rotationMax = loadVector3f(buffer),
+                    positionSpring = loadVector3f(buffer),
+                    rotationSpring = loadVector3f(buffer),
+                )
+            }
+        }
+
+        // Convert MMD euler angles (Y, X, Z order) to our coordinate
+        private fun Vector3fc.toRotation() = Quaternionf().rotationYXZ(-y(), x(), -z())
+
+        private fun loadPhysics(modelId: UUID): Physics? {
+            if (rigidBodies.isEmpty()) {
+                return null
+            }
+            return Physics(
+                rigidBodies = rigidBodies.map { rigidBody ->
+                    Physics.RigidBody(
+                        name = rigidBody.nameLocal,
+                        node = rigidBody.boneIndex?.takeIf { it in bones.indices }?.let { NodeId(modelId, it) },
+                        collisionGroup = rigidBody.groupId.coerceIn(0, 15),
+                        collisionMask = rigidBody.collisionMask,
+                        shape = when (rigidBody.shapeType) {
+                            PmxRigidBody.ShapeType.SPHERE -> Physics.RigidBody.Shape.Sphere(
+                                radius = rigidBody.shapeSize.x(),
+                            )
+
+                            PmxRigidBody.ShapeType.BOX -> Physics.RigidBody.Shape.Box(
+                                halfExtents = Vector3f(rigidBody.shapeSize),
+                            )
+
+                            PmxRigidBody.ShapeType.CAPSULE -> Physics.RigidBody.Shape.Capsule(
+                                radius = rigidBody.shapeSize.x(),
+                                height = rigidBody.shapeSize.y(),
+                            )
+                        },
+                        position = rigidBody.shapePosition,
+                        rotation = rigidBody.shapeRotation.toRotation(),
+                        mass = rigidBody.mass,
+                        linearDamping = rigidBody.moveAttenuation,
+                        angularDamping = rigidBody.rotationDamping,
+                        restitution = rigidBody.repulsion,
+                        friction = rigidBody.frictionForce,
+                        type = when (rigidBody.physicsMode) {
+                            PmxRigidBody.PhysicsMode.FOLLOW_BONE -> Physics.RigidBody.Type.KINEMATIC
+                            PmxRigidBody.PhysicsMode.PHYSICS -> Physics.RigidBody.Type.DYNAMIC
+                            PmxRigidBody.PhysicsMode.PHYSICS_AND_BONE -> Physics.RigidBody.Type.DYNAMIC_WITH_NODE_POSITION
+                        },
+                    )
+                },
+                joints = joints.mapNotNull { joint ->
+                    if (joint.rigidBodyIndexA !in rigidBodies.indices || joint.rigidBodyIndexB !in rigidBodies.indices) {
+                        return@mapNotNull null
+                    }
+                    // Mirror on X axis: translation limits swap and negate on X, rotation limits on Y and Z
+                    Physics.Joint(
+                        name = joint.nameLocal,
+                        rigidBodyA = joint.rigidBodyIndexA,
+                        rigidBodyB = joint.rigidBodyIndexB,
+                        position = joint.position,
+                        rotation = joint.rotation.toRotation(),
+                        positionMin = Vector3f(
+                            -joint.positionMax.x(),
+                            joint.positionMin.y(),
+                            joint.positionMin.z(),
+                        ).mul(MMD_SCALE),
+                        positionMax = Vector3f(
+                            -joint.positionMin.x(),
+                            joint.positionMax.y(),
+                            joint.positionMax.z(),
+                        ).mul(MMD_SCALE),
+                        rotationMin = Vector3f(
+                            joint.rotationMin.x(),
+                            -joint.rotationMax.y(),
+                            -joint.rotationMax.z(),
+                        ),
+                        rotationMax = Vector3f(
+                            joint.rotationMax.x(),
+                            -joint.rotationMin.y(),
+                            -joint.rotationMin.z(),
+                        ),
+                        positionStiffness = joint.positionSpring,
+                        rotationStiffness = joint.rotationSpring,
+                    )
+                },
+            )
+        }
+
         private data class MaterialMorphData(
             val materialIndex: Int,
             val morphIndex: Int,
@@ -958,6 +1122,12 @@ class PmxLoader : ModelFileLoader {
             loadMaterials(buffer)
             loadBones(buffer)
             loadMorphTargets(buffer)
+            // Some old tools write files without the physics sections
+            if (buffer.hasRemaining()) {
+                loadDisplayFrames(buffer)
+                loadRigidBodies(buffer)
+                loadJoints(buffer)
+            }
 
             val modelId = UUID.randomUUID()
             val rootNodes = mutableListOf<Node>()
@@ -1200,6 +1370,7 @@ class PmxLoader : ModelFileLoader {
                         }
                     },
                     defaultScene = scene,
+                    physics = loadPhysics(modelId),
                 ),
                 animations = listOf(),
             )
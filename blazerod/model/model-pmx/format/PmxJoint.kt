@@ -0,0 +1,19 @@
+package top.fifthlight.blazerod.model.pmx.format
+
+import org.joml.Vector3fc
+
+internal data class PmxJoint(
+    val nameLocal: String,
+    val nameUniversal: String,
+    val type: Int,
+    val rigidBodyIndexA: Int,
+    val rigidBodyIndexB: Int,
+    val position: Vector3fc,
+    val rotation: Vector3fc,
+    val positionMin: Vector3fc,
+    val positionMax: Vector3fc,
+    val rotationMin: Vector3fc,
+    val rotationMax: Vector3fc,
+    val positionSpring: Vector3fc,
+    val rotationSpring: Vector3fc,
+)
@@ -0,0 +1,33 @@
+package top.fifthlight.blazerod.model.pmx.format
+
+import org.joml.Vector3fc
+
+internal data class PmxRigidBody(
+    val nameLocal: String,
+    val nameUniversal: String,
+    val boneIndex: Int?,
+    val groupId: Int,
+    val collisionMask: Int,
+    val shapeType: ShapeType,
+    val shapeSize: Vector3fc,
+    val shapePosition: Vector3fc,
+    val shapeRotation: Vector3fc,
+    val mass: Float,
+    val moveAttenuation: Float,
+    val rotationDamping: Float,
+    val repulsion: Float,
+    val frictionForce: Float,
+    val physicsMode: PhysicsMode,
+) {
+    enum class ShapeType(val value: Int) {
+        SPHERE(0),
+        BOX(1),
+        CAPSULE(2),
+    }
+
+    enum class PhysicsMode(val value: Int) {
+        FOLLOW_BONE(0),
+        PHYSICS(1),
+        PHYSICS_AND_BONE(2),
+    }
+}
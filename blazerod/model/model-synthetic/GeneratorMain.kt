@@ -0,0 +1,81 @@
+package top.fifthlight.blazerod.model.synthetic
+
+import java.nio.file.Path
+import kotlin.io.path.createDirectories
+import kotlin.system.exitProcess
+
+private const val USAGE = "Usage: synthetic-model [--joints <count>] [--hierarchy chain|flat|tree] " +
+        "[--primitives <count>] [--vertices <count>] [--morphs <count>] [--ik-chains <count>] " +
+        "[--ik-length <count>] [--frames <count>] [--seed <seed>] <output directory>"
+
+private fun usage(): Nothing {
+    System.err.println(USAGE)
+    exitProcess(2)
+}
+
+/**
+ * Write a synthetic model as PMX, glTF binary and VRM (if it has enough joints for a humanoid), along with a VMD
+ * motion driving all of its bones and morph targets.
+ */
+fun main(args: Array<String>) {
+    var spec = SyntheticModelSpec()
+    var animationSpec = SyntheticAnimationSpec()
+    var output: Path? = null
+    var index = 0
+    while (index < args.size) {
+        val arg = args[index]
+        if (!arg.startsWith("--")) {
+            if (output != null) {
+                usage()
+            }
+            output = Path.of(arg)
+            index++
+            continue
+        }
+        val value = args.getOrNull(index + 1) ?: usage()
+        fun count() = value.toIntOrNull()?.takeIf { it >= 0 } ?: usage()
+        try {
+            when (arg) {
+                "--joints" -> spec = spec.copy(joints = count())
+                "--hierarchy" -> spec = spec.copy(
+                    hierarchy = SyntheticModelSpec.Hierarchy.entries.firstOrNull {
+                        it.name.equals(value, ignoreCase = true)
+                    } ?: usage()
+                )
+
+                "--primitives" -> spec = spec.copy(primitives = count())
+                "--vertices" -> spec = spec.copy(verticesPerPrimitive = count())
+                "--morphs" -> spec = spec.copy(morphTargets = count())
+                "--ik-chains" -> spec = spec.copy(ikChains = count())
+                "--ik-length" -> spec = spec.copy(ikChainLength = count())
+                "--frames" -> animationSpec = animationSpec.copy(frames = count())
+                "--seed" -> {
+                    val seed = value.toLongOrNull() ?: usage()
+                    spec = spec.copy(seed = seed)
+                    animationSpec = animationSpec.copy(seed = seed)
+                }
+
+                else -> usage()
+            }
+        } catch (ex: IllegalArgumentException) {
+            System.err.println(ex.message)
+            usage()
+        }
+        index += 2
+    }
+    val directory = output ?: usage()
+
+    val model = SyntheticModel.generate(spec)
+    directory.createDirectories()
+    PmxWriter.write(model, directory.resolve("synthetic.pmx"))
+    GltfWriter.write(model, directory.resolve("synthetic.glb"))
+    if (spec.joints >= SyntheticModel.HUMANOID_TAGS.size) {
+        GltfWriter.write(model, directory.resolve("synthetic.vrm"), vrm = true)
+    }
+    VmdWriter.write(model, animationSpec, directory.resolve("synthetic.vmd"))
+    println(
+        "Generated ${model.bones.size} bones, ${model.primitives.size} primitives of " +
+                "${model.primitives.first().vertices} vertices, ${model.morphTargetNames.size} morph targets and " +
+                "${model.ikChains.size} IK chains in $directory"
+    )
+}
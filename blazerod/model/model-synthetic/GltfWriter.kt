@@ -0,0 +1,284 @@
+package top.fifthlight.blazerod.model.synthetic
+
+import kotlinx.serialization.json.*
+import org.joml.Matrix4f
+import java.nio.file.Path
+import kotlin.io.path.writeBytes
+
+/**
+ * Write a synthetic model as glTF binary, or VRM 1.0 if [vrm] is set.
+ *
+ * All primitives are in one skinned mesh, and morph targets are shared by all primitives. IK chains are written as
+ * plain nodes, as glTF has no IK. Only VRM has expressions, one for each morph target.
+ */
+object GltfWriter {
+    private const val GLTF_BINARY_MAGIC = 0x46546c67
+    private const val CHUNK_JSON = 0x4E4F534A
+    private const val CHUNK_BINARY = 0x004E4942
+
+    private const val COMPONENT_UNSIGNED_BYTE = 5121
+    private const val COMPONENT_UNSIGNED_SHORT = 5123
+    private const val COMPONENT_UNSIGNED_INT = 5125
+    private const val COMPONENT_FLOAT = 5126
+
+    private const val TARGET_ARRAY_BUFFER = 34962
+    private const val TARGET_ELEMENT_ARRAY_BUFFER = 34963
+
+    private class Builder {
+        val binary = OutputBuffer()
+        val bufferViews = mutableListOf<JsonObject>()
+        val accessors = mutableListOf<JsonObject>()
+
+        private fun bufferView(target: Int?, write: OutputBuffer.() -> Unit): Int {
+            binary.align(4)
+            val offset = binary.size
+            binary.write()
+            bufferViews.add(buildJsonObject {
+                put("buffer", 0)
+                put("byteOffset", offset)
+                put("byteLength", binary.size - offset)
+                target?.let { put("target", it) }
+            })
+            return bufferViews.lastIndex
+        }
+
+        private fun accessor(
+            bufferView: Int,
+            componentType: Int,
+            count: Int,
+            type: String,
+            min: List<Float>? = null,
+            max: List<Float>? = null,
+        ): Int {
+            accessors.add(buildJsonObject {
+                put("bufferView", bufferView)
+                put("componentType", componentType)
+                put("count", count)
+                put("type", type)
+                min?.let { values -> putJsonArray("min") { values.forEach { add(it) } } }
+                max?.let { values -> putJsonArray("max") { values.forEach { add(it) } } }
+            })
+            return accessors.lastIndex
+        }
+
+        fun floats(
+            values: FloatArray,
+            components: Int,
+            type: String,
+            bounds: Boolean = false,
+            target: Int? = TARGET_ARRAY_BUFFER,
+        ): Int {
+            val view = bufferView(target) { values.forEach { putFloat(it) } }
+            val count = values.size / components
+            // Positions must have bounds
+            val (min, max) = if (bounds) {
+                Pair(
+                    List(components) { component -> (0 until count).minOf { values[it * components + component] } },
+                    List(components) { component -> (0 until count).maxOf { values[it * components + component] } },
+                )
+            } else {
+                Pair(null, null)
+            }
+            return accessor(view, COMPONENT_FLOAT, count, type, min, max)
+        }
+
+        fun joints(values: IntArray, jointCount: Int): Int {
+            val componentType = if (jointCount <= 0xFF) COMPONENT_UNSIGNED_BYTE else COMPONENT_UNSIGNED_SHORT
+            val view = bufferView(TARGET_ARRAY_BUFFER) {
+                for (value in values) {
+                    if (componentType == COMPONENT_UNSIGNED_BYTE) put(value.toByte()) else putShort(value.toShort())
+                }
+            }
+            return accessor(view, componentType, values.size / 4, "VEC4")
+        }
+
+        fun indices(values: IntArray, vertices: Int): Int {
+            val componentType = if (vertices <= 0xFFFF) COMPONENT_UNSIGNED_SHORT else COMPONENT_UNSIGNED_INT
+            val view = bufferView(TARGET_ELEMENT_ARRAY_BUFFER) {
+                for (value in values) {
+                    if (componentType == COMPONENT_UNSIGNED_SHORT) putShort(value.toShort()) else putInt(value)
+                }
+            }
+            return accessor(view, componentType, values.size, "SCALAR")
+        }
+    }
+
+    private fun JsonObjectBuilder.putFloats(key: String, vararg values: Float) = putJsonArray(key) {
+        values.forEach { add(it) }
+    }
+
+    private fun vrmExtension(model: SyntheticModel, meshNode: Int) = buildJsonObject {
+        put("specVersion", "1.0")
+        putJsonObject("meta") {
+            put("name", "synthetic")
+            put("version", model.spec.toString())
+            putJsonArray("authors") { add("BlazeRod") }
+            put("licenseUrl", "https://vrm.dev/licenses/1.0/")
+            put("avatarPermission", "everyone")
+            put("commercialUsage", "corporation")
+            put("creditNotation", "unnecessary")
+            put("allowRedistribution", true)
+            put("modification", "allowModificationRedistribution")
+        }
+        putJsonObject("humanoid") {
+            putJsonObject("humanBones") {
+                for ((index, bone) in model.bones.withIndex()) {
+                    val tag = bone.humanoidTag ?: continue
+                    putJsonObject(tag.vrmName!!) { put("node", index) }
+                }
+            }
+        }
+        if (model.morphTargetNames.isNotEmpty()) {
+            putJsonObject("expressions") {
+                putJsonObject("custom") {
+                    for ((index, name) in model.morphTargetNames.withIndex()) {
+                        putJsonObject(name) {
+                            putJsonArray("morphTargetBinds") {
+                                addJsonObject {
+                                    put("node", meshNode)
+                                    put("index", index)
+                                    put("weight", 1f)
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    fun write(model: SyntheticModel, vrm: Boolean = false): ByteArray {
+        if (vrm) {
+            require(model.spec.joints >= SyntheticModel.HUMANOID_TAGS.size) {
+                "VRM needs at least ${SyntheticModel.HUMANOID_TAGS.size} joints for required humanoid bones"
+            }
+        }
+        val builder = Builder()
+        val children = model.bones.indices.groupBy { model.bones[it].parent }
+        val meshNode = model.bones.size
+
+        val primitives = model.primitives.mapIndexed { index, primitive ->
+            buildJsonObject {
+                putJsonObject("attributes") {
+                    put("POSITION", builder.floats(primitive.positions, 3, "VEC3", bounds = true))
+                    put("NORMAL", builder.floats(primitive.normals, 3, "VEC3"))
+                    put("TEXCOORD_0", builder.floats(primitive.texcoords, 2, "VEC2"))
+                    put("JOINTS_0", builder.joints(primitive.joints, model.bones.size))
+                    put("WEIGHTS_0", builder.floats(primitive.weights, 4, "VEC4"))
+                }
+                put("indices", builder.indices(primitive.indices, primitive.vertices))
+                put("material", index)
+                if (primitive.morphOffsets.isNotEmpty()) {
+                    putJsonArray("targets") {
+                        for (offsets in primitive.morphOffsets) {
+                            addJsonObject {
+                                put("POSITION", builder.floats(offsets, 3, "VEC3", bounds = true))
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        val inverseBindMatrices = FloatArray(model.bones.size * 16).also { values ->
+            val matrix = Matrix4f()
+            for ((index, bone) in model.bones.withIndex()) {
+                matrix.translation(bone.position).invertAffine().get(values, index * 16)
+            }
+        }
+        val inverseBindMatricesAccessor = builder.floats(inverseBindMatrices, 16, "MAT4", target = null)
+
+        val json = buildJsonObject {
+            putJsonObject("asset") {
+                put("version", "2.0")
+                put("generator", "BlazeRod synthetic model generator")
+            }
+            if (vrm) {
+                putJsonArray("extensionsUsed") { add("VRMC_vrm") }
+                putJsonObject("extensions") {
+                    put("VRMC_vrm", vrmExtension(model, meshNode))
+                }
+            }
+            put("scene", 0)
+            putJsonArray("scenes") {
+                addJsonObject {
+                    putJsonArray("nodes") {
+                        children[null]?.forEach { add(it) }
+                        add(meshNode)
+                    }
+                }
+            }
+            putJsonArray("nodes") {
+                for ((index, bone) in model.bones.withIndex()) {
+                    addJsonObject {
+                        put("name", bone.name)
+                        val parentPosition = bone.parent?.let { model.bones[it].position }
+                        putFloats(
+                            "translation",
+                            bone.position.x() - (parentPosition?.x() ?: 0f),
+                            bone.position.y() - (parentPosition?.y() ?: 0f),
+                            bone.position.z() - (parentPosition?.z() ?: 0f),
+                        )
+                        children[index]?.let { nodes -> putJsonArray("children") { nodes.forEach { add(it) } } }
+                    }
+                }
+                addJsonObject {
+                    put("name", "mesh")
+                    put("mesh", 0)
+                    put("skin", 0)
+                }
+            }
+            putJsonArray("meshes") {
+                addJsonObject {
+                    put("name", "mesh")
+                    putJsonArray("primitives") { primitives.forEach { add(it) } }
+                    if (model.morphTargetNames.isNotEmpty()) {
+                        putJsonArray("weights") { model.morphTargetNames.forEach { add(0f) } }
+                        putJsonObject("extras") {
+                            putJsonArray("targetNames") { model.morphTargetNames.forEach { add(it) } }
+                        }
+                    }
+                }
+            }
+            putJsonArray("materials") {
+                for (index in model.primitives.indices) {
+                    addJsonObject {
+                        put("name", "material_%02d".format(index))
+                        putJsonObject("pbrMetallicRoughness") {
+                            putFloats("baseColorFactor", 1f, 1f, 1f, 1f)
+                            put("metallicFactor", 0f)
+                        }
+                    }
+                }
+            }
+            putJsonArray("skins") {
+                addJsonObject {
+                    put("inverseBindMatrices", inverseBindMatricesAccessor)
+                    put("skeleton", 0)
+                    putJsonArray("joints") { model.bones.indices.forEach { add(it) } }
+                }
+            }
+            putJsonArray("accessors") { builder.accessors.forEach { add(it) } }
+            putJsonArray("bufferViews") { builder.bufferViews.forEach { add(it) } }
+            putJsonArray("buffers") {
+                addJsonObject { put("byteLength", builder.binary.align(4).size) }
+            }
+        }
+
+        val jsonBytes = OutputBuffer().putBytes(json.toString().toByteArray(Charsets.UTF_8)).align(4, ' '.code.toByte())
+        val binaryBytes = builder.binary.align(4)
+        val output = OutputBuffer(12 + 8 + jsonBytes.size + 8 + binaryBytes.size)
+        output.putInt(GLTF_BINARY_MAGIC)
+        output.putInt(2)
+        output.putInt(12 + 8 + jsonBytes.size + 8 + binaryBytes.size)
+        output.putInt(jsonBytes.size)
+        output.putInt(CHUNK_JSON)
+        output.putBytes(jsonBytes.toByteArray())
+        output.putInt(binaryBytes.size)
+        output.putInt(CHUNK_BINARY)
+        output.putBytes(binaryBytes.toByteArray())
+        return output.toByteArray()
+    }
+
+    fun write(model: SyntheticModel, path: Path, vrm: Boolean = false) = path.writeBytes(write(model, vrm))
+}
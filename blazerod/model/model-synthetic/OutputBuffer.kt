@@ -0,0 +1,77 @@
+package top.fifthlight.blazerod.model.synthetic
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.charset.Charset
+
+// Growable little endian buffer for writing model files
+internal class OutputBuffer(initialCapacity: Int = 64 * 1024) {
+    private var buffer = ByteBuffer.allocate(initialCapacity).order(ByteOrder.LITTLE_ENDIAN)
+
+    val size: Int
+        get() = buffer.position()
+
+    private fun ensureRemaining(length: Int) {
+        if (buffer.remaining() >= length) {
+            return
+        }
+        var capacity = buffer.capacity() * 2
+        while (capacity - buffer.position() < length) {
+            capacity *= 2
+        }
+        buffer = ByteBuffer.allocate(capacity).order(ByteOrder.LITTLE_ENDIAN).put(buffer.flip())
+    }
+
+    fun put(value: Byte) = apply {
+        ensureRemaining(1)
+        buffer.put(value)
+    }
+
+    fun putShort(value: Short) = apply {
+        ensureRemaining(2)
+        buffer.putShort(value)
+    }
+
+    fun putInt(value: Int) = apply {
+        ensureRemaining(4)
+        buffer.putInt(value)
+    }
+
+    fun putFloat(value: Float) = apply {
+        ensureRemaining(4)
+        buffer.putFloat(value)
+    }
+
+    fun putBytes(value: ByteArray) = apply {
+        ensureRemaining(value.size)
+        buffer.put(value)
+    }
+
+    // Index of 1, 2 or 4 bytes, as used by PMX
+    fun putIndex(size: Int, value: Int) = when (size) {
+        1 -> put(value.toByte())
+        2 -> putShort(value.toShort())
+        4 -> putInt(value)
+        else -> throw IllegalArgumentException("Bad index size: $size")
+    }
+
+    // Zero padded string of fixed length, truncated if too long
+    fun putFixedString(value: String, length: Int, charset: Charset) = apply {
+        val bytes = value.toByteArray(charset)
+        putBytes(bytes.copyOf(length))
+    }
+
+    // Pad with value until the size is a multiple of alignment
+    fun align(alignment: Int, value: Byte = 0) = apply {
+        while (size % alignment != 0) {
+            put(value)
+        }
+    }
+
+    // Overwrite a value written before, like a count only known after writing the items
+    fun setInt(position: Int, value: Int) = apply {
+        buffer.putInt(position, value)
+    }
+
+    fun toByteArray(): ByteArray = buffer.array().copyOf(size)
+}
@@ -0,0 +1,210 @@
+package top.fifthlight.blazerod.model.synthetic
+
+import top.fifthlight.blazerod.model.util.MMD_SCALE
+import java.nio.file.Path
+import kotlin.io.path.writeBytes
+
+/**
+ * Write a synthetic model as PMX 2.0, in UTF-8 and the smallest index sizes. Morph targets are written as vertex
+ * morphs, and IK chains as IK bones. The file has no textures, display frames, rigid bodies or joints.
+ */
+object PmxWriter {
+    private val PMX_SIGNATURE = byteArrayOf(0x50, 0x4D, 0x58, 0x20)
+
+    // PMX flags of bones
+    private const val BONE_ROTATABLE = 1 shl 1
+    private const val BONE_TRANSLATABLE = 1 shl 2
+    private const val BONE_VISIBLE = 1 shl 3
+    private const val BONE_ENABLED = 1 shl 4
+    private const val BONE_IK = 1 shl 5
+
+    private const val MORPH_PANEL_OTHER: Byte = 4
+    private const val MORPH_TYPE_VERTEX: Byte = 1
+
+    private const val WEIGHT_BDEF1: Byte = 0
+    private const val WEIGHT_BDEF2: Byte = 1
+
+    // Vertex indices are unsigned, other indices are signed as -1 is none
+    private fun unsignedIndexSize(count: Int) = when {
+        count <= 0xFF -> 1
+        count <= 0xFFFF -> 2
+        else -> 4
+    }
+
+    private fun signedIndexSize(count: Int) = when {
+        count <= Byte.MAX_VALUE -> 1
+        count <= Short.MAX_VALUE -> 2
+        else -> 4
+    }
+
+    private fun OutputBuffer.putString(value: String) {
+        val bytes = value.toByteArray(Charsets.UTF_8)
+        putInt(bytes.size)
+        putBytes(bytes)
+    }
+
+    // Mirror X axis and convert to MMD unit
+    private fun OutputBuffer.putPosition(x: Float, y: Float, z: Float) {
+        putFloat(-x / MMD_SCALE)
+        putFloat(y / MMD_SCALE)
+        putFloat(z / MMD_SCALE)
+    }
+
+    fun write(model: SyntheticModel): ByteArray {
+        val vertexCount = model.primitives.sumOf { it.vertices }
+        val vertexIndexSize = unsignedIndexSize(vertexCount)
+        val materialIndexSize = signedIndexSize(model.primitives.size)
+        val boneIndexSize = signedIndexSize(model.bones.size)
+        val morphIndexSize = signedIndexSize(model.morphTargetNames.size)
+        val output = OutputBuffer()
+
+        // Header
+        output.putBytes(PMX_SIGNATURE)
+        output.putFloat(2.0f)
+        output.put(8)
+        output.put(1) // UTF-8
+        output.put(0) // Additional vec4
+        output.put(vertexIndexSize.toByte())
+        output.put(1) // Texture index size
+        output.put(materialIndexSize.toByte())
+        output.put(boneIndexSize.toByte())
+        output.put(morphIndexSize.toByte())
+        output.put(1) // Rigid body index size
+        output.putString("synthetic")
+        output.putString("synthetic")
+        output.putString(model.spec.toString())
+        output.putString(model.spec.toString())
+
+        // Vertices
+        output.putInt(vertexCount)
+        for (primitive in model.primitives) {
+            for (vertex in 0 until primitive.vertices) {
+                output.putPosition(
+                    primitive.positions[vertex * 3 + 0],
+                    primitive.positions[vertex * 3 + 1],
+                    primitive.positions[vertex * 3 + 2],
+                )
+                output.putFloat(-primitive.normals[vertex * 3 + 0])
+                output.putFloat(primitive.normals[vertex * 3 + 1])
+                output.putFloat(primitive.normals[vertex * 3 + 2])
+                output.putFloat(primitive.texcoords[vertex * 2 + 0])
+                output.putFloat(primitive.texcoords[vertex * 2 + 1])
+                val jointA = primitive.joints[vertex * 4 + 0]
+                val jointB = primitive.joints[vertex * 4 + 1]
+                if (jointA == jointB) {
+                    output.put(WEIGHT_BDEF1)
+                    output.putIndex(boneIndexSize, jointA)
+                } else {
+                    output.put(WEIGHT_BDEF2)
+                    output.putIndex(boneIndexSize, jointA)
+                    output.putIndex(boneIndexSize, jointB)
+                    output.putFloat(primitive.weights[vertex * 4 + 0])
+                }
+                output.putFloat(1f) // Edge scale
+            }
+        }
+
+        // Surfaces, PMX triangles are clockwise
+        output.putInt(model.primitives.sumOf { it.indices.size })
+        var vertexOffset = 0
+        for (primitive in model.primitives) {
+            for (triangle in 0 until primitive.indices.size / 3) {
+                output.putIndex(vertexIndexSize, vertexOffset + primitive.indices[triangle * 3 + 0])
+                output.putIndex(vertexIndexSize, vertexOffset + primitive.indices[triangle * 3 + 2])
+                output.putIndex(vertexIndexSize, vertexOffset + primitive.indices[triangle * 3 + 1])
+            }
+            vertexOffset += primitive.vertices
+        }
+
+        // Textures
+        output.putInt(0)
+
+        // Materials
+        output.putInt(model.primitives.size)
+        for ((index, primitive) in model.primitives.withIndex()) {
+            output.putString("material_%02d".format(index))
+            output.putString("material_%02d".format(index))
+            repeat(4) { output.putFloat(1f) } // Diffuse
+            repeat(3) { output.putFloat(0f) } // Specular
+            output.putFloat(0f) // Specular strength
+            repeat(3) { output.putFloat(.5f) } // Ambient
+            output.put(0) // Drawing flags
+            repeat(4) { output.putFloat(0f) } // Edge color
+            output.putFloat(0f) // Edge scale
+            output.put(-1) // Texture
+            output.put(-1) // Environment texture
+            output.put(0) // Environment blend mode
+            output.put(1) // Internal toon
+            output.put(0)
+            output.putString("")
+            output.putInt(primitive.indices.size)
+        }
+
+        // Bones
+        val ikChainByBone = model.ikChains.associateBy { it.ikBone }
+        output.putInt(model.bones.size)
+        for ((index, bone) in model.bones.withIndex()) {
+            val ikChain = ikChainByBone[index]
+            output.putString(bone.name)
+            output.putString(bone.humanoidTag?.pmxEnglish ?: bone.name)
+            output.putPosition(bone.position.x(), bone.position.y(), bone.position.z())
+            output.putIndex(boneIndexSize, bone.parent ?: -1)
+            output.putInt(0) // Layer
+            var flags = BONE_ROTATABLE or BONE_VISIBLE or BONE_ENABLED
+            if (bone.parent == null || ikChain != null) {
+                flags = flags or BONE_TRANSLATABLE
+            }
+            if (ikChain != null) {
+                flags = flags or BONE_IK
+            }
+            output.putShort(flags.toShort())
+            repeat(3) { output.putFloat(0f) } // Tail offset
+            if (ikChain != null) {
+                output.putIndex(boneIndexSize, ikChain.tip)
+                output.putInt(SyntheticModel.IK_LOOP_COUNT)
+                output.putFloat(SyntheticModel.IK_LIMIT_RADIAN)
+                output.putInt(ikChain.links.size)
+                for (link in ikChain.links) {
+                    output.putIndex(boneIndexSize, link)
+                    output.put(0) // No limits
+                }
+            }
+        }
+
+        // Morphs
+        output.putInt(model.morphTargetNames.size)
+        for ((target, name) in model.morphTargetNames.withIndex()) {
+            output.putString(name)
+            output.putString(name)
+            output.put(MORPH_PANEL_OTHER)
+            output.put(MORPH_TYPE_VERTEX)
+            val offsetCountPosition = output.size
+            output.putInt(0)
+            var offsetCount = 0
+            vertexOffset = 0
+            for (primitive in model.primitives) {
+                val offsets = primitive.morphOffsets[target]
+                for (vertex in 0 until primitive.vertices) {
+                    val x = offsets[vertex * 3 + 0]
+                    val y = offsets[vertex * 3 + 1]
+                    val z = offsets[vertex * 3 + 2]
+                    if (x == 0f && y == 0f && z == 0f) {
+                        continue
+                    }
+                    output.putIndex(vertexIndexSize, vertexOffset + vertex)
+                    output.putPosition(x, y, z)
+                    offsetCount++
+                }
+                vertexOffset += primitive.vertices
+            }
+            output.setInt(offsetCountPosition, offsetCount)
+        }
+
+        // Display frames, rigid bodies and joints
+        repeat(3) { output.putInt(0) }
+
+        return output.toByteArray()
+    }
+
+    fun write(model: SyntheticModel, path: Path) = path.writeBytes(write(model))
+}
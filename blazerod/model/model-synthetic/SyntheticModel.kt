@@ -0,0 +1,248 @@
+package top.fifthlight.blazerod.model.synthetic
+
+import org.joml.Vector3f
+import org.joml.Vector3fc
+import top.fifthlight.blazerod.model.HumanoidTag
+import kotlin.math.PI
+import kotlin.math.cos
+import kotlin.math.min
+import kotlin.math.sin
+import kotlin.random.Random
+
+/**
+ * A deterministic model generated from [spec], in glTF coordinates. It can be written as PMX, glTF binary, VRM and VMD
+ * files, or converted to an in-memory model by [toModel].
+ *
+ * Each primitive is a tube along the joints, made of rings of [RING_VERTICES] vertices. Every vertex is skinned by the
+ * two joints nearest to its ring, and each morph target moves about a quarter of the vertices along their normals.
+ */
+class SyntheticModel private constructor(
+    val spec: SyntheticModelSpec,
+    val bones: List<Bone>,
+    val ikChains: List<IkChain>,
+    val primitives: List<PrimitiveData>,
+    val morphTargetNames: List<String>,
+) {
+    class Bone(
+        val name: String,
+        val parent: Int?,
+        // Model space position
+        val position: Vector3fc,
+        val humanoidTag: HumanoidTag?,
+    )
+
+    /**
+     * An IK chain in PMX terms: the [links] rotate to move [tip] to the position of [ikBone]. Links are ordered from
+     * the tip to the root of the chain.
+     */
+    class IkChain(
+        val ikBone: Int,
+        val tip: Int,
+        val links: List<Int>,
+    )
+
+    class PrimitiveData(
+        val positions: FloatArray,
+        val normals: FloatArray,
+        val texcoords: FloatArray,
+        // Four joints and weights for each vertex
+        val joints: IntArray,
+        val weights: FloatArray,
+        // Triangles, counterclockwise
+        val indices: IntArray,
+        // Position offsets of each morph target
+        val morphOffsets: List<FloatArray>,
+    ) {
+        val vertices: Int
+            get() = positions.size / 3
+    }
+
+    companion object {
+        const val RING_VERTICES = 8
+        const val IK_LOOP_COUNT = 40
+        const val IK_LIMIT_RADIAN = 1f
+
+        private const val BONE_LENGTH = 0.05f
+        private const val FLAT_RADIUS = 0.5f
+        private const val TUBE_RADIUS = 0.03f
+        private const val MORPH_DISTANCE = 0.01f
+
+        // Required bones of VRM 1.0, assigned to the first joints in this order
+        val HUMANOID_TAGS = listOf(
+            HumanoidTag.HIPS,
+            HumanoidTag.SPINE,
+            HumanoidTag.HEAD,
+            HumanoidTag.LEFT_UPPER_LEG,
+            HumanoidTag.LEFT_LOWER_LEG,
+            HumanoidTag.LEFT_FOOT,
+            HumanoidTag.RIGHT_UPPER_LEG,
+            HumanoidTag.RIGHT_LOWER_LEG,
+            HumanoidTag.RIGHT_FOOT,
+            HumanoidTag.LEFT_UPPER_ARM,
+            HumanoidTag.LEFT_LOWER_ARM,
+            HumanoidTag.LEFT_HAND,
+            HumanoidTag.RIGHT_UPPER_ARM,
+            HumanoidTag.RIGHT_LOWER_ARM,
+            HumanoidTag.RIGHT_HAND,
+        )
+
+        private fun generateJoints(spec: SyntheticModelSpec, random: Random, bones: MutableList<Bone>) {
+            repeat(spec.joints) { index ->
+                val parent = when {
+                    index == 0 -> null
+                    spec.hierarchy == SyntheticModelSpec.Hierarchy.CHAIN -> index - 1
+                    spec.hierarchy == SyntheticModelSpec.Hierarchy.FLAT -> 0
+                    else -> (index - 1) / 2
+                }
+                val position = when {
+                    parent == null -> Vector3f(0f, 1f, 0f)
+                    spec.hierarchy == SyntheticModelSpec.Hierarchy.FLAT -> {
+                        val angle = (index - 1) * 2 * PI.toFloat() / (spec.joints - 1)
+                        Vector3f(cos(angle) * FLAT_RADIUS, 1f, sin(angle) * FLAT_RADIUS)
+                    }
+
+                    else -> Vector3f(
+                        random.nextFloat() - .5f,
+                        random.nextFloat() * .5f + .5f,
+                        random.nextFloat() - .5f,
+                    ).normalize(BONE_LENGTH).add(bones[parent].position)
+                }
+                bones.add(
+                    Bone(
+                        name = "bone_%04d".format(index),
+                        parent = parent,
+                        position = position,
+                        humanoidTag = HUMANOID_TAGS.getOrNull(index),
+                    )
+                )
+            }
+        }
+
+        private fun generateIkChains(spec: SyntheticModelSpec, bones: MutableList<Bone>) = List(spec.ikChains) { chain ->
+            val base = Vector3f((chain - (spec.ikChains - 1) / 2f) * 0.1f, 1f, 0.2f)
+            fun addBone(name: String, parent: Int, depth: Int): Int {
+                bones.add(
+                    Bone(
+                        name = name,
+                        parent = parent,
+                        position = Vector3f(base).sub(0f, depth * BONE_LENGTH, 0f),
+                        humanoidTag = null,
+                    )
+                )
+                return bones.lastIndex
+            }
+
+            var parent = 0
+            val links = List(spec.ikChainLength) { link ->
+                addBone("ik%03d_link%02d".format(chain, link), parent, link).also { parent = it }
+            }
+            val tip = addBone("ik%03d_tip".format(chain), parent, spec.ikChainLength)
+            val ikBone = addBone("ik%03d_target".format(chain), 0, spec.ikChainLength)
+            IkChain(
+                ikBone = ikBone,
+                tip = tip,
+                links = links.reversed(),
+            )
+        }
+
+        private fun generatePrimitive(
+            spec: SyntheticModelSpec,
+            random: Random,
+            bones: List<Bone>,
+            primitiveIndex: Int,
+        ): PrimitiveData {
+            val rings = spec.verticesPerPrimitive / RING_VERTICES
+            val totalRings = rings * spec.primitives
+            val vertices = rings * RING_VERTICES
+            val positions = FloatArray(vertices * 3)
+            val normals = FloatArray(vertices * 3)
+            val texcoords = FloatArray(vertices * 2)
+            val joints = IntArray(vertices * 4)
+            val weights = FloatArray(vertices * 4)
+            val center = Vector3f()
+            for (ring in 0 until rings) {
+                // Spread rings of all primitives along all joints
+                val progress = (primitiveIndex * rings + ring).toFloat() / totalRings * (spec.joints - 1)
+                val jointA = progress.toInt()
+                val jointB = min(jointA + 1, spec.joints - 1)
+                val weightB = progress - jointA
+                center.set(bones[jointA].position).lerp(bones[jointB].position, weightB)
+                for (index in 0 until RING_VERTICES) {
+                    val vertex = ring * RING_VERTICES + index
+                    val angle = index * 2 * PI.toFloat() / RING_VERTICES
+                    val normalX = cos(angle)
+                    val normalZ = sin(angle)
+                    positions[vertex * 3 + 0] = center.x + normalX * TUBE_RADIUS
+                    positions[vertex * 3 + 1] = center.y
+                    positions[vertex * 3 + 2] = center.z + normalZ * TUBE_RADIUS
+                    normals[vertex * 3 + 0] = normalX
+                    normals[vertex * 3 + 1] = 0f
+                    normals[vertex * 3 + 2] = normalZ
+                    texcoords[vertex * 2 + 0] = index.toFloat() / RING_VERTICES
+                    texcoords[vertex * 2 + 1] = ring.toFloat() / (rings - 1)
+                    joints[vertex * 4 + 0] = jointA
+                    joints[vertex * 4 + 1] = jointB
+                    weights[vertex * 4 + 0] = 1f - weightB
+                    weights[vertex * 4 + 1] = weightB
+                }
+            }
+
+            val indices = IntArray((rings - 1) * RING_VERTICES * 6)
+            var position = 0
+            for (ring in 0 until rings - 1) {
+                for (index in 0 until RING_VERTICES) {
+                    val a = ring * RING_VERTICES + index
+                    val b = ring * RING_VERTICES + (index + 1) % RING_VERTICES
+                    val c = a + RING_VERTICES
+                    val d = b + RING_VERTICES
+                    indices[position++] = a
+                    indices[position++] = c
+                    indices[position++] = b
+                    indices[position++] = b
+                    indices[position++] = c
+                    indices[position++] = d
+                }
+            }
+
+            val morphOffsets = List(spec.morphTargets) { target ->
+                FloatArray(vertices * 3).also { offsets ->
+                    for (vertex in 0 until vertices) {
+                        // At least one vertex for each target, as PMX drops morphs without offsets
+                        if (vertex != target % vertices && random.nextInt(4) != 0) {
+                            continue
+                        }
+                        val distance = (.5f + random.nextFloat()) * MORPH_DISTANCE
+                        offsets[vertex * 3 + 0] = normals[vertex * 3 + 0] * distance
+                        offsets[vertex * 3 + 1] = normals[vertex * 3 + 1] * distance
+                        offsets[vertex * 3 + 2] = normals[vertex * 3 + 2] * distance
+                    }
+                }
+            }
+
+            return PrimitiveData(
+                positions = positions,
+                normals = normals,
+                texcoords = texcoords,
+                joints = joints,
+                weights = weights,
+                indices = indices,
+                morphOffsets = morphOffsets,
+            )
+        }
+
+        fun generate(spec: SyntheticModelSpec): SyntheticModel {
+            val random = Random(spec.seed)
+            val bones = mutableListOf<Bone>()
+            generateJoints(spec, random, bones)
+            val ikChains = generateIkChains(spec, bones)
+            val primitives = List(spec.primitives) { generatePrimitive(spec, random, bones, it) }
+            return SyntheticModel(
+                spec = spec,
+                bones = bones,
+                ikChains = ikChains,
+                primitives = primitives,
+                morphTargetNames = List(spec.morphTargets) { "morph_%04d".format(it) },
+            )
+        }
+    }
+}
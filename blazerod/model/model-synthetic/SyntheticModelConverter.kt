@@ -0,0 +1,195 @@
+package top.fifthlight.blazerod.model.synthetic
+
+import org.joml.Matrix4f
+import org.joml.Quaternionf
+import org.joml.Vector3f
+import top.fifthlight.blazerod.model.*
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.util.*
+
+//                             POS NORM UV  JOINT WEIGHT
+private const val VERTEX_SIZE = (3 + 3 + 2 + 4 + 4) * 4
+
+private fun directBuffer(size: Int) = ByteBuffer.allocateDirect(size).order(ByteOrder.LITTLE_ENDIAN)
+
+private fun vertexAttributes(name: String, primitive: SyntheticModel.PrimitiveData): Primitive.Attributes.Primitive {
+    val vertices = primitive.vertices
+    val data = directBuffer(vertices * VERTEX_SIZE)
+    for (vertex in 0 until vertices) {
+        repeat(3) { data.putFloat(primitive.positions[vertex * 3 + it]) }
+        repeat(3) { data.putFloat(primitive.normals[vertex * 3 + it]) }
+        repeat(2) { data.putFloat(primitive.texcoords[vertex * 2 + it]) }
+        repeat(4) { data.putInt(primitive.joints[vertex * 4 + it]) }
+        repeat(4) { data.putFloat(primitive.weights[vertex * 4 + it]) }
+    }
+    data.flip()
+    val bufferView = BufferView(
+        buffer = Buffer(name = name, buffer = data),
+        byteLength = data.remaining(),
+        byteOffset = 0,
+        byteStride = VERTEX_SIZE,
+    )
+    fun accessor(offset: Int, componentType: Accessor.ComponentType, type: Accessor.AccessorType) = Accessor(
+        bufferView = bufferView,
+        byteOffset = offset,
+        componentType = componentType,
+        count = vertices,
+        type = type,
+    )
+    return Primitive.Attributes.Primitive(
+        position = accessor(0, Accessor.ComponentType.FLOAT, Accessor.AccessorType.VEC3),
+        normal = accessor(3 * 4, Accessor.ComponentType.FLOAT, Accessor.AccessorType.VEC3),
+        texcoords = listOf(accessor((3 + 3) * 4, Accessor.ComponentType.FLOAT, Accessor.AccessorType.VEC2)),
+        joints = listOf(accessor((3 + 3 + 2) * 4, Accessor.ComponentType.UNSIGNED_INT, Accessor.AccessorType.VEC4)),
+        weights = listOf(accessor((3 + 3 + 2 + 4) * 4, Accessor.ComponentType.FLOAT, Accessor.AccessorType.VEC4)),
+    )
+}
+
+private fun indexAccessor(name: String, primitive: SyntheticModel.PrimitiveData): Accessor {
+    val componentType = if (primitive.vertices <= 0xFFFF) {
+        Accessor.ComponentType.UNSIGNED_SHORT
+    } else {
+        Accessor.ComponentType.UNSIGNED_INT
+    }
+    val data = directBuffer(primitive.indices.size * componentType.byteLength)
+    for (index in primitive.indices) {
+        if (componentType == Accessor.ComponentType.UNSIGNED_SHORT) {
+            data.putShort(index.toShort())
+        } else {
+            data.putInt(index)
+        }
+    }
+    data.flip()
+    return Accessor(
+        bufferView = BufferView(
+            buffer = Buffer(name = name, buffer = data),
+            byteLength = data.remaining(),
+            byteOffset = 0,
+            byteStride = 0,
+        ),
+        componentType = componentType,
+        count = primitive.indices.size,
+        type = Accessor.AccessorType.SCALAR,
+    )
+}
+
+private fun morphTarget(name: String, offsets: FloatArray): Primitive.Attributes.MorphTarget {
+    val data = directBuffer(offsets.size * 4)
+    offsets.forEach { data.putFloat(it) }
+    data.flip()
+    return Primitive.Attributes.MorphTarget(
+        position = Accessor(
+            name = name,
+            bufferView = BufferView(
+                buffer = Buffer(name = name, buffer = data),
+                byteLength = data.remaining(),
+                byteOffset = 0,
+                byteStride = 0,
+            ),
+            componentType = Accessor.ComponentType.FLOAT,
+            count = offsets.size / 3,
+            type = Accessor.AccessorType.VEC3,
+        )
+    )
+}
+
+/**
+ * Build the model in memory, in the same structure as loaded from the PMX file: bone nodes, then a skinned mesh node
+ * for each primitive, with IK chains and one expression for each morph target.
+ */
+fun SyntheticModel.toModel(): Model {
+    val modelId = UUID.randomUUID()
+    val children = bones.indices.groupBy { bones[it].parent }
+    val ikChainsByTip = ikChains.groupBy { it.tip }
+
+    fun addBone(index: Int): Node {
+        val bone = bones[index]
+        val parentPosition = bone.parent?.let { bones[it].position }
+        return Node(
+            name = bone.name,
+            id = NodeId(modelId, index),
+            transform = NodeTransform.Decomposed(
+                translation = Vector3f(bone.position).also { if (parentPosition != null) it.sub(parentPosition) },
+                rotation = Quaternionf(),
+                scale = Vector3f(1f),
+            ),
+            children = children[index]?.map(::addBone) ?: listOf(),
+            components = ikChainsByTip[index]?.map { chain ->
+                NodeComponent.IkTargetComponent(
+                    ikTarget = IkTarget(
+                        limitRadian = SyntheticModel.IK_LIMIT_RADIAN,
+                        loopCount = SyntheticModel.IK_LOOP_COUNT,
+                        joints = chain.links.map { IkTarget.IkJoint(nodeId = NodeId(modelId, it), limit = null) },
+                        effectorNodeId = NodeId(modelId, chain.ikBone),
+                    ),
+                    transformId = TransformId.IK,
+                )
+            } ?: listOf(),
+        )
+    }
+
+    val rootNodes = children[null]?.map(::addBone)?.toMutableList() ?: mutableListOf()
+
+    val skin = Skin(
+        name = "Synthetic skin",
+        joints = bones.indices.map { NodeId(modelId, it) },
+        inverseBindMatrices = bones.map { Matrix4f().translation(it.position).invertAffine() },
+        jointHumanoidTags = bones.map { it.humanoidTag },
+    )
+
+    val meshIds = primitives.mapIndexed { index, primitive ->
+        val nodeIndex = bones.size + index
+        val meshId = MeshId(modelId, nodeIndex)
+        val name = "material_%02d".format(index)
+        rootNodes.add(
+            Node(
+                name = "Node for $name",
+                id = NodeId(modelId, nodeIndex),
+                components = listOf(
+                    NodeComponent.MeshComponent(
+                        mesh = Mesh(
+                            id = meshId,
+                            primitives = listOf(
+                                Primitive(
+                                    mode = Primitive.Mode.TRIANGLES,
+                                    material = Material.Unlit(name = name),
+                                    attributes = vertexAttributes("Vertex buffer for $name", primitive),
+                                    indices = indexAccessor("Index buffer for $name", primitive),
+                                    targets = primitive.morphOffsets.mapIndexed { target, offsets ->
+                                        morphTarget("Morph #$target $name vertex buffer", offsets)
+                                    },
+                                )
+                            ),
+                            weights = null,
+                        )
+                    ),
+                    NodeComponent.SkinComponent(
+                        skin = skin,
+                        meshIds = listOf(meshId),
+                    ),
+                )
+            )
+        )
+        meshId
+    }
+
+    val scene = Scene(nodes = rootNodes)
+    return Model(
+        scenes = listOf(scene),
+        defaultScene = scene,
+        skins = listOf(skin),
+        expressions = morphTargetNames.mapIndexed { target, name ->
+            Expression.Target(
+                name = name,
+                bindings = meshIds.map { meshId ->
+                    Expression.Target.Binding.MeshMorphTarget(
+                        meshId = meshId,
+                        index = target,
+                        weight = 1f,
+                    )
+                },
+            )
+        },
+    )
+}
@@ -0,0 +1,42 @@
+package top.fifthlight.blazerod.model.synthetic
+
+/**
+ * Parameters of a synthetic model. Models generated from equal specs are identical, so they can be used as fixtures
+ * of tests and benchmarks scaling with model complexity.
+ */
+data class SyntheticModelSpec(
+    // Skinned joints, bones of IK chains are not counted
+    val joints: Int = 16,
+    val hierarchy: Hierarchy = Hierarchy.TREE,
+    val primitives: Int = 1,
+    // Rounded down to whole rings of SyntheticModel.RING_VERTICES
+    val verticesPerPrimitive: Int = 256,
+    val morphTargets: Int = 0,
+    val ikChains: Int = 0,
+    // Links of each IK chain
+    val ikChainLength: Int = 3,
+    val seed: Long = 0,
+) {
+    enum class Hierarchy {
+        // Each joint is the child of the previous one
+        CHAIN,
+
+        // All joints are children of the first one
+        FLAT,
+
+        // Binary tree, in breadth-first order
+        TREE,
+    }
+
+    init {
+        require(joints >= 1) { "Bad joint count: $joints, should be at least 1" }
+        require(primitives >= 1) { "Bad primitive count: $primitives, should be at least 1" }
+        require(verticesPerPrimitive >= 2 * SyntheticModel.RING_VERTICES) {
+            "Bad vertex count: $verticesPerPrimitive, should be at least ${2 * SyntheticModel.RING_VERTICES}"
+        }
+        require(morphTargets >= 0) { "Bad morph target count: $morphTargets" }
+        // Bone names must fit in the 15 bytes of VMD
+        require(ikChains in 0 until 1000) { "Bad IK chain count: $ikChains, should be in [0, 1000)" }
+        require(ikChainLength in 1 until 100) { "Bad IK chain length: $ikChainLength, should be in [1, 100)" }
+    }
+}
@@ -0,0 +1,115 @@
+package top.fifthlight.blazerod.model.synthetic
+
+import org.joml.Quaternionf
+import org.joml.Vector3f
+import top.fifthlight.blazerod.model.util.MMD_SCALE
+import java.nio.charset.Charset
+import java.nio.file.Path
+import kotlin.io.path.writeBytes
+import kotlin.math.PI
+import kotlin.math.sin
+import kotlin.random.Random
+
+/**
+ * Parameters of a synthetic motion. Every bone and morph target of the model gets a keyframe at every
+ * [keyFrameInterval] frames, so the keyframe count scales with the model.
+ */
+data class SyntheticAnimationSpec(
+    // In 30 FPS frames
+    val frames: Int = 300,
+    val keyFrameInterval: Int = 10,
+    val seed: Long = 0,
+) {
+    init {
+        require(frames >= 0) { "Bad frame count: $frames" }
+        require(keyFrameInterval >= 1) { "Bad keyframe interval: $keyFrameInterval, should be at least 1" }
+    }
+}
+
+/**
+ * Write a synthetic motion of a synthetic model as VMD. Bones rotate back and forth around a random axis, IK bones
+ * also move in a circle, and morph targets fade in and out. Each keyframe has a random bezier curve.
+ */
+object VmdWriter {
+    private val SHIFT_JIS = Charset.forName("Shift-JIS")
+    private const val SIGNATURE = "Vocaloid Motion Data 0002"
+    private const val MAX_ANGLE = PI.toFloat() / 6
+    private const val IK_RADIUS = 0.05f
+
+    private fun OutputBuffer.putInterpolation(random: Random) {
+        // The same curve for X, Y, Z and rotation, in the layout of MMD: x1, y1, x2, y2 of all channels, then the
+        // same bytes shifted by one for each of the next three rows
+        val x1 = random.nextInt(0, 128).toByte()
+        val y1 = random.nextInt(0, 128).toByte()
+        val x2 = random.nextInt(0, 128).toByte()
+        val y2 = random.nextInt(0, 128).toByte()
+        val row = ByteArray(16) { index ->
+            when (index / 4) {
+                0 -> x1
+                1 -> y1
+                2 -> x2
+                else -> y2
+            }
+        }
+        repeat(4) { shift ->
+            putBytes(ByteArray(16) { index -> row.getOrElse(index + shift) { 0 } })
+        }
+    }
+
+    fun write(model: SyntheticModel, spec: SyntheticAnimationSpec): ByteArray {
+        val random = Random(spec.seed)
+        val keyFrames = (0..spec.frames step spec.keyFrameInterval).toList()
+        val ikBones = model.ikChains.map { it.ikBone }.toSet()
+        val output = OutputBuffer()
+
+        output.putFixedString(SIGNATURE, 30, SHIFT_JIS)
+        output.putFixedString("synthetic", 20, SHIFT_JIS)
+
+        output.putInt(model.bones.size * keyFrames.size)
+        val axis = Vector3f()
+        val rotation = Quaternionf()
+        val translation = Vector3f()
+        for ((index, bone) in model.bones.withIndex()) {
+            axis.set(random.nextFloat() - .5f, random.nextFloat() - .5f, random.nextFloat() - .5f).normalize()
+            val phase = random.nextFloat() * 2 * PI.toFloat()
+            for (frame in keyFrames) {
+                val angle = frame * 2 * PI.toFloat() / 60f + phase
+                if (index in ikBones) {
+                    rotation.identity()
+                    translation.set(sin(angle) * IK_RADIUS, 0f, sin(angle + PI.toFloat() / 2) * IK_RADIUS)
+                } else {
+                    rotation.rotationAxis(sin(angle) * MAX_ANGLE, axis)
+                    translation.set(0f)
+                }
+                output.putFixedString(bone.name, 15, SHIFT_JIS)
+                output.putInt(frame)
+                // Mirror X axis
+                output.putFloat(-translation.x / MMD_SCALE)
+                output.putFloat(translation.y / MMD_SCALE)
+                output.putFloat(translation.z / MMD_SCALE)
+                output.putFloat(rotation.x)
+                output.putFloat(-rotation.y)
+                output.putFloat(-rotation.z)
+                output.putFloat(rotation.w)
+                output.putInterpolation(random)
+            }
+        }
+
+        output.putInt(model.morphTargetNames.size * keyFrames.size)
+        for (name in model.morphTargetNames) {
+            val phase = random.nextFloat() * 2 * PI.toFloat()
+            for (frame in keyFrames) {
+                output.putFixedString(name, 15, SHIFT_JIS)
+                output.putInt(frame)
+                output.putFloat((sin(frame * 2 * PI.toFloat() / 90f + phase) + 1f) / 2f)
+            }
+        }
+
+        // Camera, light, self shadow and IK keyframes
+        repeat(4) { output.putInt(0) }
+
+        return output.toByteArray()
+    }
+
+    fun write(model: SyntheticModel, spec: SyntheticAnimationSpec, path: Path) = path.writeBytes(write(model, spec))
+}
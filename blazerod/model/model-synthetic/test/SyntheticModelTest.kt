@@ -0,0 +1,127 @@
+package top.fifthlight.blazerod.model.synthetic.test
+
+import top.fifthlight.blazerod.model.Expression
+import top.fifthlight.blazerod.model.Model
+import top.fifthlight.blazerod.model.NodeComponent
+import top.fifthlight.blazerod.model.forEach
+import top.fifthlight.blazerod.model.gltf.GltfBinaryLoader
+import top.fifthlight.blazerod.model.pmx.PmxLoader
+import top.fifthlight.blazerod.model.synthetic.*
+import top.fifthlight.blazerod.model.vmd.VmdLoader
+import java.nio.file.Path
+import kotlin.io.path.createTempFile
+import kotlin.io.path.deleteIfExists
+import kotlin.test.Test
+import kotlin.test.assertContentEquals
+import kotlin.test.assertEquals
+import kotlin.test.assertFailsWith
+import kotlin.test.assertNotNull
+
+class SyntheticModelTest {
+    private val spec = SyntheticModelSpec(
+        joints = 32,
+        primitives = 3,
+        verticesPerPrimitive = 128,
+        morphTargets = 4,
+        ikChains = 2,
+        ikChainLength = 3,
+        seed = 42,
+    )
+
+    private fun <T> withTempFile(suffix: String, block: (Path) -> T): T {
+        val file = createTempFile("synthetic", suffix)
+        try {
+            return block(file)
+        } finally {
+            file.deleteIfExists()
+        }
+    }
+
+    private fun Model.nodeComponents(): List<NodeComponent> = buildList {
+        for (scene in scenes) {
+            for (node in scene.nodes) {
+                node.forEach { addAll(it.components) }
+            }
+        }
+    }
+
+    private fun assertModelStructure(model: Model, meshNodes: Int) {
+        val components = model.nodeComponents()
+        assertEquals(meshNodes, components.count { it is NodeComponent.MeshComponent })
+        val skin = model.skins.single()
+        assertEquals(spec.joints + spec.ikChains * (spec.ikChainLength + 2), skin.joints.size)
+    }
+
+    @Test
+    fun testDeterministic() {
+        val first = SyntheticModel.generate(spec)
+        val second = SyntheticModel.generate(spec)
+        val animationSpec = SyntheticAnimationSpec(frames = 60)
+        assertContentEquals(PmxWriter.write(first), PmxWriter.write(second))
+        assertContentEquals(GltfWriter.write(first, vrm = true), GltfWriter.write(second, vrm = true))
+        assertContentEquals(VmdWriter.write(first, animationSpec), VmdWriter.write(second, animationSpec))
+    }
+
+    @Test
+    fun testPmxRoundTrip() {
+        val model = SyntheticModel.generate(spec)
+        val result = withTempFile(".pmx") { file ->
+            PmxWriter.write(model, file)
+            PmxLoader().load(file)
+        }
+        val loaded = assertNotNull(result.model)
+        assertModelStructure(loaded, spec.primitives)
+        assertEquals(spec.ikChains, loaded.nodeComponents().count { it is NodeComponent.IkTargetComponent })
+        assertEquals(spec.morphTargets, loaded.expressions.count { it is Expression.Target })
+    }
+
+    @Test
+    fun testGlbRoundTrip() {
+        val model = SyntheticModel.generate(spec)
+        val loaded = withTempFile(".glb") { file ->
+            GltfWriter.write(model, file)
+            assertNotNull(GltfBinaryLoader().load(file).model)
+        }
+        assertModelStructure(loaded, 1)
+    }
+
+    @Test
+    fun testVrmRoundTrip() {
+        val model = SyntheticModel.generate(spec)
+        val loaded = withTempFile(".vrm") { file ->
+            GltfWriter.write(model, file, vrm = true)
+            assertNotNull(GltfBinaryLoader().load(file).model)
+        }
+        assertModelStructure(loaded, 1)
+        assertEquals(spec.morphTargets, loaded.expressions.size)
+        val humanoidTags = loaded.skins.single().jointHumanoidTags.orEmpty().filterNotNull()
+        assertEquals(SyntheticModel.HUMANOID_TAGS.toSet(), humanoidTags.toSet())
+    }
+
+    @Test
+    fun testVrmNeedsHumanoid() {
+        val model = SyntheticModel.generate(SyntheticModelSpec(joints = 4))
+        assertFailsWith<IllegalArgumentException> {
+            GltfWriter.write(model, vrm = true)
+        }
+    }
+
+    @Test
+    fun testVmdRoundTrip() {
+        val model = SyntheticModel.generate(spec)
+        val result = withTempFile(".vmd") { file ->
+            VmdWriter.write(model, SyntheticAnimationSpec(frames = 60), file)
+            VmdLoader().load(file)
+        }
+        val animation = assertNotNull(result.animations).single()
+        assertEquals(model.bones.size * 2 + spec.morphTargets, animation.channels.size)
+    }
+
+    @Test
+    fun testInMemoryModel() {
+        val model = SyntheticModel.generate(spec).toModel()
+        assertModelStructure(model, spec.primitives)
+        assertEquals(spec.ikChains, model.nodeComponents().count { it is NodeComponent.IkTargetComponent })
+        assertEquals(spec.morphTargets, model.expressions.size)
+    }
+}
@@ -6,7 +6,12 @@ import top.fifthlight.mergetools.api.ExpectFactory
 import java.util.concurrent.CompletableFuture
 
 interface ModelLoader {
-    suspend fun loadModel(model: Model): RenderScene?
+    /**
+     * Load the scene of [model]. If [previous] is the scene of an earlier version of the same model, textures and
+     * buffers with unchanged content are shared with it instead of uploaded again. Only scenes loaded with
+     * [reloadable] can be passed as [previous], as indexing their content costs load time.
+     */
+    suspend fun loadModel(model: Model, previous: RenderScene? = null, reloadable: Boolean = false): RenderScene?
 
     fun loadModelAsFuture(model: Model): CompletableFuture<out RenderScene?>
 
@@ -1,6 +1,6 @@
 package top.fifthlight.blazerod.api.refcount
 
-import top.fifthlight.blazerod.debug.ResourceCountTracker
+import top.fifthlight.blazerod.debug.Metrics
 import java.util.concurrent.atomic.AtomicBoolean
 import java.util.concurrent.atomic.AtomicInteger
 
@@ -37,7 +37,7 @@ abstract class AbstractRefCount : RefCount {
             throw InvalidReferenceCountException(this, referenceCount)
         }
         if (initialized.compareAndSet(false, true)) {
-            ResourceCountTracker.instance?.increase(typeId)
+            Metrics.liveObjects(typeId).add(1)
         }
     }
 
@@ -49,7 +49,7 @@ abstract class AbstractRefCount : RefCount {
             refCount < 0 -> throw InvalidReferenceCountException(this, referenceCount)
             refCount == 0 -> {
                 closed = true
-                //ResourceCountTracker.instance?.decrease(typeId)
+                Metrics.liveObjects(typeId).add(-1)
                 onClosed()
             }
         }
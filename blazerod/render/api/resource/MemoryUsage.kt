@@ -0,0 +1,26 @@
+package top.fifthlight.blazerod.api.resource
+
+/**
+ * Estimated memory held by a resource, in bytes.
+ *
+ * @param gpuBytes size of GPU buffers and textures.
+ * @param heapBytes size of CPU side copies, including direct buffers.
+ */
+data class MemoryUsage(
+    val gpuBytes: Long,
+    val heapBytes: Long,
+) {
+    operator fun plus(other: MemoryUsage) = MemoryUsage(
+        gpuBytes = gpuBytes + other.gpuBytes,
+        heapBytes = heapBytes + other.heapBytes,
+    )
+
+    operator fun minus(other: MemoryUsage) = MemoryUsage(
+        gpuBytes = gpuBytes - other.gpuBytes,
+        heapBytes = heapBytes - other.heapBytes,
+    )
+
+    companion object {
+        val EMPTY = MemoryUsage(0, 0)
+    }
+}
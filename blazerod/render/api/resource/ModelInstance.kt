@@ -13,6 +13,9 @@ import java.util.function.Consumer
 interface ModelInstance : RefCount {
     val scene: RenderScene
 
+    // Memory held by this instance only, not including the scene
+    val memoryUsage: MemoryUsage
+
     fun clearTransform()
     fun setTransformMatrix(nodeIndex: Int, transformId: TransformId, matrix: Matrix4f)
     fun setTransformDecomposed(nodeIndex: Int, transformId: TransformId, decomposed: NodeTransformView.Decomposed)
@@ -21,13 +24,34 @@ interface ModelInstance : RefCount {
     fun setTransformBedrock(nodeIndex: Int, transformId: TransformId, updater: NodeTransform.Bedrock.() -> Unit)
     fun getIkEnabled(index: Int): Boolean
     fun setIkEnabled(index: Int, enabled: Boolean)
+
+    // Disable to skip physics simulation, e.g. for distant instances
+    var physicsEnabled: Boolean
     fun setGroupWeight(morphedPrimitiveIndex: Int, targetGroupIndex: Int, weight: Float)
 
     fun getCameraTransform(index: Int): CameraTransform?
 
+    /**
+     * Copy the pose, IK switches and spring bone and physics simulation of [previous], an instance of an earlier
+     * version of the same model, so a reloaded model keeps moving smoothly. Does nothing and returns false if the
+     * scenes differ in node, morph target or IK target layout.
+     */
+    fun copyStateFrom(previous: ModelInstance): Boolean
+
     fun updateCamera()
     fun debugRender(viewProjectionMatrix: Matrix4fc, consumers: VertexConsumerProvider)
-    fun updateRenderData()
+
+    /**
+     * Begin updating render data at frame [time] in nanoseconds, starting spring bone and physics simulations on
+     * worker threads. Begin all instances of a frame before updating any of them to run their simulations in parallel.
+     * The instance is changed by its simulation until [updateRenderData] or any other call joins it.
+     */
+    fun beginUpdateRenderData(time: Long)
+
+    /**
+     * Finish updating render data at frame [time] in nanoseconds, beginning the update first if not begun.
+     */
+    fun updateRenderData(time: Long)
 
     fun createRenderTask(
         modelMatrix: Matrix4fc,
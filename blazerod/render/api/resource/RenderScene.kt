@@ -17,5 +17,8 @@ interface RenderScene : RefCount {
     val nodeNameMap: Map<String, RenderNode>
     val humanoidTagMap: Map<HumanoidTag, RenderNode>
 
+    // Memory of resources shared by all instances of this scene
+    val memoryUsage: MemoryUsage
+
     data class IkTargetData(val effectorNode: RenderNode)
 }
\ No newline at end of file
@@ -2,14 +2,19 @@ package top.fifthlight.blazerod
 
 import net.fabricmc.api.ClientModInitializer
 import net.fabricmc.fabric.api.client.event.lifecycle.v1.ClientLifecycleEvents
+import net.fabricmc.fabric.api.client.event.lifecycle.v1.ClientTickEvents
+import net.fabricmc.fabric.api.client.keybinding.v1.KeyBindingHelper
+import net.fabricmc.fabric.api.client.rendering.v1.hud.HudElementRegistry
 import net.minecraft.client.MinecraftClient
 import net.minecraft.client.gl.RenderPassImpl
+import net.minecraft.util.Identifier
 import org.slf4j.LoggerFactory
 import top.fifthlight.blazerod.api.event.RenderEvents
 import top.fifthlight.blazerod.debug.*
 import top.fifthlight.blazerod.runtime.resource.RenderTexture
 import top.fifthlight.blazerod.runtime.uniform.UniformBuffer
 import top.fifthlight.blazerod.util.dispatchers.ThreadExecutorDispatcher
+import top.fifthlight.blazerod.util.dispatchers.UploadQueueDispatcher
 import top.fifthlight.blazerod.util.objectpool.cleanupObjectPools
 import javax.swing.SwingUtilities
 
@@ -19,19 +24,34 @@ object BlazeRodFabric : ClientModInitializer {
     override fun onInitializeClient() {
         BlazeRod.mainDispatcher = ThreadExecutorDispatcher(MinecraftClient.getInstance())
 
+        System.getProperty("blazerod.upload.budget_ms")?.toDoubleOrNull()?.let {
+            BlazeRod.uploadTimeBudgetNanos = (it * 1_000_000).toLong()
+        }
+        System.getProperty("blazerod.upload.budget_mb")?.toDoubleOrNull()?.let {
+            BlazeRod.uploadByteBudget = (it * 1024 * 1024).toLong()
+        }
+
+        if (System.getProperty("blazerod.profiler") == "true") {
+            FrameProfiler.enabled = true
+        }
+        Metrics.loadProperties()
+        HudElementRegistry.addLast(Identifier.of("blazerod", "frame_profiler")) { context, _ ->
+            FrameProfilerOverlay.render(context)
+        }
+        KeyBindingHelper.registerKeyBinding(FrameProfilerKeyBinding.keyBinding)
+        ClientTickEvents.END_CLIENT_TICK.register {
+            FrameProfilerKeyBinding.tick()
+        }
+
         if (System.getProperty("blazerod.debug") == "true") {
             BlazeRod.debug = true
             RenderPassImpl.IS_DEVELOPMENT = true
             if (System.getProperty("blazerod.debug.gui") == "true") {
-                ResourceCountTracker.initialize()
-                ObjectPoolTracker.initialize()
-                UniformBufferTracker.initialize()
+                Metrics.enabled = true
                 System.setProperty("java.awt.headless", "false")
                 SwingUtilities.invokeLater {
                     try {
-                        ResourceCountTrackerFrame().isVisible = true
-                        ObjectCountTrackerFrame().isVisible = true
-                        UniformBufferTrackerFrame().isVisible = true
+                        MetricsFrame().isVisible = true
                     } catch (ex: Exception) {
                         LOGGER.info("Failed to show debug windows", ex)
                     }
@@ -46,9 +66,15 @@ object BlazeRodFabric : ClientModInitializer {
 
         RenderEvents.FLIP_FRAME.register {
             UniformBuffer.clear()
+            FrameProfiler.span("upload") {
+                UploadQueueDispatcher.drain()
+            }
+            FrameProfiler.endFrame()
+            Metrics.sample()
         }
 
         ClientLifecycleEvents.CLIENT_STOPPING.register { client ->
+            Metrics.exportToOutput()
             cleanupObjectPools()
             UniformBuffer.close()
         }
@@ -9,4 +9,8 @@ object BlazeRod {
 
     lateinit var mainDispatcher: CoroutineDispatcher
     var debug = false
+
+    // Per-frame budget of model resource uploads
+    var uploadTimeBudgetNanos = 2_000_000L
+    var uploadByteBudget = 8L * 1024 * 1024
 }
\ No newline at end of file
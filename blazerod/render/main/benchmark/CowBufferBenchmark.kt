@@ -0,0 +1,67 @@
+package top.fifthlight.blazerod.benchmark
+
+import org.joml.Matrix4f
+import org.openjdk.jmh.annotations.*
+import org.openjdk.jmh.infra.Blackhole
+import top.fifthlight.blazerod.runtime.data.RenderSkinBuffer
+import top.fifthlight.blazerod.util.cowbuffer.CowBuffer
+import java.util.concurrent.TimeUnit
+
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+open class CowBufferBenchmark {
+    @Param("64", "512")
+    @JvmField
+    var jointSize = 0
+
+    private lateinit var buffer: CowBuffer<RenderSkinBuffer>
+    private val matrix = Matrix4f()
+
+    @Setup
+    fun setup() {
+        buffer = CowBuffer.acquire(RenderSkinBuffer(jointSize).apply { clear() }).also {
+            it.increaseReferenceCount()
+        }
+    }
+
+    @TearDown
+    fun tearDown() {
+        buffer.decreaseReferenceCount()
+    }
+
+    private fun RenderSkinBuffer.update() {
+        for (joint in 0 until jointSize) {
+            setMatrix(joint, matrix)
+        }
+    }
+
+    // Only the instance holds the buffer, so it is edited in place
+    @Benchmark
+    fun editExclusive(blackhole: Blackhole) {
+        blackhole.consume(buffer.edit { update() })
+    }
+
+    // A render task still holds the last frame's buffer, so editing copies the content
+    @Benchmark
+    fun editShared(blackhole: Blackhole) {
+        buffer.increaseReferenceCount()
+        val edited = buffer.edit { update() }
+        edited.increaseReferenceCount()
+        blackhole.consume(edited.content)
+        edited.decreaseReferenceCount()
+        buffer.decreaseReferenceCount()
+    }
+
+    // Snapshot for a render task, then release it after the task is executed
+    @Benchmark
+    fun snapshot(blackhole: Blackhole) {
+        val copy = buffer.copy()
+        copy.increaseReferenceCount()
+        blackhole.consume(copy.content)
+        copy.decreaseReferenceCount()
+    }
+}
@@ -0,0 +1,83 @@
+package top.fifthlight.blazerod.benchmark
+
+import org.joml.Matrix4f
+import org.joml.Vector3f
+import org.openjdk.jmh.annotations.*
+import org.openjdk.jmh.infra.Blackhole
+import top.fifthlight.blazerod.runtime.data.RenderSkinBuffer
+import top.fifthlight.blazerod.runtime.renderer.skinPosition
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.util.concurrent.TimeUnit
+import kotlin.random.Random
+
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+open class CpuSkinningBenchmark {
+    private companion object {
+        const val JOINT_SIZE = 128
+
+        // Position (3 floats), joint (4 shorts) and weight (4 floats), like the skinned vertex format
+        const val POSITION_OFFSET = 0
+        const val JOINT_OFFSET = 12
+        const val WEIGHT_OFFSET = 20
+        const val VERTEX_SIZE = 36
+    }
+
+    @Param("1000", "50000")
+    @JvmField
+    var vertexCount = 0
+
+    private lateinit var vertexBuffer: ByteBuffer
+    private lateinit var skinBuffer: RenderSkinBuffer
+    private val position = Vector3f()
+    private val skinnedPosition = Vector3f()
+    private val jointPosition = Vector3f()
+    private val skinMatrix = Matrix4f()
+
+    @Setup
+    fun setup() {
+        // Fixed seed, so every run skins the same mesh
+        val random = Random(0)
+        vertexBuffer = ByteBuffer.allocateDirect(vertexCount * VERTEX_SIZE).order(ByteOrder.nativeOrder())
+        repeat(vertexCount) { vertex ->
+            val base = vertex * VERTEX_SIZE
+            repeat(3) { vertexBuffer.putFloat(base + POSITION_OFFSET + it * 4, random.nextFloat()) }
+            // Most vertices have two influencing joints
+            val weights = floatArrayOf(random.nextFloat(), random.nextFloat(), 0f, 0f)
+            val sum = weights.sum()
+            repeat(4) {
+                vertexBuffer.putShort(base + JOINT_OFFSET + it * 2, random.nextInt(JOINT_SIZE).toShort())
+                vertexBuffer.putFloat(base + WEIGHT_OFFSET + it * 4, weights[it] / sum)
+            }
+        }
+        skinBuffer = RenderSkinBuffer(JOINT_SIZE)
+        val matrix = Matrix4f()
+        repeat(JOINT_SIZE) {
+            skinBuffer.setMatrix(it, matrix.rotationY(it * 0.1f).translate(0f, it * 0.01f, 0f))
+        }
+    }
+
+    @Benchmark
+    fun skinMesh(blackhole: Blackhole) {
+        for (vertex in 0 until vertexCount) {
+            val base = vertex * VERTEX_SIZE
+            position.set(base + POSITION_OFFSET, vertexBuffer)
+            skinPosition(
+                position = position,
+                vertexBuffer = vertexBuffer,
+                jointOffset = base + JOINT_OFFSET,
+                weightOffset = base + WEIGHT_OFFSET,
+                skinBuffer = skinBuffer,
+                skinMatrix = skinMatrix,
+                jointPosition = jointPosition,
+                result = skinnedPosition,
+            )
+            blackhole.consume(skinnedPosition.x)
+        }
+    }
+}
@@ -0,0 +1,70 @@
+package top.fifthlight.blazerod.benchmark
+
+import org.joml.Matrix4f
+import org.joml.Vector4f
+import org.openjdk.jmh.annotations.*
+import org.openjdk.jmh.infra.Blackhole
+import top.fifthlight.blazerod.layout.GpuDataLayout
+import top.fifthlight.blazerod.layout.LayoutStrategy
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.util.concurrent.TimeUnit
+
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+open class GpuDataLayoutBenchmark {
+    // Similar to the instance data of a draw
+    private object Std140Layout : GpuDataLayout<Std140Layout>() {
+        override val strategy: LayoutStrategy
+            get() = LayoutStrategy.Std140LayoutStrategy
+        var primitiveSize by int()
+        var primitiveIndex by int()
+        var color by vec4()
+        var viewMatrix by mat4()
+        var modelMatrix by mat4()
+    }
+
+    private object Std430Layout : GpuDataLayout<Std430Layout>() {
+        override val strategy: LayoutStrategy
+            get() = LayoutStrategy.Std430LayoutStrategy
+        var primitiveSize by int()
+        var primitiveIndex by int()
+        var color by vec4()
+        var viewMatrix by mat4()
+        var modelMatrix by mat4()
+    }
+
+    private val std140Buffer = ByteBuffer.allocateDirect(Std140Layout.totalSize).order(ByteOrder.nativeOrder())
+    private val std430Buffer = ByteBuffer.allocateDirect(Std430Layout.totalSize).order(ByteOrder.nativeOrder())
+    private val matrix = Matrix4f().translation(1f, 2f, 3f)
+    private val vector = Vector4f(1f, 0.5f, 0.25f, 1f)
+    private var index = 0
+
+    @Benchmark
+    fun writeStd140(blackhole: Blackhole) {
+        Std140Layout.withBuffer(std140Buffer) {
+            primitiveSize = 16
+            primitiveIndex = index++
+            color = vector
+            viewMatrix = matrix
+            modelMatrix = matrix
+        }
+        blackhole.consume(std140Buffer)
+    }
+
+    @Benchmark
+    fun writeStd430(blackhole: Blackhole) {
+        Std430Layout.withBuffer(std430Buffer) {
+            primitiveSize = 16
+            primitiveIndex = index++
+            color = vector
+            viewMatrix = matrix
+            modelMatrix = matrix
+        }
+        blackhole.consume(std430Buffer)
+    }
+}
@@ -0,0 +1,43 @@
+package top.fifthlight.blazerod.benchmark
+
+import it.unimi.dsi.fastutil.floats.FloatArrayList
+import org.openjdk.jmh.annotations.*
+import org.openjdk.jmh.infra.Blackhole
+import top.fifthlight.blazerod.model.animation.AnimationKeyFrameIndexer
+import top.fifthlight.blazerod.model.animation.ListAnimationKeyFrameIndexer
+import java.util.concurrent.TimeUnit
+
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+open class KeyFrameIndexerBenchmark {
+    @Param("2", "64", "4096", "65536")
+    @JvmField
+    var keyCount = 0
+
+    private lateinit var indexer: ListAnimationKeyFrameIndexer
+    private val result = AnimationKeyFrameIndexer.FindResult()
+    private var time = 0f
+
+    @Setup
+    fun setup() {
+        // VMD keys are at whole frames in 30 FPS
+        val times = FloatArrayList(keyCount)
+        repeat(keyCount) { times.add(it / 30f) }
+        indexer = ListAnimationKeyFrameIndexer(times)
+    }
+
+    // Time moves forward by a 60 FPS frame, and wraps at the end like a looping animation
+    @Benchmark
+    fun findKeyFrames(blackhole: Blackhole) {
+        time += 1f / 60f
+        if (time > indexer.lastTime) {
+            time = 0f
+        }
+        indexer.findKeyFrames(time, result)
+        blackhole.consume(result.startFrame)
+    }
+}
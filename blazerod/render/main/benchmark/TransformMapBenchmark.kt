@@ -0,0 +1,96 @@
+package top.fifthlight.blazerod.benchmark
+
+import org.openjdk.jmh.annotations.*
+import org.openjdk.jmh.infra.Blackhole
+import top.fifthlight.blazerod.model.TransformId
+import top.fifthlight.blazerod.model.synthetic.SyntheticModel
+import top.fifthlight.blazerod.model.synthetic.SyntheticModelSpec
+import top.fifthlight.blazerod.model.synthetic.toModel
+import top.fifthlight.blazerod.runtime.ModelInstanceImpl
+import top.fifthlight.blazerod.runtime.node.TransformMap
+import top.fifthlight.blazerod.runtime.test.HeadlessRuntime
+import java.util.concurrent.TimeUnit
+
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+open class TransformMapBenchmark {
+    // Roughly the bone count of a humanoid model, and of a model with many physics bones
+    @Param("64", "512")
+    @JvmField
+    var nodeCount = 0
+
+    private lateinit var maps: Array<TransformMap>
+    private lateinit var instance: ModelInstanceImpl
+    private var tick = 0
+
+    @Setup
+    fun setup() {
+        maps = Array(nodeCount) { TransformMap(null) }
+        for ((index, map) in maps.withIndex()) {
+            map.updateDecomposed(TransformId.ABSOLUTE) {
+                translation.set(0f, index * 0.1f, 0f)
+            }
+        }
+        val model = SyntheticModel.generate(SyntheticModelSpec(joints = nodeCount, seed = 0))
+        instance = ModelInstanceImpl(HeadlessRuntime.loadScene(model.toModel()))
+        instance.increaseReferenceCount()
+    }
+
+    @TearDown
+    fun tearDown() {
+        instance.decreaseReferenceCount()
+    }
+
+    @Benchmark
+    fun updateDecomposed(blackhole: Blackhole) {
+        val angle = (tick++ % 360) * 0.01f
+        for (map in maps) {
+            map.updateDecomposed(TransformId.RELATIVE_ANIMATION) {
+                rotation.rotationY(angle)
+            }
+            blackhole.consume(map.getSum(TransformId.LAST))
+        }
+    }
+
+    @Benchmark
+    fun updateMatrix(blackhole: Blackhole) {
+        val offset = (tick++ % 360) * 0.01f
+        for (map in maps) {
+            map.updateMatrix(TransformId.PHYSICS) {
+                matrix.translation(offset, 0f, 0f)
+            }
+            blackhole.consume(map.getSum(TransformId.LAST))
+        }
+    }
+
+    // Animate every node of a loaded instance, then propagate world transforms, like the per-frame node update
+    @Benchmark
+    fun propagate(blackhole: Blackhole) {
+        val angle = (tick++ % 360) * 0.01f
+        val scene = instance.scene
+        for (node in scene.nodes) {
+            instance.setTransformDecomposed(node.nodeIndex, TransformId.RELATIVE_ANIMATION) {
+                rotation.rotationX(angle)
+            }
+        }
+        instance.updateNodeTransform(scene.rootNode)
+        blackhole.consume(instance.modelData.worldTransforms)
+    }
+
+    // Animate one leaf node only, so dirty tracking skips the rest of the tree
+    @Benchmark
+    fun propagateSingleNode(blackhole: Blackhole) {
+        val angle = (tick++ % 360) * 0.01f
+        val scene = instance.scene
+        val node = scene.nodes.last()
+        instance.setTransformDecomposed(node.nodeIndex, TransformId.RELATIVE_ANIMATION) {
+            rotation.rotationX(angle)
+        }
+        instance.updateNodeTransform(scene.rootNode)
+        blackhole.consume(instance.modelData.worldTransforms)
+    }
+}
@@ -0,0 +1,43 @@
+package top.fifthlight.blazerod.benchmark
+
+import it.unimi.dsi.fastutil.bytes.ByteArrayList
+import org.openjdk.jmh.annotations.*
+import top.fifthlight.blazerod.model.vmd.VmdBezierChannelComponent
+import java.util.concurrent.TimeUnit
+import kotlin.random.Random
+
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+open class VmdBezierBenchmark {
+    private companion object {
+        const val FRAMES = 1024
+
+        // Translation X, Y, Z and rotation of bone keyframes
+        const val CHANNELS = 4
+    }
+
+    private lateinit var component: VmdBezierChannelComponent
+    private var index = 0
+
+    @Setup
+    fun setup() {
+        // Fixed seed, so every run samples the same curves
+        val random = Random(0)
+        val values = ByteArrayList(FRAMES * CHANNELS * 4)
+        repeat(FRAMES * CHANNELS * 4) { values.add(random.nextInt(0, 128).toByte()) }
+        component = VmdBezierChannelComponent(values, FRAMES, CHANNELS, cameraOrder = false)
+    }
+
+    @Benchmark
+    fun getDelta(): Float {
+        val current = index++
+        val frame = current % FRAMES
+        val channel = current % CHANNELS
+        val delta = (current % 97) / 96f
+        return component.getDelta(frame, channel, delta)
+    }
+}
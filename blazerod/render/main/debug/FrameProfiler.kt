@@ -0,0 +1,317 @@
+package top.fifthlight.blazerod.debug
+
+import jdk.jfr.Category
+import jdk.jfr.Description
+import jdk.jfr.Event
+import jdk.jfr.EventType
+import jdk.jfr.FlightRecorder
+import jdk.jfr.FlightRecorderListener
+import jdk.jfr.Label
+import jdk.jfr.Name
+import jdk.jfr.Recording
+import jdk.jfr.StackTrace
+import jdk.jfr.Timespan
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.LongAdder
+
+/**
+ * Scoped timing spans on render thread, aggregated into a tree for each frame.
+ *
+ * Spans are always compiled in, and cost a field read when profiling is off. Profiling is on if [enabled] is set, or
+ * a JFR recording has [SpanEvent] enabled, in which case every span is also emitted as a JFR event.
+ *
+ * Spans on other threads are ignored, so loaders sharing code with the render thread don't break the tree. Work done
+ * for the frame on worker threads is timed with [workerSpan] instead.
+ */
+object FrameProfiler {
+    @Name("top.fifthlight.blazerod.ProfilerSpan")
+    @Label("Profiler Span")
+    @Description("A timed span in BlazeRod render thread")
+    @Category("BlazeRod")
+    @StackTrace(false)
+    class SpanEvent : Event() {
+        @Label("Name")
+        @JvmField
+        var name: String? = null
+
+        @Label("Depth")
+        @JvmField
+        var depth: Int = 0
+    }
+
+    @Name("top.fifthlight.blazerod.ProfilerFrame")
+    @Label("Profiler Frame")
+    @Description("Time between two frame flips, with profiled render thread time")
+    @Category("BlazeRod")
+    @StackTrace(false)
+    class FrameEvent : Event() {
+        @Label("Profiled Time")
+        @Timespan
+        @JvmField
+        var profiledNanos: Long = 0
+    }
+
+    class Node(
+        val name: String,
+        val parent: Node?,
+    ) {
+        val depth: Int = parent?.let { it.depth + 1 } ?: 0
+        val children = ArrayList<Node>()
+
+        internal var startNanos = 0L
+        internal var event: SpanEvent? = null
+
+        var frameNanos = 0L
+            internal set
+        var frameCount = 0
+            internal set
+
+        // Exponential moving average, so the overlay is readable
+        var averageNanos = 0.0
+            internal set
+
+        internal fun child(name: String): Node {
+            for (child in children) {
+                if (child.name == name) {
+                    return child
+                }
+            }
+            return Node(name, this).also { children.add(it) }
+        }
+    }
+
+    /**
+     * Aggregated span of the last frame. Entries are in depth-first order.
+     */
+    data class Entry(
+        val name: String,
+        val depth: Int,
+        val frameNanos: Long,
+        val averageNanos: Double,
+        val count: Int,
+    )
+
+    private const val AVERAGE_FACTOR = 0.05
+    private const val WORKERS_NODE_NAME = "workers"
+
+    @Volatile
+    var enabled = false
+        set(value) {
+            field = value
+            updateActive()
+        }
+
+    @Volatile
+    private var jfrEnabled = false
+
+    @PublishedApi
+    @JvmField
+    @Volatile
+    internal var active = false
+
+    @Volatile
+    private var frameThread: Thread? = null
+    private val root = Node("frame", null)
+    private var current = root
+    private var frameStartNanos = 0L
+    private var frameEvent: FrameEvent? = null
+
+    private class WorkerTotal {
+        val nanos = LongAdder()
+        val count = LongAdder()
+    }
+
+    private val workerTotals = ConcurrentHashMap<String, WorkerTotal>()
+
+    @Volatile
+    var lastFrame: List<Entry> = listOf()
+        private set
+
+    init {
+        FlightRecorder.addListener(object : FlightRecorderListener {
+            override fun recordingStateChanged(recording: Recording) = updateJfrEnabled()
+
+            override fun recorderInitialized(recorder: FlightRecorder) = updateJfrEnabled()
+        })
+    }
+
+    private fun updateJfrEnabled() {
+        jfrEnabled = EventType.getEventType(SpanEvent::class.java).isEnabled
+        updateActive()
+    }
+
+    private fun updateActive() {
+        active = enabled || jfrEnabled
+    }
+
+    @PublishedApi
+    internal fun begin(name: String): Node? {
+        if (Thread.currentThread() !== frameThread) {
+            return null
+        }
+        val node = current.child(name)
+        current = node
+        if (jfrEnabled) {
+            node.event = SpanEvent().apply {
+                this.name = name
+                depth = node.depth
+                begin()
+            }
+        }
+        node.startNanos = System.nanoTime()
+        return node
+    }
+
+    @PublishedApi
+    internal fun end(node: Node) {
+        node.frameNanos += System.nanoTime() - node.startNanos
+        node.frameCount++
+        node.event?.let {
+            it.commit()
+            node.event = null
+        }
+        current = node.parent ?: root
+    }
+
+    inline fun <T> span(name: String, block: () -> T): T {
+        if (!active) {
+            return block()
+        }
+        val node = begin(name) ?: return block()
+        try {
+            return block()
+        } finally {
+            end(node)
+        }
+    }
+
+    @PublishedApi
+    internal fun beginWorker(name: String): SpanEvent? = if (jfrEnabled) {
+        SpanEvent().apply {
+            this.name = name
+            begin()
+        }
+    } else {
+        null
+    }
+
+    @PublishedApi
+    internal fun endWorker(name: String, startNanos: Long, event: SpanEvent?) {
+        val total = workerTotals.computeIfAbsent(name) { WorkerTotal() }
+        total.nanos.add(System.nanoTime() - startNanos)
+        total.count.increment()
+        event?.commit()
+    }
+
+    /**
+     * Time [block] on a worker thread. Worker spans don't nest in spans of render thread, so they are summed by name
+     * over all workers, and shown under a "workers" span of the frame they end in.
+     */
+    inline fun <T> workerSpan(name: String, block: () -> T): T {
+        if (!active) {
+            return block()
+        }
+        val event = beginWorker(name)
+        val startNanos = System.nanoTime()
+        try {
+            return block()
+        } finally {
+            endWorker(name, startNanos, event)
+        }
+    }
+
+    // Move worker times into the tree. The workers span is summed over threads, so it can be longer than the frame.
+    private fun collectWorkers() {
+        if (workerTotals.isEmpty()) {
+            return
+        }
+        val workers = root.child(WORKERS_NODE_NAME)
+        for ((name, total) in workerTotals) {
+            val node = workers.child(name)
+            val count = total.count.sumThenReset().toInt()
+            if (count == 0) {
+                continue
+            }
+            val nanos = total.nanos.sumThenReset()
+            node.frameNanos += nanos
+            node.frameCount += count
+            workers.frameNanos += nanos
+            workers.frameCount = 1
+        }
+    }
+
+    private fun collect(node: Node, entries: MutableList<Entry>) {
+        for (child in node.children) {
+            child.averageNanos += (child.frameNanos - child.averageNanos) * AVERAGE_FACTOR
+            if (child.frameCount > 0 || child.averageNanos >= 1000.0) {
+                entries.add(
+                    Entry(
+                        name = child.name,
+                        depth = child.depth,
+                        frameNanos = child.frameNanos,
+                        averageNanos = child.averageNanos,
+                        count = child.frameCount,
+                    )
+                )
+            }
+            collect(child, entries)
+            child.frameNanos = 0
+            child.frameCount = 0
+        }
+    }
+
+    /**
+     * Finish the current frame and start the next one. Must be called on render thread, once per frame. Spans are
+     * only recorded on the thread calling this.
+     */
+    fun endFrame() {
+        val now = System.nanoTime()
+        frameThread = Thread.currentThread()
+        current = root
+        if (!active) {
+            if (frameStartNanos != 0L) {
+                root.children.clear()
+                workerTotals.clear()
+                root.averageNanos = 0.0
+                lastFrame = listOf()
+                frameStartNanos = 0L
+            }
+            frameEvent = null
+            return
+        }
+        if (frameStartNanos == 0L) {
+            // Just enabled, spans of this frame are incomplete
+            root.children.clear()
+            workerTotals.clear()
+            frameStartNanos = now
+            return
+        }
+
+        frameEvent?.let { event ->
+            event.profiledNanos = root.children.sumOf { if (it.name == WORKERS_NODE_NAME) 0 else it.frameNanos }
+            event.commit()
+        }
+        frameEvent = if (jfrEnabled) FrameEvent().apply { begin() } else null
+
+        root.frameNanos = now - frameStartNanos
+        root.averageNanos = if (root.averageNanos == 0.0) {
+            root.frameNanos.toDouble()
+        } else {
+            root.averageNanos + (root.frameNanos - root.averageNanos) * AVERAGE_FACTOR
+        }
+        collectWorkers()
+        lastFrame = buildList {
+            add(
+                Entry(
+                    name = root.name,
+                    depth = root.depth,
+                    frameNanos = root.frameNanos,
+                    averageNanos = root.averageNanos,
+                    count = 1,
+                )
+            )
+            collect(root, this)
+        }
+        frameStartNanos = now
+    }
+}
@@ -0,0 +1,24 @@
+package top.fifthlight.blazerod.debug
+
+import net.minecraft.client.option.KeyBinding
+import net.minecraft.client.util.InputUtil
+
+/**
+ * Key toggling [FrameProfiler] and its overlay at runtime. Unbound by default, so it doesn't take a key from anyone.
+ */
+object FrameProfilerKeyBinding {
+    val keyBinding by lazy {
+        KeyBinding(
+            "blazerod.keybinding.profiler",
+            InputUtil.UNKNOWN_KEY.code,
+            "blazerod.name",
+        )
+    }
+
+    // Called on each client tick
+    fun tick() {
+        while (keyBinding.wasPressed()) {
+            FrameProfiler.enabled = !FrameProfiler.enabled
+        }
+    }
+}
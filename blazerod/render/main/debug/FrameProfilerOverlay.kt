@@ -0,0 +1,56 @@
+package top.fifthlight.blazerod.debug
+
+import net.minecraft.client.MinecraftClient
+import net.minecraft.client.gui.DrawContext
+
+/**
+ * In-game view of [FrameProfiler.lastFrame], drawn on HUD.
+ */
+object FrameProfilerOverlay {
+    private const val REFRESH_INTERVAL_NANOS = 500_000_000L
+    private const val PADDING = 2
+    private const val INDENT = 8
+    private const val BACKGROUND_COLOR = 0x90000000.toInt()
+    private const val TEXT_COLOR = 0xFFE0E0E0.toInt()
+
+    private var lines = listOf<Pair<Int, String>>()
+    private var lastRefreshTime = 0L
+
+    // Formatting is throttled, or values change too fast to read
+    private fun refresh() {
+        lines = FrameProfiler.lastFrame.map { entry ->
+            val averageMillis = entry.averageNanos / 1_000_000.0
+            val frameMillis = entry.frameNanos / 1_000_000.0
+            Pair(entry.depth, "%s: %.3f ms (%.3f ms, x%d)".format(entry.name, averageMillis, frameMillis, entry.count))
+        }
+    }
+
+    fun render(context: DrawContext) {
+        if (!FrameProfiler.enabled) {
+            return
+        }
+        val now = System.nanoTime()
+        if (now - lastRefreshTime >= REFRESH_INTERVAL_NANOS) {
+            lastRefreshTime = now
+            refresh()
+        }
+        if (lines.isEmpty()) {
+            return
+        }
+
+        val textRenderer = MinecraftClient.getInstance().textRenderer
+        val lineHeight = textRenderer.fontHeight + 1
+        val width = lines.maxOf { (depth, text) -> depth * INDENT + textRenderer.getWidth(text) }
+        context.fill(0, 0, width + PADDING * 2, lines.size * lineHeight + PADDING * 2, BACKGROUND_COLOR)
+        for ((index, line) in lines.withIndex()) {
+            val (depth, text) = line
+            context.drawTextWithShadow(
+                textRenderer,
+                text,
+                PADDING + depth * INDENT,
+                PADDING + index * lineHeight,
+                TEXT_COLOR,
+            )
+        }
+    }
+}
@@ -0,0 +1,243 @@
+package top.fifthlight.blazerod.debug
+
+import org.slf4j.LoggerFactory
+import java.io.Writer
+import java.nio.file.Path
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicLong
+import java.util.concurrent.atomic.LongAdder
+import kotlin.io.path.bufferedWriter
+import kotlin.io.path.extension
+
+/**
+ * Registry of runtime counters and gauges.
+ *
+ * Metrics are always updated, so they are cheap enough for hot paths. If [enabled], [sample] records the value of all
+ * metrics into a ring once per frame, which can be exported by [export] to compare runs.
+ *
+ * Metrics with the same name are the same metric, so call sites can register them in their companion objects.
+ */
+object Metrics {
+    private val LOGGER = LoggerFactory.getLogger(Metrics::class.java)
+
+    sealed class Metric(val name: String) {
+        abstract val value: Long
+    }
+
+    /**
+     * A value only increasing, like draw calls. Sampled as the increase in each frame.
+     */
+    class Counter internal constructor(name: String) : Metric(name) {
+        private val adder = LongAdder()
+
+        override val value: Long
+            get() = adder.sum()
+
+        fun increment() = adder.increment()
+
+        fun add(delta: Long) = adder.add(delta)
+    }
+
+    /**
+     * A value going up and down, like live objects or allocated bytes. Sampled as is.
+     */
+    class Gauge internal constructor(name: String) : Metric(name) {
+        private val current = AtomicLong()
+
+        override val value: Long
+            get() = current.get()
+
+        fun set(value: Long) = current.set(value)
+
+        fun add(delta: Long) {
+            current.addAndGet(delta)
+        }
+    }
+
+    class Sample(
+        val timeNanos: Long,
+        // Indexed by the order of metrics at sampling time, as metrics registered later are appended
+        val values: LongArray,
+    )
+
+    private val metricsByName = ConcurrentHashMap<String, Metric>()
+    private val metrics = mutableListOf<Metric>()
+    private val liveObjectGauges = ConcurrentHashMap<String, Gauge>()
+
+    @Volatile
+    var enabled = false
+
+    var sampleCapacity = 3600
+        set(value) {
+            require(value > 0) { "Sample capacity must be positive" }
+            synchronized(this) {
+                field = value
+                samples = arrayOfNulls(value)
+                sampleCount = 0
+                nextSample = 0
+            }
+        }
+
+    private var samples = arrayOfNulls<Sample>(sampleCapacity)
+    var sampleCount = 0
+        private set
+    private var nextSample = 0
+    private var lastCounterValues = LongArray(0)
+
+    private inline fun <reified T : Metric> register(name: String, crossinline create: (String) -> T): T {
+        val metric = metricsByName[name] ?: synchronized(this) {
+            metricsByName.getOrPut(name) {
+                create(name).also { metrics.add(it) }
+            }
+        }
+        return metric as? T
+            ?: throw IllegalArgumentException("Metric $name is already registered as ${metric::class.simpleName}")
+    }
+
+    fun counter(name: String): Counter = register(name, ::Counter)
+
+    fun gauge(name: String): Gauge = register(name, ::Gauge)
+
+    // Live reference counted objects by type, see AbstractRefCount
+    fun liveObjects(typeId: String): Gauge = liveObjectGauges[typeId] ?: gauge("live_objects.$typeId").also {
+        liveObjectGauges[typeId] = it
+    }
+
+    fun snapshot(): List<Pair<String, Long>> = synchronized(this) {
+        metrics.map { Pair(it.name, it.value) }
+    }
+
+    /**
+     * Record all metrics, called once per frame. Does nothing if not [enabled].
+     */
+    fun sample() {
+        if (!enabled) {
+            return
+        }
+        val now = System.nanoTime()
+        synchronized(this) {
+            val values = LongArray(metrics.size)
+            val lastValues = lastCounterValues.copyOf(metrics.size)
+            for ((index, metric) in metrics.withIndex()) {
+                val value = metric.value
+                values[index] = when (metric) {
+                    is Counter -> value - lastValues[index]
+                    is Gauge -> value
+                }
+                lastValues[index] = value
+            }
+            lastCounterValues = lastValues
+            samples[nextSample] = Sample(now, values)
+            nextSample = (nextSample + 1) % samples.size
+            sampleCount = minOf(sampleCount + 1, samples.size)
+        }
+    }
+
+    // Samples from the oldest to the newest
+    fun samples(): List<Sample> = synchronized(this) {
+        List(sampleCount) { index ->
+            samples[(nextSample - sampleCount + index).mod(samples.size)]!!
+        }
+    }
+
+    private fun writeCsv(writer: Writer, names: List<String>, samples: List<Sample>) {
+        writer.append("time_ns")
+        for (name in names) {
+            writer.append(',').append(name)
+        }
+        writer.append('\n')
+        for (sample in samples) {
+            writer.append(sample.timeNanos.toString())
+            for (index in names.indices) {
+                writer.append(',')
+                sample.values.getOrNull(index)?.let { writer.append(it.toString()) }
+            }
+            writer.append('\n')
+        }
+    }
+
+    private fun Writer.appendJsonString(value: String) {
+        append('"')
+        for (char in value) {
+            when {
+                char == '"' || char == '\\' -> append('\\').append(char)
+                char < ' ' -> append("\\u%04x".format(char.code))
+                else -> append(char)
+            }
+        }
+        append('"')
+    }
+
+    private fun writeJson(writer: Writer, names: List<String>, samples: List<Sample>) {
+        writer.append("{\"metrics\":[")
+        for ((index, name) in names.withIndex()) {
+            if (index > 0) {
+                writer.append(',')
+            }
+            writer.appendJsonString(name)
+        }
+        writer.append("],\"samples\":[")
+        for ((sampleIndex, sample) in samples.withIndex()) {
+            if (sampleIndex > 0) {
+                writer.append(',')
+            }
+            writer.append("{\"time_ns\":").append(sample.timeNanos.toString()).append(",\"values\":[")
+            for (index in names.indices) {
+                if (index > 0) {
+                    writer.append(',')
+                }
+                writer.append(sample.values.getOrNull(index)?.toString() ?: "null")
+            }
+            writer.append("]}")
+        }
+        writer.append("]}\n")
+    }
+
+    /**
+     * Write recorded samples to [path], as JSON if the file name ends with .json, or CSV otherwise. Counters are
+     * written as the increase in each frame, and gauges as their values.
+     */
+    fun export(path: Path) {
+        val (names, samples) = synchronized(this) {
+            Pair(metrics.map { it.name }, samples())
+        }
+        path.bufferedWriter().use { writer ->
+            if (path.extension.equals("json", ignoreCase = true)) {
+                writeJson(writer, names, samples)
+            } else {
+                writeCsv(writer, names, samples)
+            }
+        }
+    }
+
+    /**
+     * Apply the blazerod.metrics and blazerod.metrics.frames system properties. Frame counts which are not positive
+     * integers are ignored with a warning.
+     */
+    fun loadProperties() {
+        if (System.getProperty("blazerod.metrics") == "true") {
+            enabled = true
+        }
+        System.getProperty("blazerod.metrics.frames")?.let { value ->
+            val frames = value.toIntOrNull()
+            if (frames == null || frames <= 0) {
+                LOGGER.warn("Ignoring invalid blazerod.metrics.frames {}, keeping {} frames", value, sampleCapacity)
+            } else {
+                sampleCapacity = frames
+            }
+        }
+    }
+
+    /**
+     * [export] to the path in the blazerod.metrics.output system property, if set. Failures are logged, as it is
+     * called when the client stops.
+     */
+    fun exportToOutput() {
+        val path = System.getProperty("blazerod.metrics.output") ?: return
+        try {
+            export(Path.of(path))
+        } catch (ex: Exception) {
+            LOGGER.warn("Failed to export metrics to {}", path, ex)
+        }
+    }
+}
@@ -0,0 +1,83 @@
+package top.fifthlight.blazerod.debug
+
+import java.awt.BorderLayout
+import java.awt.Dimension
+import java.awt.FlowLayout
+import java.awt.event.WindowAdapter
+import java.awt.event.WindowEvent
+import java.io.File
+import javax.swing.*
+import javax.swing.table.DefaultTableModel
+
+class MetricsFrame : JFrame("BlazeRod Metrics") {
+    private val tableModel = object : DefaultTableModel(arrayOf("Name", "Value"), 0) {
+        override fun isCellEditable(row: Int, column: Int) = false
+    }
+    private val table = JTable(tableModel)
+    private val updateTimer = Timer(1000) { updateData() }
+    private val sampleLabel = JLabel()
+    private val exportButton = JButton("Export...")
+
+    init {
+        setupUI()
+        setupListeners()
+        startTracking()
+    }
+
+    private fun setupUI() {
+        defaultCloseOperation = DISPOSE_ON_CLOSE
+        preferredSize = Dimension(600, 400)
+        layout = BorderLayout()
+
+        table.fillsViewportHeight = true
+        add(JScrollPane(table), BorderLayout.CENTER)
+        add(JPanel(FlowLayout(FlowLayout.RIGHT)).apply {
+            add(sampleLabel)
+            add(exportButton)
+        }, BorderLayout.SOUTH)
+
+        pack()
+    }
+
+    private fun setupListeners() {
+        addWindowListener(object : WindowAdapter() {
+            override fun windowClosed(e: WindowEvent) {
+                updateTimer.stop()
+            }
+        })
+        exportButton.addActionListener { export() }
+    }
+
+    private fun startTracking() {
+        updateData()
+        updateTimer.start()
+    }
+
+    private fun export() {
+        val chooser = JFileChooser().apply {
+            selectedFile = File("blazerod-metrics.csv")
+        }
+        if (chooser.showSaveDialog(this) != JFileChooser.APPROVE_OPTION) {
+            return
+        }
+        try {
+            Metrics.export(chooser.selectedFile.toPath())
+        } catch (ex: Exception) {
+            JOptionPane.showMessageDialog(this, ex.message, "Export failed", JOptionPane.ERROR_MESSAGE)
+        }
+    }
+
+    private fun updateData() {
+        tableModel.rowCount = 0
+        Metrics.snapshot()
+            .sortedBy { (name, _) -> name }
+            .forEach { (name, value) ->
+                tableModel.addRow(arrayOf(name, value.toString()))
+            }
+        sampleLabel.text = if (Metrics.enabled) {
+            "${Metrics.sampleCount} frames sampled"
+        } else {
+            "Sampling disabled"
+        }
+    }
+}
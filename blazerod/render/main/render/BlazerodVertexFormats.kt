@@ -3,6 +3,7 @@ package top.fifthlight.blazerod.render
 import com.mojang.blaze3d.vertex.VertexFormat
 import com.mojang.blaze3d.vertex.VertexFormatElement
 import net.minecraft.client.render.VertexFormats
+import top.fifthlight.blazerod.model.util.VertexStrides
 
 object BlazerodVertexFormats {
     val POSITION: VertexFormat = VertexFormats.POSITION                   // 12 12
@@ -41,6 +42,17 @@ object BlazerodVertexFormats {
         .add("Weight", BlazerodVertexFormatElements.WEIGHT)               // 16 64
         .build()
 
+    init {
+        // Memory estimation without game classes uses the shared table
+        check(POSITION_COLOR_TEXTURE.vertexSize == VertexStrides.POSITION_COLOR_TEXTURE)
+        check(POSITION_COLOR_TEXTURE_JOINT_WEIGHT.vertexSize == VertexStrides.POSITION_COLOR_TEXTURE_JOINT_WEIGHT)
+        check(POSITION_COLOR_TEXTURE_NORMAL.vertexSize == VertexStrides.POSITION_COLOR_TEXTURE_NORMAL)
+        check(
+            POSITION_COLOR_TEXTURE_NORMAL_JOINT_WEIGHT.vertexSize ==
+                    VertexStrides.POSITION_COLOR_TEXTURE_NORMAL_JOINT_WEIGHT
+        )
+    }
+
     val ENTITY_PADDED: VertexFormat = VertexFormat.builder()
         .add("Position", VertexFormatElement.POSITION)                    // 12 12
         .add("Color", VertexFormatElement.COLOR)                          // 4  16
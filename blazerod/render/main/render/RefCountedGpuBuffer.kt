@@ -2,12 +2,22 @@ package top.fifthlight.blazerod.render
 
 import com.mojang.blaze3d.buffers.GpuBuffer
 import top.fifthlight.blazerod.api.refcount.AbstractRefCount
+import top.fifthlight.blazerod.debug.Metrics
 
 class RefCountedGpuBuffer(val inner: GpuBuffer) : AbstractRefCount() {
+    companion object {
+        private val GPU_BYTES = Metrics.gauge("gpu.buffer_bytes")
+    }
+
+    init {
+        GPU_BYTES.add(inner.size().toLong())
+    }
+
     override val typeId: String
         get() = "gpu_buffer"
 
     override fun onClosed() {
+        GPU_BYTES.add(-inner.size().toLong())
         inner.close()
     }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@ import com.mojang.blaze3d.buffers.GpuBuffer
 import com.mojang.blaze3d.buffers.GpuBufferSlice
 import com.mojang.blaze3d.textures.GpuTextureView
 import net.minecraft.client.gl.GlCommandEncoder
+import top.fifthlight.blazerod.debug.Metrics
 import top.fifthlight.blazerod.extension.internal.CommandEncoderExtInternal
 import top.fifthlight.blazerod.extension.internal.gl.GpuDeviceExtInternal
 import top.fifthlight.blazerod.systems.ComputePass
@@ -19,6 +20,10 @@ class ComputePassImpl(
     private val backend
         get() = resourceManagerExt.`blazerod$getBackend`()
 
+    companion object {
+        private val DISPATCHES = Metrics.counter("render.compute_dispatches")
+    }
+
     private var closed = false
     private var debugGroupPushCount = 0
     var pipeline: CompiledComputePipeline? = null
@@ -86,6 +91,7 @@ class ComputePassImpl(
 
     override fun dispatch(x: Int, y: Int, z: Int) {
         requireNotClosed()
+        DISPATCHES.increment()
         resourceManagerExt.`blazerod$dispatchCompute`(this, x, y, z)
     }
 
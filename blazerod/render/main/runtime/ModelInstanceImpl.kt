@@ -4,8 +4,10 @@ import net.minecraft.client.render.VertexConsumerProvider
 import org.joml.Matrix4f
 import org.joml.Matrix4fc
 import top.fifthlight.blazerod.api.refcount.AbstractRefCount
+import top.fifthlight.blazerod.api.resource.MemoryUsage
 import top.fifthlight.blazerod.api.resource.ModelInstance
 import top.fifthlight.blazerod.api.resource.RenderScene
+import top.fifthlight.blazerod.debug.FrameProfiler
 import top.fifthlight.blazerod.model.NodeTransform
 import top.fifthlight.blazerod.model.NodeTransformView
 import top.fifthlight.blazerod.model.TransformId
@@ -16,12 +18,16 @@ import top.fifthlight.blazerod.runtime.node.RenderNodeImpl
 import top.fifthlight.blazerod.runtime.node.TransformMap
 import top.fifthlight.blazerod.runtime.node.UpdatePhase
 import top.fifthlight.blazerod.runtime.node.markNodeTransformDirty
+import top.fifthlight.blazerod.runtime.physics.PhysicsState
+import top.fifthlight.blazerod.runtime.physics.SimulationExecutor
+import top.fifthlight.blazerod.runtime.physics.SpringBoneState
 import top.fifthlight.blazerod.runtime.resource.CameraTransformImpl
 import top.fifthlight.blazerod.util.cowbuffer.CowBuffer
 import top.fifthlight.blazerod.util.cowbuffer.copy
 import top.fifthlight.blazerod.util.iterator.mapToArray
 import top.fifthlight.mergetools.api.ActualConstructor
 import top.fifthlight.mergetools.api.ActualImpl
+import java.util.concurrent.CompletableFuture
 import java.util.function.Consumer
 
 @ActualImpl(ModelInstance::class)
@@ -65,11 +71,12 @@ class ModelInstanceImpl(
 
         val targetBuffers = scene.morphedPrimitiveComponents.mapIndexed { index, component ->
             val primitive = component.primitive
-            val targets = primitive.targets!!
+            // Count targets from groups, as the target buffers may be still streaming
+            val groups = primitive.targetGroups
             val targetBuffers = MorphTargetBuffer(
-                positionTargets = targets.position.targetsCount,
-                colorTargets = targets.color.targetsCount,
-                texCoordTargets = targets.texCoord.targetsCount,
+                positionTargets = groups.count { it.position != null },
+                colorTargets = groups.count { it.color != null },
+                texCoordTargets = groups.count { it.texCoord != null },
             )
             for (targetGroup in primitive.targetGroups) {
                 fun processGroup(index: Int?, channel: MorphTargetBuffer.WeightChannel, weight: Float) =
@@ -87,6 +94,24 @@ class ModelInstanceImpl(
 
         val ikEnabled = Array(scene.ikTargetData.size) { true }
 
+        val springBoneState = scene.springBoneComponent?.let { SpringBoneState(it.data) }
+
+        val physicsState = scene.physicsComponent?.let { PhysicsState(it.data) }
+
+        // Simulation started by beginUpdateRenderData, which changes the instance on a worker thread until joined
+        var simulation: CompletableFuture<Void>? = null
+        var renderDataUpdateBegun = false
+        var renderDataDirty = false
+
+        // Only count the direct buffers, other per-node objects are small compared to them
+        val heapBytes: Long
+            get() = localMatricesBuffer.content.buffer.capacity().toLong() +
+                    skinBuffers.sumOf { it.content.buffer.capacity().toLong() } +
+                    targetBuffers.sumOf {
+                        val content = it.content
+                        content.weightsBuffer.capacity().toLong() + content.indicesBuffer.capacity()
+                    }
+
         override fun close() {
             localMatricesBuffer.decreaseReferenceCount()
             skinBuffers.forEach { it.decreaseReferenceCount() }
@@ -94,7 +119,44 @@ class ModelInstanceImpl(
         }
     }
 
+    // Per-frame GPU data is uploaded to shared pools, so instances don't hold GPU memory
+    override val memoryUsage: MemoryUsage
+        get() = MemoryUsage(gpuBytes = 0, heapBytes = modelData.heapBytes)
+
+    // Wait for the running simulation before using the instance, except in the simulation itself
+    private fun joinSimulation() {
+        if (SimulationExecutor.isWorkerThread) {
+            return
+        }
+        modelData.renderDataUpdateBegun = false
+        val simulation = modelData.simulation ?: return
+        modelData.simulation = null
+        FrameProfiler.span("joinSimulation") {
+            simulation.join()
+        }
+    }
+
+    override fun copyStateFrom(previous: ModelInstance): Boolean {
+        val previous = previous as? ModelInstanceImpl ?: return false
+        if (!scene.hasSameLayout(previous.scene)) {
+            return false
+        }
+        joinSimulation()
+        previous.joinSimulation()
+        val previousData = previous.modelData
+        for (i in scene.nodes.indices) {
+            modelData.transformMaps[i].copyFrom(previousData.transformMaps[i], TransformId.ABSOLUTE.next)
+        }
+        markNodeTransformDirty(scene.rootNode)
+        previousData.ikEnabled.copyInto(modelData.ikEnabled)
+        physicsEnabled = previous.physicsEnabled
+        previousData.springBoneState?.let { modelData.springBoneState?.copyFrom(it) }
+        previousData.physicsState?.let { modelData.physicsState?.copyFrom(it) }
+        return true
+    }
+
     override fun clearTransform() {
+        joinSimulation()
         modelData.undirtyNodeCount = 0
         for (i in scene.nodes.indices) {
             modelData.transformMaps[i].clearFrom(TransformId.ABSOLUTE.next)
@@ -103,6 +165,7 @@ class ModelInstanceImpl(
     }
 
     override fun setTransformMatrix(nodeIndex: Int, transformId: TransformId, matrix: Matrix4f) {
+        joinSimulation()
         markNodeTransformDirty(scene.nodes[nodeIndex])
         val transform = modelData.transformMaps[nodeIndex]
         transform.setMatrix(transformId, matrix)
@@ -113,6 +176,7 @@ class ModelInstanceImpl(
         transformId: TransformId,
         decomposed: NodeTransformView.Decomposed,
     ) {
+        joinSimulation()
         markNodeTransformDirty(scene.nodes[nodeIndex])
         val transform = modelData.transformMaps[nodeIndex]
         transform.setMatrix(transformId, decomposed)
@@ -130,6 +194,7 @@ class ModelInstanceImpl(
         transformId: TransformId,
         updater: NodeTransform.Decomposed.() -> Unit,
     ) {
+        joinSimulation()
         markNodeTransformDirty(scene.nodes[nodeIndex])
         val transform = modelData.transformMaps[nodeIndex]
         transform.updateDecomposed(transformId, updater)
@@ -140,6 +205,7 @@ class ModelInstanceImpl(
         transformId: TransformId,
         updater: NodeTransform.Bedrock.() -> Unit,
     ) {
+        joinSimulation()
         markNodeTransformDirty(scene.nodes[nodeIndex])
         val transform = modelData.transformMaps[nodeIndex]
         transform.updateBedrock(transformId, updater)
@@ -148,6 +214,7 @@ class ModelInstanceImpl(
     override fun getIkEnabled(index: Int) = modelData.ikEnabled[index]
 
     override fun setIkEnabled(index: Int, enabled: Boolean) {
+        joinSimulation()
         val prevEnabled = modelData.ikEnabled[index]
         modelData.ikEnabled[index] = enabled
         if (prevEnabled && !enabled) {
@@ -160,6 +227,40 @@ class ModelInstanceImpl(
         }
     }
 
+    override var physicsEnabled: Boolean = true
+        set(value) {
+            if (field == value) {
+                return
+            }
+            joinSimulation()
+            field = value
+            if (!value) {
+                clearPhysicsTransform()
+            }
+        }
+
+    private fun clearPhysicsTransform(nodeIndex: Int) {
+        markNodeTransformDirty(scene.nodes[nodeIndex])
+        modelData.transformMaps[nodeIndex].clearFrom(TransformId.PHYSICS)
+    }
+
+    private fun clearPhysicsTransform() {
+        modelData.springBoneState?.let { state ->
+            state.reset()
+            val data = state.data
+            for (i in 0 until data.jointCount) {
+                clearPhysicsTransform(data.jointNodeIndices[i])
+            }
+        }
+        modelData.physicsState?.let { state ->
+            state.reset()
+            val data = state.data
+            for (body in data.writeBackBodies) {
+                clearPhysicsTransform(data.bodyNodeIndices[body])
+            }
+        }
+    }
+
     override fun setGroupWeight(morphedPrimitiveIndex: Int, targetGroupIndex: Int, weight: Float) {
         val primitiveComponent = scene.morphedPrimitiveComponents[morphedPrimitiveIndex]
         val group = primitiveComponent.primitive.targetGroups[targetGroupIndex]
@@ -177,23 +278,34 @@ class ModelInstanceImpl(
     override fun getCameraTransform(index: Int) = modelData.cameraTransforms.getOrNull(index)
 
     override fun updateCamera() {
+        joinSimulation()
         scene.updateCamera(this)
     }
 
     override fun debugRender(viewProjectionMatrix: Matrix4fc, consumers: VertexConsumerProvider) {
+        joinSimulation()
         scene.debugRender(this, viewProjectionMatrix, consumers)
     }
 
-    override fun updateRenderData() {
+    override fun beginUpdateRenderData(time: Long) {
+        joinSimulation()
+        scene.beginUpdateRenderData(this, time)
+    }
+
+    override fun updateRenderData(time: Long) {
+        if (!modelData.renderDataUpdateBegun) {
+            scene.beginUpdateRenderData(this, time)
+        }
+        joinSimulation()
         scene.updateRenderData(this)
     }
 
-    internal fun updateNodeTransform(nodeIndex: Int) {
+    fun updateNodeTransform(nodeIndex: Int) {
         val node = scene.nodes[nodeIndex]
         updateNodeTransform(node)
     }
 
-    internal fun updateNodeTransform(node: RenderNodeImpl) {
+    fun updateNodeTransform(node: RenderNodeImpl) {
         if (modelData.undirtyNodeCount == scene.nodes.size) {
             return
         }
@@ -207,8 +319,10 @@ class ModelInstanceImpl(
         modelMatrix: Matrix4fc,
         light: Int,
         overlay: Int,
-    ): RenderTaskImpl {
-        return RenderTaskImpl.acquire(
+    ): RenderTaskImpl = FrameProfiler.span("createRenderTask") {
+        joinSimulation()
+        // Copies skin and morph target buffers of this instance
+        RenderTaskImpl.acquire(
             instance = this,
             modelMatrix = modelMatrix,
             light = light,
@@ -229,6 +343,7 @@ class ModelInstanceImpl(
     }
 
     override fun onClosed() {
+        joinSimulation()
         scene.decreaseReferenceCount()
         modelData.close()
     }
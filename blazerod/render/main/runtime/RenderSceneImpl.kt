@@ -1,12 +1,16 @@
 package top.fifthlight.blazerod.runtime
 
 import it.unimi.dsi.fastutil.ints.Int2ReferenceOpenHashMap
+import it.unimi.dsi.fastutil.objects.ReferenceOpenHashSet
+import kotlinx.coroutines.Job
 import net.minecraft.client.render.VertexConsumerProvider
 import org.joml.Matrix4fc
 import top.fifthlight.blazerod.api.refcount.AbstractRefCount
+import top.fifthlight.blazerod.api.resource.MemoryUsage
 import top.fifthlight.blazerod.api.resource.RenderExpression
 import top.fifthlight.blazerod.api.resource.RenderExpressionGroup
 import top.fifthlight.blazerod.api.resource.RenderScene
+import top.fifthlight.blazerod.debug.FrameProfiler
 import top.fifthlight.blazerod.model.Camera
 import top.fifthlight.blazerod.model.HumanoidTag
 import top.fifthlight.blazerod.model.NodeId
@@ -14,10 +18,15 @@ import top.fifthlight.blazerod.model.NodeTransform
 import top.fifthlight.blazerod.runtime.node.RenderNodeImpl
 import top.fifthlight.blazerod.runtime.node.UpdatePhase
 import top.fifthlight.blazerod.runtime.node.component.IkTargetComponent
+import top.fifthlight.blazerod.runtime.node.component.PhysicsComponent
 import top.fifthlight.blazerod.runtime.node.component.PrimitiveComponent
 import top.fifthlight.blazerod.runtime.node.component.RenderNodeComponent
+import top.fifthlight.blazerod.runtime.node.component.SpringBoneComponent
 import top.fifthlight.blazerod.runtime.node.forEach
+import top.fifthlight.blazerod.runtime.physics.SimulationExecutor
 import top.fifthlight.blazerod.runtime.resource.RenderSkin
+import top.fifthlight.blazerod.runtime.resource.RenderTexture
+import top.fifthlight.blazerod.runtime.resource.ReusableResources
 
 class RenderSceneImpl(
     override val rootNode: RenderNodeImpl,
@@ -27,6 +36,10 @@ class RenderSceneImpl(
     override val expressionGroups: List<RenderExpressionGroup>,
     override val cameras: List<Camera>,
     val renderTransform: NodeTransform?,
+    // Textures and morph targets are streamed in after the scene is created, see SceneReconstructor
+    val streamingJob: Job? = null,
+    // Resources indexed by content, for reloading an edited model, see ModelLoader.loadModel
+    val reusableResources: ReusableResources? = null,
 ) : AbstractRefCount(), RenderScene {
     override val typeId: String
         get() = "scene"
@@ -37,6 +50,8 @@ class RenderSceneImpl(
     val morphedPrimitiveComponents: List<PrimitiveComponent>
     override val ikTargetData: List<RenderScene.IkTargetData>
     val ikTargetComponents: List<IkTargetComponent>
+    val springBoneComponent: SpringBoneComponent?
+    val physicsComponent: PhysicsComponent?
     override val nodeIdMap: Map<NodeId, RenderNodeImpl>
     override val nodeNameMap: Map<String, RenderNodeImpl>
     override val humanoidTagMap: Map<HumanoidTag, RenderNodeImpl>
@@ -48,6 +63,8 @@ class RenderSceneImpl(
         val primitiveComponents = mutableListOf<PrimitiveComponent>()
         val morphedPrimitives = Int2ReferenceOpenHashMap<PrimitiveComponent>()
         val ikTargets = Int2ReferenceOpenHashMap<IkTargetComponent>()
+        var springBoneComponent: SpringBoneComponent? = null
+        var physicsComponent: PhysicsComponent? = null
         val nodeIdMap = mutableMapOf<NodeId, RenderNodeImpl>()
         val nodeNameMap = mutableMapOf<String, RenderNodeImpl>()
         val humanoidTagMap = mutableMapOf<HumanoidTag, RenderNodeImpl>()
@@ -73,6 +90,18 @@ class RenderSceneImpl(
             node.getComponentsOfType(RenderNodeComponent.Type.IkTarget).forEach { component ->
                 ikTargets.put(component.ikIndex, component)
             }
+            node.getComponentsOfType(RenderNodeComponent.Type.SpringBone).forEach { component ->
+                if (springBoneComponent != null) {
+                    throw IllegalStateException("Duplicate spring bone component")
+                }
+                springBoneComponent = component
+            }
+            node.getComponentsOfType(RenderNodeComponent.Type.Physics).forEach { component ->
+                if (physicsComponent != null) {
+                    throw IllegalStateException("Duplicate physics component")
+                }
+                physicsComponent = component
+            }
         }
         this.sortedNodes = nodes
         this.debugRenderNodes = debugRenderNodes
@@ -87,17 +116,107 @@ class RenderSceneImpl(
         this.ikTargetComponents = (0 until ikTargets.size).map {
             ikTargets.get(it) ?: error("Ik target index not found: $it")
         }
+        this.springBoneComponent = springBoneComponent
+        this.physicsComponent = physicsComponent
         this.nodeIdMap = nodeIdMap
         this.nodeNameMap = nodeNameMap
         this.humanoidTagMap = humanoidTagMap
     }
 
-    private fun executePhase(instance: ModelInstanceImpl, phase: UpdatePhase) {
+    val streaming
+        get() = streamingJob?.isCompleted == false
+
+    // Usage changes as resources stream in, so only cache it after streaming completed
+    private var completeMemoryUsage: MemoryUsage? = null
+
+    override val memoryUsage: MemoryUsage
+        get() = completeMemoryUsage ?: computeMemoryUsage().also {
+            if (!streaming) {
+                completeMemoryUsage = it
+            }
+        }
+
+    private fun computeMemoryUsage(): MemoryUsage {
+        // Buffers and textures can be shared between primitives, count each of them once
+        val countedBuffers = ReferenceOpenHashSet<Any>()
+        val textures = ReferenceOpenHashSet<RenderTexture>()
+        var gpuBytes = 0L
+        var heapBytes = 0L
+        for (component in primitiveComponents) {
+            val primitive = component.primitive
+            primitive.gpuVertexBuffer?.let { buffer ->
+                if (countedBuffers.add(buffer)) {
+                    gpuBytes += buffer.inner.size
+                }
+            }
+            primitive.indexBuffer?.let { indexBuffer ->
+                if (countedBuffers.add(indexBuffer.buffer)) {
+                    gpuBytes += indexBuffer.buffer.inner.size
+                }
+            }
+            primitive.cpuVertexBuffer?.let { buffer ->
+                if (countedBuffers.add(buffer)) {
+                    heapBytes += buffer.capacity()
+                }
+            }
+            primitive.targets?.let { targets ->
+                for (target in listOf(targets.position, targets.color, targets.texCoord)) {
+                    target.gpuBuffer?.let { buffer ->
+                        if (countedBuffers.add(buffer)) {
+                            gpuBytes += buffer.size
+                        }
+                    }
+                    target.cpuBuffer?.let { buffer ->
+                        if (countedBuffers.add(buffer)) {
+                            heapBytes += buffer.capacity()
+                        }
+                    }
+                }
+            }
+            for (texture in primitive.material.textures) {
+                if (textures.add(texture)) {
+                    gpuBytes += texture.gpuSize
+                }
+            }
+        }
+        return MemoryUsage(gpuBytes = gpuBytes, heapBytes = heapBytes)
+    }
+
+    // Skin writes of JointComponent are in RENDER_DATA_UPDATE, and IK solving is in IK_UPDATE
+    private fun executePhase(instance: ModelInstanceImpl, phase: UpdatePhase) = FrameProfiler.span(phase.type.name) {
         for (node in sortedNodes) {
             node.update(phase, node, instance)
         }
     }
 
+    /**
+     * Whether [other] has the same nodes, morph targets, expressions and IK targets in the same order, so node and morph
+     * target indices of one scene are valid in the other. True for most edits of a model that only change its look.
+     */
+    fun hasSameLayout(other: RenderSceneImpl): Boolean {
+        // Animations and controllers hold expressions of the scene they were created with
+        if (nodes.size != other.nodes.size || expressions != other.expressions ||
+            expressionGroups != other.expressionGroups ||
+            ikTargetComponents.size != other.ikTargetComponents.size ||
+            morphedPrimitiveComponents.size != other.morphedPrimitiveComponents.size
+        ) {
+            return false
+        }
+        for ((index, node) in nodes.withIndex()) {
+            val otherNode = other.nodes[index]
+            if (node.nodeName != otherNode.nodeName || node.parent?.nodeIndex != otherNode.parent?.nodeIndex) {
+                return false
+            }
+        }
+        for ((index, component) in morphedPrimitiveComponents.withIndex()) {
+            val otherComponent = other.morphedPrimitiveComponents[index]
+            if (component.primitive.targetGroups.size != otherComponent.primitive.targetGroups.size) {
+                return false
+            }
+        }
+        return true
+    }
+
     fun updateCamera(instance: ModelInstanceImpl) {
         if (cameras.isEmpty()) {
             return
@@ -105,11 +224,13 @@ class RenderSceneImpl(
         if (instance.modelData.undirtyNodeCount == nodes.size) {
             return
         }
-        executePhase(instance, UpdatePhase.GlobalTransformPropagation)
-        executePhase(instance, UpdatePhase.IkUpdate)
-        executePhase(instance, UpdatePhase.InfluenceTransformUpdate)
-        executePhase(instance, UpdatePhase.GlobalTransformPropagation)
-        executePhase(instance, UpdatePhase.CameraUpdate)
+        FrameProfiler.span("updateCamera") {
+            executePhase(instance, UpdatePhase.GlobalTransformPropagation)
+            executePhase(instance, UpdatePhase.IkUpdate)
+            executePhase(instance, UpdatePhase.InfluenceTransformUpdate)
+            executePhase(instance, UpdatePhase.GlobalTransformPropagation)
+            executePhase(instance, UpdatePhase.CameraUpdate)
+        }
     }
 
     fun debugRender(instance: ModelInstanceImpl, viewProjectionMatrix: Matrix4fc, consumers: VertexConsumerProvider) {
@@ -127,18 +248,62 @@ class RenderSceneImpl(
         }
     }
 
+    /**
+     * Update transforms of [instance], and start its simulations on [SimulationExecutor]. [updateRenderData] joins
+     * them, see ModelInstanceImpl.
+     *
+     * @param time frame time in nanoseconds, simulations advance by the time since their last update.
+     */
+    fun beginUpdateRenderData(instance: ModelInstanceImpl, time: Long) {
+        val modelData = instance.modelData
+        modelData.renderDataUpdateBegun = true
+        // Springs and rigid bodies keep moving even if the pose is not changed
+        val simulated = instance.physicsEnabled && (springBoneComponent != null || physicsComponent != null)
+        if (!simulated && modelData.undirtyNodeCount == nodes.size) {
+            return
+        }
+        modelData.renderDataDirty = true
+        FrameProfiler.span("beginUpdateRenderData") {
+            executePhase(instance, UpdatePhase.GlobalTransformPropagation)
+            executePhase(instance, UpdatePhase.IkUpdate)
+            executePhase(instance, UpdatePhase.InfluenceTransformUpdate)
+            executePhase(instance, UpdatePhase.GlobalTransformPropagation)
+        }
+        if (simulated) {
+            modelData.simulation = SimulationExecutor.submit { simulate(instance, time) }
+        }
+    }
+
+    // Runs on a worker thread, only changing the transforms and simulation states of instance
+    private fun simulate(instance: ModelInstanceImpl, time: Long) {
+        springBoneComponent?.let { component ->
+            FrameProfiler.workerSpan("springBone") {
+                component.simulate(instance, time)
+                executePhase(instance, UpdatePhase.GlobalTransformPropagation)
+            }
+        }
+        physicsComponent?.let { component ->
+            FrameProfiler.workerSpan("physics") {
+                component.simulate(instance, time)
+                executePhase(instance, UpdatePhase.GlobalTransformPropagation)
+            }
+        }
+    }
+
+    // Simulation of the instance should be joined before
     fun updateRenderData(instance: ModelInstanceImpl) {
-        if (instance.modelData.undirtyNodeCount == nodes.size) {
+        val modelData = instance.modelData
+        if (!modelData.renderDataDirty) {
             return
         }
-        executePhase(instance, UpdatePhase.GlobalTransformPropagation)
-        executePhase(instance, UpdatePhase.IkUpdate)
-        executePhase(instance, UpdatePhase.InfluenceTransformUpdate)
-        executePhase(instance, UpdatePhase.GlobalTransformPropagation)
-        executePhase(instance, UpdatePhase.RenderDataUpdate)
+        modelData.renderDataDirty = false
+        FrameProfiler.span("updateRenderData") {
+            executePhase(instance, UpdatePhase.RenderDataUpdate)
+        }
     }
 
     override fun onClosed() {
+        streamingJob?.cancel()
         rootNode.decreaseReferenceCount()
     }
 }
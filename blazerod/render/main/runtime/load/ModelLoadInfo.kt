@@ -1,5 +1,7 @@
 package top.fifthlight.blazerod.runtime.load
 
+import com.mojang.blaze3d.textures.GpuTexture
+import com.mojang.blaze3d.textures.GpuTextureView
 import com.mojang.blaze3d.vertex.VertexFormat
 import kotlinx.coroutines.Deferred
 import net.minecraft.client.texture.NativeImage
@@ -13,9 +15,12 @@ import top.fifthlight.blazerod.runtime.resource.MorphTargetGroup
 import top.fifthlight.blazerod.runtime.resource.RenderPrimitive
 import top.fifthlight.blazerod.runtime.resource.RenderSkin
 import top.fifthlight.blazerod.runtime.resource.RenderTexture
+import top.fifthlight.blazerod.runtime.resource.TextureKey
 import java.nio.ByteBuffer
 import top.fifthlight.blazerod.model.Camera as ModelCamera
 import top.fifthlight.blazerod.model.IkTarget as ModelIkTarget
+import top.fifthlight.blazerod.model.Physics as ModelPhysics
+import top.fifthlight.blazerod.model.SpringBone as ModelSpringBone
 
 data class TextureLoadData(
     val name: String?,
@@ -98,7 +103,6 @@ sealed class MaterialLoadInfo {
 }
 
 data class MorphTargetsLoadData<Info : Any>(
-    val targetGroups: List<MorphTargetGroup>,
     val position: Info,
     val color: Info,
     val texCoord: Info,
@@ -152,6 +156,14 @@ data class NodeLoadInfo(
             val influence: Influence,
             val transformId: TransformId,
         ) : Component()
+
+        data class SpringBone(
+            val springBone: ModelSpringBone,
+        ) : Component()
+
+        data class Physics(
+            val physics: ModelPhysics,
+        ) : Component()
     }
 }
 
@@ -160,12 +172,22 @@ data class GpuLoadVertexData(
     val cpuBuffer: ByteBuffer?,
 )
 
+// Uploaded texture, not wrapped in a RenderTexture, as it is handed over to the placeholder showing it
+data class GpuLoadTexture(
+    val texture: GpuTexture,
+    val view: GpuTextureView,
+)
+
 data class ModelLoadInfo<Texture : Any?, Index : Any, Vertex : Any, Morph : Any>(
     val textures: List<Deferred<Texture>>,
+    val textureKeys: List<TextureKey?>,
+    // Textures reused from previous scene, their loads in [textures] are always null
+    val reusedTextures: Map<Int, RenderTexture>,
     val indexBuffers: List<Deferred<Index>>,
     val vertexBuffers: List<Deferred<Vertex>>,
     val primitiveInfos: List<PrimitiveLoadInfo>,
     val morphTargetInfos: List<Deferred<Morph>>,
+    val morphTargetGroups: List<List<MorphTargetGroup>>,
     val nodes: List<NodeLoadInfo>,
     val rootNodeIndex: Int,
     val skins: List<RenderSkin>,
@@ -175,4 +197,4 @@ data class ModelLoadInfo<Texture : Any?, Index : Any, Vertex : Any, Morph : Any>
 )
 
 typealias PreProcessModelLoadInfo = ModelLoadInfo<TextureLoadData?, IndexBufferLoadData, ByteBuffer, MorphTargetsLoadData<MorphTargetsLoadData.TargetInfo>>
-typealias GpuLoadModelLoadInfo = ModelLoadInfo<RenderTexture?, GpuIndexBuffer, GpuLoadVertexData, MorphTargetsLoadData<RenderPrimitive.Target>>
+typealias GpuLoadModelLoadInfo = ModelLoadInfo<GpuLoadTexture?, GpuIndexBuffer, GpuLoadVertexData, MorphTargetsLoadData<RenderPrimitive.Target>>
@@ -2,9 +2,11 @@ package top.fifthlight.blazerod.runtime.load
 
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
-import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.SupervisorJob
 import kotlinx.coroutines.future.future
+import org.slf4j.LoggerFactory
 import top.fifthlight.blazerod.api.loader.ModelLoader
+import top.fifthlight.blazerod.api.resource.RenderScene
 import top.fifthlight.blazerod.model.Model
 import top.fifthlight.blazerod.runtime.RenderSceneImpl
 import top.fifthlight.blazerod.util.dispatchers.BlazeRod
@@ -17,18 +19,53 @@ object ModelLoaderImpl : ModelLoader {
     @ActualConstructor("create")
     fun create() = this
 
-    override suspend fun loadModel(model: Model): RenderSceneImpl? = coroutineScope {
-        val loadInfo = ModelPreprocessor.preprocess(
-            scope = this,
-            loadDispatcher = Dispatchers.Default,
-            model = model,
-        ) ?: return@coroutineScope null
-        val gpuInfo = ModelResourceLoader.load(
-            scope = this,
-            gpuDispatcher = Dispatchers.BlazeRod.Main,
-            info = loadInfo,
-        )
-        SceneReconstructor.reconstruct(info = gpuInfo)
+    private val LOGGER = LoggerFactory.getLogger(ModelLoaderImpl::class.java)
+
+    override suspend fun loadModel(model: Model, previous: RenderScene?, reloadable: Boolean): RenderSceneImpl? {
+        // Textures and morph targets keep loading after the scene is returned, so they can't run in caller's scope
+        val streamingJob = SupervisorJob()
+        val streamingScope = CoroutineScope(Dispatchers.Default + streamingJob)
+        val reuse = ResourceReuse((previous as? RenderSceneImpl)?.reusableResources, reloadable)
+        try {
+            reuse.use { reuse ->
+                val loadInfo = ModelPreprocessor.preprocess(
+                    scope = streamingScope,
+                    loadDispatcher = Dispatchers.Default,
+                    model = model,
+                    reuse = reuse,
+                ) ?: run {
+                    streamingJob.cancel()
+                    return null
+                }
+                val gpuInfo = ModelResourceLoader.load(
+                    scope = streamingScope,
+                    gpuDispatcher = Dispatchers.BlazeRod.Upload,
+                    info = loadInfo,
+                    reuse = reuse,
+                )
+                return SceneReconstructor.reconstruct(
+                    info = gpuInfo,
+                    streamingScope = streamingScope,
+                    gpuDispatcher = Dispatchers.BlazeRod.Upload,
+                    reuse = reuse,
+                ).also {
+                    // Let the job complete after all streaming jobs finished
+                    streamingJob.complete()
+                    if (previous != null) {
+                        LOGGER.info(
+                            "Reused {} of {} textures and {} of {} buffers from previous scene",
+                            reuse.reusedTextures.get(),
+                            loadInfo.textures.size,
+                            reuse.reusedBuffers.get(),
+                            loadInfo.indexBuffers.size + loadInfo.vertexBuffers.size,
+                        )
+                    }
+                }
+            }
+        } catch (ex: Throwable) {
+            streamingJob.cancel()
+            throw ex
+        }
     }
 
     override fun loadModelAsFuture(model: Model) = CoroutineScope(Dispatchers.Default).future {
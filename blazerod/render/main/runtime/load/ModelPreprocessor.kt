@@ -11,8 +11,11 @@ import top.fifthlight.blazerod.extension.TextureFormatExt
 import top.fifthlight.blazerod.model.*
 import top.fifthlight.blazerod.render.BlazerodVertexFormatElements
 import top.fifthlight.blazerod.render.BlazerodVertexFormats
+import top.fifthlight.blazerod.runtime.resource.ContentKey
 import top.fifthlight.blazerod.runtime.resource.MorphTargetGroup
 import top.fifthlight.blazerod.runtime.resource.RenderSkin
+import top.fifthlight.blazerod.runtime.resource.RenderTexture
+import top.fifthlight.blazerod.runtime.resource.TextureKey
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
 
@@ -20,6 +23,7 @@ class ModelPreprocessor private constructor(
     private val coroutineScope: CoroutineScope,
     private val dispatcher: CoroutineDispatcher,
     private val model: Model,
+    private val reuse: ResourceReuse,
 ) {
     data class SkinJointData(
         val skinIndex: Int,
@@ -55,13 +59,29 @@ class ModelPreprocessor private constructor(
     }
 
     private val textures = mutableListOf<Deferred<TextureLoadData?>>()
+    private val textureKeys = mutableListOf<TextureKey?>()
+    private val reusedTextures = mutableMapOf<Int, RenderTexture>()
     private val textureIndexMap = mutableMapOf<Texture, Int>()
     private fun loadTextureIndex(texture: Texture) = textureIndexMap.getOrPut(texture) {
-        val texture = coroutineScope.async(dispatcher) {
-            val bufferView = texture.bufferView ?: return@async null
-            val byteBuffer = bufferView.buffer.buffer
+        val index = textures.size
+        val byteBuffer = texture.bufferView?.let { bufferView ->
+            bufferView.buffer.buffer
                 .slice(bufferView.byteOffset, bufferView.byteLength)
                 .order(ByteOrder.nativeOrder())
+        }
+        // Hashing the encoded data is much cheaper than decoding it, so check for reusable texture first
+        val key = byteBuffer?.takeIf { reuse.needsKeys }?.let {
+            TextureKey(ContentKey.of(it), texture.type, texture.sampler)
+        }
+        textureKeys.add(key)
+        val reused = key?.let { reuse.texture(it) }
+        if (reused != null) {
+            reusedTextures[index] = reused
+            textures.add(CompletableDeferred(null))
+            return@getOrPut index
+        }
+        val loadData = coroutineScope.async(dispatcher) {
+            byteBuffer ?: return@async null
             val nativeImage = try {
                 NativeImageExt.read(null, texture.type, byteBuffer)
             } catch (ex: Exception) {
@@ -73,8 +93,7 @@ class ModelPreprocessor private constructor(
                 sampler = texture.sampler,
             )
         }
-        val index = textures.size
-        textures.add(texture)
+        textures.add(loadData)
         index
     }
 
@@ -300,6 +319,7 @@ class ModelPreprocessor private constructor(
     }
 
     private var morphTargetInfos = mutableListOf<Deferred<MorphTargetsLoadData<MorphTargetsLoadData.TargetInfo>>>()
+    private val morphTargetGroups = mutableListOf<List<MorphTargetGroup>>()
 
     @ConsistentCopyVisibility
     private data class BuildingTarget private constructor(
@@ -336,37 +356,45 @@ class ModelPreprocessor private constructor(
     ): Int {
         val verticesCount = primitive.attributes.position.count
         val targets = primitive.targets
+        // Groups only depend on which attributes each target has, so they are ready before the buffers, and instances
+        // can be created with their weights while the target buffers are still streaming
+        var posIndex = 0
+        var colorIndex = 0
+        var texCoordIndex = 0
+        val groups = targets.mapIndexed { index, target ->
+            MorphTargetGroup(
+                position = target.position?.let { posIndex++ },
+                color = target.colors.firstOrNull()?.let { colorIndex++ },
+                texCoord = target.texcoords.firstOrNull()?.let { texCoordIndex++ },
+                weight = weights?.getOrNull(index) ?: 0f,
+            )
+        }
         val loadedTargets = coroutineScope.async(dispatcher) {
             val positionTarget = BuildingTarget.of(
                 textureFormat = TextureFormatExt.RGBA32F,
                 itemCount = verticesCount,
-                targetsCount = targets.count { it.position != null },
+                targetsCount = posIndex,
             )
             val colorTarget = BuildingTarget.of(
                 textureFormat = TextureFormatExt.RGBA32F,
                 itemCount = verticesCount,
-                targetsCount = targets.count { it.colors.isNotEmpty() },
+                targetsCount = colorIndex,
             )
             val texCoordTarget = BuildingTarget.of(
                 textureFormat = TextureFormatExt.RG32F,
                 itemCount = verticesCount,
-                targetsCount = targets.count { it.texcoords.isNotEmpty() },
+                targetsCount = texCoordIndex,
             )
-            var posIndex = 0
-            var colorIndex = 0
-            var texCoordIndex = 0
             var posElements = 0
-            val groups = mutableListOf<MorphTargetGroup>()
-            for ((index, target) in targets.withIndex()) {
-                val position = target.position?.let { position ->
+            for (target in targets) {
+                target.position?.let { position ->
                     position.read { input ->
                         positionTarget.buffer.position(posElements * 16)
                         positionTarget.buffer.put(input)
                         posElements++
                     }
-                    posIndex++
                 }
-                val color = target.colors.firstOrNull()?.let { color ->
+                target.colors.firstOrNull()?.let { color ->
                     when (color.type) {
                         Accessor.AccessorType.VEC3 -> {
                             var index = 0
@@ -387,25 +415,14 @@ class ModelPreprocessor private constructor(
 
                         else -> throw AssertionError("Bad morph target: accessor type of color is ${color.type}")
                     }
-                    colorIndex++
                 }
-                val texCoord = target.texcoords.firstOrNull()?.let { texCoord ->
+                target.texcoords.firstOrNull()?.let { texCoord ->
                     texCoord.readNormalized {
                         texCoordTarget.buffer.putFloat(it)
                     }
-                    texCoordIndex++
                 }
-                groups.add(
-                    MorphTargetGroup(
-                        position = position,
-                        color = color,
-                        texCoord = texCoord,
-                        weight = weights?.getOrNull(index) ?: 0f,
-                    )
-                )
             }
             MorphTargetsLoadData(
-                targetGroups = groups,
                 position = positionTarget.toLoadData(),
                 color = colorTarget.toLoadData(),
                 texCoord = texCoordTarget.toLoadData(),
@@ -413,6 +430,7 @@ class ModelPreprocessor private constructor(
         }
         val targetIndex = morphTargetInfos.size
         morphTargetInfos.add(loadedTargets)
+        morphTargetGroups.add(groups)
         return targetIndex
     }
 
@@ -625,7 +643,14 @@ class ModelPreprocessor private constructor(
             nodeName = "Root node",
             humanoidTags = listOf(),
             transform = null,
-            components = listOf(),
+            components = listOfNotNull(
+                model.springBone
+                    ?.takeIf { it.springs.isNotEmpty() }
+                    ?.let { NodeLoadInfo.Component.SpringBone(it) },
+                model.physics
+                    ?.takeIf { it.rigidBodies.isNotEmpty() }
+                    ?.let { NodeLoadInfo.Component.Physics(it) },
+            ),
             childrenIndices = scene.nodes.map { loadNode(it) },
         )
         val rootNodeIndex = nodes.size
@@ -633,6 +658,8 @@ class ModelPreprocessor private constructor(
         val (expressions, expressionGroups) = loadExpressions(expressions)
         return PreProcessModelLoadInfo(
             textures = textures,
+            textureKeys = textureKeys,
+            reusedTextures = reusedTextures,
             indexBuffers = indexBuffers,
             vertexBuffers = vertexBuffers,
             primitiveInfos = primitiveInfos,
@@ -640,6 +667,7 @@ class ModelPreprocessor private constructor(
             rootNodeIndex = rootNodeIndex,
             skins = skinsList,
             morphTargetInfos = morphTargetInfos,
+            morphTargetGroups = morphTargetGroups,
             expressions = expressions,
             expressionGroups = expressionGroups,
             renderTransform = scene.transform,
@@ -657,6 +685,7 @@ class ModelPreprocessor private constructor(
             scope: CoroutineScope,
             loadDispatcher: CoroutineDispatcher,
             model: Model,
-        ) = ModelPreprocessor(scope, loadDispatcher, model).loadModel()
+            reuse: ResourceReuse,
+        ) = ModelPreprocessor(scope, loadDispatcher, model, reuse).loadModel()
     }
 }
\ No newline at end of file
@@ -1,25 +1,35 @@
 package top.fifthlight.blazerod.runtime.load
 
 import com.mojang.blaze3d.buffers.GpuBuffer
-import com.mojang.blaze3d.systems.RenderSystem
 import com.mojang.blaze3d.textures.GpuTexture
 import com.mojang.blaze3d.textures.TextureFormat
 import kotlinx.coroutines.CoroutineDispatcher
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Deferred
+import kotlinx.coroutines.NonCancellable
+import kotlinx.coroutines.Runnable
 import kotlinx.coroutines.async
+import kotlinx.coroutines.currentCoroutineContext
+import kotlinx.coroutines.job
+import kotlinx.coroutines.joinAll
+import kotlinx.coroutines.withContext
 import top.fifthlight.blazerod.extension.GpuBufferExt
-import top.fifthlight.blazerod.extension.createBuffer
 import top.fifthlight.blazerod.render.GpuIndexBuffer
 import top.fifthlight.blazerod.render.RefCountedGpuBuffer
+import top.fifthlight.blazerod.runtime.resource.ContentKey
+import top.fifthlight.blazerod.runtime.resource.IndexBufferKey
 import top.fifthlight.blazerod.runtime.resource.RenderPrimitive
-import top.fifthlight.blazerod.runtime.resource.RenderTexture
+import top.fifthlight.blazerod.runtime.resource.ResourceDevice
+import top.fifthlight.blazerod.runtime.resource.ReusableResources
 import top.fifthlight.blazerod.util.blaze3d.blaze3d
 import top.fifthlight.blazerod.util.blaze3d.useMipmap
+import top.fifthlight.blazerod.util.dispatchers.UploadQueueDispatcher
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
+import java.util.function.Supplier
 import kotlin.coroutines.CoroutineContext
 import kotlin.coroutines.EmptyCoroutineContext
+import kotlin.math.min
 
 object ModelResourceLoader {
     private fun <T, R> Deferred<T>.map(
@@ -38,80 +48,192 @@ object ModelResourceLoader {
         it.map(scope, context, block)
     }
 
+    // Large uploads are split into chunks, so a single job never takes the whole frame budget
+    private const val UPLOAD_CHUNK_SIZE = 1024 * 1024
+
+    private suspend fun <T> upload(
+        gpuDispatcher: CoroutineDispatcher,
+        bytes: Long,
+        block: () -> T,
+    ): T = withContext(gpuDispatcher + UploadQueueDispatcher.UploadSize(bytes)) {
+        block()
+    }
+
+    /**
+     * Create a GPU resource owned by the current job. The resource is closed on render thread if the job fails or is
+     * cancelled, including after it returned, as nobody receives the result then. Creation itself is not cancellable,
+     * or a created resource could be dropped before it is tracked.
+     */
+    private suspend fun <T : AutoCloseable> create(
+        gpuDispatcher: CoroutineDispatcher,
+        block: () -> T,
+    ): T {
+        val resource = withContext(gpuDispatcher + NonCancellable + UploadQueueDispatcher.UploadSize(0)) {
+            block()
+        }
+        currentCoroutineContext().job.invokeOnCompletion { cause ->
+            if (cause != null) {
+                gpuDispatcher.dispatch(EmptyCoroutineContext, Runnable { resource.close() })
+            }
+        }
+        return resource
+    }
+
+    private suspend fun createBuffer(
+        device: ResourceDevice,
+        gpuDispatcher: CoroutineDispatcher,
+        labelGetter: Supplier<String>?,
+        usage: Int,
+        extraUsage: Int,
+        data: ByteBuffer,
+    ): GpuBuffer {
+        val size = data.remaining()
+        val buffer = create(gpuDispatcher) {
+            device.createBuffer(
+                labelGetter = labelGetter,
+                usage = usage or GpuBuffer.USAGE_COPY_DST,
+                extraUsage = extraUsage,
+                size = size,
+            )
+        }
+        var offset = 0
+        while (offset < size) {
+            val length = min(UPLOAD_CHUNK_SIZE, size - offset)
+            val chunkOffset = offset
+            upload(gpuDispatcher, length.toLong()) {
+                val chunk = data.slice(data.position() + chunkOffset, length)
+                device.writeToBuffer(buffer.slice(chunkOffset, length), chunk)
+            }
+            offset += length
+        }
+        return buffer
+    }
+
     fun load(
         scope: CoroutineScope,
         gpuDispatcher: CoroutineDispatcher,
         info: PreProcessModelLoadInfo,
+        reuse: ResourceReuse,
+        device: ResourceDevice = ResourceDevice.current,
     ): GpuLoadModelLoadInfo {
-        val textures = info.textures.mapAll(scope, gpuDispatcher) { info ->
+        val indexBuffers = info.indexBuffers.mapAll(scope) { indexData ->
+            val key = if (reuse.needsKeys) {
+                IndexBufferKey(indexData.type, indexData.length, ContentKey.of(indexData.buffer))
+            } else {
+                null
+            }
+            val indexBuffer = key?.let { reuse.indexBuffer(it) } ?: run {
+                val buffer = RefCountedGpuBuffer(
+                    createBuffer(
+                        device = device,
+                        gpuDispatcher = gpuDispatcher,
+                        labelGetter = null,
+                        usage = GpuBuffer.USAGE_INDEX,
+                        extraUsage = 0,
+                        data = indexData.buffer,
+                    )
+                )
+                GpuIndexBuffer(
+                    type = indexData.type,
+                    length = indexData.length,
+                    buffer = buffer,
+                )
+            }
+            key?.let { reuse.current?.putIndexBuffer(it, indexBuffer) }
+            indexBuffer
+        }
+        val vertexBuffers = info.vertexBuffers.mapAll(scope) {
+            val key = if (reuse.needsKeys) ContentKey.of(it) else null
+            val vertexBuffer = key?.let { key -> reuse.vertexBuffer(key) } ?: run {
+                val buffer = RefCountedGpuBuffer(
+                    createBuffer(
+                        device = device,
+                        gpuDispatcher = gpuDispatcher,
+                        labelGetter = null,
+                        usage = GpuBuffer.USAGE_VERTEX,
+                        extraUsage = GpuBufferExt.EXTRA_USAGE_STORAGE_BUFFER,
+                        data = it,
+                    )
+                )
+                ReusableResources.VertexBuffer(
+                    gpuBuffer = buffer,
+                    cpuBuffer = it,
+                )
+            }
+            key?.let { key -> reuse.current?.putVertexBuffer(key, vertexBuffer) }
+            GpuLoadVertexData(
+                gpuBuffer = vertexBuffer.gpuBuffer,
+                cpuBuffer = vertexBuffer.cpuBuffer,
+            )
+        }
+        // Upload geometry first, so the scene can be shown before textures and morph targets are ready
+        val geometry = indexBuffers + vertexBuffers
+        val textures = info.textures.mapAll(scope) { info ->
             val info = info ?: return@mapAll null
             info.use { info ->
+                geometry.joinAll()
                 val (name, nativeImage, sampler) = info
-                val device = RenderSystem.getDevice()
-                val commandEncoder = device.createCommandEncoder()
-                val gpuTexture: GpuTexture
-                nativeImage.use {
-                    gpuTexture = device.createTexture(
+                val width = nativeImage.width
+                val height = nativeImage.height
+                val gpuTexture = create(gpuDispatcher) {
+                    device.createTexture(
                         name,
                         GpuTexture.USAGE_TEXTURE_BINDING or GpuTexture.USAGE_COPY_DST,
                         TextureFormat.RGBA8,
-                        nativeImage.width,
-                        nativeImage.height,
+                        width,
+                        height,
                         1,
                         1
-                    )
-                    gpuTexture.setAddressMode(sampler.wrapS.blaze3d, sampler.wrapT.blaze3d)
-                    gpuTexture.setTextureFilter(
-                        sampler.minFilter.blaze3d,
-                        sampler.magFilter.blaze3d,
-                        sampler.minFilter.useMipmap,
-                    )
-                    commandEncoder.writeToTexture(gpuTexture, nativeImage)
+                    ).apply {
+                        setAddressMode(sampler.wrapS.blaze3d, sampler.wrapT.blaze3d)
+                        setTextureFilter(
+                            sampler.minFilter.blaze3d,
+                            sampler.magFilter.blaze3d,
+                            sampler.minFilter.useMipmap,
+                        )
+                    }
+                }
+                val view = create(gpuDispatcher) {
+                    device.createTextureView(gpuTexture)
                 }
-                val textureView = device.createTextureView(gpuTexture)
-                RenderTexture(gpuTexture, textureView)
+                // Upload in bands of rows
+                val rowBytes = width.toLong() * TextureFormat.RGBA8.pixelSize()
+                val bandRows = (UPLOAD_CHUNK_SIZE / rowBytes).toInt().coerceAtLeast(1)
+                var y = 0
+                while (y < height) {
+                    val rows = min(bandRows, height - y)
+                    val bandY = y
+                    upload(gpuDispatcher, rowBytes * rows) {
+                        device.writeToTexture(
+                            gpuTexture,
+                            nativeImage,
+                            0,
+                            0,
+                            0,
+                            bandY,
+                            width,
+                            rows,
+                            0,
+                            bandY,
+                        )
+                    }
+                    y += rows
+                }
+                GpuLoadTexture(gpuTexture, view)
             }
         }
-        val indexBuffers = info.indexBuffers.mapAll(scope, gpuDispatcher) { indexData ->
-            val device = RenderSystem.getDevice()
-            val buffer = RefCountedGpuBuffer(
-                device.createBuffer(
-                    null,
-                    GpuBuffer.USAGE_INDEX,
-                    indexData.buffer,
-                )
-            )
-            GpuIndexBuffer(
-                type = indexData.type,
-                length = indexData.length,
-                buffer = buffer,
-            )
-        }
-        val vertexBuffers = info.vertexBuffers.mapAll(scope, gpuDispatcher) {
-            val device = RenderSystem.getDevice()
-            val buffer = RefCountedGpuBuffer(
-                device.createBuffer(
-                    labelGetter = null,
-                    usage = GpuBuffer.USAGE_VERTEX,
-                    extraUsage = GpuBufferExt.EXTRA_USAGE_STORAGE_BUFFER,
-                    data = it,
-                )
-            )
-            GpuLoadVertexData(
-                gpuBuffer = buffer,
-                cpuBuffer = it,
-            )
-        }
-        val morphTargetInfos = info.morphTargetInfos.mapAll(scope, gpuDispatcher) {
-            fun loadTarget(target: MorphTargetsLoadData.TargetInfo): RenderPrimitive.Target {
+        val morphTargetInfos = info.morphTargetInfos.mapAll(scope) {
+            textures.joinAll()
+            suspend fun loadTarget(target: MorphTargetsLoadData.TargetInfo): RenderPrimitive.Target {
                 val targetBuffer = if (target.targetsCount == 0) {
                     // No targets, but we can't create an empty buffer, so let's create a dummy one
                     ByteBuffer.allocateDirect(target.itemStride).order(ByteOrder.nativeOrder())
                 } else {
                     target.buffer
                 }
-                val device = RenderSystem.getDevice()
-                val gpuBuffer = device.createBuffer(
+                val gpuBuffer = createBuffer(
+                    device = device,
+                    gpuDispatcher = gpuDispatcher,
                     labelGetter = { "Morph target buffer" },
                     usage = GpuBuffer.USAGE_UNIFORM_TEXEL_BUFFER,
                     extraUsage = GpuBufferExt.EXTRA_USAGE_STORAGE_BUFFER,
@@ -124,7 +246,6 @@ object ModelResourceLoader {
                 )
             }
             MorphTargetsLoadData(
-                targetGroups = it.targetGroups,
                 position = loadTarget(it.position),
                 color = loadTarget(it.color),
                 texCoord = loadTarget(it.texCoord),
@@ -132,9 +253,12 @@ object ModelResourceLoader {
         }
         return GpuLoadModelLoadInfo(
             textures = textures,
+            textureKeys = info.textureKeys,
+            reusedTextures = info.reusedTextures,
             indexBuffers = indexBuffers,
             vertexBuffers = vertexBuffers,
             morphTargetInfos = morphTargetInfos,
+            morphTargetGroups = info.morphTargetGroups,
             primitiveInfos = info.primitiveInfos,
             rootNodeIndex = info.rootNodeIndex,
             nodes = info.nodes,
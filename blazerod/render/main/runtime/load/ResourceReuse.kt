@@ -0,0 +1,61 @@
+package top.fifthlight.blazerod.runtime.load
+
+import top.fifthlight.blazerod.api.refcount.RefCount
+import top.fifthlight.blazerod.render.GpuIndexBuffer
+import top.fifthlight.blazerod.runtime.resource.ContentKey
+import top.fifthlight.blazerod.runtime.resource.IndexBufferKey
+import top.fifthlight.blazerod.runtime.resource.RenderTexture
+import top.fifthlight.blazerod.runtime.resource.ReusableResources
+import top.fifthlight.blazerod.runtime.resource.TextureKey
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * Resource lookups of a single load. Resources reused from [previous] are referenced until [close], which is called
+ * after the new scene took its own references, so the previous scene can be closed while loading.
+ *
+ * If [reloadable], all resources of the new scene are indexed in [current], for the next reload.
+ */
+class ResourceReuse(
+    private val previous: ReusableResources?,
+    reloadable: Boolean,
+) : AutoCloseable {
+    val current = if (reloadable) ReusableResources() else null
+
+    // Content keys are only needed to look up or index resources, hashing is skipped otherwise
+    val needsKeys
+        get() = previous != null || current != null
+
+    private val held = mutableListOf<RefCount>()
+    private var closed = false
+
+    val reusedTextures = AtomicInteger()
+    val reusedBuffers = AtomicInteger()
+
+    private fun hold(resource: RefCount): Boolean = synchronized(held) {
+        if (closed) {
+            // Too late to be referenced by the new scene
+            resource.decreaseReferenceCount()
+            return false
+        }
+        held.add(resource)
+        true
+    }
+
+    fun texture(key: TextureKey): RenderTexture? = previous?.acquireTexture(key)
+        ?.takeIf { hold(it) }
+        ?.also { reusedTextures.incrementAndGet() }
+
+    fun vertexBuffer(key: ContentKey): ReusableResources.VertexBuffer? = previous?.acquireVertexBuffer(key)
+        ?.takeIf { hold(it.gpuBuffer) }
+        ?.also { reusedBuffers.incrementAndGet() }
+
+    fun indexBuffer(key: IndexBufferKey): GpuIndexBuffer? = previous?.acquireIndexBuffer(key)
+        ?.takeIf { hold(it) }
+        ?.also { reusedBuffers.incrementAndGet() }
+
+    override fun close() = synchronized(held) {
+        closed = true
+        held.forEach { it.decreaseReferenceCount() }
+        held.clear()
+    }
+}
@@ -1,32 +1,59 @@
 package top.fifthlight.blazerod.runtime.load
 
+import kotlinx.coroutines.CoroutineDispatcher
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Deferred
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.NonCancellable
+import kotlinx.coroutines.Runnable
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
 import net.minecraft.client.gl.RenderPassImpl
+import org.joml.Matrix4f
+import org.joml.Vector3f
+import org.slf4j.LoggerFactory
 import top.fifthlight.blazerod.api.refcount.checkInUse
 import top.fifthlight.blazerod.model.TransformId
 import top.fifthlight.blazerod.runtime.RenderSceneImpl
 import top.fifthlight.blazerod.runtime.node.RenderNodeImpl
 import top.fifthlight.blazerod.runtime.node.component.*
+import top.fifthlight.blazerod.runtime.physics.PhysicsData
+import top.fifthlight.blazerod.runtime.physics.SpringBoneData
 import top.fifthlight.blazerod.runtime.resource.RenderMaterial
 import top.fifthlight.blazerod.runtime.resource.RenderPrimitive
 import top.fifthlight.blazerod.runtime.resource.RenderPrimitive.Targets
 import top.fifthlight.blazerod.runtime.resource.RenderTexture
+import kotlin.coroutines.EmptyCoroutineContext
+import kotlin.coroutines.cancellation.CancellationException
 import top.fifthlight.blazerod.model.Camera as ModelCamera
+import top.fifthlight.blazerod.model.Physics as ModelPhysics
+import top.fifthlight.blazerod.model.SpringBone as ModelSpringBone
 
-class SceneReconstructor private constructor(private val info: GpuLoadModelLoadInfo) {
+class SceneReconstructor private constructor(
+    private val info: GpuLoadModelLoadInfo,
+    private val streamingScope: CoroutineScope,
+    private val gpuDispatcher: CoroutineDispatcher,
+    private val reuse: ResourceReuse,
+) {
     private val nodeIdToIndexMap = buildMap {
         info.nodes.forEachIndexed { index, node ->
             node.nodeId?.let { put(it, index) }
         }
     }
 
-    private suspend fun loadTexture(
+    // Texture index to placeholder, replaced by the real texture when it is streamed in
+    private val placeholderTextures = mutableMapOf<Int, RenderTexture>()
+
+    private fun loadTexture(
         textureInfo: MaterialLoadInfo.TextureInfo?,
         fallback: RenderTexture = RenderTexture.WHITE_RGBA_TEXTURE,
     ) = textureInfo?.let {
-        info.textures[textureInfo.textureIndex].await()
+        info.reusedTextures[textureInfo.textureIndex]
+            ?: placeholderTextures.getOrPut(textureInfo.textureIndex) { RenderTexture.placeholder() }
     } ?: fallback
 
-    private suspend fun loadMaterial(materialLoadInfo: MaterialLoadInfo) = when (materialLoadInfo) {
+    private fun loadMaterial(materialLoadInfo: MaterialLoadInfo) = when (materialLoadInfo) {
         is MaterialLoadInfo.Pbr -> RenderMaterial.Pbr(
             name = materialLoadInfo.name,
             baseColor = materialLoadInfo.baseColor,
@@ -68,7 +95,124 @@ class SceneReconstructor private constructor(private val info: GpuLoadModelLoadI
         )
     }
 
+    private fun loadSpringBone(springBone: ModelSpringBone): SpringBoneData? {
+        // Colliders referring to missing nodes are dropped, so remap the indices
+        val colliderIndices = IntArray(springBone.colliders.size) { -1 }
+        val colliders = mutableListOf<SpringBoneData.Collider>()
+        for ((index, collider) in springBone.colliders.withIndex()) {
+            val nodeIndex = nodeIdToIndexMap[collider.node] ?: continue
+            val shape = collider.shape
+            colliderIndices[index] = colliders.size
+            colliders.add(
+                SpringBoneData.Collider(
+                    nodeIndex = nodeIndex,
+                    offset = shape.offset,
+                    tail = (shape as? ModelSpringBone.Collider.Shape.Capsule)?.tail,
+                    radius = shape.radius,
+                )
+            )
+        }
+
+        fun restTranslation(nodeIndex: Int) = info.nodes[nodeIndex].transform?.getTranslation(Vector3f()) ?: Vector3f()
+
+        val springs = springBone.springs.mapNotNull { spring ->
+            val jointNodeIndices = spring.joints.map { nodeIdToIndexMap[it.node] ?: return@mapNotNull null }
+            val tailLength = spring.tailLength
+            val simulatedJoints = if (tailLength != null) spring.joints.size else spring.joints.size - 1
+            val joints = (0 until simulatedJoints).map { index ->
+                val joint = spring.joints[index]
+                val localTail = if (index + 1 < jointNodeIndices.size) {
+                    restTranslation(jointNodeIndices[index + 1])
+                } else {
+                    // Virtual tail, extending the bone direction
+                    val translation = restTranslation(jointNodeIndices[index])
+                    if (translation.lengthSquared() > 0f) {
+                        translation.normalize(tailLength!!)
+                    } else {
+                        translation.set(0f, tailLength!!, 0f)
+                    }
+                }
+                SpringBoneData.Joint(
+                    nodeIndex = jointNodeIndices[index],
+                    localTail = localTail,
+                    hitRadius = joint.hitRadius,
+                    stiffness = joint.stiffness,
+                    gravityPower = joint.gravityPower,
+                    gravityDir = joint.gravityDir,
+                    dragForce = joint.dragForce,
+                )
+            }
+            if (joints.isEmpty()) {
+                return@mapNotNull null
+            }
+            SpringBoneData.Spring(
+                joints = joints,
+                colliders = spring.colliderGroups
+                    .flatMap { springBone.colliderGroups.getOrNull(it)?.colliders ?: listOf() }
+                    .mapNotNull { colliderIndices.getOrNull(it)?.takeIf { index -> index >= 0 } }
+                    .distinct(),
+            )
+        }
+        if (springs.isEmpty()) {
+            return null
+        }
+        return SpringBoneData(springs, colliders)
+    }
+
+    private fun loadPhysics(physics: ModelPhysics): PhysicsData {
+        // Rest world transforms and depths of nodes
+        val restTransforms = arrayOfNulls<Matrix4f>(info.nodes.size)
+        val depths = IntArray(info.nodes.size)
+        fun visit(index: Int, parentTransform: Matrix4f?, depth: Int) {
+            val node = info.nodes[index]
+            val transform = Matrix4f()
+            parentTransform?.let { transform.set(it) }
+            node.transform?.let { transform.mul(it.matrix) }
+            restTransforms[index] = transform
+            depths[index] = depth
+            for (child in node.childrenIndices) {
+                visit(child, transform, depth + 1)
+            }
+        }
+        visit(info.rootNodeIndex, null, 0)
+
+        return PhysicsData(
+            rigidBodies = physics.rigidBodies.map { rigidBody ->
+                val nodeIndex = rigidBody.node?.let { nodeIdToIndexMap[it] } ?: -1
+                PhysicsData.RigidBody(
+                    nodeIndex = nodeIndex,
+                    nodeDepth = if (nodeIndex >= 0) depths[nodeIndex] else 0,
+                    shape = rigidBody.shape,
+                    type = rigidBody.type,
+                    mass = rigidBody.mass,
+                    linearDamping = rigidBody.linearDamping,
+                    angularDamping = rigidBody.angularDamping,
+                    collisionGroup = rigidBody.collisionGroup,
+                    collisionMask = rigidBody.collisionMask,
+                    restPosition = rigidBody.position,
+                    restRotation = rigidBody.rotation,
+                    nodeRestTransform = if (nodeIndex >= 0) restTransforms[nodeIndex] else null,
+                )
+            },
+            joints = physics.joints.map { joint ->
+                PhysicsData.Joint(
+                    bodyA = joint.rigidBodyA,
+                    bodyB = joint.rigidBodyB,
+                    restPosition = joint.position,
+                    restRotation = joint.rotation,
+                    positionMin = joint.positionMin,
+                    positionMax = joint.positionMax,
+                    rotationMin = joint.rotationMin,
+                    rotationMax = joint.rotationMax,
+                    positionStiffness = joint.positionStiffness,
+                    rotationStiffness = joint.rotationStiffness,
+                )
+            },
+        )
+    }
+
     private val cameras = mutableListOf<ModelCamera>()
+    private val morphedPrimitives = mutableListOf<Pair<Int, RenderPrimitive>>()
     private suspend fun loadNode(
         index: Int,
         node: NodeLoadInfo,
@@ -87,26 +231,24 @@ class SceneReconstructor private constructor(private val info: GpuLoadModelLoadI
                     val material = primitiveInfo.materialInfo?.let { materialLoadInfo ->
                         loadMaterial(materialLoadInfo)
                     } ?: RenderMaterial.defaultMaterial
-                    val targets =
-                        primitiveInfo.morphedPrimitiveIndex?.let { index -> info.morphTargetInfos[index].await() }
+                    val primitive = RenderPrimitive(
+                        vertices = primitiveInfo.vertices,
+                        vertexFormatMode = primitiveInfo.vertexFormatMode,
+                        gpuVertexBuffer = vertexBuffer.gpuBuffer,
+                        cpuVertexBuffer = vertexBuffer.cpuBuffer,
+                        indexBuffer = indexBuffer,
+                        material = material,
+                        targets = null,
+                        targetGroups = primitiveInfo.morphedPrimitiveIndex?.let { index ->
+                            info.morphTargetGroups[index]
+                        } ?: listOf(),
+                    )
+                    primitiveInfo.morphedPrimitiveIndex?.let { index ->
+                        morphedPrimitives.add(Pair(index, primitive))
+                    }
                     PrimitiveComponent(
                         primitiveIndex = component.infoIndex,
-                        primitive = RenderPrimitive(
-                            vertices = primitiveInfo.vertices,
-                            vertexFormatMode = primitiveInfo.vertexFormatMode,
-                            gpuVertexBuffer = vertexBuffer.gpuBuffer,
-                            cpuVertexBuffer = vertexBuffer.cpuBuffer,
-                            indexBuffer = indexBuffer,
-                            material = material,
-                            targets = targets?.let {
-                                Targets(
-                                    position = it.position,
-                                    color = it.color,
-                                    texCoord = it.texCoord,
-                                )
-                            },
-                            targetGroups = targets?.targetGroups ?: listOf(),
-                        ),
+                        primitive = primitive,
                         skinIndex = primitiveInfo.skinIndex,
                         morphedPrimitiveIndex = primitiveInfo.morphedPrimitiveIndex,
                     )
@@ -153,10 +295,80 @@ class SceneReconstructor private constructor(private val info: GpuLoadModelLoadI
                         }
                     )
                 }
+
+                is NodeLoadInfo.Component.SpringBone -> {
+                    SpringBoneComponent(
+                        data = loadSpringBone(component.springBone) ?: return@mapNotNull null,
+                    )
+                }
+
+                is NodeLoadInfo.Component.Physics -> {
+                    PhysicsComponent(
+                        data = loadPhysics(component.physics),
+                    )
+                }
             }
         },
     )
 
+    // The result can be loaded right when the streaming job is cancelled, and nobody takes it then
+    @OptIn(ExperimentalCoroutinesApi::class)
+    private fun <T> Deferred<T>.closeResultOnCompletion(close: (T) -> Unit) = invokeOnCompletion { cause ->
+        if (cause == null) {
+            val result = getCompleted()
+            gpuDispatcher.dispatch(EmptyCoroutineContext, Runnable { close(result) })
+        }
+    }
+
+    private fun streamTexture(index: Int, placeholder: RenderTexture) = streamingScope.launch {
+        val deferred = info.textures[index]
+        val texture = try {
+            deferred.await()
+        } catch (ex: CancellationException) {
+            deferred.closeResultOnCompletion { texture ->
+                texture?.view?.close()
+                texture?.texture?.close()
+            }
+            throw ex
+        } catch (ex: Exception) {
+            LOGGER.warn("Failed to load texture $index, keeping the placeholder", ex)
+            null
+        } ?: return@launch
+        withContext(gpuDispatcher + NonCancellable) {
+            // The placeholder takes the ownership of texture and view
+            placeholder.replace(texture.texture, texture.view)
+            if (!placeholder.closed) {
+                info.textureKeys[index]?.let { reuse.current?.putTexture(it, placeholder) }
+            }
+        }
+    }
+
+    private fun streamMorphTargets(index: Int, primitive: RenderPrimitive) = streamingScope.launch {
+        val deferred = info.morphTargetInfos[index]
+        val targets = try {
+            deferred.await()
+        } catch (ex: CancellationException) {
+            deferred.closeResultOnCompletion { targets ->
+                targets.position.close()
+                targets.color.close()
+                targets.texCoord.close()
+            }
+            throw ex
+        } catch (ex: Exception) {
+            LOGGER.warn("Failed to load morph targets of primitive $index, keeping it unmorphed", ex)
+            return@launch
+        }
+        withContext(gpuDispatcher + NonCancellable) {
+            primitive.attachTargets(
+                Targets(
+                    position = targets.position,
+                    color = targets.color,
+                    texCoord = targets.texCoord,
+                )
+            )
+        }
+    }
+
     private suspend fun reconstruct(): RenderSceneImpl {
         val nodes = info.nodes.mapIndexed { index, node -> loadNode(index, node) }
         for ((index, node) in nodes.withIndex()) {
@@ -171,13 +383,39 @@ class SceneReconstructor private constructor(private val info: GpuLoadModelLoadI
             expressionGroups = info.expressionGroups,
             cameras = cameras,
             renderTransform = info.renderTransform,
-        )
+            streamingJob = streamingScope.coroutineContext[Job],
+            reusableResources = reuse.current,
+        ).also {
+            for ((index, texture) in info.reusedTextures) {
+                info.textureKeys[index]?.let { reuse.current?.putTexture(it, texture) }
+            }
+            for ((index, placeholder) in placeholderTextures) {
+                streamTexture(index, placeholder)
+            }
+            for ((index, primitive) in morphedPrimitives) {
+                streamMorphTargets(index, primitive)
+            }
+        }
     }
 
     companion object {
-        suspend fun reconstruct(info: GpuLoadModelLoadInfo) = SceneReconstructor(info).reconstruct().also {
+        private val LOGGER = LoggerFactory.getLogger(SceneReconstructor::class.java)
+
+        /**
+         * Build the scene once geometry is uploaded. Textures are shown as placeholders and morphed primitives are drawn
+         * unmorphed, until they are streamed in by jobs launched in [streamingScope]. The job of [streamingScope] is
+         * owned by the returned scene, and cancelled when the scene is closed. Textures reused from previous scene are
+         * shown immediately.
+         *
+         * @param gpuDispatcher the dispatcher to swap the streamed resources in, which should run on render thread.
+         */
+        suspend fun reconstruct(
+            info: GpuLoadModelLoadInfo,
+            streamingScope: CoroutineScope,
+            gpuDispatcher: CoroutineDispatcher,
+            reuse: ResourceReuse,
+        ) = SceneReconstructor(info, streamingScope, gpuDispatcher, reuse).reconstruct().also {
             if (RenderPassImpl.IS_DEVELOPMENT) {
-                info.textures.forEach { it.await()?.checkInUse() }
                 info.indexBuffers.forEach { it.await().checkInUse() }
                 info.vertexBuffers.forEach { it.await().gpuBuffer?.checkInUse() }
             }
@@ -116,6 +116,15 @@ fun ModelInstanceImpl.markNodeTransformDirty(node: RenderNodeImpl) {
     }
 }
 
+// Update world transform of the node and its dirty ancestors only, leaving descendants dirty for next propagation
+fun ModelInstanceImpl.updateWorldTransform(node: RenderNodeImpl) {
+    if (!isNodeTransformDirty(node)) {
+        return
+    }
+    node.parent?.let { updateWorldTransform(it) }
+    node.update(UpdatePhase.GlobalTransformPropagation, node, this)
+}
+
 private fun ModelInstanceImpl.cleanNodeTransformDirty(node: RenderNodeImpl) {
     if (modelData.transformDirty[node.nodeIndex]) {
         modelData.transformDirty[node.nodeIndex] = false
@@ -31,6 +31,19 @@ class TransformMap(first: NodeTransformView?) {
         dirtyTransforms.removeIf { it >= id }
     }
 
+    // Copy transforms from [id] of [other], for carrying the pose of an instance to another scene of the same layout
+    fun copyFrom(other: TransformMap, id: TransformId) {
+        clearFrom(id)
+        for ((transformId, transform) in other.transforms) {
+            if (transformId < id) {
+                continue
+            }
+            transforms[transformId] = transform.clone()
+            intermediateMatrices.getOrPut(transformId, ::Matrix4f)
+        }
+        markDirty(id)
+    }
+
     private val tempAccumulatedMatrix = Matrix4f()
     private fun calculateIntermediateMatrices(targetId: TransformId): Matrix4fc {
         // 1. 确定计算的起始点 (startId)。
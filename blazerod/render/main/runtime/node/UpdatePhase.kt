@@ -12,6 +12,8 @@ sealed class UpdatePhase(
         IK_UPDATE,
         INFLUENCE_TRANSFORM_UPDATE,
         GLOBAL_TRANSFORM_PROPAGATION,
+        SPRING_BONE_UPDATE,
+        PHYSICS_UPDATE,
         RENDER_DATA_UPDATE,
         CAMERA_UPDATE,
         DEBUG_RENDER,
@@ -23,6 +25,10 @@ sealed class UpdatePhase(
 
     data object GlobalTransformPropagation : UpdatePhase(Type.GLOBAL_TRANSFORM_PROPAGATION)
 
+    data object SpringBoneUpdate : UpdatePhase(Type.SPRING_BONE_UPDATE)
+
+    data object PhysicsUpdate : UpdatePhase(Type.PHYSICS_UPDATE)
+
     data object RenderDataUpdate : UpdatePhase(Type.RENDER_DATA_UPDATE)
 
     data object CameraUpdate : UpdatePhase(Type.CAMERA_UPDATE)
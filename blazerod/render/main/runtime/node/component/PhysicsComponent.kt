@@ -0,0 +1,116 @@
+package top.fifthlight.blazerod.runtime.node.component
+
+import org.joml.Matrix4f
+import top.fifthlight.blazerod.model.TransformId
+import top.fifthlight.blazerod.runtime.ModelInstanceImpl
+import top.fifthlight.blazerod.runtime.node.RenderNodeImpl
+import top.fifthlight.blazerod.runtime.node.UpdatePhase
+import top.fifthlight.blazerod.runtime.node.getTransformMap
+import top.fifthlight.blazerod.runtime.node.getWorldTransform
+import top.fifthlight.blazerod.runtime.physics.PhysicsData
+import top.fifthlight.blazerod.runtime.physics.PhysicsSolver
+import top.fifthlight.blazerod.runtime.physics.get3
+import top.fifthlight.blazerod.runtime.physics.get4
+import top.fifthlight.blazerod.runtime.physics.put3
+import top.fifthlight.blazerod.runtime.physics.put4
+
+// Attached to the root node, drives all rigid bodies of the scene
+class PhysicsComponent(
+    val data: PhysicsData,
+) : RenderNodeComponent<PhysicsComponent>() {
+    override fun onClosed() {}
+
+    override val type: Type<PhysicsComponent>
+        get() = Type.Physics
+
+    companion object {
+        private val updatePhases = listOf(UpdatePhase.Type.PHYSICS_UPDATE)
+    }
+
+    override val updatePhases
+        get() = Companion.updatePhases
+
+    // World transform of the node, without physics transform
+    private fun ModelInstanceImpl.getAnimatedWorldTransform(node: RenderNodeImpl, dest: Matrix4f): Matrix4f {
+        val localTransform = getTransformMap(node).getSum(TransformId.PHYSICS.prev)
+        return node.parent?.let { parent ->
+            getWorldTransform(parent).mul(localTransform, dest)
+        } ?: dest.set(localTransform)
+    }
+
+    // Simulated by the scene with frame time, see simulate
+    override fun update(phase: UpdatePhase, node: RenderNodeImpl, instance: ModelInstanceImpl) = Unit
+
+    /**
+     * Step the rigid bodies of [instance] to [time], and write their transforms back. Only changes [instance], so it
+     * can run on a worker thread.
+     *
+     * @param time frame time in nanoseconds.
+     */
+    fun simulate(instance: ModelInstanceImpl, time: Long) {
+        val state = instance.modelData.physicsState ?: return
+
+        val elapsed = if (state.lastUpdateTime < 0) {
+            0f
+        } else {
+            (time - state.lastUpdateTime) / 1_000_000_000f
+        }
+        val steps = PhysicsSolver.advance(state, elapsed)
+        state.lastUpdateTime = time
+
+        val nodes = instance.scene.nodes
+        val matrix = state.cacheMatrix
+        val offset = state.cacheMatrix2
+        val position = state.cacheVector
+        val rotation = state.cacheRotation
+        if (steps > 0) {
+            for (body in 0 until data.bodyCount) {
+                val nodeIndex = data.bodyNodeIndices[body]
+                if (nodeIndex < 0) {
+                    data.bodyRestPositions.copyInto(state.targetPositions, body * 3, body * 3, body * 3 + 3)
+                    data.bodyRestRotations.copyInto(state.targetRotations, body * 4, body * 4, body * 4 + 4)
+                    continue
+                }
+                if (data.bodyTypes[body] == PhysicsData.TYPE_DYNAMIC && state.initialized) {
+                    continue
+                }
+                // Body follows the node
+                instance.getAnimatedWorldTransform(nodes[nodeIndex], matrix)
+                offset.translationRotate(
+                    data.bodyOffsetPositions.get3(body, position),
+                    data.bodyOffsetRotations.get4(body, rotation),
+                )
+                matrix.mul(offset)
+                state.targetPositions.put3(body, matrix.getTranslation(position))
+                state.targetRotations.put4(body, matrix.getNormalizedRotation(rotation))
+            }
+            repeat(steps) {
+                PhysicsSolver.step(state, PhysicsSolver.FIXED_TIME_STEP)
+            }
+        }
+        if (!state.initialized) {
+            return
+        }
+
+        // Write back, from parent to children. Done every update, as animation below may be changed.
+        for (body in data.writeBackBodies) {
+            val bodyNode = nodes[data.bodyNodeIndices[body]]
+            offset.translationRotate(
+                data.bodyOffsetPositions.get3(body, position),
+                data.bodyOffsetRotations.get4(body, rotation),
+            ).invertAffine()
+            val target = matrix.translationRotate(
+                state.positions.get3(body, position),
+                state.rotations.get4(body, rotation),
+            ).mul(offset)
+            val animated = instance.getAnimatedWorldTransform(bodyNode, offset)
+            if (data.bodyTypes[body] == PhysicsData.TYPE_DYNAMIC_WITH_NODE_POSITION) {
+                target.setTranslation(animated.getTranslation(position))
+            }
+            // Physics transform = animated^-1 * target
+            val physicsTransform = animated.invertAffine().mul(target)
+            instance.setTransformMatrix(bodyNode.nodeIndex, TransformId.PHYSICS, physicsTransform)
+            instance.updateNodeTransform(bodyNode)
+        }
+    }
+}
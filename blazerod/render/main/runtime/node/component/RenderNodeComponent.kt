@@ -11,16 +11,19 @@ import java.util.*
 
 sealed class RenderNodeComponent<C : RenderNodeComponent<C>> : AbstractRefCount() {
     companion object {
-        protected val DEBUG_RENDER_LAYER: RenderLayer.MultiPhase = RenderLayer.of(
-            "blazerod_joint_debug_lines",
-            1536,
-            RenderPipelines.LINES,
-            RenderLayer.MultiPhaseParameters.builder()
-                .lineWidth(RenderPhase.LineWidth(OptionalDouble.of(1.0)))
-                .layering(RenderPhase.VIEW_OFFSET_Z_LAYERING)
-                .target(RenderPhase.ITEM_ENTITY_TARGET)
-                .build(false)
-        )
+        // Lazy, so components can be created without the render layers of game, see the headless runtime tests
+        protected val DEBUG_RENDER_LAYER: RenderLayer.MultiPhase by lazy {
+            RenderLayer.of(
+                "blazerod_joint_debug_lines",
+                1536,
+                RenderPipelines.LINES,
+                RenderLayer.MultiPhaseParameters.builder()
+                    .lineWidth(RenderPhase.LineWidth(OptionalDouble.of(1.0)))
+                    .layering(RenderPhase.VIEW_OFFSET_Z_LAYERING)
+                    .target(RenderPhase.ITEM_ENTITY_TARGET)
+                    .build(false)
+            )
+        }
     }
 
     override val typeId: String
@@ -32,6 +35,8 @@ sealed class RenderNodeComponent<C : RenderNodeComponent<C>> : AbstractRefCount(
         object InfluenceSource : Type<top.fifthlight.blazerod.runtime.node.component.InfluenceSourceComponent>()
         object Camera : Type<top.fifthlight.blazerod.runtime.node.component.CameraComponent>()
         object IkTarget : Type<top.fifthlight.blazerod.runtime.node.component.IkTargetComponent>()
+        object SpringBone : Type<top.fifthlight.blazerod.runtime.node.component.SpringBoneComponent>()
+        object Physics : Type<top.fifthlight.blazerod.runtime.node.component.PhysicsComponent>()
     }
 
     abstract val type: Type<C>
@@ -0,0 +1,84 @@
+package top.fifthlight.blazerod.runtime.node.component
+
+import top.fifthlight.blazerod.model.TransformId
+import top.fifthlight.blazerod.runtime.ModelInstanceImpl
+import top.fifthlight.blazerod.runtime.node.RenderNodeImpl
+import top.fifthlight.blazerod.runtime.node.UpdatePhase
+import top.fifthlight.blazerod.runtime.node.getTransformMap
+import top.fifthlight.blazerod.runtime.node.getWorldTransform
+import top.fifthlight.blazerod.runtime.node.updateWorldTransform
+import top.fifthlight.blazerod.runtime.physics.SpringBoneData
+import top.fifthlight.blazerod.runtime.physics.SpringBoneSolver
+
+// Attached to the root node, drives all springs of the scene
+class SpringBoneComponent(
+    val data: SpringBoneData,
+) : RenderNodeComponent<SpringBoneComponent>() {
+    override fun onClosed() {}
+
+    override val type: Type<SpringBoneComponent>
+        get() = Type.SpringBone
+
+    companion object {
+        private val updatePhases = listOf(UpdatePhase.Type.SPRING_BONE_UPDATE)
+    }
+
+    override val updatePhases
+        get() = Companion.updatePhases
+
+    // Simulated by the scene with frame time, see simulate
+    override fun update(phase: UpdatePhase, node: RenderNodeImpl, instance: ModelInstanceImpl) = Unit
+
+    /**
+     * Step the springs of [instance] to [time]. Only world transforms read by the springs are updated, the scene
+     * propagates the rest once after. Only changes [instance], so it can run on a worker thread.
+     *
+     * @param time frame time in nanoseconds.
+     */
+    fun simulate(instance: ModelInstanceImpl, time: Long) {
+        val state = instance.modelData.springBoneState ?: return
+
+        val elapsed = if (state.lastUpdateTime < 0) {
+            0f
+        } else {
+            (time - state.lastUpdateTime) / 1_000_000_000f
+        }
+        val steps = SpringBoneSolver.advance(state, elapsed)
+        state.lastUpdateTime = time
+
+        val nodes = instance.scene.nodes
+        repeat(steps) {
+            for (i in 0 until data.colliderCount) {
+                val colliderNode = nodes[data.colliderNodeIndices[i]]
+                instance.updateWorldTransform(colliderNode)
+                SpringBoneSolver.updateCollider(state, i, instance.getWorldTransform(colliderNode))
+            }
+            for (springIndex in 0 until data.springCount) {
+                for (jointIndex in data.springJointOffsets[springIndex] until data.springJointOffsets[springIndex + 1]) {
+                    val jointNode = nodes[data.jointNodeIndices[jointIndex]]
+                    // World transform without the physics rotation of last step
+                    val jointWorld = state.jointMatrix
+                    val localTransform = instance.getTransformMap(jointNode).getSum(TransformId.PHYSICS.prev)
+                    jointNode.parent?.let { parent ->
+                        // Previous joint of the chain was changed, update the path to here only
+                        instance.updateWorldTransform(parent)
+                        instance.getWorldTransform(parent).mul(localTransform, jointWorld)
+                    } ?: jointWorld.set(localTransform)
+
+                    val rotation = SpringBoneSolver.updateJoint(
+                        state = state,
+                        springIndex = springIndex,
+                        jointIndex = jointIndex,
+                        jointWorld = jointWorld,
+                        deltaTime = SpringBoneSolver.FIXED_TIME_STEP,
+                        dest = state.cacheRotation,
+                    )
+                    instance.setTransformDecomposed(jointNode.nodeIndex, TransformId.PHYSICS) {
+                        this.rotation.set(rotation)
+                    }
+                }
+            }
+            state.initialized = true
+        }
+    }
+}
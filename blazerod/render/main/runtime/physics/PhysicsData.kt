@@ -0,0 +1,310 @@
+package top.fifthlight.blazerod.runtime.physics
+
+import org.joml.Matrix4f
+import org.joml.Matrix4fc
+import org.joml.Quaternionf
+import org.joml.Quaternionfc
+import org.joml.Vector3f
+import org.joml.Vector3fc
+import top.fifthlight.blazerod.model.Physics
+import kotlin.math.max
+
+/**
+ * Scene-wide rigid body description, packed into flat arrays for [PhysicsSolver].
+ *
+ * Bodies connected by joints form islands, which sleep and wake together. Kinematic bodies don't belong to any island,
+ * but every island records the kinematic bodies it's attached to, so it can be woken when they move.
+ */
+class PhysicsData(
+    rigidBodies: List<RigidBody>,
+    joints: List<Joint>,
+) {
+    class RigidBody(
+        // -1 if not attached to any node
+        val nodeIndex: Int,
+        // Depth of the node in the scene, parents are written back before children
+        val nodeDepth: Int,
+        val shape: Physics.RigidBody.Shape,
+        val type: Physics.RigidBody.Type,
+        val mass: Float,
+        val linearDamping: Float,
+        val angularDamping: Float,
+        val collisionGroup: Int,
+        val collisionMask: Int,
+        // Rest pose in model space
+        val restPosition: Vector3fc,
+        val restRotation: Quaternionfc,
+        // Rest world transform of the node
+        val nodeRestTransform: Matrix4fc?,
+    )
+
+    class Joint(
+        val bodyA: Int,
+        val bodyB: Int,
+        // Rest pose in model space
+        val restPosition: Vector3fc,
+        val restRotation: Quaternionfc,
+        val positionMin: Vector3fc,
+        val positionMax: Vector3fc,
+        val rotationMin: Vector3fc,
+        val rotationMax: Vector3fc,
+        val positionStiffness: Vector3fc,
+        val rotationStiffness: Vector3fc,
+    )
+
+    companion object {
+        const val TYPE_KINEMATIC = 0
+        const val TYPE_DYNAMIC = 1
+        const val TYPE_DYNAMIC_WITH_NODE_POSITION = 2
+    }
+
+    val bodyCount = rigidBodies.size
+    val jointCount = joints.size
+
+    val bodyNodeIndices = IntArray(bodyCount)
+    val bodyTypes = IntArray(bodyCount)
+    val bodyInverseMass = FloatArray(bodyCount)
+    // Diagonal of the inverse inertia tensor, in body space
+    val bodyInverseInertia = FloatArray(bodyCount * 3)
+    val bodyLinearDamping = FloatArray(bodyCount)
+    val bodyAngularDamping = FloatArray(bodyCount)
+
+    // Collision shape: a segment in body space (half of it, centered at origin) swept by a radius
+    val bodyRadius = FloatArray(bodyCount)
+    val bodySegments = FloatArray(bodyCount * 3)
+
+    val bodyRestPositions = FloatArray(bodyCount * 3)
+    val bodyRestRotations = FloatArray(bodyCount * 4)
+
+    // Body transform relative to the node: body world = node world * offset
+    val bodyOffsetPositions = FloatArray(bodyCount * 3)
+    val bodyOffsetRotations = FloatArray(bodyCount * 4)
+
+    val jointBodyA = IntArray(jointCount)
+    val jointBodyB = IntArray(jointCount)
+    // Joint frame in space of body A and body B
+    val jointFramePositionsA = FloatArray(jointCount * 3)
+    val jointFrameRotationsA = FloatArray(jointCount * 4)
+    val jointFramePositionsB = FloatArray(jointCount * 3)
+    val jointFrameRotationsB = FloatArray(jointCount * 4)
+    val jointPositionMin = FloatArray(jointCount * 3)
+    val jointPositionMax = FloatArray(jointCount * 3)
+    val jointRotationMin = FloatArray(jointCount * 3)
+    val jointRotationMax = FloatArray(jointCount * 3)
+    val jointPositionStiffness = FloatArray(jointCount * 3)
+    val jointRotationStiffness = FloatArray(jointCount * 3)
+
+    // Pairs of bodies to test collision with, as (a, b) tuples
+    val collisionPairs: IntArray
+
+    // Island of each body, -1 for kinematic bodies
+    val bodyIslands = IntArray(bodyCount) { -1 }
+    val islandCount: Int
+    val islandBodyOffsets: IntArray
+    val islandBodies: IntArray
+    val islandKinematicOffsets: IntArray
+    val islandKinematics: IntArray
+
+    // Simulated bodies attached to nodes, ordered from parent to children
+    val writeBackBodies: IntArray
+
+    init {
+        val cacheMatrix = Matrix4f()
+        val cachePosition = Vector3f()
+        val cacheRotation = Quaternionf()
+        for ((index, body) in rigidBodies.withIndex()) {
+            bodyNodeIndices[index] = body.nodeIndex
+            bodyTypes[index] = when (body.type) {
+                Physics.RigidBody.Type.KINEMATIC -> TYPE_KINEMATIC
+                Physics.RigidBody.Type.DYNAMIC -> TYPE_DYNAMIC
+                Physics.RigidBody.Type.DYNAMIC_WITH_NODE_POSITION -> TYPE_DYNAMIC_WITH_NODE_POSITION
+            }
+            val simulated = bodyTypes[index] != TYPE_KINEMATIC && body.mass > 0f
+            if (!simulated) {
+                // Massless bodies can't be simulated, just let them follow the node
+                bodyTypes[index] = TYPE_KINEMATIC
+            }
+            bodyLinearDamping[index] = body.linearDamping.coerceIn(0f, 1f)
+            bodyAngularDamping[index] = body.angularDamping.coerceIn(0f, 1f)
+
+            // Inertia of the bounding box of the shape is good enough
+            val (sizeX, sizeY, sizeZ) = when (val shape = body.shape) {
+                is Physics.RigidBody.Shape.Sphere -> {
+                    bodyRadius[index] = shape.radius
+                    Triple(shape.radius, shape.radius, shape.radius)
+                }
+
+                is Physics.RigidBody.Shape.Capsule -> {
+                    bodyRadius[index] = shape.radius
+                    bodySegments[index * 3 + 1] = shape.height / 2
+                    Triple(shape.radius, shape.height / 2 + shape.radius, shape.radius)
+                }
+
+                is Physics.RigidBody.Shape.Box -> {
+                    // Boxes collide as a capsule along the longest axis
+                    val extents = shape.halfExtents
+                    val longestAxis = extents.maxComponent()
+                    val longest = extents.get(longestAxis)
+                    val radius = (0 until 3).filter { it != longestAxis }.minOf { extents.get(it) }
+                    bodyRadius[index] = radius
+                    bodySegments[index * 3 + longestAxis] = max(0f, longest - radius)
+                    Triple(extents.x(), extents.y(), extents.z())
+                }
+            }
+            if (simulated) {
+                val mass = body.mass
+                bodyInverseMass[index] = 1f / mass
+                val xx = sizeX * sizeX
+                val yy = sizeY * sizeY
+                val zz = sizeZ * sizeZ
+                bodyInverseInertia[index * 3] = 3f / (mass * (yy + zz)).coerceAtLeast(1e-6f)
+                bodyInverseInertia[index * 3 + 1] = 3f / (mass * (xx + zz)).coerceAtLeast(1e-6f)
+                bodyInverseInertia[index * 3 + 2] = 3f / (mass * (xx + yy)).coerceAtLeast(1e-6f)
+            }
+
+            bodyRestPositions.put3(index, body.restPosition)
+            bodyRestRotations.put4(index, body.restRotation)
+
+            val offset = cacheMatrix.translationRotate(body.restPosition, body.restRotation)
+            body.nodeRestTransform?.let { nodeRestTransform ->
+                offset.mulLocal(Matrix4f(nodeRestTransform).invert())
+            }
+            bodyOffsetPositions.put3(index, offset.getTranslation(cachePosition))
+            bodyOffsetRotations.put4(index, offset.getNormalizedRotation(cacheRotation))
+        }
+
+        val restA = Matrix4f()
+        val restB = Matrix4f()
+        val frame = Matrix4f()
+        for ((index, joint) in joints.withIndex()) {
+            jointBodyA[index] = joint.bodyA
+            jointBodyB[index] = joint.bodyB
+            val jointRest = cacheMatrix.translationRotate(joint.restPosition, joint.restRotation)
+            rigidBodies[joint.bodyA].let { restA.translationRotate(it.restPosition, it.restRotation).invert() }
+            rigidBodies[joint.bodyB].let { restB.translationRotate(it.restPosition, it.restRotation).invert() }
+            restA.mul(jointRest, frame)
+            jointFramePositionsA.put3(index, frame.getTranslation(cachePosition))
+            jointFrameRotationsA.put4(index, frame.getNormalizedRotation(cacheRotation))
+            restB.mul(jointRest, frame)
+            jointFramePositionsB.put3(index, frame.getTranslation(cachePosition))
+            jointFrameRotationsB.put4(index, frame.getNormalizedRotation(cacheRotation))
+            jointPositionMin.put3(index, joint.positionMin)
+            jointPositionMax.put3(index, joint.positionMax)
+            jointRotationMin.put3(index, joint.rotationMin)
+            jointRotationMax.put3(index, joint.rotationMax)
+            jointPositionStiffness.put3(index, joint.positionStiffness)
+            jointRotationStiffness.put3(index, joint.rotationStiffness)
+        }
+
+        // Union simulated bodies connected by joints
+        val islandParents = IntArray(bodyCount) { it }
+        fun find(body: Int): Int {
+            var current = body
+            while (islandParents[current] != current) {
+                islandParents[current] = islandParents[islandParents[current]]
+                current = islandParents[current]
+            }
+            return current
+        }
+        for (i in 0 until jointCount) {
+            val a = jointBodyA[i]
+            val b = jointBodyB[i]
+            if (bodyTypes[a] != TYPE_KINEMATIC && bodyTypes[b] != TYPE_KINEMATIC) {
+                islandParents[find(a)] = find(b)
+            }
+        }
+        val islandIndices = HashMap<Int, Int>()
+        for (body in 0 until bodyCount) {
+            if (bodyTypes[body] == TYPE_KINEMATIC) {
+                continue
+            }
+            bodyIslands[body] = islandIndices.getOrPut(find(body)) { islandIndices.size }
+        }
+        islandCount = islandIndices.size
+
+        val bodiesOfIsland = List(islandCount) { mutableListOf<Int>() }
+        val kinematicsOfIsland = List(islandCount) { mutableSetOf<Int>() }
+        for (body in 0 until bodyCount) {
+            val island = bodyIslands[body]
+            if (island >= 0) {
+                bodiesOfIsland[island].add(body)
+            }
+        }
+        val connectedPairs = HashSet<Long>()
+        fun pairKey(a: Int, b: Int) = if (a < b) {
+            (a.toLong() shl 32) or b.toLong()
+        } else {
+            (b.toLong() shl 32) or a.toLong()
+        }
+        for (i in 0 until jointCount) {
+            val a = jointBodyA[i]
+            val b = jointBodyB[i]
+            connectedPairs.add(pairKey(a, b))
+            if (bodyIslands[a] >= 0 && bodyIslands[b] < 0) {
+                kinematicsOfIsland[bodyIslands[a]].add(b)
+            } else if (bodyIslands[b] >= 0 && bodyIslands[a] < 0) {
+                kinematicsOfIsland[bodyIslands[b]].add(a)
+            }
+        }
+        islandBodyOffsets = IntArray(islandCount + 1)
+        islandKinematicOffsets = IntArray(islandCount + 1)
+        for (island in 0 until islandCount) {
+            islandBodyOffsets[island + 1] = islandBodyOffsets[island] + bodiesOfIsland[island].size
+            islandKinematicOffsets[island + 1] = islandKinematicOffsets[island] + kinematicsOfIsland[island].size
+        }
+        islandBodies = bodiesOfIsland.flatten().toIntArray()
+        islandKinematics = kinematicsOfIsland.flatten().toIntArray()
+
+        collisionPairs = buildList {
+            for (a in 0 until bodyCount) {
+                for (b in a + 1 until bodyCount) {
+                    if (bodyTypes[a] == TYPE_KINEMATIC && bodyTypes[b] == TYPE_KINEMATIC) {
+                        continue
+                    }
+                    val bodyA = rigidBodies[a]
+                    val bodyB = rigidBodies[b]
+                    if (bodyA.collisionMask and (1 shl bodyB.collisionGroup) == 0 ||
+                        bodyB.collisionMask and (1 shl bodyA.collisionGroup) == 0
+                    ) {
+                        continue
+                    }
+                    if (pairKey(a, b) in connectedPairs) {
+                        continue
+                    }
+                    add(a)
+                    add(b)
+                }
+            }
+        }.toIntArray()
+
+        writeBackBodies = (0 until bodyCount)
+            .filter { bodyTypes[it] != TYPE_KINEMATIC && bodyNodeIndices[it] >= 0 }
+            .sortedBy { rigidBodies[it].nodeDepth }
+            .toIntArray()
+    }
+}
+
+internal fun FloatArray.put3(index: Int, vector: Vector3fc) {
+    val offset = index * 3
+    this[offset] = vector.x()
+    this[offset + 1] = vector.y()
+    this[offset + 2] = vector.z()
+}
+
+internal fun FloatArray.put4(index: Int, quaternion: Quaternionfc) {
+    val offset = index * 4
+    this[offset] = quaternion.x()
+    this[offset + 1] = quaternion.y()
+    this[offset + 2] = quaternion.z()
+    this[offset + 3] = quaternion.w()
+}
+
+internal fun FloatArray.get3(index: Int, dest: Vector3f): Vector3f {
+    val offset = index * 3
+    return dest.set(this[offset], this[offset + 1], this[offset + 2])
+}
+
+internal fun FloatArray.get4(index: Int, dest: Quaternionf): Quaternionf {
+    val offset = index * 4
+    return dest.set(this[offset], this[offset + 1], this[offset + 2], this[offset + 3])
+}
@@ -0,0 +1,597 @@
+package top.fifthlight.blazerod.runtime.physics
+
+import org.joml.Quaternionf
+import org.joml.Vector3f
+import org.joml.Vector3fc
+import kotlin.math.abs
+import kotlin.math.acos
+import kotlin.math.pow
+import kotlin.math.sin
+
+/**
+ * Small XPBD rigid body solver, following "Detailed Rigid Body Simulation with Extended Position Based Dynamics"
+ * (Müller et al. 2020), with one constraint iteration per substep.
+ *
+ * Like [SpringBoneSolver], it only reads [PhysicsData] and writes the given [PhysicsState], so it is deterministic for
+ * given inputs, and different instances can be stepped on different threads.
+ *
+ * Restitution and friction are ignored, and boxes collide as capsules along their longest axis.
+ */
+object PhysicsSolver {
+    const val FIXED_TIME_STEP = 1f / 60f
+    const val SUBSTEPS = 4
+    const val MAX_STEPS_PER_UPDATE = 3
+
+    // Longer gaps (instance not rendered, game paused) restart the simulation from current pose
+    const val MAX_ELAPSED_TIME = .5f
+
+    const val GRAVITY = -9.8f
+
+    private const val SLEEP_LINEAR_VELOCITY = .01f
+    private const val SLEEP_ANGULAR_VELOCITY = .05f
+    private const val SLEEP_TIME = .5f
+    private const val WAKE_DISTANCE = 1e-4f
+    private const val WAKE_ROTATION_DOT = 1f - 1e-6f
+
+    private const val EPSILON = 1e-6f
+
+    /**
+     * Accumulate elapsed time, and return how many fixed steps to run.
+     *
+     * @param elapsed elapsed time since last update, in seconds.
+     */
+    fun advance(state: PhysicsState, elapsed: Float): Int {
+        if (elapsed < 0f || elapsed > MAX_ELAPSED_TIME) {
+            state.reset()
+        }
+        if (!state.initialized) {
+            state.accumulatedTime = 0f
+            return 1
+        }
+        state.accumulatedTime += elapsed
+        val steps = (state.accumulatedTime / FIXED_TIME_STEP).toInt()
+        if (steps > MAX_STEPS_PER_UPDATE) {
+            // Drop the time we can't catch up with, instead of spiraling
+            state.accumulatedTime = 0f
+            return MAX_STEPS_PER_UPDATE
+        }
+        state.accumulatedTime -= steps * FIXED_TIME_STEP
+        return steps
+    }
+
+    private fun isKinematic(data: PhysicsData, body: Int) = data.bodyTypes[body] == PhysicsData.TYPE_KINEMATIC
+
+    private fun isAwake(state: PhysicsState, body: Int): Boolean {
+        val island = state.data.bodyIslands[body]
+        return island >= 0 && !state.islandSleeping[island]
+    }
+
+    private fun wakeIsland(state: PhysicsState, island: Int) {
+        state.islandSleeping[island] = false
+        state.islandSleepTime[island] = 0f
+    }
+
+    /**
+     * Run one fixed step. [PhysicsState.targetPositions] and [PhysicsState.targetRotations] should be filled before,
+     * for all kinematic bodies and bodies following node position.
+     */
+    fun step(state: PhysicsState, deltaTime: Float) {
+        val data = state.data
+        if (!state.initialized) {
+            state.targetPositions.copyInto(state.positions)
+            state.targetRotations.copyInto(state.rotations)
+            state.targetPositions.copyInto(state.prevPositions)
+            state.targetRotations.copyInto(state.prevRotations)
+            state.velocities.fill(0f)
+            state.angularVelocities.fill(0f)
+            state.initialized = true
+        }
+
+        // Wake islands whose kinematic bodies are moved
+        for (island in 0 until data.islandCount) {
+            if (!state.islandSleeping[island]) {
+                continue
+            }
+            for (i in data.islandKinematicOffsets[island] until data.islandKinematicOffsets[island + 1]) {
+                if (kinematicMoved(state, data.islandKinematics[i])) {
+                    wakeIsland(state, island)
+                    break
+                }
+            }
+        }
+
+        state.positions.copyInto(state.startPositions)
+        state.rotations.copyInto(state.startRotations)
+
+        val substepTime = deltaTime / SUBSTEPS
+        for (substep in 1..SUBSTEPS) {
+            val progress = substep.toFloat() / SUBSTEPS
+            for (body in 0 until data.bodyCount) {
+                if (isKinematic(data, body)) {
+                    moveKinematic(state, body, progress)
+                } else if (isAwake(state, body)) {
+                    integrate(state, body, substepTime)
+                }
+            }
+            for (joint in 0 until data.jointCount) {
+                val a = data.jointBodyA[joint]
+                val b = data.jointBodyB[joint]
+                if (isAwake(state, a) || isAwake(state, b)) {
+                    solveJoint(state, joint, substepTime)
+                }
+            }
+            val pairs = data.collisionPairs
+            for (i in 0 until pairs.size / 2) {
+                solveCollision(state, pairs[i * 2], pairs[i * 2 + 1], substepTime)
+            }
+            for (body in 0 until data.bodyCount) {
+                if (isAwake(state, body)) {
+                    updateVelocity(state, body, substepTime)
+                }
+            }
+        }
+
+        // Put back to node position, only rotation is driven by physics
+        for (body in 0 until data.bodyCount) {
+            if (data.bodyTypes[body] == PhysicsData.TYPE_DYNAMIC_WITH_NODE_POSITION) {
+                val offset = body * 3
+                state.positions[offset] = state.targetPositions[offset]
+                state.positions[offset + 1] = state.targetPositions[offset + 1]
+                state.positions[offset + 2] = state.targetPositions[offset + 2]
+            }
+        }
+
+        updateSleeping(state, deltaTime)
+    }
+
+    private fun kinematicMoved(state: PhysicsState, body: Int): Boolean {
+        val position = state.positions.get3(body, state.cachePositionA)
+        val target = state.targetPositions.get3(body, state.cachePositionB)
+        if (position.distanceSquared(target) > WAKE_DISTANCE * WAKE_DISTANCE) {
+            return true
+        }
+        val rotation = state.rotations.get4(body, state.cacheRotationA)
+        val targetRotation = state.targetRotations.get4(body, state.cacheRotationB)
+        return abs(rotation.dot(targetRotation)) < WAKE_ROTATION_DOT
+    }
+
+    private fun moveKinematic(state: PhysicsState, body: Int, progress: Float) {
+        val start = state.startPositions.get3(body, state.cachePositionA)
+        val target = state.targetPositions.get3(body, state.cachePositionB)
+        state.positions.put3(body, start.lerp(target, progress))
+        val startRotation = state.startRotations.get4(body, state.cacheRotationA)
+        val targetRotation = state.targetRotations.get4(body, state.cacheRotationB)
+        state.rotations.put4(body, startRotation.slerp(targetRotation, progress))
+    }
+
+    private fun integrate(state: PhysicsState, body: Int, time: Float) {
+        val data = state.data
+        val offset = body * 3
+        val positions = state.positions
+        val velocities = state.velocities
+        val angularVelocities = state.angularVelocities
+
+        state.positions.copyInto(state.prevPositions, offset, offset, offset + 3)
+        state.rotations.copyInto(state.prevRotations, body * 4, body * 4, body * 4 + 4)
+
+        val linearDamping = (1f - data.bodyLinearDamping[body]).pow(time)
+        velocities[offset + 1] += GRAVITY * time
+        for (i in 0 until 3) {
+            velocities[offset + i] *= linearDamping
+            positions[offset + i] += velocities[offset + i] * time
+        }
+
+        val angularDamping = (1f - data.bodyAngularDamping[body]).pow(time)
+        for (i in 0 until 3) {
+            angularVelocities[offset + i] *= angularDamping
+        }
+        addRotation(
+            state = state,
+            body = body,
+            x = angularVelocities[offset] * time,
+            y = angularVelocities[offset + 1] * time,
+            z = angularVelocities[offset + 2] * time,
+        )
+    }
+
+    private fun updateVelocity(state: PhysicsState, body: Int, time: Float) {
+        val offset = body * 3
+        for (i in 0 until 3) {
+            state.velocities[offset + i] = (state.positions[offset + i] - state.prevPositions[offset + i]) / time
+        }
+        val rotation = state.rotations.get4(body, state.cacheRotationA)
+        val prevRotation = state.prevRotations.get4(body, state.cacheRotationB)
+        val delta = rotation.mul(prevRotation.conjugate())
+        val sign = if (delta.w < 0f) -2f else 2f
+        state.angularVelocities[offset] = delta.x * sign / time
+        state.angularVelocities[offset + 1] = delta.y * sign / time
+        state.angularVelocities[offset + 2] = delta.z * sign / time
+    }
+
+    private fun updateSleeping(state: PhysicsState, deltaTime: Float) {
+        val data = state.data
+        for (island in 0 until data.islandCount) {
+            if (state.islandSleeping[island]) {
+                continue
+            }
+            var resting = true
+            for (i in data.islandBodyOffsets[island] until data.islandBodyOffsets[island + 1]) {
+                val body = data.islandBodies[i]
+                val offset = body * 3
+                val linear = state.velocities.let {
+                    it[offset] * it[offset] + it[offset + 1] * it[offset + 1] + it[offset + 2] * it[offset + 2]
+                }
+                val angular = state.angularVelocities.let {
+                    it[offset] * it[offset] + it[offset + 1] * it[offset + 1] + it[offset + 2] * it[offset + 2]
+                }
+                if (linear > SLEEP_LINEAR_VELOCITY * SLEEP_LINEAR_VELOCITY ||
+                    angular > SLEEP_ANGULAR_VELOCITY * SLEEP_ANGULAR_VELOCITY
+                ) {
+                    resting = false
+                    break
+                }
+            }
+            if (!resting) {
+                state.islandSleepTime[island] = 0f
+                continue
+            }
+            state.islandSleepTime[island] += deltaTime
+            if (state.islandSleepTime[island] >= SLEEP_TIME) {
+                state.islandSleeping[island] = true
+                for (i in data.islandBodyOffsets[island] until data.islandBodyOffsets[island + 1]) {
+                    val offset = data.islandBodies[i] * 3
+                    state.velocities.fill(0f, offset, offset + 3)
+                    state.angularVelocities.fill(0f, offset, offset + 3)
+                }
+            }
+        }
+    }
+
+    // q += 0.5 * (x, y, z, 0) * q, in world space
+    private fun addRotation(state: PhysicsState, body: Int, x: Float, y: Float, z: Float) {
+        val offset = body * 4
+        val rotations = state.rotations
+        val qx = rotations[offset]
+        val qy = rotations[offset + 1]
+        val qz = rotations[offset + 2]
+        val qw = rotations[offset + 3]
+        val rotation = state.helperRotation.set(
+            qx + .5f * (qw * x + y * qz - z * qy),
+            qy + .5f * (qw * y + z * qx - x * qz),
+            qz + .5f * (qw * z + x * qy - y * qx),
+            qw + .5f * -(x * qx + y * qy + z * qz),
+        ).normalize()
+        rotations.put4(body, rotation)
+    }
+
+    // Multiply the vector with world space inverse inertia tensor of the body
+    private fun applyInverseInertia(state: PhysicsState, body: Int, vector: Vector3f): Vector3f {
+        val data = state.data
+        if (isKinematic(data, body)) {
+            return vector.zero()
+        }
+        val rotation = state.rotations.get4(body, state.helperRotation)
+        rotation.transformInverse(vector)
+        val offset = body * 3
+        vector.mul(
+            data.bodyInverseInertia[offset],
+            data.bodyInverseInertia[offset + 1],
+            data.bodyInverseInertia[offset + 2],
+        )
+        return rotation.transform(vector)
+    }
+
+    private fun positionalInverseMass(state: PhysicsState, body: Int, arm: Vector3fc, normal: Vector3fc): Float {
+        if (isKinematic(state.data, body)) {
+            return 0f
+        }
+        val cross = arm.cross(normal, state.helperVector2)
+        val inertia = applyInverseInertia(state, body, state.helperVector.set(cross))
+        return state.data.bodyInverseMass[body] + cross.dot(inertia)
+    }
+
+    private fun angularInverseMass(state: PhysicsState, body: Int, normal: Vector3fc): Float {
+        if (isKinematic(state.data, body)) {
+            return 0f
+        }
+        return normal.dot(applyInverseInertia(state, body, state.helperVector.set(normal)))
+    }
+
+    private fun applyPositionalImpulse(
+        state: PhysicsState,
+        body: Int,
+        arm: Vector3fc,
+        impulse: Vector3fc,
+        sign: Float,
+    ) {
+        val data = state.data
+        if (isKinematic(data, body)) {
+            return
+        }
+        val offset = body * 3
+        val inverseMass = data.bodyInverseMass[body] * sign
+        state.positions[offset] += impulse.x() * inverseMass
+        state.positions[offset + 1] += impulse.y() * inverseMass
+        state.positions[offset + 2] += impulse.z() * inverseMass
+        val rotation = applyInverseInertia(state, body, arm.cross(impulse, state.helperVector2))
+        addRotation(state, body, rotation.x * sign, rotation.y * sign, rotation.z * sign)
+    }
+
+    private fun applyAngularImpulse(state: PhysicsState, body: Int, impulse: Vector3fc, sign: Float) {
+        if (isKinematic(state.data, body)) {
+            return
+        }
+        val rotation = applyInverseInertia(state, body, state.helperVector2.set(impulse))
+        addRotation(state, body, rotation.x * sign, rotation.y * sign, rotation.z * sign)
+    }
+
+    /**
+     * Move body A by [correction], and body B by -[correction] at the given arms, weighted by their inverse masses.
+     */
+    private fun applyPositionalCorrection(
+        state: PhysicsState,
+        a: Int,
+        b: Int,
+        armA: Vector3fc,
+        armB: Vector3fc,
+        correction: Vector3f,
+        compliance: Float,
+        time: Float,
+    ) {
+        val length = correction.length()
+        if (length < EPSILON) {
+            return
+        }
+        val normal = correction.div(length)
+        val inverseMass = positionalInverseMass(state, a, armA, normal) + positionalInverseMass(state, b, armB, normal)
+        val alpha = compliance / (time * time)
+        if (inverseMass + alpha < EPSILON) {
+            return
+        }
+        val impulse = normal.mul(length / (inverseMass + alpha))
+        applyPositionalImpulse(state, a, armA, impulse, 1f)
+        applyPositionalImpulse(state, b, armB, impulse, -1f)
+    }
+
+    /**
+     * Rotate body B by [correction] (as rotation vector in world space), and body A by -[correction], weighted by
+     * their inverse inertia.
+     */
+    private fun applyAngularCorrection(
+        state: PhysicsState,
+        a: Int,
+        b: Int,
+        correction: Vector3f,
+        compliance: Float,
+        time: Float,
+    ) {
+        val angle = correction.length()
+        if (angle < EPSILON) {
+            return
+        }
+        val normal = correction.div(angle)
+        val inverseMass = angularInverseMass(state, a, normal) + angularInverseMass(state, b, normal)
+        val alpha = compliance / (time * time)
+        if (inverseMass + alpha < EPSILON) {
+            return
+        }
+        val impulse = normal.mul(angle / (inverseMass + alpha))
+        applyAngularImpulse(state, a, impulse, -1f)
+        applyAngularImpulse(state, b, impulse, 1f)
+    }
+
+    // Load world space anchor and rotation of the joint frame attached to the body
+    private fun loadJointFrame(
+        state: PhysicsState,
+        joint: Int,
+        body: Int,
+        framePositions: FloatArray,
+        frameRotations: FloatArray,
+        anchor: Vector3f,
+        frameRotation: Quaternionf,
+    ) {
+        val rotation = state.rotations.get4(body, state.cacheRotation)
+        rotation.transform(framePositions.get3(joint, anchor)).add(
+            state.positions[body * 3],
+            state.positions[body * 3 + 1],
+            state.positions[body * 3 + 2],
+        )
+        rotation.mul(frameRotations.get4(joint, frameRotation), frameRotation)
+    }
+
+    private fun solveJoint(state: PhysicsState, joint: Int, time: Float) {
+        val data = state.data
+        val a = data.jointBodyA[joint]
+        val b = data.jointBodyB[joint]
+        val anchorA = state.cachePositionA
+        val anchorB = state.cachePositionB
+        val frameRotationA = state.cacheRotationA
+        val frameRotationB = state.cacheRotationB
+        val vector = state.cacheVector
+        val offset = joint * 3
+
+        fun loadFrameA() = loadJointFrame(
+            state = state,
+            joint = joint,
+            body = a,
+            framePositions = data.jointFramePositionsA,
+            frameRotations = data.jointFrameRotationsA,
+            anchor = anchorA,
+            frameRotation = frameRotationA,
+        )
+
+        fun loadFrameB() = loadJointFrame(
+            state = state,
+            joint = joint,
+            body = b,
+            framePositions = data.jointFramePositionsB,
+            frameRotations = data.jointFrameRotationsB,
+            anchor = anchorB,
+            frameRotation = frameRotationB,
+        )
+
+        // Angular limits, on XYZ euler angles of B relative to A
+        loadFrameA()
+        loadFrameB()
+        val relative = frameRotationA.conjugate(state.cacheRotation2).mul(frameRotationB)
+        val angles = relative.getEulerAnglesXYZ(state.cacheVector2)
+        val clamped = state.cacheVector3.set(angles)
+        for (i in 0 until 3) {
+            val min = data.jointRotationMin[offset + i]
+            val max = data.jointRotationMax[offset + i]
+            if (min <= max) {
+                clamped.setComponent(i, clamped.get(i).coerceIn(min, max))
+            }
+        }
+        if (!clamped.equals(angles, EPSILON)) {
+            // Rotation from current relative rotation to the limited one, in frame A
+            val target = state.cacheRotation.rotationXYZ(clamped.x, clamped.y, clamped.z)
+            val delta = target.mul(relative.conjugate())
+            if (delta.w < 0f) {
+                delta.set(-delta.x, -delta.y, -delta.z, -delta.w)
+            }
+            val halfAngle = acos(delta.w.coerceIn(-1f, 1f))
+            val sinHalfAngle = sin(halfAngle)
+            if (sinHalfAngle > EPSILON) {
+                vector.set(delta.x, delta.y, delta.z).mul(2f * halfAngle / sinHalfAngle)
+                frameRotationA.transform(vector)
+                applyAngularCorrection(state, a, b, vector, 0f, time)
+            }
+        }
+
+        // Angular springs, pulling back to rest rotation
+        for (i in 0 until 3) {
+            val stiffness = data.jointRotationStiffness[offset + i]
+            val angle = clamped.get(i)
+            if (stiffness <= 0f || abs(angle) < EPSILON) {
+                continue
+            }
+            loadFrameA()
+            vector.zero().setComponent(i, -angle)
+            frameRotationA.transform(vector)
+            applyAngularCorrection(state, a, b, vector, 1f / stiffness, time)
+        }
+
+        // Linear limits, on position of B's anchor in frame A
+        loadFrameA()
+        loadFrameB()
+        val local = frameRotationA.transformInverse(anchorB.sub(anchorA, state.cacheVector2))
+        val target = state.cacheVector3.set(local)
+        for (i in 0 until 3) {
+            val min = data.jointPositionMin[offset + i]
+            val max = data.jointPositionMax[offset + i]
+            if (min <= max) {
+                target.setComponent(i, target.get(i).coerceIn(min, max))
+            }
+        }
+        val armA = anchorA.sub(state.positions[a * 3], state.positions[a * 3 + 1], state.positions[a * 3 + 2])
+        val armB = anchorB.sub(state.positions[b * 3], state.positions[b * 3 + 1], state.positions[b * 3 + 2])
+        applyPositionalCorrection(
+            state = state,
+            a = a,
+            b = b,
+            armA = armA,
+            armB = armB,
+            correction = frameRotationA.transform(local.sub(target, vector)),
+            compliance = 0f,
+            time = time,
+        )
+
+        // Linear springs, pulling back to rest position
+        for (i in 0 until 3) {
+            val stiffness = data.jointPositionStiffness[offset + i]
+            val distance = target.get(i)
+            if (stiffness <= 0f || abs(distance) < EPSILON) {
+                continue
+            }
+            loadFrameA()
+            loadFrameB()
+            anchorA.sub(state.positions[a * 3], state.positions[a * 3 + 1], state.positions[a * 3 + 2])
+            anchorB.sub(state.positions[b * 3], state.positions[b * 3 + 1], state.positions[b * 3 + 2])
+            vector.zero().setComponent(i, distance)
+            frameRotationA.transform(vector)
+            applyPositionalCorrection(state, a, b, anchorA, anchorB, vector, 1f / stiffness, time)
+        }
+    }
+
+    private fun solveCollision(state: PhysicsState, a: Int, b: Int, time: Float) {
+        val awakeA = isAwake(state, a)
+        val awakeB = isAwake(state, b)
+        if (!awakeA && !awakeB) {
+            return
+        }
+        val data = state.data
+
+        // Segment of A: centerA +- halfA
+        val centerA = state.positions.get3(a, state.cachePositionA)
+        val halfA = state.rotations.get4(a, state.cacheRotationA)
+            .transform(data.bodySegments.get3(a, state.cacheVector))
+        val centerB = state.positions.get3(b, state.cachePositionB)
+        val halfB = state.rotations.get4(b, state.cacheRotationB)
+            .transform(data.bodySegments.get3(b, state.cacheVector2))
+
+        // Closest points between the two segments, as parameters in [-1, 1]
+        val rx = centerA.x - centerB.x
+        val ry = centerA.y - centerB.y
+        val rz = centerA.z - centerB.z
+        val aa = halfA.lengthSquared()
+        val bb = halfB.lengthSquared()
+        val ab = halfA.dot(halfB)
+        val ar = halfA.x * rx + halfA.y * ry + halfA.z * rz
+        val br = halfB.x * rx + halfB.y * ry + halfB.z * rz
+        var s: Float
+        var t: Float
+        if (aa < EPSILON && bb < EPSILON) {
+            s = 0f
+            t = 0f
+        } else if (aa < EPSILON) {
+            s = 0f
+            t = (br / bb).coerceIn(-1f, 1f)
+        } else if (bb < EPSILON) {
+            t = 0f
+            s = (-ar / aa).coerceIn(-1f, 1f)
+        } else {
+            val denominator = aa * bb - ab * ab
+            s = if (denominator > EPSILON) {
+                ((ab * br - bb * ar) / denominator).coerceIn(-1f, 1f)
+            } else {
+                0f
+            }
+            t = (ab * s + br) / bb
+            if (t < -1f || t > 1f) {
+                t = t.coerceIn(-1f, 1f)
+                s = ((ab * t - ar) / aa).coerceIn(-1f, 1f)
+            }
+        }
+
+        val pointA = halfA.mul(s).add(centerA)
+        val pointB = halfB.mul(t).add(centerB)
+        val normal = state.cacheVector3.set(pointB).sub(pointA)
+        val distance = normal.length()
+        val radius = data.bodyRadius[a] + data.bodyRadius[b]
+        if (distance >= radius || distance < EPSILON) {
+            return
+        }
+
+        if (!awakeA && !isKinematic(data, a)) {
+            wakeIsland(state, data.bodyIslands[a])
+        }
+        if (!awakeB && !isKinematic(data, b)) {
+            wakeIsland(state, data.bodyIslands[b])
+        }
+
+        // Arms from body centers to the contact points
+        val armA = pointA.sub(centerA, centerA)
+        val armB = pointB.sub(centerB, centerB)
+        applyPositionalCorrection(
+            state = state,
+            a = a,
+            b = b,
+            armA = armA,
+            armB = armB,
+            correction = normal.mul(-(radius - distance) / distance),
+            compliance = 0f,
+            time = time,
+        )
+    }
+}
@@ -0,0 +1,77 @@
+package top.fifthlight.blazerod.runtime.physics
+
+import org.joml.Matrix4f
+import org.joml.Quaternionf
+import org.joml.Vector3f
+
+/**
+ * Per-instance rigid body state. Every instance owns one, so instances can be stepped concurrently.
+ */
+class PhysicsState(val data: PhysicsData) {
+    val positions = FloatArray(data.bodyCount * 3)
+    val rotations = FloatArray(data.bodyCount * 4)
+    val prevPositions = FloatArray(data.bodyCount * 3)
+    val prevRotations = FloatArray(data.bodyCount * 4)
+    val velocities = FloatArray(data.bodyCount * 3)
+    val angularVelocities = FloatArray(data.bodyCount * 3)
+
+    // Pose of bodies driven by nodes, at the end of current step. Filled before stepping.
+    val targetPositions = FloatArray(data.bodyCount * 3)
+    val targetRotations = FloatArray(data.bodyCount * 4)
+
+    // Pose of kinematic bodies at the start of current step, for interpolating in substeps
+    internal val startPositions = FloatArray(data.bodyCount * 3)
+    internal val startRotations = FloatArray(data.bodyCount * 4)
+
+    val islandSleeping = BooleanArray(data.islandCount)
+    val islandSleepTime = FloatArray(data.islandCount)
+
+    // Bodies are placed at target pose on the first step after reset
+    var initialized = false
+    var accumulatedTime = 0f
+    var lastUpdateTime = -1L
+
+    // Scratch objects
+    internal val cacheMatrix = Matrix4f()
+    internal val cacheMatrix2 = Matrix4f()
+    internal val helperVector = Vector3f()
+    internal val helperVector2 = Vector3f()
+    internal val helperRotation = Quaternionf()
+    internal val cachePositionA = Vector3f()
+    internal val cachePositionB = Vector3f()
+    internal val cacheVector = Vector3f()
+    internal val cacheVector2 = Vector3f()
+    internal val cacheVector3 = Vector3f()
+    internal val cacheRotationA = Quaternionf()
+    internal val cacheRotationB = Quaternionf()
+    internal val cacheRotation = Quaternionf()
+    internal val cacheRotation2 = Quaternionf()
+
+    // Continue the simulation of other, if the rigid bodies are of the same shape
+    fun copyFrom(other: PhysicsState) {
+        if (other.data.bodyCount != data.bodyCount || other.data.islandCount != data.islandCount) {
+            return
+        }
+        other.positions.copyInto(positions)
+        other.rotations.copyInto(rotations)
+        other.prevPositions.copyInto(prevPositions)
+        other.prevRotations.copyInto(prevRotations)
+        other.velocities.copyInto(velocities)
+        other.angularVelocities.copyInto(angularVelocities)
+        other.islandSleeping.copyInto(islandSleeping)
+        other.islandSleepTime.copyInto(islandSleepTime)
+        initialized = other.initialized
+        accumulatedTime = other.accumulatedTime
+        lastUpdateTime = other.lastUpdateTime
+    }
+
+    fun reset() {
+        initialized = false
+        accumulatedTime = 0f
+        lastUpdateTime = -1L
+        velocities.fill(0f)
+        angularVelocities.fill(0f)
+        islandSleeping.fill(false)
+        islandSleepTime.fill(0f)
+    }
+}
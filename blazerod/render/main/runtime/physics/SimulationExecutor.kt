@@ -0,0 +1,33 @@
+package top.fifthlight.blazerod.runtime.physics
+
+import java.util.concurrent.CompletableFuture
+import java.util.concurrent.Executors
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * Worker threads running spring bone and physics simulations of instances, so simulations of different instances run
+ * in parallel. See ModelInstance.beginUpdateRenderData.
+ */
+object SimulationExecutor {
+    private val threadIndex = AtomicInteger()
+
+    private class WorkerThread(runnable: Runnable) : Thread(
+        runnable,
+        "BlazeRod simulation thread #${threadIndex.incrementAndGet()}",
+    ) {
+        init {
+            isDaemon = true
+        }
+    }
+
+    // Leave a core for the render thread, which joins simulations
+    private val executor = Executors.newFixedThreadPool(
+        (Runtime.getRuntime().availableProcessors() - 1).coerceIn(1, 4),
+        ::WorkerThread,
+    )
+
+    val isWorkerThread
+        get() = Thread.currentThread() is WorkerThread
+
+    fun submit(task: Runnable): CompletableFuture<Void> = CompletableFuture.runAsync(task, executor)
+}
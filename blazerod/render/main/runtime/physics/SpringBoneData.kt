@@ -0,0 +1,104 @@
+package top.fifthlight.blazerod.runtime.physics
+
+import org.joml.Vector3fc
+
+/**
+ * Scene-wide spring bone description, packed into flat arrays so the solver can walk them linearly.
+ *
+ * Joints of one spring are stored consecutively, in chain order, and springs are stored in the order they should be
+ * solved. Only joints having a tail are stored, so the last joint of a chain (which is just the tail of the previous
+ * one) is not included.
+ */
+class SpringBoneData(
+    springs: List<Spring>,
+    colliders: List<Collider>,
+) {
+    class Joint(
+        val nodeIndex: Int,
+        // Tail position in the joint's local space, usually the rest translation of the child node
+        val localTail: Vector3fc,
+        val hitRadius: Float,
+        val stiffness: Float,
+        val gravityPower: Float,
+        val gravityDir: Vector3fc,
+        val dragForce: Float,
+    )
+
+    class Spring(
+        val joints: List<Joint>,
+        val colliders: List<Int>,
+    )
+
+    class Collider(
+        val nodeIndex: Int,
+        val offset: Vector3fc,
+        // Non-null for capsule colliders
+        val tail: Vector3fc?,
+        val radius: Float,
+    )
+
+    val springCount = springs.size
+    val jointCount = springs.sumOf { it.joints.size }
+    val colliderCount = colliders.size
+
+    // Spring s owns joints in [springJointOffsets[s], springJointOffsets[s + 1])
+    val springJointOffsets = IntArray(springCount + 1)
+
+    // Spring s collides with springColliders[springColliderOffsets[s] until springColliderOffsets[s + 1]]
+    val springColliderOffsets = IntArray(springCount + 1)
+    val springColliders = IntArray(springs.sumOf { it.colliders.size })
+
+    val jointNodeIndices = IntArray(jointCount)
+    val jointLocalTails = FloatArray(jointCount * 3)
+    val jointHitRadius = FloatArray(jointCount)
+    val jointStiffness = FloatArray(jointCount)
+    val jointGravityPower = FloatArray(jointCount)
+    val jointGravityDirs = FloatArray(jointCount * 3)
+    val jointDragForce = FloatArray(jointCount)
+
+    val colliderNodeIndices = IntArray(colliderCount)
+    val colliderCapsule = BooleanArray(colliderCount)
+    val colliderOffsets = FloatArray(colliderCount * 3)
+    val colliderTails = FloatArray(colliderCount * 3)
+    val colliderRadius = FloatArray(colliderCount)
+
+    init {
+        var jointIndex = 0
+        var colliderOffset = 0
+        for ((springIndex, spring) in springs.withIndex()) {
+            springJointOffsets[springIndex] = jointIndex
+            springColliderOffsets[springIndex] = colliderOffset
+            for (joint in spring.joints) {
+                jointNodeIndices[jointIndex] = joint.nodeIndex
+                jointLocalTails.put(jointIndex, joint.localTail)
+                jointHitRadius[jointIndex] = joint.hitRadius
+                jointStiffness[jointIndex] = joint.stiffness
+                jointGravityPower[jointIndex] = joint.gravityPower
+                jointGravityDirs.put(jointIndex, joint.gravityDir)
+                jointDragForce[jointIndex] = joint.dragForce
+                jointIndex++
+            }
+            for (collider in spring.colliders) {
+                require(collider in 0 until colliderCount) { "Bad spring collider index: $collider" }
+                springColliders[colliderOffset++] = collider
+            }
+        }
+        springJointOffsets[springCount] = jointIndex
+        springColliderOffsets[springCount] = colliderOffset
+
+        for ((index, collider) in colliders.withIndex()) {
+            colliderNodeIndices[index] = collider.nodeIndex
+            colliderCapsule[index] = collider.tail != null
+            colliderOffsets.put(index, collider.offset)
+            colliderTails.put(index, collider.tail ?: collider.offset)
+            colliderRadius[index] = collider.radius
+        }
+    }
+}
+
+private fun FloatArray.put(index: Int, vector: Vector3fc) {
+    val offset = index * 3
+    this[offset] = vector.x()
+    this[offset + 1] = vector.y()
+    this[offset + 2] = vector.z()
+}
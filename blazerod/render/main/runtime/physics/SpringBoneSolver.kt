@@ -0,0 +1,213 @@
+package top.fifthlight.blazerod.runtime.physics
+
+import org.joml.Matrix4fc
+import org.joml.Quaternionf
+import kotlin.math.sqrt
+
+/**
+ * Fixed-step spring bone integrator, following the VRMC_springBone specification.
+ *
+ * The solver only reads the packed [SpringBoneData] and writes the given [SpringBoneState], it don't touch any node or
+ * GPU object, so it is deterministic for given inputs and can be run for different instances on different threads.
+ * Tails are simulated in model space.
+ */
+object SpringBoneSolver {
+    const val FIXED_TIME_STEP = 1f / 60f
+    const val MAX_STEPS_PER_UPDATE = 4
+
+    // Longer gaps (instance not rendered, game paused) restart the simulation from rest pose
+    const val MAX_ELAPSED_TIME = .5f
+
+    private const val EPSILON = 1e-6f
+
+    /**
+     * Accumulate elapsed time, and return how many fixed steps to run.
+     *
+     * @param elapsed elapsed time since last update, in seconds.
+     */
+    fun advance(state: SpringBoneState, elapsed: Float): Int {
+        if (elapsed < 0f || elapsed > MAX_ELAPSED_TIME) {
+            state.reset()
+        }
+        if (!state.initialized) {
+            state.accumulatedTime = 0f
+            return 1
+        }
+        state.accumulatedTime += elapsed
+        val steps = (state.accumulatedTime / FIXED_TIME_STEP).toInt()
+        if (steps > MAX_STEPS_PER_UPDATE) {
+            // Drop the time we can't catch up with, instead of spiraling
+            state.accumulatedTime = 0f
+            return MAX_STEPS_PER_UPDATE
+        }
+        state.accumulatedTime -= steps * FIXED_TIME_STEP
+        return steps
+    }
+
+    /**
+     * Update world space shape of one collider.
+     *
+     * @param world world transform of the collider's node.
+     */
+    fun updateCollider(state: SpringBoneState, colliderIndex: Int, world: Matrix4fc) {
+        val data = state.data
+        val offset = colliderIndex * 3
+        val vector = state.cacheVector
+
+        world.transformPosition(
+            data.colliderOffsets[offset],
+            data.colliderOffsets[offset + 1],
+            data.colliderOffsets[offset + 2],
+            vector,
+        )
+        state.colliderHeads[offset] = vector.x
+        state.colliderHeads[offset + 1] = vector.y
+        state.colliderHeads[offset + 2] = vector.z
+
+        world.transformPosition(
+            data.colliderTails[offset],
+            data.colliderTails[offset + 1],
+            data.colliderTails[offset + 2],
+            vector,
+        )
+        state.colliderTails[offset] = vector.x
+        state.colliderTails[offset + 1] = vector.y
+        state.colliderTails[offset + 2] = vector.z
+
+        world.getScale(vector)
+        state.colliderRadius[colliderIndex] = data.colliderRadius[colliderIndex] * vector.x
+    }
+
+    /**
+     * Simulate the tail of one joint, and compute the rotation to apply on the joint.
+     *
+     * @param jointWorld world transform of the joint, without the physics rotation.
+     * @param dest receive the rotation to be applied after the joint's local transform.
+     */
+    fun updateJoint(
+        state: SpringBoneState,
+        springIndex: Int,
+        jointIndex: Int,
+        jointWorld: Matrix4fc,
+        deltaTime: Float,
+        dest: Quaternionf,
+    ): Quaternionf {
+        val data = state.data
+        val offset = jointIndex * 3
+        val current = state.currentTails
+        val prev = state.prevTails
+        val vector = state.cacheVector
+
+        val localTailX = data.jointLocalTails[offset]
+        val localTailY = data.jointLocalTails[offset + 1]
+        val localTailZ = data.jointLocalTails[offset + 2]
+
+        val headX = jointWorld.m30()
+        val headY = jointWorld.m31()
+        val headZ = jointWorld.m32()
+        jointWorld.transformPosition(localTailX, localTailY, localTailZ, vector)
+        var axisX = vector.x - headX
+        var axisY = vector.y - headY
+        var axisZ = vector.z - headZ
+        val length = sqrt(axisX * axisX + axisY * axisY + axisZ * axisZ)
+        if (length < EPSILON) {
+            return dest.identity()
+        }
+        axisX /= length
+        axisY /= length
+        axisZ /= length
+
+        if (!state.initialized) {
+            current[offset] = vector.x
+            current[offset + 1] = vector.y
+            current[offset + 2] = vector.z
+            prev[offset] = vector.x
+            prev[offset + 1] = vector.y
+            prev[offset + 2] = vector.z
+        }
+
+        // Verlet integration with drag, stiffness toward rest direction and gravity
+        val inertia = 1f - data.jointDragForce[jointIndex]
+        val stiffness = data.jointStiffness[jointIndex] * deltaTime
+        val gravity = data.jointGravityPower[jointIndex] * deltaTime
+        var nextX = current[offset] + (current[offset] - prev[offset]) * inertia +
+                axisX * stiffness + data.jointGravityDirs[offset] * gravity
+        var nextY = current[offset + 1] + (current[offset + 1] - prev[offset + 1]) * inertia +
+                axisY * stiffness + data.jointGravityDirs[offset + 1] * gravity
+        var nextZ = current[offset + 2] + (current[offset + 2] - prev[offset + 2]) * inertia +
+                axisZ * stiffness + data.jointGravityDirs[offset + 2] * gravity
+
+        // Keep bone length
+        run {
+            val dx = nextX - headX
+            val dy = nextY - headY
+            val dz = nextZ - headZ
+            val distance = sqrt(dx * dx + dy * dy + dz * dz)
+            if (distance < EPSILON) {
+                nextX = headX + axisX * length
+                nextY = headY + axisY * length
+                nextZ = headZ + axisZ * length
+            } else {
+                val scale = length / distance
+                nextX = headX + dx * scale
+                nextY = headY + dy * scale
+                nextZ = headZ + dz * scale
+            }
+        }
+
+        // Push the tail out of colliders
+        val hitRadius = data.jointHitRadius[jointIndex]
+        for (i in data.springColliderOffsets[springIndex] until data.springColliderOffsets[springIndex + 1]) {
+            val collider = data.springColliders[i]
+            val colliderOffset = collider * 3
+            var closestX = state.colliderHeads[colliderOffset]
+            var closestY = state.colliderHeads[colliderOffset + 1]
+            var closestZ = state.colliderHeads[colliderOffset + 2]
+            if (data.colliderCapsule[collider]) {
+                val segmentX = state.colliderTails[colliderOffset] - closestX
+                val segmentY = state.colliderTails[colliderOffset + 1] - closestY
+                val segmentZ = state.colliderTails[colliderOffset + 2] - closestZ
+                val segmentLengthSquared = segmentX * segmentX + segmentY * segmentY + segmentZ * segmentZ
+                if (segmentLengthSquared > EPSILON) {
+                    val t = (((nextX - closestX) * segmentX + (nextY - closestY) * segmentY +
+                            (nextZ - closestZ) * segmentZ) / segmentLengthSquared).coerceIn(0f, 1f)
+                    closestX += segmentX * t
+                    closestY += segmentY * t
+                    closestZ += segmentZ * t
+                }
+            }
+            val radius = state.colliderRadius[collider] + hitRadius
+            val dx = nextX - closestX
+            val dy = nextY - closestY
+            val dz = nextZ - closestZ
+            val distanceSquared = dx * dx + dy * dy + dz * dz
+            if (distanceSquared >= radius * radius || distanceSquared < EPSILON) {
+                continue
+            }
+            val pushScale = radius / sqrt(distanceSquared)
+            val pushedX = closestX + dx * pushScale - headX
+            val pushedY = closestY + dy * pushScale - headY
+            val pushedZ = closestZ + dz * pushScale - headZ
+            val pushedLength = sqrt(pushedX * pushedX + pushedY * pushedY + pushedZ * pushedZ)
+            if (pushedLength < EPSILON) {
+                continue
+            }
+            nextX = headX + pushedX / pushedLength * length
+            nextY = headY + pushedY / pushedLength * length
+            nextZ = headZ + pushedZ / pushedLength * length
+        }
+
+        prev[offset] = current[offset]
+        prev[offset + 1] = current[offset + 1]
+        prev[offset + 2] = current[offset + 2]
+        current[offset] = nextX
+        current[offset + 1] = nextY
+        current[offset + 2] = nextZ
+
+        // Rotate the rest tail direction to the simulated one, in joint's local space
+        val jointRotation = jointWorld.getNormalizedRotation(state.jointRotation)
+        vector.set(nextX - headX, nextY - headY, nextZ - headZ)
+        jointRotation.transformInverse(vector)
+        return dest.rotationTo(localTailX, localTailY, localTailZ, vector.x, vector.y, vector.z)
+    }
+}
@@ -0,0 +1,46 @@
+package top.fifthlight.blazerod.runtime.physics
+
+import org.joml.Matrix4f
+import org.joml.Quaternionf
+import org.joml.Vector3f
+
+/**
+ * Per-instance spring bone state. Every instance owns one, so instances can be stepped concurrently.
+ */
+class SpringBoneState(val data: SpringBoneData) {
+    val currentTails = FloatArray(data.jointCount * 3)
+    val prevTails = FloatArray(data.jointCount * 3)
+
+    val colliderHeads = FloatArray(data.colliderCount * 3)
+    val colliderTails = FloatArray(data.colliderCount * 3)
+    val colliderRadius = FloatArray(data.colliderCount)
+
+    // Tails are placed at rest position on the first step after reset
+    var initialized = false
+    var accumulatedTime = 0f
+    var lastUpdateTime = -1L
+
+    // Scratch objects for the solver
+    internal val jointMatrix = Matrix4f()
+    internal val jointRotation = Quaternionf()
+    internal val cacheRotation = Quaternionf()
+    internal val cacheVector = Vector3f()
+
+    // Continue the simulation of other, if the springs are of the same shape
+    fun copyFrom(other: SpringBoneState) {
+        if (other.data.jointCount != data.jointCount || other.data.colliderCount != data.colliderCount) {
+            return
+        }
+        other.currentTails.copyInto(currentTails)
+        other.prevTails.copyInto(prevTails)
+        initialized = other.initialized
+        accumulatedTime = other.accumulatedTime
+        lastUpdateTime = other.lastUpdateTime
+    }
+
+    fun reset() {
+        initialized = false
+        accumulatedTime = 0f
+        lastUpdateTime = -1L
+    }
+}
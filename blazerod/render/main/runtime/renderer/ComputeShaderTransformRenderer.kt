@@ -19,6 +19,7 @@ import org.joml.Vector4f
 import top.fifthlight.blazerod.BlazeRod
 import top.fifthlight.blazerod.api.render.Renderer
 import top.fifthlight.blazerod.api.resource.RenderTask
+import top.fifthlight.blazerod.debug.FrameProfiler
 import top.fifthlight.blazerod.extension.*
 import top.fifthlight.blazerod.model.toVector4f
 import top.fifthlight.blazerod.render.BlazerodVertexFormats
@@ -71,10 +72,11 @@ class ComputeShaderTransformRenderer private constructor() :
         constructor(
             material: RenderMaterial<*>,
             irisVertexFormat: Boolean,
+            morphed: Boolean,
         ) : this(
             skinned = material.skinned,
             irisVertexFormat = irisVertexFormat,
-            morphed = material.morphed
+            morphed = morphed
         )
 
         val skinned
@@ -131,10 +133,13 @@ class ComputeShaderTransformRenderer private constructor() :
 
         private val pipelineCache = mutableMapOf<RenderMaterial.Descriptor, Int2ReferenceMap<ComputePipeline>>()
 
-        private fun getPipeline(material: RenderMaterial<*>, irisVertexFormat: Boolean): ComputePipeline {
+        // Primitives with streaming morph targets are transformed unmorphed until the targets are attached
+        private fun getPipeline(primitive: RenderPrimitive, irisVertexFormat: Boolean): ComputePipeline {
+            val material = primitive.material
             val pipelineInfo = PipelineInfo(
                 material = material,
                 irisVertexFormat = irisVertexFormat,
+                morphed = material.morphed && !primitive.morphPending,
             )
             val materialMap = pipelineCache.getOrPut(material.descriptor) { Int2ReferenceAVLTreeMap() }
             return materialMap.getOrPut(pipelineInfo.bitmap.inner) {
@@ -175,8 +180,9 @@ class ComputeShaderTransformRenderer private constructor() :
     override val type: Type
         get() = Type
 
-    private val dataPool = GpuShaderDataPool.ofSsbo()
+    private val dataPool = GpuShaderDataPool.ofSsbo("compute_transform_data")
     private val vertexDataPool = GpuShaderDataPool.create(
+        name = "compute_transform_vertex",
         usage = GpuBuffer.USAGE_VERTEX,
         extraUsage = GpuBufferExt.EXTRA_USAGE_STORAGE_BUFFER,
         alignment = RenderSystem.getDevice().ssboOffsetAlignment,
@@ -234,7 +240,7 @@ class ComputeShaderTransformRenderer private constructor() :
             }
 
             val pipeline = getPipeline(
-                material = material,
+                primitive = primitive,
                 irisVertexFormat = irisVertexFormat,
             )
 
@@ -381,7 +387,9 @@ class ComputeShaderTransformRenderer private constructor() :
                 primitive = primitive,
                 task = task,
                 skinBuffer = primitiveComponent.skinIndex?.let { task.skinBuffer[it] }?.content,
-                targetBuffer = primitiveComponent.morphedPrimitiveIndex?.let { task.morphTargetBuffer[it] }?.content,
+                targetBuffer = primitiveComponent.morphedPrimitiveIndex
+                    ?.takeIf { !primitive.morphPending }
+                    ?.let { task.morphTargetBuffer[it] }?.content,
                 targetVertexFormat = targetVertexFormat,
                 irisVertexFormat = irisVertexFormat,
                 modelNormalMatrix = modelNormalMatrix,
@@ -402,6 +410,13 @@ class ComputeShaderTransformRenderer private constructor() :
     override fun executeTasks(
         colorFrameBuffer: GpuTextureView,
         depthFrameBuffer: GpuTextureView?,
+    ) = FrameProfiler.span("executeTasks") {
+        executeComputeTasks(colorFrameBuffer, depthFrameBuffer)
+    }
+
+    private fun executeComputeTasks(
+        colorFrameBuffer: GpuTextureView,
+        depthFrameBuffer: GpuTextureView?,
     ) {
         if (computeItems.isEmpty()) {
             return
@@ -465,6 +480,7 @@ class ComputeShaderTransformRenderer private constructor() :
                     setVertexFormat(item.vertexFormat)
                     setVertexFormatMode(primitive.vertexFormatMode)
                     setVertexBuffer(0, item.vertexBuffer.buffer())
+                    DRAW_CALLS.increment()
                     primitive.indexBuffer?.let { indices ->
                         setIndexBuffer(indices)
                         drawIndexed(0, 0, indices.length, 1)
@@ -556,6 +572,7 @@ class ComputeShaderTransformRenderer private constructor() :
                 setVertexFormat(targetVertexFormat)
                 setVertexFormatMode(primitive.vertexFormatMode)
                 setVertexBuffer(0, vertexBuffer.buffer())
+                DRAW_CALLS.increment()
                 primitive.indexBuffer?.let { indices ->
                     setIndexBuffer(indices)
                     drawIndexed(0, 0, indices.length, 1)
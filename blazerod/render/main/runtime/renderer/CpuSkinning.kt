@@ -0,0 +1,40 @@
+package top.fifthlight.blazerod.runtime.renderer
+
+import org.joml.Matrix4f
+import org.joml.Vector3f
+import org.joml.Vector3fc
+import top.fifthlight.blazerod.runtime.data.RenderSkinBuffer
+import java.nio.ByteBuffer
+
+/**
+ * Skin a vertex position by its four joints and weights, read from [vertexBuffer] at [jointOffset] and [weightOffset].
+ * Weights near zero and joints not in [skinBuffer] are skipped. [skinMatrix] and [jointPosition] are scratch objects,
+ * so the per-vertex loop doesn't allocate.
+ */
+fun skinPosition(
+    position: Vector3fc,
+    vertexBuffer: ByteBuffer,
+    jointOffset: Int,
+    weightOffset: Int,
+    skinBuffer: RenderSkinBuffer,
+    skinMatrix: Matrix4f,
+    jointPosition: Vector3f,
+    result: Vector3f,
+): Vector3f {
+    result.set(0f)
+    for (index in (0 until 4)) {
+        val weight = vertexBuffer.getFloat(weightOffset + index * 4)
+        if (weight < 1E-6) {
+            continue
+        }
+        val joint = vertexBuffer.getShort(jointOffset + index * 2).toUShort().toInt()
+        if (joint in (0 until skinBuffer.jointSize)) {
+            skinBuffer.getPositionMatrix(joint, skinMatrix)
+        } else {
+            continue
+        }
+        position.mulPosition(skinMatrix, jointPosition)
+        jointPosition.mulAdd(weight, result, result)
+    }
+    return result
+}
@@ -59,6 +59,7 @@ class CpuTransformRenderer private constructor() :
         get() = Type
 
     private val dataPool = GpuShaderDataPool.create(
+        name = "cpu_transform_vertex",
         usage = GpuBuffer.USAGE_VERTEX,
         extraUsage = 0,
         alignment = 0,
@@ -148,24 +149,16 @@ class CpuTransformRenderer private constructor() :
                                 }
                             }
                             if (sourceJointOffset != null && sourceWeightOffset != null && skinBuffer != null) {
-                                skinnedPosition.set(0f)
-                                for (index in (0 until 4)) {
-                                    val weight =
-                                        sourceVertexBuffer.getFloat(sourceOffset + sourceWeightOffset + index * 4)
-                                    if (weight < 1E-6) {
-                                        continue
-                                    }
-                                    val joint =
-                                        sourceVertexBuffer.getShort(sourceOffset + sourceJointOffset + index * 2)
-                                            .toUShort().toInt()
-                                    if (joint in (0 until skinBuffer.jointSize)) {
-                                        skinBuffer.getPositionMatrix(joint, skinMatrix)
-                                    } else {
-                                        continue
-                                    }
-                                    positionVector.mulPosition(skinMatrix, jointPosition)
-                                    jointPosition.mulAdd(weight, skinnedPosition, skinnedPosition)
-                                }
+                                skinPosition(
+                                    position = positionVector,
+                                    vertexBuffer = sourceVertexBuffer,
+                                    jointOffset = sourceOffset + sourceJointOffset,
+                                    weightOffset = sourceOffset + sourceWeightOffset,
+                                    skinBuffer = skinBuffer,
+                                    skinMatrix = skinMatrix,
+                                    jointPosition = jointPosition,
+                                    result = skinnedPosition,
+                                )
                                 positionVector.set(skinnedPosition)
                             }
                             positionVector.get(targetOffset + targetPositionOffset, transformedBuffer)
@@ -347,6 +340,7 @@ class CpuTransformRenderer private constructor() :
 
                 setVertexFormatMode(primitive.vertexFormatMode)
                 setVertexBuffer(0, vertexBuffer.buffer())
+                DRAW_CALLS.increment()
                 primitive.indexBuffer?.let { indices ->
                     setIndexBuffer(indices)
                     drawIndexed(0, 0, indices.length, 1)
@@ -6,6 +6,8 @@ import top.fifthlight.blazerod.api.render.RendererTypeHolder
 import top.fifthlight.blazerod.api.render.ScheduledRenderer
 import top.fifthlight.blazerod.api.resource.RenderScene
 import top.fifthlight.blazerod.api.resource.RenderTask
+import top.fifthlight.blazerod.debug.FrameProfiler
+import top.fifthlight.blazerod.debug.Metrics
 import top.fifthlight.blazerod.runtime.RenderSceneImpl
 import top.fifthlight.blazerod.runtime.RenderTaskImpl
 import top.fifthlight.blazerod.runtime.TaskMap
@@ -23,7 +25,7 @@ abstract class RendererImpl<R : RendererImpl<R, T>, T : Renderer.Type<R, T>> : R
         depthFrameBuffer: GpuTextureView?,
         task: RenderTask,
         scene: RenderScene,
-    ) {
+    ) = FrameProfiler.span("render") {
         val instance = (task as RenderTaskImpl).instance
         val scene = (scene as RenderSceneImpl)
         for (component in scene.primitiveComponents) {
@@ -38,7 +40,7 @@ abstract class RendererImpl<R : RendererImpl<R, T>, T : Renderer.Type<R, T>> : R
                     (instance.modelData.skinBuffers.getOrNull(it)?.content
                         ?: error("Has skin but no skin buffer"))
                 },
-                targetBuffer = component.morphedPrimitiveIndex?.let {
+                targetBuffer = component.morphedPrimitiveIndex?.takeIf { !component.primitive.morphPending }?.let {
                     (instance.modelData.targetBuffers.getOrNull(it)?.content
                         ?: error("Has morph target but no morph target buffer"))
                 },
@@ -58,6 +60,8 @@ abstract class RendererImpl<R : RendererImpl<R, T>, T : Renderer.Type<R, T>> : R
     )
 
     companion object {
+        internal val DRAW_CALLS = Metrics.counter("render.draw_calls")
+
         @JvmStatic
         @ActualConstructor
         fun createVertexShaderTransform() = VertexShaderTransformRenderer.create()
@@ -102,28 +106,29 @@ abstract class TaskMapScheduledRenderer<R, T : Renderer.Type<R, T>> :
 
     override fun schedule(task: RenderTask) = taskMap.addTask(task as RenderTaskImpl)
 
-    override fun executeTasks(colorFrameBuffer: GpuTextureView, depthFrameBuffer: GpuTextureView?) {
-        taskMap.executeTasks { scene, tasks ->
-            when (tasks.size) {
-                0 -> {}
-                1 -> {
-                    render(colorFrameBuffer, depthFrameBuffer, tasks[0], scene)
-                }
+    override fun executeTasks(colorFrameBuffer: GpuTextureView, depthFrameBuffer: GpuTextureView?) =
+        FrameProfiler.span("executeTasks") {
+            taskMap.executeTasks { scene, tasks ->
+                when (tasks.size) {
+                    0 -> {}
+                    1 -> {
+                        render(colorFrameBuffer, depthFrameBuffer, tasks[0], scene)
+                    }
 
-                else -> {
-                    for (component in scene.primitiveComponents) {
-                        renderInstanced(
-                            colorFrameBuffer = colorFrameBuffer,
-                            depthFrameBuffer = depthFrameBuffer,
-                            tasks = tasks,
-                            scene = scene,
-                            component = component,
-                        )
+                    else -> FrameProfiler.span("renderInstanced") {
+                        for (component in scene.primitiveComponents) {
+                            renderInstanced(
+                                colorFrameBuffer = colorFrameBuffer,
+                                depthFrameBuffer = depthFrameBuffer,
+                                tasks = tasks,
+                                scene = scene,
+                                component = component,
+                            )
+                        }
                     }
                 }
             }
         }
-    }
 
     abstract fun renderInstanced(
         colorFrameBuffer: GpuTextureView,
@@ -62,11 +62,11 @@ class VertexShaderTransformRenderer private constructor() :
             item
         })
 
-        constructor(material: RenderMaterial<*>, instanced: Boolean) : this(
+        constructor(material: RenderMaterial<*>, instanced: Boolean, morphed: Boolean) : this(
             doubleSided = material.doubleSided,
             skinned = material.skinned,
             instanced = instanced,
-            morphed = material.morphed
+            morphed = morphed
         )
 
         val doubleSided
@@ -134,10 +134,13 @@ class VertexShaderTransformRenderer private constructor() :
 
         private val pipelineCache = mutableMapOf<RenderMaterial.Descriptor, Int2ReferenceMap<RenderPipeline>>()
 
-        private fun getPipeline(material: RenderMaterial<*>, instanced: Boolean): RenderPipeline {
+        // Primitives with streaming morph targets are drawn unmorphed until the targets are attached
+        private fun getPipeline(primitive: RenderPrimitive, instanced: Boolean): RenderPipeline {
+            val material = primitive.material
             val pipelineInfo = PipelineInfo(
                 material = material,
                 instanced = instanced,
+                morphed = material.morphed && !primitive.morphPending,
             )
             val materialMap = pipelineCache.getOrPut(material.descriptor) { Int2ReferenceAVLTreeMap() }
             return materialMap.getOrPut(pipelineInfo.bitmap.inner) {
@@ -223,9 +226,9 @@ class VertexShaderTransformRenderer private constructor() :
         get() = Type
 
     private val dataPool = if (useSsbo) {
-        GpuShaderDataPool.ofSsbo()
+        GpuShaderDataPool.ofSsbo("vertex_transform_data")
     } else {
-        GpuShaderDataPool.ofTbo()
+        GpuShaderDataPool.ofTbo("vertex_transform_data")
     }
 
     private val lightVector = Vector2i()
@@ -325,7 +328,7 @@ class VertexShaderTransformRenderer private constructor() :
                 }
             }
 
-            val pipeline = getPipeline(material = material, instanced = false)
+            val pipeline = getPipeline(primitive = primitive, instanced = false)
 
             renderPass = commandEncoder.createRenderPass(
                 { "BlazeRod render pass (non-instanced)" },
@@ -408,6 +411,7 @@ class VertexShaderTransformRenderer private constructor() :
                 primitive.targets?.let { targets ->
                     bindMorphTargets(targets)
                 }
+                DRAW_CALLS.increment()
                 primitive.indexBuffer?.let { indices ->
                     setIndexBuffer(indices)
                     drawIndexed(0, 0, indices.length, 1)
@@ -478,7 +482,7 @@ class VertexShaderTransformRenderer private constructor() :
                 skinJointBufferSlice =
                     dataPool.upload(tasks.map { it.skinBuffer[skinIndex].content.buffer })
             }
-            component.morphedPrimitiveIndex?.let { morphedPrimitiveIndex ->
+            component.morphedPrimitiveIndex?.takeIf { !primitive.morphPending }?.let { morphedPrimitiveIndex ->
                 val targets = primitive.targets ?: error("Morphed primitive index was set but targets were not")
                 morphDataUniformBufferSlice = MorphDataUniformBuffer.write {
                     totalVertices = primitive.vertices
@@ -508,7 +512,7 @@ class VertexShaderTransformRenderer private constructor() :
                 }
             }
 
-            val pipeline = getPipeline(material = material, instanced = true)
+            val pipeline = getPipeline(primitive = primitive, instanced = true)
 
             renderPass = commandEncoder.createRenderPass(
                 { "BlazeRod render pass (instanced)" },
@@ -589,6 +593,7 @@ class VertexShaderTransformRenderer private constructor() :
                 primitive.targets?.let { targets ->
                     bindMorphTargets(targets)
                 }
+                DRAW_CALLS.increment()
                 primitive.indexBuffer?.let { indices ->
                     setIndexBuffer(indices)
                     drawIndexed(0, 0, indices.length, tasks.size)
@@ -25,6 +25,9 @@ sealed class RenderMaterial<Desc : RenderMaterial.Descriptor> : AbstractRefCount
     abstract val skinned: Boolean
     abstract val morphed: Boolean
 
+    open val textures: List<RenderTexture>
+        get() = listOfNotNull(baseColorTexture)
+
     abstract val descriptor: Desc
 
     abstract class Descriptor(
@@ -66,6 +69,15 @@ sealed class RenderMaterial<Desc : RenderMaterial.Descriptor> : AbstractRefCount
             emissiveTexture.increaseReferenceCount()
         }
 
+        override val textures: List<RenderTexture>
+            get() = listOf(
+                baseColorTexture,
+                metallicRoughnessTexture,
+                normalTexture,
+                occlusionTexture,
+                emissiveTexture,
+            )
+
         override val descriptor
             get() = Descriptor
 
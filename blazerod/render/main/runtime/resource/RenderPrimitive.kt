@@ -16,7 +16,7 @@ class RenderPrimitive(
     val cpuVertexBuffer: ByteBuffer?,
     val indexBuffer: GpuIndexBuffer?,
     val material: RenderMaterial<*>,
-    val targets: Targets?,
+    targets: Targets?,
     val targetGroups: List<MorphTargetGroup>,
 ) : AbstractRefCount() {
     override val typeId: String
@@ -28,13 +28,33 @@ class RenderPrimitive(
         material.increaseReferenceCount()
         if (targetGroups.isEmpty()) {
             require(targets == null) { "Empty target groups with non-empty targets" }
-        } else {
-            require(targets != null) { "Non-empty target groups with empty targets" }
         }
     }
 
-    val gpuComplete = gpuVertexBuffer != null && targets?.gpuComplete != false
-    val cpuComplete = cpuVertexBuffer != null && targets?.cpuComplete != false
+    // Null for primitives with target groups means the targets are still streaming, and the primitive is drawn without
+    // morphing until they are attached
+    var targets: Targets? = targets
+        private set
+
+    val morphPending
+        get() = targetGroups.isNotEmpty() && targets == null
+
+    val gpuComplete
+        get() = gpuVertexBuffer != null && targets?.gpuComplete != false
+    val cpuComplete
+        get() = cpuVertexBuffer != null && targets?.cpuComplete != false
+
+    /**
+     * Attach the streamed morph targets. Must be called on the render thread.
+     */
+    fun attachTargets(targets: Targets) {
+        check(morphPending) { "Primitive has no pending morph targets" }
+        if (closed) {
+            targets.close()
+            return
+        }
+        this.targets = targets
+    }
 
     class Target(
         val gpuBuffer: GpuBuffer?,
@@ -62,19 +82,21 @@ class RenderPrimitive(
         val position: Target,
         val color: Target,
         val texCoord: Target,
-    ) {
+    ) : AutoCloseable {
         val gpuComplete = position.gpuBuffer != null && color.gpuBuffer != null && texCoord.gpuBuffer != null
         val cpuComplete = position.cpuBuffer != null && color.cpuBuffer != null && texCoord.cpuBuffer != null
+
+        override fun close() {
+            position.close()
+            color.close()
+            texCoord.close()
+        }
     }
 
     override fun onClosed() {
         gpuVertexBuffer?.decreaseReferenceCount()
         indexBuffer?.decreaseReferenceCount()
         material.decreaseReferenceCount()
-        targets?.apply {
-            position.close()
-            color.close()
-            texCoord.close()
-        }
+        targets?.close()
     }
 }
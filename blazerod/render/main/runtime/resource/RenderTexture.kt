@@ -1,20 +1,68 @@
 package top.fifthlight.blazerod.runtime.resource
 
-import com.mojang.blaze3d.systems.RenderSystem
 import com.mojang.blaze3d.textures.GpuTexture
 import com.mojang.blaze3d.textures.GpuTextureView
 import com.mojang.blaze3d.textures.TextureFormat
 import net.minecraft.client.texture.NativeImage
 import top.fifthlight.blazerod.api.refcount.AbstractRefCount
+import top.fifthlight.blazerod.debug.Metrics
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
 
-class RenderTexture(
-    val texture: GpuTexture,
-    val view: GpuTextureView,
+class RenderTexture private constructor(
+    texture: GpuTexture,
+    view: GpuTextureView,
+    isPlaceholder: Boolean,
 ) : AbstractRefCount() {
+    constructor(texture: GpuTexture, view: GpuTextureView) : this(texture, view, false)
+
+    var texture = texture
+        private set
+    var view = view
+        private set
+
+    // Placeholders borrow another texture until the real one is streamed in, so they don't own it
+    var isPlaceholder = isPlaceholder
+        private set
+
+    init {
+        GPU_BYTES.add(gpuSize)
+    }
+
+    val gpuSize: Long
+        get() {
+            if (isPlaceholder) {
+                return 0
+            }
+            val pixelSize = texture.format.pixelSize().toLong()
+            return (0 until texture.mipLevels).sumOf { level ->
+                texture.getWidth(level).toLong() * texture.getHeight(level) * pixelSize
+            } * texture.depthOrLayers
+        }
+
+    /**
+     * Replace the placeholder with the streamed texture, taking ownership of [texture] and [view].
+     *
+     * Must be called on the render thread, as renderers read [view] on every draw.
+     */
+    fun replace(texture: GpuTexture, view: GpuTextureView) {
+        check(isPlaceholder) { "Only placeholder textures can be replaced" }
+        if (closed) {
+            view.close()
+            texture.close()
+            return
+        }
+        this.texture = texture
+        this.view = view
+        isPlaceholder = false
+        GPU_BYTES.add(gpuSize)
+    }
 
     override fun onClosed() {
+        if (isPlaceholder) {
+            return
+        }
+        GPU_BYTES.add(-gpuSize)
         view.close()
         texture.close()
     }
@@ -23,12 +71,18 @@ class RenderTexture(
         get() = "gpu_texture"
 
     companion object {
+        private val GPU_BYTES = Metrics.gauge("gpu.texture_bytes")
+
+        fun placeholder() = WHITE_RGBA_TEXTURE.let { white ->
+            RenderTexture(white.texture, white.view, true)
+        }
+
         val WHITE_RGBA_TEXTURE by lazy {
             val buffer = ByteBuffer.allocateDirect(16).order(ByteOrder.nativeOrder()).asIntBuffer().apply {
                 repeat(4) { put(0xFFFFFFFFu.toInt()) }
                 flip()
             }
-            RenderSystem.getDevice().let { device ->
+            ResourceDevice.current.let { device ->
                 val texture = device.createTexture(
                     "White RGBA texture",
                     GpuTexture.USAGE_TEXTURE_BINDING or GpuTexture.USAGE_COPY_DST,
@@ -38,7 +92,7 @@ class RenderTexture(
                     1,
                     1
                 )
-                device.createCommandEncoder().writeToTexture(texture, buffer, NativeImage.Format.RGBA, 0, 0, 0, 0, 1, 1)
+                device.writeToTexture(texture, buffer, NativeImage.Format.RGBA, 0, 0, 0, 0, 1, 1)
                 RenderTexture(texture, device.createTextureView(texture))
             }.apply {
                 // Increase ref count to keep it from being closed
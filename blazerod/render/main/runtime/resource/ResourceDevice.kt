@@ -0,0 +1,157 @@
+package top.fifthlight.blazerod.runtime.resource
+
+import com.mojang.blaze3d.buffers.GpuBuffer
+import com.mojang.blaze3d.buffers.GpuBufferSlice
+import com.mojang.blaze3d.systems.RenderSystem
+import com.mojang.blaze3d.textures.GpuTexture
+import com.mojang.blaze3d.textures.GpuTextureView
+import com.mojang.blaze3d.textures.TextureFormat
+import net.minecraft.client.texture.NativeImage
+import top.fifthlight.blazerod.extension.createBuffer
+import java.nio.ByteBuffer
+import java.nio.IntBuffer
+import java.util.function.Supplier
+
+/**
+ * Device that model resources are created on. Scene loading and [RenderTexture.WHITE_RGBA_TEXTURE] create their
+ * resources through [current] only, so it can be replaced to load and update scenes without a game client.
+ *
+ * Functions are called on the upload dispatcher, see ModelResourceLoader.
+ */
+interface ResourceDevice {
+    fun createBuffer(
+        labelGetter: Supplier<String>?,
+        usage: Int,
+        extraUsage: Int,
+        size: Int,
+    ): GpuBuffer
+
+    fun writeToBuffer(slice: GpuBufferSlice, data: ByteBuffer)
+
+    fun createTexture(
+        label: String?,
+        usage: Int,
+        format: TextureFormat,
+        width: Int,
+        height: Int,
+        depthOrLayers: Int,
+        mipLevels: Int,
+    ): GpuTexture
+
+    fun writeToTexture(
+        texture: GpuTexture,
+        image: NativeImage,
+        mipLevel: Int,
+        depthOrLayer: Int,
+        destX: Int,
+        destY: Int,
+        width: Int,
+        height: Int,
+        srcX: Int,
+        srcY: Int,
+    )
+
+    fun writeToTexture(
+        texture: GpuTexture,
+        data: IntBuffer,
+        format: NativeImage.Format,
+        mipLevel: Int,
+        depthOrLayer: Int,
+        destX: Int,
+        destY: Int,
+        width: Int,
+        height: Int,
+    )
+
+    fun createTextureView(texture: GpuTexture): GpuTextureView
+
+    object Blaze3D : ResourceDevice {
+        override fun createBuffer(
+            labelGetter: Supplier<String>?,
+            usage: Int,
+            extraUsage: Int,
+            size: Int,
+        ) = RenderSystem.getDevice().createBuffer(
+            labelGetter = labelGetter,
+            usage = usage,
+            extraUsage = extraUsage,
+            size = size,
+        )
+
+        override fun writeToBuffer(slice: GpuBufferSlice, data: ByteBuffer) =
+            RenderSystem.getDevice().createCommandEncoder().writeToBuffer(slice, data)
+
+        override fun createTexture(
+            label: String?,
+            usage: Int,
+            format: TextureFormat,
+            width: Int,
+            height: Int,
+            depthOrLayers: Int,
+            mipLevels: Int,
+        ): GpuTexture = RenderSystem.getDevice().createTexture(
+            label,
+            usage,
+            format,
+            width,
+            height,
+            depthOrLayers,
+            mipLevels,
+        )
+
+        override fun writeToTexture(
+            texture: GpuTexture,
+            image: NativeImage,
+            mipLevel: Int,
+            depthOrLayer: Int,
+            destX: Int,
+            destY: Int,
+            width: Int,
+            height: Int,
+            srcX: Int,
+            srcY: Int,
+        ) = RenderSystem.getDevice().createCommandEncoder().writeToTexture(
+            texture,
+            image,
+            mipLevel,
+            depthOrLayer,
+            destX,
+            destY,
+            width,
+            height,
+            srcX,
+            srcY,
+        )
+
+        override fun writeToTexture(
+            texture: GpuTexture,
+            data: IntBuffer,
+            format: NativeImage.Format,
+            mipLevel: Int,
+            depthOrLayer: Int,
+            destX: Int,
+            destY: Int,
+            width: Int,
+            height: Int,
+        ) = RenderSystem.getDevice().createCommandEncoder().writeToTexture(
+            texture,
+            data,
+            format,
+            mipLevel,
+            depthOrLayer,
+            destX,
+            destY,
+            width,
+            height,
+        )
+
+        override fun createTextureView(texture: GpuTexture): GpuTextureView =
+            RenderSystem.getDevice().createTextureView(texture)
+    }
+
+    companion object {
+        // Set before the first scene is loaded, as the white texture is created once and shared by all scenes
+        @Volatile
+        var current: ResourceDevice = Blaze3D
+    }
+}
@@ -0,0 +1,94 @@
+package top.fifthlight.blazerod.runtime.resource
+
+import com.mojang.blaze3d.vertex.VertexFormat
+import top.fifthlight.blazerod.api.refcount.AbstractRefCount
+import top.fifthlight.blazerod.model.Texture
+import top.fifthlight.blazerod.render.GpuIndexBuffer
+import top.fifthlight.blazerod.render.RefCountedGpuBuffer
+import java.nio.ByteBuffer
+import java.util.concurrent.ConcurrentHashMap
+import java.util.zip.CRC32
+import java.util.zip.CRC32C
+
+/**
+ * Size and two independent checksums of some data, to find resources with the same data without keeping the data.
+ */
+data class ContentKey(
+    val size: Int,
+    val crc32c: Int,
+    val crc32: Int,
+) {
+    companion object {
+        // Reads the remaining bytes of buffer, without changing its position
+        fun of(buffer: ByteBuffer) = ContentKey(
+            size = buffer.remaining(),
+            crc32c = CRC32C().apply { update(buffer.duplicate()) }.value.toInt(),
+            crc32 = CRC32().apply { update(buffer.duplicate()) }.value.toInt(),
+        )
+    }
+}
+
+// Encoded texture data, sampler is included as it is set on the GPU texture
+data class TextureKey(
+    val content: ContentKey,
+    val type: Texture.TextureType?,
+    val sampler: Texture.Sampler,
+)
+
+data class IndexBufferKey(
+    val type: VertexFormat.IndexType,
+    val length: Int,
+    val content: ContentKey,
+)
+
+/**
+ * Resources of a scene indexed by their content, so the scene of an edited model can reuse the resources not changed.
+ *
+ * Resources are not owned by this index: the scene holds them, and closed resources are never returned. All functions
+ * are thread-safe.
+ */
+class ReusableResources {
+    class VertexBuffer(
+        val gpuBuffer: RefCountedGpuBuffer,
+        val cpuBuffer: ByteBuffer?,
+    )
+
+    private val textures = ConcurrentHashMap<TextureKey, RenderTexture>()
+    private val vertexBuffers = ConcurrentHashMap<ContentKey, VertexBuffer>()
+    private val indexBuffers = ConcurrentHashMap<IndexBufferKey, GpuIndexBuffer>()
+
+    fun putTexture(key: TextureKey, texture: RenderTexture) {
+        textures[key] = texture
+    }
+
+    fun putVertexBuffer(key: ContentKey, buffer: VertexBuffer) {
+        vertexBuffers[key] = buffer
+    }
+
+    fun putIndexBuffer(key: IndexBufferKey, buffer: GpuIndexBuffer) {
+        indexBuffers[key] = buffer
+    }
+
+    // Take a reference of the resource, or return null if it is closed
+    private fun <T : AbstractRefCount> T.tryAcquire(): T? = try {
+        increaseReferenceCount()
+        this
+    } catch (ex: IllegalArgumentException) {
+        // Closed between lookup and increase
+        null
+    }
+
+    /**
+     * Take a reference of the streamed texture with the same data. Placeholders are never indexed, as they don't
+     * own their texture yet.
+     */
+    fun acquireTexture(key: TextureKey): RenderTexture? =
+        textures[key]?.takeIf { !it.closed && !it.isPlaceholder }?.tryAcquire()
+
+    fun acquireVertexBuffer(key: ContentKey): VertexBuffer? = vertexBuffers[key]?.takeIf { buffer ->
+        !buffer.gpuBuffer.closed && buffer.gpuBuffer.tryAcquire() != null
+    }
+
+    fun acquireIndexBuffer(key: IndexBufferKey): GpuIndexBuffer? =
+        indexBuffers[key]?.takeIf { !it.closed }?.tryAcquire()
+}
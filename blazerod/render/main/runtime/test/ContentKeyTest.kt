@@ -0,0 +1,39 @@
+package top.fifthlight.blazerod.runtime.test
+
+import org.junit.jupiter.api.Assertions.*
+import org.junit.jupiter.api.Test
+import top.fifthlight.blazerod.runtime.resource.ContentKey
+import java.nio.ByteBuffer
+
+class ContentKeyTest {
+    private fun bufferOf(vararg bytes: Int): ByteBuffer =
+        ByteBuffer.allocateDirect(bytes.size).apply {
+            bytes.forEach { put(it.toByte()) }
+            flip()
+        }
+
+    @Test
+    fun sameContentHasSameKey() {
+        assertEquals(ContentKey.of(bufferOf(1, 2, 3, 4)), ContentKey.of(bufferOf(1, 2, 3, 4)))
+    }
+
+    @Test
+    fun differentContentHasDifferentKey() {
+        assertNotEquals(ContentKey.of(bufferOf(1, 2, 3, 4)), ContentKey.of(bufferOf(1, 2, 3, 5)))
+        assertNotEquals(ContentKey.of(bufferOf(1, 2, 3)), ContentKey.of(bufferOf(1, 2, 3, 0)))
+    }
+
+    @Test
+    fun onlyRemainingBytesAreHashed() {
+        val buffer = bufferOf(9, 9, 1, 2, 3, 4).position(2)
+        assertEquals(ContentKey.of(bufferOf(1, 2, 3, 4)), ContentKey.of(buffer))
+    }
+
+    @Test
+    fun bufferPositionIsNotChanged() {
+        val buffer = bufferOf(1, 2, 3, 4)
+        val key = ContentKey.of(buffer)
+        assertEquals(0, buffer.position())
+        assertEquals(4, key.size)
+    }
+}
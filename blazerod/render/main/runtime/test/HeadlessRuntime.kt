@@ -0,0 +1,188 @@
+package top.fifthlight.blazerod.runtime.test
+
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
+import kotlinx.coroutines.runBlocking
+import org.joml.Matrix4f
+import top.fifthlight.blazerod.animation.AnimationItemInstanceImpl
+import top.fifthlight.blazerod.animation.AnimationLoader
+import top.fifthlight.blazerod.model.Model
+import top.fifthlight.blazerod.model.animation.Animation
+import top.fifthlight.blazerod.model.animation.AnimationContext
+import top.fifthlight.blazerod.model.animation.AnimationState
+import top.fifthlight.blazerod.model.util.MutableFloat
+import top.fifthlight.blazerod.model.util.MutableLong
+import top.fifthlight.blazerod.runtime.ModelInstanceImpl
+import top.fifthlight.blazerod.runtime.RenderSceneImpl
+import top.fifthlight.blazerod.runtime.load.ModelLoaderImpl
+import top.fifthlight.blazerod.runtime.resource.ResourceDevice
+import top.fifthlight.blazerod.util.dispatchers.UploadQueueDispatcher
+import java.lang.management.ManagementFactory
+import kotlin.math.floor
+import com.sun.management.ThreadMXBean as AllocationThreadMXBean
+
+/**
+ * Animation context only advanced by [advance], as there is no game to read time from.
+ */
+class HeadlessAnimationContext : AnimationContext {
+    private var gameTick = 0L
+    private var deltaTick = 0f
+
+    // Simulated frame time in nanoseconds, passed to simulations
+    var time = 0L
+        private set
+
+    fun advance(seconds: Float) {
+        time += (seconds * 1_000_000_000L).toLong()
+        val ticks = deltaTick + seconds / AnimationContext.SECONDS_PER_TICK
+        val wholeTicks = floor(ticks)
+        gameTick += wholeTicks.toLong()
+        deltaTick = ticks - wholeTicks
+    }
+
+    override fun getGameTick() = gameTick
+
+    override fun getDeltaTick() = deltaTick
+
+    private val longBuffer = MutableLong()
+    private val floatBuffer = MutableFloat()
+
+    @Suppress("UNCHECKED_CAST")
+    override fun <T> getProperty(type: AnimationContext.Property<T>): T? = when (type) {
+        AnimationContext.Property.GameTick -> longBuffer.apply { value = gameTick }
+        AnimationContext.Property.DeltaTick -> floatBuffer.apply { value = deltaTick }
+        else -> null
+    } as T?
+
+    override fun getPropertyTypes(): Set<AnimationContext.Property<*>> = propertyTypes
+
+    companion object {
+        private val propertyTypes = setOf(
+            AnimationContext.Property.GameTick,
+            AnimationContext.Property.DeltaTick,
+        )
+    }
+}
+
+/**
+ * CPU time and heap allocation of the frames run by [HeadlessRuntime.runFrames].
+ */
+data class FrameStats(
+    val frames: Int,
+    val totalNanos: Long,
+    val maxNanos: Long,
+    // -1 if the JVM can't measure allocations
+    val allocatedBytes: Long,
+) {
+    val averageNanos
+        get() = if (frames == 0) 0L else totalNanos / frames
+
+    val allocatedBytesPerFrame
+        get() = if (frames == 0 || allocatedBytes < 0) allocatedBytes else allocatedBytes / frames
+
+    override fun toString() = "%d frames, average %.3f ms, max %.3f ms, %s".format(
+        frames,
+        averageNanos / 1_000_000.0,
+        maxNanos / 1_000_000.0,
+        if (allocatedBytes < 0) "allocations unknown" else "$allocatedBytesPerFrame bytes allocated per frame",
+    )
+}
+
+/**
+ * Load, animate and update scenes in plain JUnit, without a game client.
+ *
+ * Resources are created on [HostResourceDevice], and the upload queue is drained on the calling thread, as the render
+ * thread does every frame in game. Each frame runs what the player renderer does: update the animation, apply it to
+ * the instance, update render data, then create and release a render task. Nothing is drawn.
+ */
+object HeadlessRuntime {
+    init {
+        ResourceDevice.current = HostResourceDevice
+    }
+
+    private val threadMXBean = ManagementFactory.getThreadMXBean() as? AllocationThreadMXBean
+
+    private fun allocatedBytes(): Long = threadMXBean
+        ?.takeIf { it.isThreadAllocatedMemorySupported && it.isThreadAllocatedMemoryEnabled }
+        ?.getThreadAllocatedBytes(Thread.currentThread().threadId())
+        ?: -1
+
+    private fun <T> drainUntil(condition: () -> Boolean, result: () -> T): T {
+        while (!condition()) {
+            UploadQueueDispatcher.drain()
+            Thread.onSpinWait()
+        }
+        return result()
+    }
+
+    /**
+     * Load the scene of [model], returning after all resources including the streamed ones are uploaded.
+     */
+    fun loadScene(model: Model): RenderSceneImpl {
+        val load = CoroutineScope(Dispatchers.Default).async { ModelLoaderImpl.loadModel(model) }
+        val scene = drainUntil({ load.isCompleted }) { runBlocking { load.await() } }
+            ?: throw IllegalArgumentException("Model has no scene")
+        return drainUntil({ !scene.streaming }) { scene }
+    }
+
+    class Animated(
+        val instance: ModelInstanceImpl,
+        val animation: AnimationItemInstanceImpl,
+        val context: HeadlessAnimationContext,
+        val state: AnimationState,
+    )
+
+    fun animate(instance: ModelInstanceImpl, animation: Animation): Animated {
+        val context = HeadlessAnimationContext()
+        val item = AnimationItemInstanceImpl(AnimationLoader.load(instance.scene, animation))
+        return Animated(
+            instance = instance,
+            animation = item,
+            context = context,
+            state = item.createState(context),
+        )
+    }
+
+    private val modelMatrix = Matrix4f()
+
+    private fun frame(animated: Animated, frameSeconds: Float) {
+        val instance = animated.instance
+        animated.context.advance(frameSeconds)
+        animated.state.updateTime(animated.context)
+        val pendingValues = animated.animation.update(animated.context, animated.state)
+        animated.animation.apply(instance, pendingValues)
+        instance.updateRenderData(animated.context.time)
+        instance.createRenderTask(modelMatrix, 0, 0).release()
+    }
+
+    /**
+     * Run [warmupFrames] unmeasured frames, then [frames] measured ones. Allocations are counted on the calling thread
+     * only, as the whole update runs on it.
+     */
+    fun runFrames(
+        animated: Animated,
+        frames: Int,
+        warmupFrames: Int = 0,
+        frameSeconds: Float = 1f / 60f,
+    ): FrameStats {
+        repeat(warmupFrames) { frame(animated, frameSeconds) }
+        var totalNanos = 0L
+        var maxNanos = 0L
+        val startAllocatedBytes = allocatedBytes()
+        repeat(frames) {
+            val startTime = System.nanoTime()
+            frame(animated, frameSeconds)
+            val time = System.nanoTime() - startTime
+            totalNanos += time
+            maxNanos = maxOf(maxNanos, time)
+        }
+        val endAllocatedBytes = allocatedBytes()
+        return FrameStats(
+            frames = frames,
+            totalNanos = totalNanos,
+            maxNanos = maxNanos,
+            allocatedBytes = if (startAllocatedBytes < 0) -1 else endAllocatedBytes - startAllocatedBytes,
+        )
+    }
+}
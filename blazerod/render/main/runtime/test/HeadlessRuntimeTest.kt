@@ -0,0 +1,112 @@
+package top.fifthlight.blazerod.runtime.test
+
+import org.joml.Matrix4f
+import top.fifthlight.blazerod.model.animation.Animation
+import top.fifthlight.blazerod.model.synthetic.SyntheticAnimationSpec
+import top.fifthlight.blazerod.model.synthetic.SyntheticModel
+import top.fifthlight.blazerod.model.synthetic.SyntheticModelSpec
+import top.fifthlight.blazerod.model.synthetic.VmdWriter
+import top.fifthlight.blazerod.model.synthetic.toModel
+import top.fifthlight.blazerod.model.vmd.VmdLoader
+import top.fifthlight.blazerod.runtime.ModelInstanceImpl
+import kotlin.io.path.createTempFile
+import kotlin.io.path.deleteIfExists
+import kotlin.test.Test
+import kotlin.test.assertEquals
+import kotlin.test.assertFalse
+import kotlin.test.assertIs
+import kotlin.test.assertNotNull
+import kotlin.test.assertTrue
+
+class HeadlessRuntimeTest {
+    companion object {
+        // Generous bound on allocations of the render thread, so per-frame garbage regressions are caught without
+        // depending on JIT details. Simulations run on worker threads and are not counted.
+        private const val MAX_ALLOCATED_BYTES_PER_FRAME = 256L * 1024
+    }
+
+    private val spec = SyntheticModelSpec(
+        joints = 32,
+        primitives = 2,
+        verticesPerPrimitive = 128,
+        morphTargets = 4,
+        ikChains = 2,
+        ikChainLength = 3,
+        seed = 42,
+    )
+
+    private val model = SyntheticModel.generate(spec)
+
+    private fun loadAnimation(frames: Int): Animation {
+        val file = createTempFile("synthetic", ".vmd")
+        try {
+            VmdWriter.write(model, SyntheticAnimationSpec(frames = frames), file)
+            return assertNotNull(VmdLoader().load(file).animations).single()
+        } finally {
+            file.deleteIfExists()
+        }
+    }
+
+    private fun <T> withInstance(block: (ModelInstanceImpl) -> T): T {
+        val scene = HeadlessRuntime.loadScene(model.toModel())
+        val instance = ModelInstanceImpl(scene)
+        instance.increaseReferenceCount()
+        try {
+            return block(instance)
+        } finally {
+            instance.decreaseReferenceCount()
+            assertTrue(scene.closed)
+        }
+    }
+
+    private fun skinMatrices(instance: ModelInstanceImpl): List<Matrix4f> {
+        val skinBuffer = instance.modelData.skinBuffers.single().content
+        return List(instance.scene.skins.single().jointSize) {
+            Matrix4f().also { matrix -> skinBuffer.getPositionMatrix(it, matrix) }
+        }
+    }
+
+    @Test
+    fun testLoadScene() = withInstance { instance ->
+        val scene = instance.scene
+        assertFalse(scene.streaming)
+        assertEquals(model.bones.size + spec.primitives, scene.nodes.size - 1)
+        assertEquals(spec.primitives, scene.primitiveComponents.size)
+        assertEquals(spec.primitives, scene.morphedPrimitiveComponents.size)
+        assertEquals(spec.ikChains, scene.ikTargetComponents.size)
+        assertEquals(model.bones.size, scene.skins.single().jointSize)
+        for (component in scene.primitiveComponents) {
+            val primitive = component.primitive
+            val gpuBuffer = assertIs<HostGpuBuffer>(assertNotNull(primitive.gpuVertexBuffer).inner)
+            val cpuBuffer = assertNotNull(primitive.cpuVertexBuffer)
+            assertEquals(cpuBuffer.duplicate().clear(), gpuBuffer.data.duplicate().clear().limit(cpuBuffer.capacity()))
+            assertEquals(spec.morphTargets, assertNotNull(primitive.targets).targetsCount)
+        }
+    }
+
+    @Test
+    fun testAnimateFrames() = withInstance { instance ->
+        val animated = HeadlessRuntime.animate(instance, loadAnimation(frames = 60))
+        HeadlessRuntime.runFrames(animated, frames = 1, frameSeconds = 0f)
+        val start = skinMatrices(instance)
+        HeadlessRuntime.runFrames(animated, frames = 30)
+        val end = skinMatrices(instance)
+        assertTrue(start.zip(end).any { (startMatrix, endMatrix) -> !startMatrix.equals(endMatrix, 1e-4f) })
+    }
+
+    @Test
+    fun testFrameStats() = withInstance { instance ->
+        val animated = HeadlessRuntime.animate(instance, loadAnimation(frames = 300))
+        val stats = HeadlessRuntime.runFrames(animated, frames = 240, warmupFrames = 60)
+        println("Headless frames: $stats")
+        assertEquals(240, stats.frames)
+        // Allocations can't be measured on this JVM
+        if (stats.allocatedBytesPerFrame < 0) {
+            return@withInstance
+        }
+        assertTrue(
+            stats.allocatedBytesPerFrame <= MAX_ALLOCATED_BYTES_PER_FRAME,
+            "${stats.allocatedBytesPerFrame} bytes allocated per frame, over $MAX_ALLOCATED_BYTES_PER_FRAME",
+        )
+    }
+}
@@ -0,0 +1,121 @@
+package top.fifthlight.blazerod.runtime.test
+
+import com.mojang.blaze3d.buffers.GpuBuffer
+import com.mojang.blaze3d.buffers.GpuBufferSlice
+import com.mojang.blaze3d.textures.GpuTexture
+import com.mojang.blaze3d.textures.GpuTextureView
+import com.mojang.blaze3d.textures.TextureFormat
+import net.minecraft.client.texture.NativeImage
+import top.fifthlight.blazerod.extension.GpuBufferExt
+import top.fifthlight.blazerod.runtime.resource.ResourceDevice
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.IntBuffer
+import java.util.function.Supplier
+
+/**
+ * Buffer backed by host memory. Writes are copied into [data], so tests can check what is uploaded.
+ */
+class HostGpuBuffer(
+    usage: Int,
+    size: Int,
+    private val extraUsage: Int,
+) : GpuBuffer(usage, size), GpuBufferExt {
+    val data: ByteBuffer = ByteBuffer.allocateDirect(size).order(ByteOrder.nativeOrder())
+
+    private var closed = false
+
+    override fun `blazerod$getExtraUsage`() = extraUsage
+
+    override fun isClosed() = closed
+
+    override fun close() {
+        closed = true
+    }
+}
+
+// Texture contents are dropped, nothing in the update pipeline reads them
+class HostGpuTexture(
+    usage: Int,
+    label: String,
+    format: TextureFormat,
+    width: Int,
+    height: Int,
+    depthOrLayers: Int,
+    mipLevels: Int,
+) : GpuTexture(usage, label, format, width, height, depthOrLayers, mipLevels) {
+    private var closed = false
+
+    override fun isClosed() = closed
+
+    override fun close() {
+        closed = true
+    }
+}
+
+class HostGpuTextureView(texture: GpuTexture) : GpuTextureView(texture, 0, texture.mipLevels) {
+    private var closed = false
+
+    override fun isClosed() = closed
+
+    override fun close() {
+        closed = true
+    }
+}
+
+/**
+ * [ResourceDevice] creating resources in host memory, to load scenes without a game client or a GPU.
+ */
+object HostResourceDevice : ResourceDevice {
+    override fun createBuffer(
+        labelGetter: Supplier<String>?,
+        usage: Int,
+        extraUsage: Int,
+        size: Int,
+    ) = HostGpuBuffer(usage, size, extraUsage)
+
+    override fun writeToBuffer(slice: GpuBufferSlice, data: ByteBuffer) {
+        val buffer = slice.buffer() as HostGpuBuffer
+        require(data.remaining() <= slice.length()) {
+            "Write of ${data.remaining()} bytes overflows slice of ${slice.length()} bytes"
+        }
+        buffer.data.put(slice.offset(), data, data.position(), data.remaining())
+    }
+
+    override fun createTexture(
+        label: String?,
+        usage: Int,
+        format: TextureFormat,
+        width: Int,
+        height: Int,
+        depthOrLayers: Int,
+        mipLevels: Int,
+    ) = HostGpuTexture(usage, label ?: "Host texture", format, width, height, depthOrLayers, mipLevels)
+
+    override fun writeToTexture(
+        texture: GpuTexture,
+        image: NativeImage,
+        mipLevel: Int,
+        depthOrLayer: Int,
+        destX: Int,
+        destY: Int,
+        width: Int,
+        height: Int,
+        srcX: Int,
+        srcY: Int,
+    ) = Unit
+
+    override fun writeToTexture(
+        texture: GpuTexture,
+        data: IntBuffer,
+        format: NativeImage.Format,
+        mipLevel: Int,
+        depthOrLayer: Int,
+        destX: Int,
+        destY: Int,
+        width: Int,
+        height: Int,
+    ) = Unit
+
+    override fun createTextureView(texture: GpuTexture) = HostGpuTextureView(texture)
+}
@@ -0,0 +1,152 @@
+package top.fifthlight.blazerod.runtime.test
+
+import org.joml.Quaternionf
+import org.joml.Vector3f
+import org.junit.jupiter.api.Assertions.*
+import org.junit.jupiter.api.Test
+import top.fifthlight.blazerod.model.Physics
+import top.fifthlight.blazerod.runtime.physics.PhysicsData
+import top.fifthlight.blazerod.runtime.physics.PhysicsSolver
+import top.fifthlight.blazerod.runtime.physics.PhysicsState
+import kotlin.math.abs
+
+class PhysicsSolverTest {
+    private fun body(
+        position: Vector3f,
+        type: Physics.RigidBody.Type,
+        mass: Float = 1f,
+        damping: Float = 0f,
+    ) = PhysicsData.RigidBody(
+        nodeIndex = -1,
+        nodeDepth = 0,
+        shape = Physics.RigidBody.Shape.Sphere(.1f),
+        type = type,
+        mass = mass,
+        linearDamping = damping,
+        angularDamping = damping,
+        collisionGroup = 0,
+        collisionMask = 0xFFFF,
+        restPosition = position,
+        restRotation = Quaternionf(),
+        nodeRestTransform = null,
+    )
+
+    // Kinematic anchor at origin, and a body hanging on it with a ball joint
+    private fun pendulum(bodyPosition: Vector3f, damping: Float = 0f) = PhysicsData(
+        rigidBodies = listOf(
+            body(Vector3f(), Physics.RigidBody.Type.KINEMATIC, mass = 0f),
+            body(bodyPosition, Physics.RigidBody.Type.DYNAMIC, damping = damping),
+        ),
+        joints = listOf(
+            PhysicsData.Joint(
+                bodyA = 0,
+                bodyB = 1,
+                restPosition = Vector3f(),
+                restRotation = Quaternionf(),
+                positionMin = Vector3f(),
+                positionMax = Vector3f(),
+                // Min greater than max means free
+                rotationMin = Vector3f(1f),
+                rotationMax = Vector3f(-1f),
+                positionStiffness = Vector3f(),
+                rotationStiffness = Vector3f(),
+            )
+        ),
+    )
+
+    private fun PhysicsState.targetRest() {
+        data.bodyRestPositions.copyInto(targetPositions)
+        data.bodyRestRotations.copyInto(targetRotations)
+    }
+
+    private fun PhysicsState.position(body: Int) = Vector3f(
+        positions[body * 3],
+        positions[body * 3 + 1],
+        positions[body * 3 + 2],
+    )
+
+    @Test
+    fun freeFallFollowsReferenceTrajectory() {
+        val data = PhysicsData(
+            rigidBodies = listOf(body(Vector3f(), Physics.RigidBody.Type.DYNAMIC)),
+            joints = listOf(),
+        )
+        val state = PhysicsState(data)
+        state.targetRest()
+        // Symplectic Euler: after n substeps of h, y = g * h^2 * n * (n + 1) / 2
+        val substepTime = PhysicsSolver.FIXED_TIME_STEP / PhysicsSolver.SUBSTEPS
+        for (step in 1..60) {
+            PhysicsSolver.step(state, PhysicsSolver.FIXED_TIME_STEP)
+            val substeps = step * PhysicsSolver.SUBSTEPS
+            val expected = PhysicsSolver.GRAVITY * substepTime * substepTime * substeps * (substeps + 1) / 2
+            val position = state.position(0)
+            assertEquals(expected, position.y, abs(expected) * 5e-4f + 1e-6f, "Step $step")
+            assertEquals(0f, position.x)
+            assertEquals(0f, position.z)
+        }
+    }
+
+    @Test
+    fun pendulumKeepsLengthAndSwingsDown() {
+        val state = PhysicsState(pendulum(Vector3f(1f, 0f, 0f)))
+        state.targetRest()
+        var lowest = 0f
+        repeat(120) {
+            PhysicsSolver.step(state, PhysicsSolver.FIXED_TIME_STEP)
+            val position = state.position(1)
+            assertEquals(1f, position.length(), 1e-2f)
+            // Energy should never increase
+            assertTrue(position.y < 1e-3f, "Pendulum rising above start: $position")
+            lowest = minOf(lowest, position.y)
+        }
+        assertTrue(lowest < -0.9f, "Pendulum not swinging down: $lowest")
+    }
+
+    @Test
+    fun simulationIsDeterministic() {
+        val first = PhysicsState(pendulum(Vector3f(.6f, -.3f, .4f)))
+        val second = PhysicsState(pendulum(Vector3f(.6f, -.3f, .4f)))
+        first.targetRest()
+        second.targetRest()
+        repeat(90) {
+            PhysicsSolver.step(first, PhysicsSolver.FIXED_TIME_STEP)
+            PhysicsSolver.step(second, PhysicsSolver.FIXED_TIME_STEP)
+        }
+        assertArrayEquals(first.positions, second.positions)
+        assertArrayEquals(first.rotations, second.rotations)
+        assertArrayEquals(first.velocities, second.velocities)
+    }
+
+    @Test
+    fun restingIslandSleepsAndWakes() {
+        val state = PhysicsState(pendulum(Vector3f(0f, -1f, 0f), damping = .5f))
+        state.targetRest()
+        repeat(60) {
+            PhysicsSolver.step(state, PhysicsSolver.FIXED_TIME_STEP)
+        }
+        assertTrue(state.islandSleeping[0], "Resting pendulum should sleep")
+        val sleepingPosition = state.position(1)
+        PhysicsSolver.step(state, PhysicsSolver.FIXED_TIME_STEP)
+        assertEquals(sleepingPosition, state.position(1))
+
+        // Moving the anchor wakes the island
+        state.targetPositions[0] = .5f
+        PhysicsSolver.step(state, PhysicsSolver.FIXED_TIME_STEP)
+        assertFalse(state.islandSleeping[0])
+        assertNotEquals(sleepingPosition, state.position(1))
+    }
+
+    @Test
+    fun advanceUsesFixedSteps() {
+        val state = PhysicsState(pendulum(Vector3f(1f, 0f, 0f)))
+        assertEquals(1, PhysicsSolver.advance(state, 0f))
+        state.targetRest()
+        PhysicsSolver.step(state, PhysicsSolver.FIXED_TIME_STEP)
+        assertEquals(0, PhysicsSolver.advance(state, PhysicsSolver.FIXED_TIME_STEP * .5f))
+        assertEquals(1, PhysicsSolver.advance(state, PhysicsSolver.FIXED_TIME_STEP * .75f))
+        assertEquals(PhysicsSolver.MAX_STEPS_PER_UPDATE, PhysicsSolver.advance(state, .4f))
+        // Long pause resets the simulation
+        assertEquals(1, PhysicsSolver.advance(state, 10f))
+        assertFalse(state.initialized)
+    }
+}
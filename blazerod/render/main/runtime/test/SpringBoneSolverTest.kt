@@ -0,0 +1,115 @@
+package top.fifthlight.blazerod.runtime.test
+
+import org.joml.Matrix4f
+import org.joml.Quaternionf
+import org.joml.Vector3f
+import org.junit.jupiter.api.Assertions.*
+import org.junit.jupiter.api.Test
+import top.fifthlight.blazerod.runtime.physics.SpringBoneData
+import top.fifthlight.blazerod.runtime.physics.SpringBoneSolver
+import top.fifthlight.blazerod.runtime.physics.SpringBoneState
+
+class SpringBoneSolverTest {
+    private fun singleJointData(
+        localTail: Vector3f = Vector3f(0f, 1f, 0f),
+        stiffness: Float = 0f,
+        gravityPower: Float = 0f,
+        dragForce: Float = .5f,
+        colliders: List<SpringBoneData.Collider> = listOf(),
+    ) = SpringBoneData(
+        springs = listOf(
+            SpringBoneData.Spring(
+                joints = listOf(
+                    SpringBoneData.Joint(
+                        nodeIndex = 0,
+                        localTail = localTail,
+                        hitRadius = 0f,
+                        stiffness = stiffness,
+                        gravityPower = gravityPower,
+                        gravityDir = Vector3f(0f, -1f, 0f),
+                        dragForce = dragForce,
+                    )
+                ),
+                colliders = colliders.indices.toList(),
+            )
+        ),
+        colliders = colliders,
+    )
+
+    private fun simulate(state: SpringBoneState, steps: Int, jointWorld: Matrix4f = Matrix4f()): Quaternionf {
+        val rotation = Quaternionf()
+        repeat(steps) {
+            for (i in 0 until state.data.colliderCount) {
+                SpringBoneSolver.updateCollider(state, i, Matrix4f())
+            }
+            SpringBoneSolver.updateJoint(state, 0, 0, jointWorld, SpringBoneSolver.FIXED_TIME_STEP, rotation)
+            state.initialized = true
+        }
+        return rotation
+    }
+
+    private fun tail(state: SpringBoneState, index: Int = 0) = Vector3f(
+        state.currentTails[index * 3],
+        state.currentTails[index * 3 + 1],
+        state.currentTails[index * 3 + 2],
+    )
+
+    @Test
+    fun restPoseIsKeptWithoutForces() {
+        val state = SpringBoneState(singleJointData(stiffness = 1f))
+        val rotation = simulate(state, 120)
+        assertTrue(tail(state).equals(Vector3f(0f, 1f, 0f), 1e-5f))
+        assertTrue(rotation.equals(Quaternionf(), 1e-5f))
+    }
+
+    @Test
+    fun gravityPullsTailDown() {
+        val state = SpringBoneState(singleJointData(localTail = Vector3f(1f, 0f, 0f), gravityPower = 1f))
+        simulate(state, 600)
+        val tail = tail(state)
+        assertEquals(1f, tail.length(), 1e-4f)
+        assertTrue(tail.y < -0.9f, "Tail not hanging down: $tail")
+    }
+
+    @Test
+    fun tailIsPushedOutOfSphereCollider() {
+        val collider = SpringBoneData.Collider(
+            nodeIndex = 0,
+            offset = Vector3f(0.2f, 0.9f, 0f),
+            tail = null,
+            radius = 0.4f,
+        )
+        val state = SpringBoneState(singleJointData(stiffness = 1f, colliders = listOf(collider)))
+        simulate(state, 120)
+        val tail = tail(state)
+        assertEquals(1f, tail.length(), 1e-4f)
+        // Length constraint is applied after push out, so allow a small penetration
+        assertTrue(tail.distance(0.2f, 0.9f, 0f) >= 0.4f - 1e-3f, "Tail inside collider: $tail")
+        assertTrue(tail.x < -0.1f, "Tail not pushed aside: $tail")
+    }
+
+    @Test
+    fun simulationIsDeterministic() {
+        val jointWorld = Matrix4f().rotateZ(0.5f).translate(0.1f, 0.2f, 0.3f)
+        val first = SpringBoneState(singleJointData(stiffness = 0.5f, gravityPower = 0.8f))
+        val second = SpringBoneState(singleJointData(stiffness = 0.5f, gravityPower = 0.8f))
+        val firstRotation = simulate(first, 90, jointWorld)
+        val secondRotation = simulate(second, 90, jointWorld)
+        assertArrayEquals(first.currentTails, second.currentTails)
+        assertArrayEquals(first.prevTails, second.prevTails)
+        assertEquals(firstRotation, secondRotation)
+    }
+
+    @Test
+    fun advanceUsesFixedSteps() {
+        val state = SpringBoneState(singleJointData())
+        assertEquals(1, SpringBoneSolver.advance(state, 0f))
+        state.initialized = true
+        assertEquals(0, SpringBoneSolver.advance(state, SpringBoneSolver.FIXED_TIME_STEP * 0.5f))
+        assertEquals(1, SpringBoneSolver.advance(state, SpringBoneSolver.FIXED_TIME_STEP * 0.75f))
+        assertEquals(SpringBoneSolver.MAX_STEPS_PER_UPDATE, SpringBoneSolver.advance(state, 0.4f))
+        // Long pause resets the simulation
+        assertEquals(1, SpringBoneSolver.advance(state, 10f))
+        assertFalse(state.initialized)
+    }
+}
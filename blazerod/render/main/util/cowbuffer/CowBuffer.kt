@@ -2,6 +2,7 @@ package top.fifthlight.blazerod.util.cowbuffer
 
 import top.fifthlight.blazerod.api.refcount.AbstractRefCount
 import top.fifthlight.blazerod.api.refcount.RefCount
+import top.fifthlight.blazerod.debug.Metrics
 import top.fifthlight.blazerod.util.objectpool.ObjectPool
 
 /**
@@ -12,6 +13,7 @@ import top.fifthlight.blazerod.util.objectpool.ObjectPool
  */
 class CowBuffer<C : CowBuffer.Content<C>> private constructor() : AbstractRefCount() {
     companion object {
+        private val COPIES = Metrics.counter("cow_buffer.copies")
         private val POOL = ObjectPool<CowBuffer<*>>(
             identifier = "cow_buffer",
             create = ::CowBuffer,
@@ -50,6 +52,7 @@ class CowBuffer<C : CowBuffer.Content<C>> private constructor() : AbstractRefCou
             editor(content)
             return this
         } else {
+            COPIES.increment()
             val copy = content.copy()
             editor(copy)
             return acquire(copy)
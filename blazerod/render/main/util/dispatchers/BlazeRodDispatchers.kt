@@ -7,6 +7,10 @@ import top.fifthlight.blazerod.BlazeRod
 object BlazeRodDispatchers {
     val Main: CoroutineDispatcher
         get() = BlazeRod.mainDispatcher
+
+    // Render thread, but budgeted per frame
+    val Upload: CoroutineDispatcher
+        get() = UploadQueueDispatcher
 }
 
 val Dispatchers.BlazeRod
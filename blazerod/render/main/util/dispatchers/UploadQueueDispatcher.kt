@@ -0,0 +1,72 @@
+package top.fifthlight.blazerod.util.dispatchers
+
+import kotlinx.coroutines.CoroutineDispatcher
+import kotlinx.coroutines.Runnable
+import top.fifthlight.blazerod.BlazeRod
+import top.fifthlight.blazerod.debug.Metrics
+import java.util.concurrent.ConcurrentLinkedQueue
+import kotlin.coroutines.AbstractCoroutineContextElement
+import kotlin.coroutines.CoroutineContext
+
+/**
+ * Dispatcher for GPU resource uploads. Jobs are queued, and [drain] runs them on render thread once per frame, until
+ * [BlazeRod.uploadTimeBudgetNanos] or [BlazeRod.uploadByteBudget] is used up.
+ *
+ * Add [UploadSize] to the context of a job to account its bytes. Jobs should be small enough to fit in the budget, so
+ * split large uploads into chunks.
+ */
+object UploadQueueDispatcher : CoroutineDispatcher() {
+    /**
+     * Bytes uploaded by the job, counted against [BlazeRod.uploadByteBudget].
+     */
+    class UploadSize(val bytes: Long) : AbstractCoroutineContextElement(UploadSize) {
+        companion object Key : CoroutineContext.Key<UploadSize>
+    }
+
+    private class Job(
+        val bytes: Long,
+        val block: Runnable,
+    )
+
+    private val queue = ConcurrentLinkedQueue<Job>()
+    private val uploadedBytesCounter = Metrics.counter("upload_queue.bytes")
+    private val jobCounter = Metrics.counter("upload_queue.jobs")
+    private val pendingJobsGauge = Metrics.gauge("upload_queue.pending_jobs")
+
+    val pendingJobs
+        get() = queue.size
+
+    // Always queue, even on render thread, or the job won't be budgeted
+    override fun isDispatchNeeded(context: CoroutineContext) = true
+
+    override fun dispatch(context: CoroutineContext, block: Runnable) {
+        queue.add(Job(context[UploadSize]?.bytes ?: 0, block))
+    }
+
+    /**
+     * Run queued jobs within the budget. At least one job runs in every call, so uploads always make progress.
+     */
+    fun drain() {
+        val startTime = System.nanoTime()
+        var uploadedBytes = 0L
+        var jobCount = 0
+        while (true) {
+            val job = queue.peek() ?: break
+            if (jobCount > 0) {
+                if (System.nanoTime() - startTime >= BlazeRod.uploadTimeBudgetNanos) {
+                    break
+                }
+                if (uploadedBytes + job.bytes > BlazeRod.uploadByteBudget) {
+                    break
+                }
+            }
+            queue.poll()
+            job.block.run()
+            uploadedBytes += job.bytes
+            jobCount++
+        }
+        uploadedBytesCounter.add(uploadedBytes)
+        jobCounter.add(jobCount.toLong())
+        pendingJobsGauge.set(queue.size.toLong())
+    }
+}
@@ -0,0 +1,23 @@
+package top.fifthlight.blazerod.util.gpushaderpool
+
+import com.mojang.blaze3d.buffers.GpuFence
+import top.fifthlight.blazerod.debug.FrameProfiler
+import top.fifthlight.blazerod.debug.Metrics
+
+private val FENCE_STALLS = Metrics.counter("gpu_fence.stalls")
+private val FENCE_STALL_NANOS = Metrics.counter("gpu_fence.stall_ns")
+
+/**
+ * Wait until GPU passed the fence. Waits on fences not signaled yet are counted as stalls, as CPU is blocked by GPU.
+ */
+internal fun GpuFence.awaitBlocking() {
+    if (awaitCompletion(0)) {
+        return
+    }
+    FENCE_STALLS.increment()
+    val startTime = System.nanoTime()
+    FrameProfiler.span("fenceWait") {
+        awaitCompletion(Long.MAX_VALUE)
+    }
+    FENCE_STALL_NANOS.add(System.nanoTime() - startTime)
+}
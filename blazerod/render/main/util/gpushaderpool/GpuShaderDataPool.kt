@@ -5,6 +5,7 @@ import com.mojang.blaze3d.buffers.GpuBufferSlice
 import com.mojang.blaze3d.buffers.GpuFence
 import com.mojang.blaze3d.systems.RenderSystem
 import it.unimi.dsi.fastutil.ints.Int2ReferenceOpenHashMap
+import top.fifthlight.blazerod.debug.Metrics
 import top.fifthlight.blazerod.extension.*
 import top.fifthlight.blazerod.util.math.lcm
 import top.fifthlight.blazerod.util.math.roundUpToMultiple
@@ -14,41 +15,48 @@ import java.util.TreeSet
 import kotlin.collections.ArrayDeque
 
 sealed class GpuShaderDataPool(
+    name: String,
     protected val usage: Int,
     protected val extraUsage: Int,
 ) : AutoCloseable {
     companion object {
         @JvmStatic
         fun create(
+            name: String,
             usage: Int,
             extraUsage: Int,
             alignment: Int,
             supportSlicing: Boolean,
         ) = if (supportSlicing) {
             Sliced(
+                name = name,
                 usage = usage,
                 extraUsage = extraUsage,
                 alignment = alignment,
             )
         } else {
             Pooled(
+                name = name,
                 usage = usage,
                 extraUsage = extraUsage,
             )
         }
     }
 
+    protected val allocatedBytes = Metrics.counter("gpu_shader_data_pool.$name.bytes")
+
     abstract val supportSlicing: Boolean
 
     abstract fun allocate(size: Int): GpuBufferSlice
     abstract fun rotate()
 
     class Sliced(
+        name: String,
         usage: Int,
         extraUsage: Int,
         initialCapacity: Int = 512 * 1024,
         private val alignment: Int,
-    ) : GpuShaderDataPool(usage, extraUsage) {
+    ) : GpuShaderDataPool(name, usage, extraUsage) {
         override val supportSlicing: Boolean
             get() = true
 
@@ -74,6 +82,7 @@ sealed class GpuShaderDataPool(
 
         override fun allocate(size: Int): GpuBufferSlice {
             require(size > 0) { "Size must be positive" }
+            allocatedBytes.add(size.toLong())
             val buffer = buffer ?: run {
                 // Initialize a new buffer
                 capacity = maxOf(capacity, size)
@@ -118,9 +127,11 @@ sealed class GpuShaderDataPool(
     }
 
     class Pooled(
+        name: String,
         usage: Int,
         extraUsage: Int,
     ) : GpuShaderDataPool(
+        name = name,
         usage = usage,
         extraUsage = extraUsage,
     ) {
@@ -201,6 +212,7 @@ sealed class GpuShaderDataPool(
 
         override fun allocate(size: Int): GpuBufferSlice {
             require(size > 0) { "Size must be positive" }
+            allocatedBytes.add(size.toLong())
             val frameData =
                 allFrameData.get(currentFrame) ?: error("No frame data of frame $currentFrame, this should not happen!")
 
@@ -244,7 +256,7 @@ sealed class GpuShaderDataPool(
             while (waitingFrameData.size >= 3) {
                 val frameData = waitingFrameData.removeFirst()
                 frameData.fence?.use {
-                    it.awaitCompletion(Long.MAX_VALUE)
+                    it.awaitBlocking()
                     it.close()
                     frameData.fence = null
                 }
@@ -273,15 +285,17 @@ sealed class GpuShaderDataPool(
     }
 }
 
-fun GpuShaderDataPool.Companion.ofSsbo() = GpuShaderDataPool.create(
+fun GpuShaderDataPool.Companion.ofSsbo(name: String) = GpuShaderDataPool.create(
+    name = name,
     usage = 0,
     extraUsage = GpuBufferExt.EXTRA_USAGE_STORAGE_BUFFER,
     alignment = RenderSystem.getDevice().ssboOffsetAlignment,
     supportSlicing = true
 )
 
-fun GpuShaderDataPool.Companion.ofTbo() = RenderSystem.getDevice().let {
+fun GpuShaderDataPool.Companion.ofTbo(name: String) = RenderSystem.getDevice().let {
     GpuShaderDataPool.create(
+        name = name,
         usage = GpuBuffer.USAGE_UNIFORM_TEXEL_BUFFER,
         extraUsage = 0,
         alignment = if (it.supportTextureBufferSlice) {
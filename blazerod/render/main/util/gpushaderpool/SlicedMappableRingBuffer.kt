@@ -49,7 +49,8 @@ class SlicedMappableRingBuffer(
     fun getBlocking(): GpuBufferSlice {
         val fence = fences[current]
         if (fence != null) {
-            fence.awaitCompletion(Long.MAX_VALUE)
+            // Blocks if GPU is still reading the slice written BUFFER_COUNT frames ago
+            fence.awaitBlocking()
             fence.close()
             fences[current] = null
         }
@@ -1,6 +1,6 @@
 package top.fifthlight.blazerod.util.objectpool
 
-import top.fifthlight.blazerod.debug.ObjectPoolTracker
+import top.fifthlight.blazerod.debug.Metrics
 import java.util.*
 
 private val pools = Collections.synchronizedSet(mutableSetOf<Pool<*>>())
@@ -27,56 +27,43 @@ open class ObjectPool<T : Any>(
     protected var closed: Boolean = false
     protected val pool = ArrayDeque<T>()
 
+    // Hits are acquires served from the pool, misses are acquires creating new objects
+    private val hits = Metrics.counter("object_pool.$identifier.hits")
+    private val misses = Metrics.counter("object_pool.$identifier.misses")
+    private val failed = Metrics.counter("object_pool.$identifier.failed")
+    private val allocated = Metrics.gauge("object_pool.$identifier.allocated")
+    private val pooled = Metrics.gauge("object_pool.$identifier.pooled")
+
     override fun acquire(): T {
         require(!closed) { "Pool is closed" }
         return if (pool.isEmpty()) {
-            create().also {
-                ObjectPoolTracker.instance?.set(identifier) {
-                    copy(allocatedItem = allocatedItem + 1)
-                }
-            }
+            misses.increment()
+            create()
         } else {
-            ObjectPoolTracker.instance?.set(identifier) {
-                copy(
-                    allocatedItem = allocatedItem + 1,
-                    pooledItem = pooledItem - 1,
-                )
-            }
+            hits.increment()
+            pooled.add(-1)
             pool.removeFirst()
         }.also { obj ->
             try {
                 onAcquired?.invoke(obj)
             } catch (ex: Throwable) {
-                ObjectPoolTracker.instance?.set(identifier) {
-                    copy(
-                        allocatedItem = allocatedItem - 1,
-                        failedItem = failedItem + 1,
-                    )
-                }
+                failed.increment()
                 throw ex
             }
+            allocated.add(1)
         }
     }
 
     override fun release(obj: T) {
         require(!closed) { "Pool is closed" }
+        allocated.add(-1)
         try {
             onReleased?.invoke(obj)
         } catch (ex: Throwable) {
-            ObjectPoolTracker.instance?.set(identifier) {
-                copy(
-                    allocatedItem = allocatedItem - 1,
-                    failedItem = failedItem + 1,
-                )
-            }
+            failed.increment()
             throw ex
         }
-        ObjectPoolTracker.instance?.set(identifier) {
-            copy(
-                allocatedItem = allocatedItem - 1,
-                pooledItem = pooledItem + 1,
-            )
-        }
+        pooled.add(1)
         pool.addLast(obj)
     }
 
@@ -84,7 +71,7 @@ open class ObjectPool<T : Any>(
         if (closed) {
             return
         }
-        ObjectPoolTracker.instance?.set(identifier) { ObjectPoolTracker.Item() }
+        pooled.add(-pool.size.toLong())
         pool.forEach { onClosed?.invoke(it) }
         pool.clear()
         closed = true
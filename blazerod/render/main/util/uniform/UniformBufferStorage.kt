@@ -4,7 +4,7 @@ import com.mojang.blaze3d.buffers.GpuBuffer
 import com.mojang.blaze3d.buffers.GpuBufferSlice
 import com.mojang.blaze3d.systems.RenderSystem
 import org.slf4j.LoggerFactory
-import top.fifthlight.blazerod.debug.UniformBufferTracker
+import top.fifthlight.blazerod.debug.Metrics
 import top.fifthlight.blazerod.util.gpushaderpool.SlicedMappableRingBuffer
 import top.fifthlight.blazerod.util.math.roundUpToMultiple
 import java.nio.ByteBuffer
@@ -18,6 +18,7 @@ class UniformBufferStorage(
         private val LOGGER = LoggerFactory.getLogger(UniformBufferStorage::class.java)
     }
 
+    private val capacityGauge = Metrics.gauge("uniform_buffer.$name.capacity")
     private val oldBuffers = mutableListOf<SlicedMappableRingBuffer>()
     private var buffer: SlicedMappableRingBuffer
     private var size = 0
@@ -34,7 +35,7 @@ class UniformBufferStorage(
             size = realBlockSize * capacity,
             alignment = alignment,
         )
-        UniformBufferTracker.instance?.set(name, capacity)
+        capacityGauge.set(capacity.toLong())
     }
 
     /**
@@ -51,7 +52,7 @@ class UniformBufferStorage(
 
     private fun growBuffer(newCapacity: Int) {
         capacity = newCapacity
-        UniformBufferTracker.instance?.set(name, newCapacity)
+        capacityGauge.set(newCapacity.toLong())
         size = 0
         oldBuffers.add(buffer)
         buffer = SlicedMappableRingBuffer(
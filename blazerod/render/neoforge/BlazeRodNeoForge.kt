@@ -8,6 +8,9 @@ import net.neoforged.fml.ModContainer
 import net.neoforged.fml.common.EventBusSubscriber
 import net.neoforged.fml.common.Mod
 import net.neoforged.fml.event.lifecycle.FMLClientSetupEvent
+import net.neoforged.neoforge.client.event.ClientTickEvent
+import net.neoforged.neoforge.client.event.RegisterKeyMappingsEvent
+import net.neoforged.neoforge.client.event.RenderGuiEvent
 import net.neoforged.neoforge.client.event.lifecycle.ClientStoppingEvent
 import net.neoforged.neoforge.common.NeoForge
 import org.slf4j.LoggerFactory
@@ -16,6 +19,7 @@ import top.fifthlight.blazerod.debug.*
 import top.fifthlight.blazerod.runtime.resource.RenderTexture
 import top.fifthlight.blazerod.runtime.uniform.UniformBuffer
 import top.fifthlight.blazerod.util.dispatchers.ThreadExecutorDispatcher
+import top.fifthlight.blazerod.util.dispatchers.UploadQueueDispatcher
 import top.fifthlight.blazerod.util.objectpool.cleanupObjectPools
 import javax.swing.SwingUtilities
 
@@ -30,6 +34,18 @@ class BlazeRodNeoForge(private val container: ModContainer) {
         fun onClientSetup(event: FMLClientSetupEvent) {
             BlazeRod.mainDispatcher = ThreadExecutorDispatcher(MinecraftClient.getInstance())
 
+            System.getProperty("blazerod.upload.budget_ms")?.toDoubleOrNull()?.let {
+                BlazeRod.uploadTimeBudgetNanos = (it * 1_000_000).toLong()
+            }
+            System.getProperty("blazerod.upload.budget_mb")?.toDoubleOrNull()?.let {
+                BlazeRod.uploadByteBudget = (it * 1024 * 1024).toLong()
+            }
+
+            if (System.getProperty("blazerod.profiler") == "true") {
+                FrameProfiler.enabled = true
+            }
+            Metrics.loadProperties()
+
             // NeoForge initialize device before us, so no RenderEvents.INITIALIZE_DEVICE here
             event.enqueueWork {
                 // GO MAIN THREAD!
@@ -37,15 +53,11 @@ class BlazeRodNeoForge(private val container: ModContainer) {
                     BlazeRod.debug = true
                     RenderPassImpl.IS_DEVELOPMENT = true
                     if (System.getProperty("blazerod.debug.gui") == "true") {
-                        ResourceCountTracker.initialize()
-                        ObjectPoolTracker.initialize()
-                        UniformBufferTracker.initialize()
+                        Metrics.enabled = true
                         System.setProperty("java.awt.headless", "false")
                         SwingUtilities.invokeLater {
                             try {
-                                ResourceCountTrackerFrame().isVisible = true
-                                ObjectCountTrackerFrame().isVisible = true
-                                UniformBufferTrackerFrame().isVisible = true
+                                MetricsFrame().isVisible = true
                             } catch (ex: Exception) {
                                 LOGGER.info("Failed to show debug windows", ex)
                             }
@@ -58,15 +70,37 @@ class BlazeRodNeoForge(private val container: ModContainer) {
 
             RenderEvents.FLIP_FRAME.register {
                 UniformBuffer.clear()
+                FrameProfiler.span("upload") {
+                    UploadQueueDispatcher.drain()
+                }
+                FrameProfiler.endFrame()
+                Metrics.sample()
             }
 
             NeoForge.EVENT_BUS.register(object {
+                @SubscribeEvent
+                fun renderGui(event: RenderGuiEvent.Post) {
+                    FrameProfilerOverlay.render(event.guiGraphics)
+                }
+
+                @SubscribeEvent
+                fun clientTick(event: ClientTickEvent.Post) {
+                    FrameProfilerKeyBinding.tick()
+                }
+
                 @SubscribeEvent
                 fun clientStop(event: ClientStoppingEvent) {
+                    Metrics.exportToOutput()
                     cleanupObjectPools()
                     UniformBuffer.close()
                 }
             })
         }
+
+        @SubscribeEvent
+        @JvmStatic
+        fun onRegisterKeyMappings(event: RegisterKeyMappingsEvent) {
+            event.register(FrameProfilerKeyBinding.keyBinding)
+        }
     }
 }
@@ -14,9 +14,11 @@ import top.fifthlight.armorstand.state.ModelInstanceManager
 import top.fifthlight.armorstand.util.RendererManager
 import top.fifthlight.blazerod.api.render.ScheduledRenderer
 import top.fifthlight.blazerod.api.resource.CameraTransform
+import top.fifthlight.blazerod.api.resource.ModelInstance
 import top.fifthlight.blazerod.model.Camera
 import java.lang.ref.WeakReference
 import java.util.*
+import kotlin.math.sqrt
 
 object PlayerRenderer {
     private var renderingWorld = false
@@ -56,9 +58,23 @@ object PlayerRenderer {
 
     fun startRenderWorld() {
         renderingWorld = true
+        frameTime = System.nanoTime()
     }
 
     private val matrix = Matrix4f()
+    private var frameTime = 0L
+
+    // Players drawn in world, whose render data update is begun when appended and finished in executeDraw, so
+    // simulations of all players run in parallel with entity rendering
+    private class PendingDraw {
+        var instance: ModelInstance? = null
+        val modelMatrix = Matrix4f()
+        var light = 0
+        var overlay = 0
+    }
+
+    private val pendingDraws = mutableListOf<PendingDraw>()
+    private var pendingDrawCount = 0
 
     @JvmStatic
     fun updatePlayer(
@@ -66,13 +82,19 @@ object PlayerRenderer {
         state: PlayerEntityRenderState,
     ) {
         val uuid = player.uuid
-        val entry = ModelInstanceManager.get(uuid, System.nanoTime())
+        val client = MinecraftClient.getInstance()
+        val distanceSquared = player.squaredDistanceTo(client.gameRenderer.camera.pos)
+        val entry = ModelInstanceManager.get(uuid, System.nanoTime(), distance = sqrt(distanceSquared))
         if (entry !is ModelInstanceManager.ModelInstanceItem.Model) {
             return
         }
 
         val controller = entry.controller
         controller.update(uuid, player, state)
+
+        // Don't simulate physics for far away players
+        val physicsDistance = ConfigHolder.config.value.physicsDistance
+        entry.instance.physicsEnabled = uuid == client.player?.uuid || distanceSquared <= physicsDistance * physicsDistance
     }
 
     @JvmStatic
@@ -93,7 +115,33 @@ object PlayerRenderer {
         val instance = entry.instance
 
         controller.apply(uuid, instance, vanillaState)
-        instance.updateRenderData()
+
+        val currentRenderer = RendererManager.currentRenderer
+        if (!ArmorStandClient.instance.debugBone && currentRenderer is ScheduledRenderer<*, *> && renderingWorld) {
+            instance.beginUpdateRenderData(frameTime)
+            val pendingDraw = pendingDraws.getOrNull(pendingDrawCount) ?: PendingDraw().also { pendingDraws.add(it) }
+            pendingDrawCount++
+            instance.increaseReferenceCount()
+            pendingDraw.instance = instance
+
+            val backupItem = matrixStack.peek().copy()
+            matrixStack.pop()
+            matrixStack.push()
+            pendingDraw.modelMatrix.set(matrixStack.peek().positionMatrix)
+            pendingDraw.modelMatrix.scale(ConfigHolder.config.value.modelScale)
+            matrixStack.pop()
+            matrixStack.push()
+            matrixStack.peek().apply {
+                positionMatrix.set(backupItem.positionMatrix)
+                normalMatrix.set(backupItem.normalMatrix)
+            }
+
+            pendingDraw.light = light
+            pendingDraw.overlay = overlay
+            return true
+        }
+
+        instance.updateRenderData(if (renderingWorld) frameTime else System.nanoTime())
 
         val backupItem = matrixStack.peek().copy()
         matrixStack.pop()
@@ -104,22 +152,17 @@ object PlayerRenderer {
         } else {
             matrix.set(matrixStack.peek().positionMatrix)
             matrix.scale(ConfigHolder.config.value.modelScale)
-            val currentRenderer = RendererManager.currentRenderer
             val task = instance.createRenderTask(matrix, light, overlay)
-            if (currentRenderer is ScheduledRenderer<*, *> && renderingWorld) {
-                currentRenderer.schedule(task)
-            } else {
-                val mainTarget = MinecraftClient.getInstance().framebuffer
-                val colorFrameBuffer = RenderSystem.outputColorTextureOverride ?: mainTarget.colorAttachmentView!!
-                val depthFrameBuffer = RenderSystem.outputDepthTextureOverride ?: mainTarget.depthAttachmentView
-                currentRenderer.render(
-                    colorFrameBuffer = colorFrameBuffer,
-                    depthFrameBuffer = depthFrameBuffer,
-                    scene = instance.scene,
-                    task = task,
-                )
-                task.release()
-            }
+            val mainTarget = MinecraftClient.getInstance().framebuffer
+            val colorFrameBuffer = RenderSystem.outputColorTextureOverride ?: mainTarget.colorAttachmentView!!
+            val depthFrameBuffer = RenderSystem.outputDepthTextureOverride ?: mainTarget.depthAttachmentView
+            currentRenderer.render(
+                colorFrameBuffer = colorFrameBuffer,
+                depthFrameBuffer = depthFrameBuffer,
+                scene = instance.scene,
+                task = task,
+            )
+            task.release()
         }
 
         matrixStack.pop()
@@ -134,7 +177,22 @@ object PlayerRenderer {
     fun executeDraw() {
         renderingWorld = false
         val mainTarget = MinecraftClient.getInstance().framebuffer
-        RendererManager.currentRendererScheduled?.let { renderer ->
+        val scheduledRenderer = RendererManager.currentRendererScheduled
+        for (i in 0 until pendingDrawCount) {
+            val pendingDraw = pendingDraws[i]
+            val instance = pendingDraw.instance!!
+            pendingDraw.instance = null
+            instance.updateRenderData(frameTime)
+            val task = instance.createRenderTask(pendingDraw.modelMatrix, pendingDraw.light, pendingDraw.overlay)
+            if (scheduledRenderer != null) {
+                scheduledRenderer.schedule(task)
+            } else {
+                task.release()
+            }
+            instance.decreaseReferenceCount()
+        }
+        pendingDrawCount = 0
+        scheduledRenderer?.let { renderer ->
             val colorFrameBuffer = RenderSystem.outputColorTextureOverride ?: mainTarget.colorAttachmentView!!
             val depthFrameBuffer = RenderSystem.outputDepthTextureOverride ?: mainTarget.depthAttachmentView
             renderer.executeTasks(colorFrameBuffer, depthFrameBuffer)
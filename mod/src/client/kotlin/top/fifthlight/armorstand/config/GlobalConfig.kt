@@ -11,6 +11,7 @@ import kotlinx.serialization.json.decodeFromStream
 import kotlinx.serialization.json.encodeToStream
 import org.slf4j.LoggerFactory
 import top.fifthlight.armorstand.util.GameDirectoryGetter
+import top.fifthlight.armorstand.util.ModelComplexity
 import top.fifthlight.blazerod.api.render.Renderer
 import top.fifthlight.blazerod.api.render.RendererTypeHolderFactory
 import java.nio.file.InvalidPathException
@@ -28,6 +29,16 @@ data class GlobalConfig(
     val hidePlayerArmor: Boolean = false,
     val modelScale: Float = 1f,
     val thirdPersonDistanceScale: Float = 1f,
+    val physicsDistance: Float = 32f,
+    // Memory budget of loaded models, in MiB
+    val modelGpuMemoryBudget: Int = 1024,
+    val modelHeapMemoryBudget: Int = 512,
+    // Models of players announced within this distance are parsed ahead, in blocks. 0 to disable.
+    val modelPrefetchDistance: Int = 64,
+    // Other players' models over these limits are shown as vanilla players. 0 means unlimited.
+    // Vertex limit is in thousands, and texture memory limit is in MiB.
+    val otherModelVertexLimit: Int = 0,
+    val otherModelTextureMemoryLimit: Int = 0,
     val renderer: RendererKey = RendererKey.VERTEX_SHADER_TRANSFORM,
     val vmcUdpPort: Int = 9000,
 ) {
@@ -60,6 +71,13 @@ data class GlobalConfig(
         ),
     }
 
+    val otherModelComplexityLimit by lazy {
+        ModelComplexity.UNLIMITED.copy(
+            vertexCount = otherModelVertexLimit * 1000,
+            textureBytes = otherModelTextureMemoryLimit * 1024L * 1024L,
+        )
+    }
+
     val modelPath by lazy {
         try {
             model?.let { Path(it) }
@@ -12,12 +12,15 @@ import javax.swing.table.DefaultTableModel
 class ModelManagerDebugFrame : JFrame("Model Manager Status") {
     companion object {
         private const val NANOSECONDS_PER_SECOND = 1000000000L
+        private const val BYTES_PER_MEGABYTE = 1024.0 * 1024.0
+
+        private fun Long.toMegabytes() = "%.2f MiB".format(this / BYTES_PER_MEGABYTE)
     }
     private val itemTableItem = DefaultTableModel(
         arrayOf("UUID", "Status", "Last Access", "Time Left"), 0
     )
     private val modelTableItem = DefaultTableModel(
-        arrayOf("Path", "Status", "Is favorited"), 0
+        arrayOf("Path", "Status", "Is favorited", "VRAM", "Heap"), 0
     )
     private val itemTable = JTable(itemTableItem)
     private val modelTable = JTable(modelTableItem)
@@ -92,17 +95,18 @@ class ModelManagerDebugFrame : JFrame("Model Manager Status") {
 
         modelTableItem.rowCount = 0
         ModelInstanceManager.modelCaches.forEach { (path, item) ->
+            val cache = item.takeIf { it.isCompleted }?.getCompleted()
+            val memoryUsage = (cache as? ModelInstanceManager.ModelCache.Loaded)?.scene?.memoryUsage
             modelTableItem.addRow(arrayOf(
                 path,
-                if (item.isCompleted) {
-                    when (item.getCompleted()) {
-                        ModelInstanceManager.ModelCache.Failed -> "Failed"
-                        is ModelInstanceManager.ModelCache.Loaded -> "Loaded"
-                    }
-                } else {
-                    "Loading"
+                when (cache) {
+                    null -> "Loading"
+                    ModelInstanceManager.ModelCache.Failed -> "Failed"
+                    is ModelInstanceManager.ModelCache.Loaded -> "Loaded"
                 },
                 (path in ModelInstanceManager.favoriteModelPaths).toString(),
+                memoryUsage?.gpuBytes?.toMegabytes() ?: "N/A",
+                memoryUsage?.heapBytes?.toMegabytes() ?: "N/A",
             ))
         }
     }
@@ -1,8 +1,10 @@
 package top.fifthlight.armorstand.manage
 
+import top.fifthlight.armorstand.util.ModelHash
 import java.nio.file.Path
 
 data class AnimationItem(
     val path: Path,
-    val name: String
+    val name: String,
+    val hash: ModelHash,
 )
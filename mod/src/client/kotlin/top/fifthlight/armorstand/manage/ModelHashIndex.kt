@@ -0,0 +1,97 @@
+package top.fifthlight.armorstand.manage
+
+import top.fifthlight.armorstand.util.ModelHash
+import java.nio.file.Path
+import java.util.*
+
+/**
+ * In-memory index from model hash to model path, so resolving player models don't need to query the database.
+ *
+ * Files with the same hash are all indexed, and the smallest path is returned, so the result is stable between scans.
+ * All functions are thread-safe.
+ */
+class ModelHashIndex {
+    private val pathToHash = mutableMapOf<Path, ModelHash>()
+    private val hashToPaths = mutableMapOf<ModelHash, TreeSet<Path>>()
+
+    operator fun get(hash: ModelHash): Path? = synchronized(this) {
+        hashToPaths[hash]?.first()
+    }
+
+    val size
+        get() = synchronized(this) { pathToHash.size }
+
+    /**
+     * Return paths in [changes] already indexed with another hash, which are models edited in place.
+     */
+    fun editedPaths(changes: Map<Path, ModelHash?>): Set<Path> = synchronized(this) {
+        changes.filterTo(mutableMapOf()) { (path, hash) ->
+            val previousHash = pathToHash[path]
+            hash != null && previousHash != null && previousHash != hash
+        }.keys
+    }
+
+    // Records path of each touched hash before changing, to find out hashes whose path changed
+    private class ChangeTracker(private val index: ModelHashIndex) {
+        private val previousPaths = mutableMapOf<ModelHash, Path?>()
+
+        fun touch(hash: ModelHash) {
+            if (hash !in previousPaths) {
+                previousPaths[hash] = index.hashToPaths[hash]?.first()
+            }
+        }
+
+        fun changedHashes() = previousPaths
+            .filterTo(mutableMapOf()) { (hash, path) -> index.hashToPaths[hash]?.first() != path }
+            .keys
+    }
+
+    private fun remove(tracker: ChangeTracker, path: Path) {
+        val hash = pathToHash.remove(path) ?: return
+        tracker.touch(hash)
+        hashToPaths[hash]?.let { paths ->
+            paths.remove(path)
+            if (paths.isEmpty()) {
+                hashToPaths.remove(hash)
+            }
+        }
+    }
+
+    private fun put(tracker: ChangeTracker, path: Path, hash: ModelHash) {
+        if (pathToHash[path] == hash) {
+            return
+        }
+        remove(tracker, path)
+        tracker.touch(hash)
+        pathToHash[path] = hash
+        hashToPaths.getOrPut(hash, ::TreeSet).add(path)
+    }
+
+    /**
+     * Replace the index content with all models in [models], and return the hashes whose path changed.
+     */
+    fun replaceAll(models: Map<Path, ModelHash>): Set<ModelHash> = synchronized(this) {
+        val tracker = ChangeTracker(this)
+        pathToHash.keys.filter { it !in models }.forEach { remove(tracker, it) }
+        for ((path, hash) in models) {
+            put(tracker, path, hash)
+        }
+        tracker.changedHashes()
+    }
+
+    /**
+     * Apply changes of some models, where null hash means the model is removed, and return the hashes whose path
+     * changed.
+     */
+    fun update(changes: Map<Path, ModelHash?>): Set<ModelHash> = synchronized(this) {
+        val tracker = ChangeTracker(this)
+        for ((path, hash) in changes) {
+            if (hash == null) {
+                remove(tracker, path)
+            } else {
+                put(tracker, path, hash)
+            }
+        }
+        tracker.changedHashes()
+    }
+}
@@ -1,9 +1,11 @@
 package top.fifthlight.armorstand.manage
 
+import kotlinx.coroutines.flow.SharedFlow
 import kotlinx.coroutines.flow.StateFlow
 import top.fifthlight.armorstand.manage.database.DatabaseManager
 import top.fifthlight.armorstand.manage.model.ModelItem
 import top.fifthlight.armorstand.manage.model.ModelThumbnail
+import top.fifthlight.armorstand.util.ModelComplexity
 import top.fifthlight.armorstand.util.ModelHash
 import java.nio.file.Path
 import java.time.Instant
@@ -20,13 +22,31 @@ interface ModelManager {
     fun startWatching()
     fun stopWatching()
 
+    // Updated when model data changed, including each batch committed during a scan
     val lastUpdateTime: StateFlow<Instant?>
     fun scheduleScan(immediately: Boolean = false)
 
+    // Hashes whose model path changed, emitted after scans
+    val modelPathChanges: SharedFlow<Set<ModelHash>>
+
+    // Paths of models whose content changed, emitted after scans
+    val modelContentChanges: SharedFlow<Set<Path>>
+
+    // Hashes whose complexity is calculated, emitted some time after scans as models are parsed in background
+    val modelComplexityChanges: SharedFlow<Set<ModelHash>>
+
+    // Lookup from in-memory index, without touching the database
+    fun getModelPathByHash(hash: ModelHash): Path?
+
     suspend fun getTotalModels(search: String? = null): Int
     suspend fun getModelByPath(path: Path): ModelItem?
     suspend fun getModelByHash(hash: ModelHash): ModelItem?
+    // Cached by hash, only the first lookup of each hash queries the database
+    suspend fun getModelComplexity(hash: ModelHash): ModelComplexity?
     suspend fun getAnimations(): List<AnimationItem>
+
+    // Animations directly in the directory, relative to model directory
+    suspend fun getAnimationsInDirectory(directory: Path): List<AnimationItem>
     suspend fun getModelThumbnail(modelItem: ModelItem): ModelThumbnail
     suspend fun getModels(
         offset: Int,
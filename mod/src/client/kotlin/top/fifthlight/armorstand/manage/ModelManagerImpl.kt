@@ -1,11 +1,14 @@
 package top.fifthlight.armorstand.manage
 
 import kotlinx.coroutines.*
+import kotlinx.coroutines.channels.Channel
+import kotlinx.coroutines.flow.MutableSharedFlow
 import kotlinx.coroutines.flow.MutableStateFlow
 import org.slf4j.LoggerFactory
 import top.fifthlight.armorstand.ArmorStandClient
 import top.fifthlight.armorstand.manage.database.DatabaseManager
 import top.fifthlight.armorstand.manage.database.DatabaseManagerImpl
+import top.fifthlight.armorstand.manage.model.ModelCursor
 import top.fifthlight.armorstand.manage.model.ModelItem
 import top.fifthlight.armorstand.manage.model.ModelThumbnail
 import top.fifthlight.armorstand.manage.scan.FileHandler
@@ -18,6 +21,7 @@ import top.fifthlight.armorstand.manage.schema.SchemaManager
 import top.fifthlight.armorstand.manage.watch.ModelWatcher
 import top.fifthlight.armorstand.manage.watch.ModelWatcherImpl
 import top.fifthlight.armorstand.state.ModelInstanceManager
+import top.fifthlight.armorstand.util.ModelComplexity
 import top.fifthlight.armorstand.util.ModelHash
 import java.io.IOException
 import java.lang.AutoCloseable
@@ -26,6 +30,8 @@ import java.nio.file.Files
 import java.nio.file.Path
 import java.nio.file.Paths
 import java.time.Instant
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.atomic.AtomicInteger
 import kotlin.io.path.*
 
 class ModelManagerImpl(
@@ -37,9 +43,7 @@ class ModelManagerImpl(
     private val modelDir: Path = ModelManagerHolder.modelDir,
     private val fileHandler: FileHandler = ModelLoaderFileHandler,
     private val watcher: ModelWatcher = ModelWatcherImpl(modelDir) {
-        fileHandler.isModelFile(it) || fileHandler.isAnimationFile(
-            it
-        )
+        fileHandler.isFileToScan(it)
     },
     private val scanner: ModelScanner = ModelScannerImpl(modelDir, databaseManager),
 ) : ModelManager, AutoCloseable {
@@ -50,17 +54,105 @@ class ModelManagerImpl(
     private val databaseFile = modelDir.resolve("$databaseName.mv.db").toAbsolutePath()
 
     private val scope = CoroutineScope(SupervisorJob() + Dispatchers.Default)
+    private val hashIndex = ModelHashIndex()
+    override val modelPathChanges = MutableSharedFlow<Set<ModelHash>>(extraBufferCapacity = 16)
+    override val modelContentChanges = MutableSharedFlow<Set<Path>>(extraBufferCapacity = 16)
+    override val modelComplexityChanges = MutableSharedFlow<Set<ModelHash>>(extraBufferCapacity = 16)
+
+    // Complexity by hash, including unknown ones, so resolving player models don't need to query the database.
+    // Complexity only changes when calculated, which drops the entries of updated hashes.
+    private class CachedComplexity(val complexity: ModelComplexity?)
+
+    private val complexityGeneration = AtomicInteger()
+    private val complexityCache = ConcurrentHashMap<ModelHash, CachedComplexity>()
+
+    // Models to calculate complexity of, consumed one batch at a time so scans never wait for parsing
+    private val complexityQueue = Channel<Map<Path, ModelHash>>(Channel.UNLIMITED)
+
     private val scheduler = ScanScheduler(
-        onScan = {
-            scanner.scan(fileHandler)
+        onScan = { changedPaths ->
+            if (changedPaths == null) {
+                val models = scanner.scan(fileHandler) {
+                    // Let model lists show committed results while scanning
+                    notifyDataChanged(Instant.now())
+                }
+                val editedPaths = hashIndex.editedPaths(models)
+                updateHashIndex(models)
+                emitContentChanges(editedPaths)
+                complexityQueue.send(models)
+            } else {
+                val changes = scanner.scanChanged(fileHandler, changedPaths)
+                val editedPaths = hashIndex.editedPaths(changes)
+                emitPathChanges(hashIndex.update(changes))
+                emitContentChanges(editedPaths)
+                complexityQueue.send(buildMap {
+                    for ((path, hash) in changes) {
+                        hash?.let { put(path, it) }
+                    }
+                })
+            }
         }
     )
     override val lastUpdateTime = MutableStateFlow(scheduler.lastScanTime.value)
 
+    private data class ListingKey(
+        val search: String?,
+        val order: ModelManager.Order,
+        val ascend: Boolean,
+    )
+
+    // Query caches, dropped on every data change. Results of queries started before a change are not cached.
+    private val dataGeneration = AtomicInteger()
+    private val totalModelsCache = ConcurrentHashMap<String, Int>()
+
+    // Cursor of the row before each visited page offset, so paging to a neighbour page doesn't need OFFSET
+    private val pageCursors = ConcurrentHashMap<ListingKey, ConcurrentHashMap<Int, ModelCursor>>()
+
+    private fun notifyDataChanged(time: Instant?) {
+        dataGeneration.incrementAndGet()
+        totalModelsCache.clear()
+        pageCursors.clear()
+        lastUpdateTime.value = time
+    }
+
+    private suspend fun updateHashIndex(models: Map<Path, ModelHash>) = emitPathChanges(hashIndex.replaceAll(models))
+
+    private suspend fun emitPathChanges(changedHashes: Set<ModelHash>) {
+        if (changedHashes.isNotEmpty()) {
+            logger.debug("Model path of {} hashes changed", changedHashes.size)
+            modelPathChanges.emit(changedHashes)
+        }
+    }
+
+    private suspend fun emitContentChanges(editedPaths: Set<Path>) {
+        if (editedPaths.isNotEmpty()) {
+            logger.debug("Content of {} models changed", editedPaths.size)
+            modelContentChanges.emit(editedPaths)
+        }
+    }
+
     init {
         scope.launch {
             scheduler.lastScanTime.collect {
-                lastUpdateTime.value = it
+                notifyDataChanged(it)
+            }
+        }
+        scope.launch {
+            for (models in complexityQueue) {
+                val updatedHashes = try {
+                    scanner.updateComplexity(models)
+                } catch (ex: CancellationException) {
+                    throw ex
+                } catch (ex: Exception) {
+                    logger.warn("Failed to update model complexity", ex)
+                    continue
+                }
+                if (updatedHashes.isNotEmpty()) {
+                    complexityGeneration.incrementAndGet()
+                    updatedHashes.forEach(complexityCache::remove)
+                    logger.debug("Complexity of {} models calculated", updatedHashes.size)
+                    modelComplexityChanges.emit(updatedHashes)
+                }
             }
         }
 
@@ -96,6 +188,12 @@ class ModelManagerImpl(
                     throw IllegalStateException("Failed to recreate database, give up and crash!", ex)
                 }
             }
+            try {
+                // Fill the index from last session, so players can be resolved before the first scan finishes
+                updateHashIndex(databaseManager.transaction { modelRepository.findAllHashes() })
+            } catch (ex: Exception) {
+                logger.warn("Failed to load model hash index", ex)
+            }
             runCatching {
                 // On windows, set the database file as hidden.
                 // On other platforms, because the file name is start with dot, the file is already hidden.
@@ -153,9 +251,10 @@ class ModelManagerImpl(
     }
 
     override fun startWatching() {
-        watcher.start {
-            scheduleScan()
-        }
+        watcher.start(
+            onChanged = { path -> scheduler.scheduleScan(listOf(path)) },
+            onOverflow = { scheduleScan() },
+        )
     }
 
     override fun stopWatching() {
@@ -164,8 +263,17 @@ class ModelManagerImpl(
 
     override fun scheduleScan(immediately: Boolean) = scheduler.scheduleScan(immediately)
 
-    override suspend fun getTotalModels(search: String?) =
-        databaseManager.transaction { modelRepository.count(search) }
+    override suspend fun getTotalModels(search: String?): Int {
+        val search = search?.takeIf { it.isNotEmpty() }
+        val key = search ?: ""
+        totalModelsCache[key]?.let { return it }
+        val generation = dataGeneration.get()
+        val count = databaseManager.transaction { modelRepository.count(search) }
+        if (dataGeneration.get() == generation) {
+            totalModelsCache[key] = count
+        }
+        return count
+    }
 
     override suspend fun getModelByPath(path: Path): ModelItem? =
         databaseManager.transaction { modelRepository.findByPath(path.normalize().toString()) }
@@ -173,11 +281,27 @@ class ModelManagerImpl(
     override suspend fun getModelByHash(hash: ModelHash): ModelItem? =
         databaseManager.transaction { modelRepository.findByHash(hash) }
 
+    override fun getModelPathByHash(hash: ModelHash): Path? = hashIndex[hash]
+
+    override suspend fun getModelComplexity(hash: ModelHash): ModelComplexity? {
+        complexityCache[hash]?.let { return it.complexity }
+        val generation = complexityGeneration.get()
+        val complexity = databaseManager.transaction { complexityRepository.find(hash) }
+        if (complexityGeneration.get() == generation) {
+            complexityCache[hash] = CachedComplexity(complexity)
+        }
+        return complexity
+    }
+
     override suspend fun getAnimations(): List<AnimationItem> =
         databaseManager.transaction { animationRepository.findAll() }
 
-    override suspend fun getModelThumbnail(modelItem: ModelItem): ModelThumbnail =
-        databaseManager.transaction { thumbRepository.findEmbed(modelItem.hash) }
+    override suspend fun getAnimationsInDirectory(directory: Path): List<AnimationItem> =
+        databaseManager.transaction { animationRepository.findByDirectory(directory.normalize().toString()) }
+
+    override suspend fun getModelThumbnail(modelItem: ModelItem): ModelThumbnail = databaseManager.transaction {
+        thumbRepository.findScaled(modelItem.hash) ?: thumbRepository.findEmbed(modelItem.hash)
+    }
 
     override suspend fun getModels(
         offset: Int,
@@ -185,14 +309,26 @@ class ModelManagerImpl(
         search: String?,
         order: ModelManager.Order,
         ascend: Boolean,
-    ): List<ModelItem> = databaseManager.transaction {
-        modelRepository.findRange(
-            search = search,
-            order = order,
-            ascend = ascend,
-            limit = length,
-            offset = offset,
-        )
+    ): List<ModelItem> {
+        val key = ListingKey(search?.takeIf { it.isNotEmpty() }, order, ascend)
+        val cursor = pageCursors[key]?.get(offset)
+        val generation = dataGeneration.get()
+        val page = databaseManager.transaction {
+            modelRepository.findRange(
+                search = key.search,
+                order = order,
+                ascend = ascend,
+                limit = length,
+                offset = if (cursor != null) 0 else offset,
+                after = cursor,
+            )
+        }
+        page.last?.let { last ->
+            if (dataGeneration.get() == generation) {
+                pageCursors.computeIfAbsent(key) { ConcurrentHashMap() }[offset + page.items.size] = last
+            }
+        }
+        return page.items
     }
 
     override suspend fun setFavorite(path: Path, favorite: Boolean) = databaseManager.transaction {
@@ -201,7 +337,7 @@ class ModelManagerImpl(
             favorite = favorite,
             timeMillis = System.currentTimeMillis()
         )
-        lastUpdateTime.value = Instant.now()
+        notifyDataChanged(Instant.now())
     }
 
     override suspend fun getFavoriteModels(): List<ModelItem> =
@@ -10,10 +10,16 @@ interface TransactionScope {
     val animationRepository: AnimationRepository
     val favoriteRepository: FavoriteRepository
     val thumbRepository: ThumbnailRepository
+    val complexityRepository: ModelComplexityRepository
     val fileCacheRepository: FileCacheRepository
     val scanSessionRepository: ScanSessionRepository
 }
 
+interface WriteTransactionScope : TransactionScope {
+    // Commit changes made so far, so readers can see them before the transaction finishes
+    fun commit()
+}
+
 interface DatabaseManager {
     suspend fun start(
         driverClass: String,
@@ -24,4 +30,10 @@ interface DatabaseManager {
     suspend fun stop()
 
     suspend fun <T> transaction(block: suspend TransactionScope.() -> T): T
+
+    /**
+     * Run a long write transaction, like scanning, on a dedicated writer connection, so [transaction]s are not blocked
+     * by it.
+     */
+    suspend fun <T> writeTransaction(block: suspend WriteTransactionScope.() -> T): T
 }
\ No newline at end of file
@@ -18,9 +18,20 @@ class DatabaseManagerImpl : DatabaseManager {
         Thread(runnable, "Model database thread").apply { isDaemon = true }
     }.asCoroutineDispatcher()
 
+    private val writerDispatcher = Executors.newSingleThreadExecutor { runnable ->
+        Thread(runnable, "Model database writer thread").apply { isDaemon = true }
+    }.asCoroutineDispatcher()
+
     private var connection: Pair<Connection, TransactionScope>? = null
+    private var writerConnection: Pair<Connection, WriteTransactionScope>? = null
+
+    private class WriteTransactionScopeImpl(
+        connection: Connection,
+    ) : TransactionScopeImpl(connection), WriteTransactionScope {
+        override fun commit() = connection.commit()
+    }
 
-    private class TransactionScopeImpl(
+    private open class TransactionScopeImpl(
         override val connection: Connection,
     ) : TransactionScope {
         override val modelRepository by lazy {
@@ -39,6 +50,10 @@ class DatabaseManagerImpl : DatabaseManager {
             ThumbnailRepositoryImpl(connection)
         }
 
+        override val complexityRepository by lazy {
+            ModelComplexityRepositoryImpl(connection)
+        }
+
         override val fileCacheRepository by lazy {
             FileCacheRepositoryImpl(connection)
         }
@@ -54,10 +69,10 @@ class DatabaseManagerImpl : DatabaseManager {
         schemaManager: SchemaManager,
     ) = withContext(dispatcher) {
         Class.forName(driverClass)
-        val newConnection = DriverManager.getConnection(jdbcUrl).apply {
+        val newConnection = StatementCachingConnection(DriverManager.getConnection(jdbcUrl).apply {
             autoCommit = false
             isReadOnly = false
-        }
+        })
         connection = Pair(newConnection, TransactionScopeImpl(newConnection))
         logger.info("Opened model database")
         try {
@@ -71,12 +86,25 @@ class DatabaseManagerImpl : DatabaseManager {
             }
             throw ex
         }
+        newConnection.commit()
+        withContext(writerDispatcher) {
+            // H2 embedded database can be opened by multiple connections in the same process, with MVCC
+            val newWriterConnection = StatementCachingConnection(DriverManager.getConnection(jdbcUrl).apply {
+                autoCommit = false
+                isReadOnly = false
+            })
+            writerConnection = Pair(newWriterConnection, WriteTransactionScopeImpl(newWriterConnection))
+        }
     }
 
     override suspend fun stop() {
+        withContext(writerDispatcher) {
+            writerConnection?.first?.close()
+        }
         withContext(dispatcher) {
             connection?.first?.close()
         }
+        writerDispatcher.close()
         dispatcher.close()
         logger.info("Closed model database")
     }
@@ -85,19 +113,32 @@ class DatabaseManagerImpl : DatabaseManager {
         "Database connection is not initialized"
     }.let { (connection, scope) ->
         withContext(dispatcher) {
+            connection.runTransaction { block(scope) }
+        }
+    }
+
+    override suspend fun <T> writeTransaction(block: suspend WriteTransactionScope.() -> T) =
+        checkNotNull(writerConnection) {
+            "Database connection is not initialized"
+        }.let { (connection, scope) ->
+            withContext(writerDispatcher) {
+                connection.runTransaction { block(scope) }
+            }
+        }
+
+    private suspend fun <T> Connection.runTransaction(block: suspend () -> T): T {
+        try {
+            val result = block()
+            commit()
+            return result
+        } catch (ex: Exception) {
             try {
-                val result = block(scope)
-                connection.commit()
-                result
-            } catch (ex: Exception) {
-                try {
-                    connection.rollback()
-                } catch (rollbackEx: Exception) {
-                    rollbackEx.addSuppressed(ex)
-                    throw rollbackEx
-                }
-                throw ex
+                rollback()
+            } catch (rollbackEx: Exception) {
+                rollbackEx.addSuppressed(ex)
+                throw rollbackEx
             }
+            throw ex
         }
     }
 }
@@ -0,0 +1,77 @@
+package top.fifthlight.armorstand.manage.database
+
+import java.sql.Connection
+import java.sql.PreparedStatement
+
+/**
+ * Connection reusing prepared statements by SQL, so repositories can prepare and close statements on every call
+ * without parsing the SQL again. Closing a statement from [prepareStatement] returns it to the cache.
+ *
+ * Not thread safe, like the connections of [DatabaseManagerImpl], which are only used by their own thread.
+ */
+class StatementCachingConnection(
+    private val delegate: Connection,
+    // Statements of the same SQL can be open at the same time, e.g. queries in a loop of results
+    private val maxIdlePerSql: Int = 4,
+) : Connection by delegate {
+    private val idleStatements = HashMap<String, ArrayDeque<CachedStatement>>()
+
+    var preparedStatements = 0
+        private set
+    var reusedStatements = 0
+        private set
+
+    private inner class CachedStatement(
+        val sql: String,
+        val statement: PreparedStatement,
+    ) : PreparedStatement by statement {
+        var released = false
+
+        override fun isClosed() = released || statement.isClosed
+
+        override fun close() {
+            if (released) {
+                return
+            }
+            released = true
+            release(this)
+        }
+    }
+
+    private fun release(cached: CachedStatement) {
+        val statement = cached.statement
+        val idle = idleStatements.getOrPut(cached.sql) { ArrayDeque() }
+        if (statement.isClosed || idle.size >= maxIdlePerSql) {
+            statement.close()
+            return
+        }
+        try {
+            statement.clearParameters()
+            statement.clearBatch()
+        } catch (ex: Exception) {
+            statement.close()
+            throw ex
+        }
+        idle.addLast(cached)
+    }
+
+    override fun prepareStatement(sql: String): PreparedStatement {
+        idleStatements[sql]?.removeLastOrNull()?.let { cached ->
+            cached.released = false
+            reusedStatements++
+            return cached
+        }
+        preparedStatements++
+        return CachedStatement(sql, delegate.prepareStatement(sql))
+    }
+
+    override fun close() {
+        for (idle in idleStatements.values) {
+            for (cached in idle) {
+                cached.statement.close()
+            }
+        }
+        idleStatements.clear()
+        delegate.close()
+    }
+}
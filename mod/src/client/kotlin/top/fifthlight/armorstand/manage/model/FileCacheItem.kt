@@ -0,0 +1,11 @@
+package top.fifthlight.armorstand.manage.model
+
+data class FileCacheItem(
+    val lastChanged: Long,
+    // -1 if unknown
+    val size: Long,
+    val fileKey: String?,
+    // CRC32C of content, null if unknown
+    val fingerprint: Long?,
+    val sha256: ByteArray,
+)
@@ -0,0 +1,16 @@
+package top.fifthlight.armorstand.manage.model
+
+// Sort key of a model row, to continue a listing after it without skipping over previous rows
+data class ModelCursor(
+    // null if the model is not favorite
+    val favoriteAt: Long?,
+    val name: String,
+    val lastChanged: Long,
+    val path: String,
+)
+
+data class ModelPage(
+    val items: List<ModelItem>,
+    // Cursor of the last item, null if the page is empty
+    val last: ModelCursor?,
+)
@@ -15,4 +15,11 @@ sealed class ModelThumbnail {
         val length: Long,
         val type: Texture.TextureType? = null,
     ) : ModelThumbnail()
+
+    // Small copy of the thumbnail made while scanning, encoded as PNG
+    class Scaled(
+        val width: Int,
+        val height: Int,
+        val data: ByteArray,
+    ) : ModelThumbnail()
 }
\ No newline at end of file
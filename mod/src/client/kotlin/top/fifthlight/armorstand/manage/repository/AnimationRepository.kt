@@ -7,4 +7,10 @@ interface AnimationRepository {
     fun upsert(path: String, name: String, lastChanged: Long, sha256: ModelHash)
     fun exists(path: String): Boolean
     fun findAll(): List<AnimationItem>
+
+    // Animations directly in the directory at path, empty path for the root directory
+    fun findByDirectory(directory: String): List<AnimationItem>
+
+    // Delete the animation at path, or all animations in the directory at path
+    fun deleteUnder(path: String)
 }
\ No newline at end of file
@@ -5,15 +5,18 @@ import top.fifthlight.armorstand.util.ModelHash
 import top.fifthlight.armorstand.util.bind
 import top.fifthlight.armorstand.util.exists
 import top.fifthlight.armorstand.util.mapExecuted
+import java.io.File
 import java.nio.file.Path
 import java.sql.Connection
+import java.sql.ResultSet
 
 class AnimationRepositoryImpl(private val conn: Connection) : AnimationRepository {
     override fun upsert(path: String, name: String, lastChanged: Long, sha256: ModelHash) {
         conn.prepareStatement(
-            "MERGE INTO animation(path, name, lastChanged, sha256) KEY(path) VALUES(?, ?, ?, ?)"
+            "MERGE INTO animation(path, directory, name, lastChanged, sha256) KEY(path) VALUES(?, ?, ?, ?, ?)"
         ).bind {
             string(path)
+            string(Path.of(path).parent?.toString() ?: "")
             string(name)
             long(lastChanged)
             bytes(sha256.hash)
@@ -27,11 +30,34 @@ class AnimationRepositoryImpl(private val conn: Connection) : AnimationRepositor
             string(path)
         }.exists()
 
+    private fun ResultSet.toAnimationItem() = AnimationItem(
+        path = Path.of(getString(1)).normalize(),
+        name = getString(2),
+        hash = ModelHash(getBytes(3)),
+    )
+
     override fun findAll(): List<AnimationItem> =
-        conn.prepareStatement("SELECT path, name FROM animation").mapExecuted {
-            AnimationItem(
-                path = Path.of(getString(1)).normalize(),
-                name = getString(2)
-            )
+        conn.prepareStatement("SELECT path, name, sha256 FROM animation").mapExecuted {
+            toAnimationItem()
+        }
+
+    override fun findByDirectory(directory: String): List<AnimationItem> =
+        conn.prepareStatement("SELECT path, name, sha256 FROM animation WHERE directory = ?").bind {
+            string(directory)
+        }.mapExecuted {
+            toAnimationItem()
         }
+
+    override fun deleteUnder(path: String) {
+        val directoryPrefix = path + File.separator
+        conn.prepareStatement(
+            "DELETE FROM animation WHERE path = ? OR LEFT(path, ?) = ?"
+        ).bind {
+            string(path)
+            int(directoryPrefix.length)
+            string(directoryPrefix)
+        }.use {
+            it.executeUpdate()
+        }
+    }
 }
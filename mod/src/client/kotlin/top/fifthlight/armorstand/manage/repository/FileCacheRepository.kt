@@ -1,6 +1,13 @@
 package top.fifthlight.armorstand.manage.repository
 
+import top.fifthlight.armorstand.manage.model.FileCacheItem
+
 interface FileCacheRepository {
     fun findSha256(path: String, lastChanged: Long): ByteArray?
+    fun find(path: String): FileCacheItem?
     fun upsertCache(path: String, lastChanged: Long, sha256: ByteArray)
+    fun upsertCache(path: String, lastChanged: Long, size: Long, fileKey: String?, fingerprint: Long, sha256: ByteArray)
+
+    // Delete the cache of file at path, or all files in the directory at path
+    fun deleteUnder(path: String)
 }
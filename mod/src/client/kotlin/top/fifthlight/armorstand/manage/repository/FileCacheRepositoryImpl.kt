@@ -1,7 +1,9 @@
 package top.fifthlight.armorstand.manage.repository
 
+import top.fifthlight.armorstand.manage.model.FileCacheItem
 import top.fifthlight.armorstand.util.bind
 import top.fifthlight.armorstand.util.firstExecuted
+import java.io.File
 import java.sql.Connection
 
 class FileCacheRepositoryImpl(private val conn: Connection) : FileCacheRepository {
@@ -15,15 +17,71 @@ class FileCacheRepositoryImpl(private val conn: Connection) : FileCacheRepositor
             getBytes(1)
         }
 
+    override fun find(path: String): FileCacheItem? =
+        conn.prepareStatement(
+            "SELECT lastChanged, size, fileKey, fingerprint, sha256 FROM file WHERE path = ? LIMIT 1"
+        ).bind {
+            string(path)
+        }.firstExecuted {
+            FileCacheItem(
+                lastChanged = getLong(1),
+                size = getLong(2),
+                fileKey = getString(3),
+                fingerprint = getLong(4).takeUnless { wasNull() },
+                sha256 = getBytes(5),
+            )
+        }
+
     override fun upsertCache(path: String, lastChanged: Long, sha256: ByteArray) {
         conn.prepareStatement(
-            "MERGE INTO file(path, lastChanged, sha256) KEY(path) VALUES(?, ?, ?)"
+            """
+            MERGE INTO file(path, lastChanged, size, fileKey, fingerprint, sha256)
+            KEY(path) VALUES(?, ?, -1, NULL, NULL, ?)
+            """.trimIndent()
+        ).bind {
+            string(path)
+            long(lastChanged)
+            bytes(sha256)
+        }.use {
+            it.executeUpdate()
+        }
+    }
+
+    override fun upsertCache(
+        path: String,
+        lastChanged: Long,
+        size: Long,
+        fileKey: String?,
+        fingerprint: Long,
+        sha256: ByteArray,
+    ) {
+        conn.prepareStatement(
+            """
+            MERGE INTO file(path, lastChanged, size, fileKey, fingerprint, sha256)
+            KEY(path) VALUES(?, ?, ?, ?, ?, ?)
+            """.trimIndent()
         ).bind {
             string(path)
             long(lastChanged)
+            long(size)
+            string(fileKey)
+            long(fingerprint)
             bytes(sha256)
         }.use {
             it.executeUpdate()
         }
     }
+
+    override fun deleteUnder(path: String) {
+        val directoryPrefix = path + File.separator
+        conn.prepareStatement(
+            "DELETE FROM file WHERE path = ? OR LEFT(path, ?) = ?"
+        ).bind {
+            string(path)
+            int(directoryPrefix.length)
+            string(directoryPrefix)
+        }.use {
+            it.executeUpdate()
+        }
+    }
 }
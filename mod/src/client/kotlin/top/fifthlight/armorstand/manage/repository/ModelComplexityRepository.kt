@@ -0,0 +1,10 @@
+package top.fifthlight.armorstand.manage.repository
+
+import top.fifthlight.armorstand.util.ModelComplexity
+import top.fifthlight.armorstand.util.ModelHash
+
+interface ModelComplexityRepository {
+    fun exists(sha256: ModelHash): Boolean
+    fun upsert(sha256: ModelHash, complexity: ModelComplexity)
+    fun find(sha256: ModelHash): ModelComplexity?
+}
@@ -0,0 +1,51 @@
+package top.fifthlight.armorstand.manage.repository
+
+import top.fifthlight.armorstand.util.ModelComplexity
+import top.fifthlight.armorstand.util.ModelHash
+import top.fifthlight.armorstand.util.bind
+import top.fifthlight.armorstand.util.exists
+import top.fifthlight.armorstand.util.firstExecuted
+import java.sql.Connection
+
+class ModelComplexityRepositoryImpl(private val conn: Connection) : ModelComplexityRepository {
+    override fun exists(sha256: ModelHash): Boolean =
+        conn.prepareStatement("SELECT 1 FROM model_complexity WHERE sha256 = ? LIMIT 1").bind {
+            bytes(sha256.hash)
+        }.exists()
+
+    override fun upsert(sha256: ModelHash, complexity: ModelComplexity) {
+        conn.prepareStatement(
+            """
+            MERGE INTO model_complexity(sha256, vertexCount, primitiveCount, jointCount, morphTargetCount, textureBytes)
+            KEY(sha256) VALUES(?, ?, ?, ?, ?, ?)
+            """.trimIndent()
+        ).bind {
+            bytes(sha256.hash)
+            int(complexity.vertexCount)
+            int(complexity.primitiveCount)
+            int(complexity.jointCount)
+            int(complexity.morphTargetCount)
+            long(complexity.textureBytes)
+        }.use {
+            it.executeUpdate()
+        }
+    }
+
+    override fun find(sha256: ModelHash): ModelComplexity? =
+        conn.prepareStatement(
+            """
+            SELECT vertexCount, primitiveCount, jointCount, morphTargetCount, textureBytes
+            FROM model_complexity WHERE sha256 = ? LIMIT 1
+            """.trimIndent()
+        ).bind {
+            bytes(sha256.hash)
+        }.firstExecuted {
+            ModelComplexity(
+                vertexCount = getInt(1),
+                primitiveCount = getInt(2),
+                jointCount = getInt(3),
+                morphTargetCount = getInt(4),
+                textureBytes = getLong(5),
+            )
+        }
+}
@@ -1,8 +1,11 @@
 package top.fifthlight.armorstand.manage.repository
 
 import top.fifthlight.armorstand.manage.ModelManager
+import top.fifthlight.armorstand.manage.model.ModelCursor
 import top.fifthlight.armorstand.manage.model.ModelItem
+import top.fifthlight.armorstand.manage.model.ModelPage
 import top.fifthlight.armorstand.util.ModelHash
+import java.nio.file.Path
 
 interface ModelRepository {
     fun upsert(path: String, name: String, lastChanged: Long, sha256: ModelHash)
@@ -14,9 +17,15 @@ interface ModelRepository {
         ascend: Boolean,
         limit: Int,
         offset: Int,
-    ): List<ModelItem>
+        // Continue after this row, so previous rows don't need to be skipped with offset
+        after: ModelCursor? = null,
+    ): ModelPage
 
     fun findByPath(path: String): ModelItem?
     fun findByHash(hash: ModelHash): ModelItem?
+    fun findAllHashes(): Map<Path, ModelHash>
     fun exists(path: String, hash: ModelHash): Boolean
+
+    // Delete the model at path, or all models in the directory at path, and return deleted paths
+    fun deleteUnder(path: String): List<String>
 }
\ No newline at end of file
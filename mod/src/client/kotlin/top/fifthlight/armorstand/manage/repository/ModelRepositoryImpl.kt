@@ -1,23 +1,46 @@
 package top.fifthlight.armorstand.manage.repository
 
 import top.fifthlight.armorstand.manage.ModelManager
+import top.fifthlight.armorstand.manage.model.ModelCursor
 import top.fifthlight.armorstand.manage.model.ModelItem
+import top.fifthlight.armorstand.manage.model.ModelPage
 import top.fifthlight.armorstand.util.*
+import java.io.File
 import java.nio.file.Path
 import java.sql.Connection
 
 class ModelRepositoryImpl(private val conn: Connection) : ModelRepository {
     override fun upsert(path: String, name: String, lastChanged: Long, sha256: ModelHash) {
+        val searchName = name.lowercase()
         conn.prepareStatement(
-            "MERGE INTO model(path, name, lastChanged, sha256) KEY(path) VALUES(?, ?, ?, ?)"
+            "MERGE INTO model(path, name, searchName, lastChanged, sha256) KEY(path) VALUES(?, ?, ?, ?, ?)"
         ).bind {
             string(path)
             string(name)
+            string(searchName)
             long(lastChanged)
             bytes(sha256.hash)
         }.use { ps ->
             ps.executeUpdate()
         }
+        conn.prepareStatement("DELETE FROM model_name_trigram WHERE path = ?").bind {
+            string(path)
+        }.use { ps ->
+            ps.executeUpdate()
+        }
+        val trigrams = trigrams(searchName)
+        if (trigrams.isNotEmpty()) {
+            conn.prepareStatement("INSERT INTO model_name_trigram(trigram, path) VALUES(?, ?)").use { ps ->
+                for (trigram in trigrams) {
+                    ps.bind {
+                        string(trigram)
+                        string(path)
+                    }
+                    ps.addBatch()
+                }
+                ps.executeBatch()
+            }
+        }
     }
 
     override fun exists(path: String): Boolean =
@@ -27,72 +50,233 @@ class ModelRepositoryImpl(private val conn: Connection) : ModelRepository {
             ps.executeQuery().use { it.next() }
         }
 
+    private fun trigrams(searchName: String) = searchName.windowed(3).distinct()
+
+    // Substring match on the lowercased name. Terms of at least three characters are narrowed down with the
+    // trigram index first, so the cost depends on number of candidates instead of number of models.
+    private fun searchCondition(search: String): String {
+        val trigrams = trigrams(search.lowercase())
+        val locate = "LOCATE(?, m.searchName) > 0"
+        if (trigrams.isEmpty()) {
+            return locate
+        }
+        return """
+            m.path IN (
+                SELECT t.path FROM model_name_trigram t
+                WHERE t.trigram IN (${trigrams.joinToString(", ") { "?" }})
+                GROUP BY t.path
+                HAVING COUNT(*) = ?
+            ) AND $locate
+        """.trimIndent()
+    }
+
+    private fun ParamBinderScope.searchParams(search: String) {
+        val searchName = search.lowercase()
+        val trigrams = trigrams(searchName)
+        if (trigrams.isNotEmpty()) {
+            trigrams.forEach { string(it) }
+            int(trigrams.size)
+        }
+        string(searchName)
+    }
+
     override fun count(search: String?): Int =
         conn.prepareStatement(
             if (search == null) {
                 "SELECT COUNT(*) FROM model"
             } else {
-                "SELECT COUNT(*) FROM model WHERE LOCATE(LOWER(?),LOWER(name))>0"
+                "SELECT COUNT(*) FROM model m WHERE ${searchCondition(search)}"
             }
         ).bind {
             if (search != null) {
-                string(search)
+                searchParams(search)
             }
         }.withExecuted {
             next()
             getInt(1)
         }
 
-    override fun findRange(
+    // Columns of the sort key inside a section, in order
+    private class SortKey(
+        val expression: String,
+        val ascend: Boolean,
+        val value: ParamBinderScope.() -> Unit,
+    )
+
+    private fun sortKeys(
+        order: ModelManager.Order,
+        ascend: Boolean,
+        favorite: Boolean,
+        cursor: ModelCursor?,
+    ) = buildList {
+        if (favorite) {
+            // Newest favorite first
+            add(SortKey("f.favorite_at", false) {
+                long(cursor?.favoriteAt ?: 0)
+            })
+        }
+        add(
+            when (order) {
+                ModelManager.Order.NAME -> SortKey("m.name", ascend) {
+                    string(cursor?.name)
+                }
+
+                ModelManager.Order.LAST_CHANGED -> SortKey("m.lastChanged", ascend) {
+                    long(cursor?.lastChanged ?: 0)
+                }
+            }
+        )
+        // Path is unique, so rows with same name or time still have a stable order
+        add(SortKey("m.path", ascend) {
+            string(cursor?.path)
+        })
+    }
+
+    // One section of the listing: the favorite models or the other ones. Keeping them in separate queries lets the
+    // keyset condition and ordering run on idx_favorite_favorite_at, idx_model_name_path or idx_model_lastChanged_path.
+    private fun findSection(
         search: String?,
         order: ModelManager.Order,
         ascend: Boolean,
+        favorite: Boolean,
         limit: Int,
         offset: Int,
-    ): List<ModelItem> {
-        val sortDirection = if (ascend) {
-            "ASC"
-        } else {
-            "DESC"
-        }
-        val orderColumn = when (order) {
-            ModelManager.Order.NAME -> "m.name"
-            ModelManager.Order.LAST_CHANGED -> "m.lastChanged"
+        after: ModelCursor?,
+    ): List<Pair<ModelItem, ModelCursor>> {
+        val sortKeys = sortKeys(order, ascend, favorite, after)
+        val conditions = buildList {
+            if (!favorite) {
+                add("NOT EXISTS (SELECT 1 FROM favorite f WHERE f.path = m.path)")
+            }
+            if (search != null) {
+                add(searchCondition(search))
+            }
+            if (after != null) {
+                // (k0 > c0) OR (k0 = c0 AND k1 > c1) OR ..., with the comparison flipped for descending keys
+                add(sortKeys.indices.joinToString(" OR ", prefix = "(", postfix = ")") { index ->
+                    val key = sortKeys[index]
+                    val equals = sortKeys.subList(0, index).map { "${it.expression} = ?" }
+                    val compare = "${key.expression} ${if (key.ascend) ">" else "<"} ?"
+                    (equals + compare).joinToString(" AND ", prefix = "(", postfix = ")")
+                })
+            }
         }
-        val where = if (search == null) {
+        val where = if (conditions.isEmpty()) {
             ""
         } else {
-            "WHERE LOCATE(LOWER(?), LOWER(m.name)) > 0"
+            conditions.joinToString(" AND ", prefix = "WHERE ")
+        }
+        val orderBy = sortKeys.joinToString(", ") { key ->
+            "${key.expression} ${if (key.ascend) "ASC" else "DESC"}"
         }
-        val sql = """
-            SELECT m.path, m.name, m.lastChanged, m.sha256, f.path IS NOT NULL
+        val sql = if (favorite) {
+            """
+            SELECT m.path, m.name, m.lastChanged, m.sha256, f.favorite_at
+            FROM favorite f
+                JOIN model m ON m.path = f.path
+            $where
+            ORDER BY $orderBy
+            LIMIT ? OFFSET ?
+            """.trimIndent()
+        } else {
+            """
+            SELECT m.path, m.name, m.lastChanged, m.sha256, NULL
             FROM model m
-                LEFT JOIN favorite f ON m.path = f.path
             $where
-            ORDER BY
-                CASE WHEN f.path IS NOT NULL THEN 0 ELSE 1 END,
-                CASE WHEN f.path IS NOT NULL THEN f.favorite_at END DESC,
-                $orderColumn $sortDirection
+            ORDER BY $orderBy
             LIMIT ? OFFSET ?
-        """.trimIndent()
+            """.trimIndent()
+        }
 
         return conn.prepareStatement(sql).bind {
             if (search != null) {
-                string(search)
+                searchParams(search)
+            }
+            if (after != null) {
+                for (index in sortKeys.indices) {
+                    for (key in sortKeys.subList(0, index + 1)) {
+                        key.value(this)
+                    }
+                }
             }
             int(limit)
             int(offset)
         }.mapExecuted {
-            ModelItem(
-                path = Path.of(getString(1)).normalize(),
+            val path = getString(1)
+            val favoriteAt = getLong(5).takeUnless { wasNull() }
+            val item = ModelItem(
+                path = Path.of(path).normalize(),
                 name = getString(2),
                 lastChanged = getLong(3),
                 hash = ModelHash(getBytes(4)),
-                favorite = getBoolean(5),
+                favorite = favorite,
+            )
+            Pair(
+                item,
+                ModelCursor(
+                    favoriteAt = favoriteAt,
+                    name = item.name,
+                    lastChanged = item.lastChanged,
+                    path = path,
+                ),
             )
         }
     }
 
+    private fun countFavorites(search: String?): Int = conn.prepareStatement(
+        buildString {
+            append("SELECT COUNT(*) FROM favorite f JOIN model m ON m.path = f.path")
+            if (search != null) {
+                append(" WHERE ")
+                append(searchCondition(search))
+            }
+        }
+    ).bind {
+        if (search != null) {
+            searchParams(search)
+        }
+    }.withExecuted {
+        next()
+        getInt(1)
+    }
+
+    override fun findRange(
+        search: String?,
+        order: ModelManager.Order,
+        ascend: Boolean,
+        limit: Int,
+        offset: Int,
+        after: ModelCursor?,
+    ): ModelPage {
+        // Favorite models come first, so a cursor on a non-favorite model has passed all of them
+        val inFavorites = after == null || after.favoriteAt != null
+        val favorites = if (inFavorites) {
+            findSection(search, order, ascend, favorite = true, limit = limit, offset = offset, after = after)
+        } else {
+            listOf()
+        }
+        val rows = if (favorites.size < limit) {
+            val othersOffset = when {
+                !inFavorites || offset == 0 -> offset
+                favorites.isNotEmpty() -> 0
+                // The offset skipped past some or all favorites, continue with what's left of it
+                else -> (offset - countFavorites(search)).coerceAtLeast(0)
+            }
+            favorites + findSection(
+                search = search,
+                order = order,
+                ascend = ascend,
+                favorite = false,
+                limit = limit - favorites.size,
+                offset = othersOffset,
+                after = after?.takeIf { !inFavorites },
+            )
+        } else {
+            favorites
+        }
+        return ModelPage(rows.map { it.first }, rows.lastOrNull()?.second)
+    }
+
     override fun findByPath(path: String): ModelItem? = conn.prepareStatement(
         """
         SELECT m.path, m.name, m.lastChanged, m.sha256, f.path IS NOT NULL
@@ -131,10 +315,39 @@ class ModelRepositoryImpl(private val conn: Connection) : ModelRepository {
         )
     }
 
+    override fun findAllHashes(): Map<Path, ModelHash> = conn.prepareStatement(
+        "SELECT path, sha256 FROM model"
+    ).mapExecuted {
+        Pair(Path.of(getString(1)).normalize(), ModelHash(getBytes(2)))
+    }.toMap()
+
     override fun exists(path: String, hash: ModelHash) = conn.prepareStatement(
         "SELECT 1 FROM model WHERE path = ? and sha256 = ?"
     ).bind {
         string(path)
         bytes(hash.hash)
     }.exists()
+
+    override fun deleteUnder(path: String): List<String> {
+        val directoryPrefix = path + File.separator
+        val paths = conn.prepareStatement(
+            "SELECT path FROM model WHERE path = ? OR LEFT(path, ?) = ?"
+        ).bind {
+            string(path)
+            int(directoryPrefix.length)
+            string(directoryPrefix)
+        }.mapExecuted {
+            getString(1)
+        }
+        conn.prepareStatement(
+            "DELETE FROM model WHERE path = ? OR LEFT(path, ?) = ?"
+        ).bind {
+            string(path)
+            int(directoryPrefix.length)
+            string(directoryPrefix)
+        }.use {
+            it.executeUpdate()
+        }
+        return paths
+    }
 }
\ No newline at end of file
@@ -8,6 +8,9 @@ interface ScanSessionRepository {
 
     // DROP TEMP TABLE ...
     fun close()
+
+    // Marks may be buffered in memory, write them to the temporary tables
+    fun flush()
     fun markFileSha(sha256: ModelHash)
     fun markModelPath(path: String)
     fun markMarkerModelPath(path: String)
@@ -18,4 +21,7 @@ interface ScanSessionRepository {
 
     // DELETE ... WHERE NOT EXISTS(...)
     fun cleanup()
+
+    // Delete thumbnails and complexities not used by any model, for scans not covering the whole directory
+    fun cleanupUnreferenced()
 }
\ No newline at end of file
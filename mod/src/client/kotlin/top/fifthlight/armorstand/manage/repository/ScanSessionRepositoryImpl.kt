@@ -1,12 +1,21 @@
 package top.fifthlight.armorstand.manage.repository
 
 import top.fifthlight.armorstand.util.ModelHash
+import top.fifthlight.armorstand.util.ParamBinderScope
 import top.fifthlight.armorstand.util.bind
 import top.fifthlight.armorstand.util.exists
 import java.sql.Connection
 
 class ScanSessionRepositoryImpl(private val conn: Connection) : ScanSessionRepository {
+    // Marks are only read in this session, so they are kept in memory and written in batches on flush
+    private val pendingFileShas = LinkedHashSet<ModelHash>()
+    private val pendingModelPaths = LinkedHashSet<String>()
+    private val pendingMarkerModelPaths = LinkedHashSet<String>()
+    private val pendingAnimationPaths = LinkedHashSet<String>()
+    private val pendingThumbnailShas = LinkedHashSet<ModelHash>()
+
     override fun open() {
+        clearPending()
         conn.createStatement().apply {
             addBatch("CREATE TEMPORARY TABLE scanned_file_sha256(sha256 BINARY(32) PRIMARY KEY)")
             addBatch("CREATE TEMPORARY TABLE scanned_model_paths(path VARCHAR PRIMARY KEY)")
@@ -18,6 +27,7 @@ class ScanSessionRepositoryImpl(private val conn: Connection) : ScanSessionRepos
     }
 
     override fun close() {
+        clearPending()
         conn.createStatement().apply {
             addBatch("DROP TABLE scanned_file_sha256")
             addBatch("DROP TABLE scanned_model_paths")
@@ -28,57 +38,70 @@ class ScanSessionRepositoryImpl(private val conn: Connection) : ScanSessionRepos
         }
     }
 
-    override fun markFileSha(sha256: ModelHash) {
-        conn.prepareStatement(
-            "MERGE INTO scanned_file_sha256(sha256) KEY(sha256) VALUES(?)"
-        ).bind {
-            bytes(sha256.hash)
-        }.use {
-            it.executeUpdate()
+    private fun clearPending() {
+        pendingFileShas.clear()
+        pendingModelPaths.clear()
+        pendingMarkerModelPaths.clear()
+        pendingAnimationPaths.clear()
+        pendingThumbnailShas.clear()
+    }
+
+    private fun <T> flushMarks(sql: String, pending: MutableSet<T>, bind: ParamBinderScope.(T) -> Unit) {
+        if (pending.isEmpty()) {
+            return
+        }
+        conn.prepareStatement(sql).use { ps ->
+            for (item in pending) {
+                ps.bind { bind(item) }
+                ps.addBatch()
+            }
+            ps.executeBatch()
         }
+        pending.clear()
     }
 
-    override fun markModelPath(path: String) {
-        conn.prepareStatement(
-            "MERGE INTO scanned_model_paths(path) KEY(path) VALUES(?)"
-        ).bind {
-            string(path)
-        }.use {
-            it.executeUpdate()
+    override fun flush() {
+        flushMarks("MERGE INTO scanned_file_sha256(sha256) KEY(sha256) VALUES(?)", pendingFileShas) {
+            bytes(it.hash)
+        }
+        flushMarks("MERGE INTO scanned_model_paths(path) KEY(path) VALUES(?)", pendingModelPaths) {
+            string(it)
+        }
+        flushMarks("MERGE INTO scanned_marker_model_paths(path) KEY(path) VALUES(?)", pendingMarkerModelPaths) {
+            string(it)
+        }
+        flushMarks("MERGE INTO scanned_animation_paths(path) KEY(path) VALUES(?)", pendingAnimationPaths) {
+            string(it)
+        }
+        flushMarks("MERGE INTO scanned_thumbnail_sha256(sha256) KEY(sha256) VALUES(?)", pendingThumbnailShas) {
+            bytes(it.hash)
         }
     }
 
+    override fun markFileSha(sha256: ModelHash) {
+        pendingFileShas.add(sha256)
+    }
+
+    override fun markModelPath(path: String) {
+        pendingModelPaths.add(path)
+    }
+
     override fun markMarkerModelPath(path: String) {
-        conn.prepareStatement(
-            "MERGE INTO scanned_marker_model_paths(path) KEY(path) VALUES(?)"
-        ).bind {
-            string(path)
-        }.use {
-            it.executeUpdate()
-        }
+        pendingMarkerModelPaths.add(path)
     }
 
     override fun markAnimationPath(path: String) {
-        conn.prepareStatement(
-            "MERGE INTO scanned_animation_paths(path) KEY(path) VALUES(?)"
-        ).bind {
-            string(path)
-        }.use {
-            it.executeUpdate()
-        }
+        pendingAnimationPaths.add(path)
     }
 
     override fun markThumbnailSha(sha256: ModelHash) {
-        conn.prepareStatement(
-            "MERGE INTO scanned_thumbnail_sha256(sha256) KEY(sha256) VALUES(?)"
-        ).bind {
-            bytes(sha256.hash)
-        }.use {
-            it.executeUpdate()
-        }
+        pendingThumbnailShas.add(sha256)
     }
 
     override fun isMarkerModelMarked(path: String): Boolean {
+        if (path in pendingMarkerModelPaths) {
+            return true
+        }
         return conn.prepareStatement(
             "SELECT 1 FROM scanned_marker_model_paths WHERE path = ? LIMIT 1"
         ).bind {
@@ -86,14 +109,19 @@ class ScanSessionRepositoryImpl(private val conn: Connection) : ScanSessionRepos
         }.exists()
     }
 
-    override fun isThumbnailMarked(sha256: ModelHash): Boolean =
-        conn.prepareStatement(
+    override fun isThumbnailMarked(sha256: ModelHash): Boolean {
+        if (sha256 in pendingThumbnailShas) {
+            return true
+        }
+        return conn.prepareStatement(
             "SELECT 1 FROM scanned_thumbnail_sha256 WHERE sha256 = ? LIMIT 1"
         ).bind {
             bytes(sha256.hash)
         }.exists()
+    }
 
     override fun cleanup() {
+        flush()
         conn.createStatement().use { st ->
             st.addBatch(
                 """
@@ -130,6 +158,52 @@ class ScanSessionRepositoryImpl(private val conn: Connection) : ScanSessionRepos
                 )
             """.trimIndent()
             )
+            st.addBatch(
+                """
+                DELETE FROM model_complexity
+                WHERE NOT EXISTS (
+                    SELECT 1 FROM model m WHERE m.sha256 = model_complexity.sha256
+                )
+            """.trimIndent()
+            )
+            st.addBatch(
+                """
+                DELETE FROM scaled_thumbnails
+                WHERE NOT EXISTS (
+                    SELECT 1 FROM model m WHERE m.sha256 = scaled_thumbnails.sha256
+                )
+            """.trimIndent()
+            )
+            st.executeBatch()
+        }
+    }
+
+    override fun cleanupUnreferenced() {
+        conn.createStatement().use { st ->
+            st.addBatch(
+                """
+                DELETE FROM embed_thumbnails
+                WHERE NOT EXISTS (
+                    SELECT 1 FROM model m WHERE m.sha256 = embed_thumbnails.sha256
+                )
+            """.trimIndent()
+            )
+            st.addBatch(
+                """
+                DELETE FROM model_complexity
+                WHERE NOT EXISTS (
+                    SELECT 1 FROM model m WHERE m.sha256 = model_complexity.sha256
+                )
+            """.trimIndent()
+            )
+            st.addBatch(
+                """
+                DELETE FROM scaled_thumbnails
+                WHERE NOT EXISTS (
+                    SELECT 1 FROM model m WHERE m.sha256 = scaled_thumbnails.sha256
+                )
+            """.trimIndent()
+            )
             st.executeBatch()
         }
     }
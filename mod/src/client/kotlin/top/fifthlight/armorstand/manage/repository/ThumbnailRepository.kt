@@ -7,4 +7,7 @@ interface ThumbnailRepository {
     fun existsEmbed(sha256: ModelHash): Boolean
     fun insertEmbed(sha256: ModelHash, offset: Long, length: Long, mimeType: String?)
     fun findEmbed(sha256: ModelHash): ModelThumbnail
+    fun existsScaled(sha256: ModelHash): Boolean
+    fun upsertScaled(sha256: ModelHash, thumbnail: ModelThumbnail.Scaled)
+    fun findScaled(sha256: ModelHash): ModelThumbnail.Scaled?
 }
\ No newline at end of file
@@ -40,4 +40,35 @@ class ThumbnailRepositoryImpl(private val conn: Connection) : ThumbnailRepositor
                 type = Texture.TextureType.entries.firstOrNull { it.mimeType == mime },
             )
         } ?: ModelThumbnail.None
+
+    override fun existsScaled(sha256: ModelHash): Boolean =
+        conn.prepareStatement("SELECT 1 FROM scaled_thumbnails WHERE sha256 = ? LIMIT 1").bind {
+            bytes(sha256.hash)
+        }.exists()
+
+    override fun upsertScaled(sha256: ModelHash, thumbnail: ModelThumbnail.Scaled) {
+        conn.prepareStatement(
+            "MERGE INTO scaled_thumbnails(sha256, width, height, data) KEY(sha256) VALUES(?, ?, ?, ?)"
+        ).bind {
+            bytes(sha256.hash)
+            int(thumbnail.width)
+            int(thumbnail.height)
+            bytes(thumbnail.data)
+        }.use {
+            it.executeUpdate()
+        }
+    }
+
+    override fun findScaled(sha256: ModelHash): ModelThumbnail.Scaled? =
+        conn.prepareStatement(
+            "SELECT width, height, data FROM scaled_thumbnails WHERE sha256 = ? LIMIT 1"
+        ).bind {
+            bytes(sha256.hash)
+        }.firstExecuted {
+            ModelThumbnail.Scaled(
+                width = getInt(1),
+                height = getInt(2),
+                data = getBytes(3),
+            )
+        }
 }
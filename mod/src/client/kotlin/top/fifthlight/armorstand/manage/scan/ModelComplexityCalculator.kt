@@ -0,0 +1,19 @@
+package top.fifthlight.armorstand.manage.scan
+
+import top.fifthlight.armorstand.util.ModelComplexity
+import top.fifthlight.blazerod.model.Model
+import top.fifthlight.blazerod.model.util.ModelContent
+
+object ModelComplexityCalculator {
+    // Counted like the model analyzer, see ModelContent
+    fun calculate(model: Model): ModelComplexity {
+        val content = ModelContent.of(model)
+        return ModelComplexity(
+            vertexCount = content.vertexCount,
+            primitiveCount = content.primitiveCount,
+            jointCount = content.jointCount,
+            morphTargetCount = content.morphTargetCount,
+            textureBytes = content.textureBytes,
+        )
+    }
+}
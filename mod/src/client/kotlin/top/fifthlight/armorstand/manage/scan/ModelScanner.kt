@@ -1,5 +1,26 @@
 package top.fifthlight.armorstand.manage.scan
 
+import top.fifthlight.armorstand.util.ModelHash
+import java.nio.file.Path
+
 interface ModelScanner {
-    suspend fun scan(fileHandler: FileHandler)
+    /**
+     * Scan the model directory, and return all models found with their hashes. Paths are relative to model directory.
+     *
+     * Results are committed in batches while scanning, and [onProgress] is called with count of committed files after
+     * each batch.
+     */
+    suspend fun scan(fileHandler: FileHandler, onProgress: (committedFiles: Int) -> Unit = {}): Map<Path, ModelHash>
+
+    /**
+     * Only update the given changed paths, which can be files or directories, and can be already deleted. Return
+     * hashes of changed models, or null for removed models. Paths are relative to model directory.
+     */
+    suspend fun scanChanged(fileHandler: FileHandler, paths: Set<Path>): Map<Path, ModelHash?>
+
+    /**
+     * Calculate complexity of [models] not calculated yet, outside of scan transactions. Return hashes whose
+     * complexity is newly calculated. Paths are relative to model directory.
+     */
+    suspend fun updateComplexity(models: Map<Path, ModelHash>): Set<ModelHash>
 }
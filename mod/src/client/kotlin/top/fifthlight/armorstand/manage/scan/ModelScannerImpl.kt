@@ -3,19 +3,27 @@ package top.fifthlight.armorstand.manage.scan
 import kotlinx.coroutines.*
 import org.slf4j.LoggerFactory
 import top.fifthlight.armorstand.manage.database.DatabaseManager
+import top.fifthlight.armorstand.manage.database.StatementCachingConnection
 import top.fifthlight.armorstand.manage.database.TransactionScope
+import top.fifthlight.armorstand.manage.database.WriteTransactionScope
+import top.fifthlight.armorstand.manage.model.ModelThumbnail
 import top.fifthlight.armorstand.util.ModelHash
+import top.fifthlight.armorstand.util.calculateFingerprint
 import top.fifthlight.armorstand.util.calculateSha256
+import top.fifthlight.armorstand.util.calculateSha256AndFingerprint
 import top.fifthlight.armorstand.util.toHexString
 import top.fifthlight.blazerod.model.ModelFileLoader
+import top.fifthlight.blazerod.model.formats.ModelFileLoaders
+import top.fifthlight.blazerod.model.util.readToBuffer
 import java.io.IOException
-import java.nio.ByteBuffer
+import java.nio.channels.FileChannel
 import java.nio.file.FileVisitResult
 import java.nio.file.FileVisitor
 import java.nio.file.Files
 import java.nio.file.Path
 import java.nio.file.attribute.BasicFileAttributes
 import java.security.MessageDigest
+import java.util.concurrent.ConcurrentHashMap
 
 class ModelScannerImpl(
     private val modelDir: Path,
@@ -23,67 +31,173 @@ class ModelScannerImpl(
 ) : ModelScanner {
     companion object {
         private val logger = LoggerFactory.getLogger(ModelScannerImpl::class.java)
+
+        // Commit scan results after this many files, or after this time since last commit
+        private const val COMMIT_BATCH_SIZE = 64
+        private const val COMMIT_INTERVAL_NS = 250L * 1000000L
+
+        private const val THUMBNAIL_READ_SIZE_LIMIT = 32 * 1024 * 1024
+    }
+
+    // Only used on the database writer thread, so no synchronization needed
+    private class BatchCommitter(
+        private val scope: WriteTransactionScope,
+        private val onProgress: (Int) -> Unit,
+    ) {
+        private var pendingFiles = 0
+        private var committedFiles = 0
+        private var lastCommitTime = System.nanoTime()
+
+        // Time spent writing buffered rows and committing, to tell database cost apart from hashing and parsing
+        var commitTimeNs = 0L
+            private set
+        val totalFiles
+            get() = committedFiles + pendingFiles
+
+        fun fileDone() {
+            pendingFiles++
+            if (pendingFiles >= COMMIT_BATCH_SIZE || System.nanoTime() - lastCommitTime >= COMMIT_INTERVAL_NS) {
+                commit()
+            }
+        }
+
+        fun commit() {
+            if (pendingFiles == 0) {
+                return
+            }
+            val startTime = System.nanoTime()
+            scope.scanSessionRepository.flush()
+            scope.commit()
+            committedFiles += pendingFiles
+            pendingFiles = 0
+            lastCommitTime = System.nanoTime()
+            commitTimeNs += lastCommitTime - startTime
+            onProgress(committedFiles)
+        }
     }
 
     // Actually this API is stable in newer coroutines library, so it is safe to use
+    // Hashing is mostly CPU bound on SSDs, so scale with cores, but don't flood slow disks with too many readers
     @OptIn(ExperimentalCoroutinesApi::class)
-    private val ioDispatcher = Dispatchers.IO.limitedParallelism(4)
+    private val ioDispatcher = Dispatchers.IO.limitedParallelism(
+        Runtime.getRuntime().availableProcessors().coerceIn(2, 8)
+    )
+
+    // Parsing holds the whole model in memory, so keep it low
+    @OptIn(ExperimentalCoroutinesApi::class)
+    private val parseDispatcher = Dispatchers.Default.limitedParallelism(2)
+
+    // Icons only need a small image, so decode the embedded thumbnail once per model and store a scaled copy
+    private suspend fun TransactionScope.updateScaledThumbnail(file: Path, sha256: ModelHash) {
+        if (thumbRepository.existsScaled(sha256)) {
+            return
+        }
+        val embed = thumbRepository.findEmbed(sha256) as? ModelThumbnail.Embed ?: return
+        val thumbnail = try {
+            withContext(parseDispatcher) {
+                FileChannel.open(file).use { channel ->
+                    ThumbnailScaler.scale(
+                        channel.readToBuffer(
+                            offset = embed.offset,
+                            length = embed.length,
+                            readSizeLimit = THUMBNAIL_READ_SIZE_LIMIT,
+                        )
+                    )
+                }
+            }
+        } catch (ex: Exception) {
+            logger.warn("Failed to scale thumbnail: {}", file, ex)
+            return
+        }
+        logger.trace("Scaled thumbnail to {}x{}, {} bytes", thumbnail.width, thumbnail.height, thumbnail.data.size)
+        thumbRepository.upsertScaled(sha256, thumbnail)
+    }
+
+    /**
+     * Get hash of a normal file. The cached hash is used if size, modify time and file key are all unchanged. If only
+     * modify time or file key changed (e.g. touched, or checked out again by git), the content fingerprint is compared
+     * first, so SHA-256 is only calculated when content really changed.
+     */
+    private suspend fun TransactionScope.hashFile(
+        file: Path,
+        relativePath: String,
+        attributes: BasicFileAttributes,
+    ): ByteArray {
+        val lastChanged = attributes.lastModifiedTime().toMillis()
+        val size = attributes.size()
+        val fileKey = attributes.fileKey()?.toString()
+        val cached = fileCacheRepository.find(relativePath)
+        if (cached != null && cached.size == size) {
+            if (cached.lastChanged == lastChanged && cached.fileKey == fileKey) {
+                logger.trace("Use cached hash {}", cached.sha256.toHexString())
+                return cached.sha256
+            }
+            if (cached.fingerprint != null) {
+                val fingerprint = withContext(ioDispatcher) { file.calculateFingerprint() }
+                if (fingerprint == cached.fingerprint) {
+                    logger.trace("Content not changed, use cached hash {}", cached.sha256.toHexString())
+                    fileCacheRepository.upsertCache(relativePath, lastChanged, size, fileKey, fingerprint, cached.sha256)
+                    return cached.sha256
+                }
+            }
+        }
+        val (sha256, fingerprint) = withContext(ioDispatcher) { file.calculateSha256AndFingerprint() }
+        logger.trace("Calculated hash {}", sha256.toHexString())
+        fileCacheRepository.upsertCache(relativePath, lastChanged, size, fileKey, fingerprint, sha256)
+        return sha256
+    }
 
-    private suspend fun TransactionScope.handleFile(fileHandler: FileHandler, file: Path) {
+    /**
+     * Hash all files of a marker model. Files are hashed concurrently, and combined in order of their relative path.
+     */
+    private suspend fun hashMarkerFiles(
+        markerLoader: ModelFileLoader,
+        marker: Path,
+        directory: Path,
+    ): ByteArray = coroutineScope {
+        val fileHashes = markerLoader.getMarkerFileHashes(marker, directory)
+            .map { path ->
+                val normalizedName = directory.relativize(path.toAbsolutePath()).normalize().joinToString("/")
+                Pair(normalizedName, path)
+            }
+            .sortedBy { (normalizedName, _) -> normalizedName }
+            .map { (normalizedName, path) ->
+                logger.trace("Processing marker sign file {}", normalizedName)
+                Pair(normalizedName, async(ioDispatcher) { path.calculateSha256() })
+            }
+        val digest = MessageDigest.getInstance("SHA-256")
+        for ((normalizedName, hash) in fileHashes) {
+            digest.update(normalizedName.encodeToByteArray())
+            digest.update(hash.await())
+        }
+        digest.digest()
+    }
+
+    private suspend fun TransactionScope.handleFile(
+        fileHandler: FileHandler,
+        file: Path,
+        models: MutableMap<Path, ModelHash>,
+    ) {
         try {
             val directory = file.toAbsolutePath().parent
             val relativePath = modelDir.relativize(file).normalize().toString()
             val name = file.fileName.toString()
-            val lastChanged = Files.getLastModifiedTime(file).toMillis()
+            val attributes = Files.readAttributes(file, BasicFileAttributes::class.java)
+            val lastChanged = attributes.lastModifiedTime().toMillis()
 
             logger.trace("Process model file {}", name)
 
-            // findSha256(path, lastChanged) will return null when lastChanged not match
-            val cachedSha = fileCacheRepository.findSha256(relativePath, lastChanged)?.also {
-                logger.trace("Use cached hash {}", it.toHexString())
-            }
-
             val markerLoader = fileHandler.getLoaderOfMarkedFile(file)
 
-            val sha256 = when {
-                cachedSha != null -> cachedSha
-
-                markerLoader != null -> {
-                    val toBeHashedFiles = markerLoader.getMarkerFileHashes(file, directory)
-                        .asSequence()
-                        .map { path ->
-                            val relativePath = directory.relativize(path.toAbsolutePath()).normalize()
-                            Pair(relativePath.joinToString("/"), path)
-                        }
-                        .toList()
-                    val digest = MessageDigest.getInstance("SHA-256")
-                    val buffer = ByteBuffer.allocate(256 * 1024)
-                    for ((normalizedName, path) in toBeHashedFiles) {
-                        logger.trace("Processing marker sign file {}", normalizedName)
-                        digest.update(normalizedName.encodeToByteArray())
-                        Files.newByteChannel(path).use {
-                            while (true) {
-                                buffer.clear()
-                                val len = it.read(buffer)
-                                if (len < 0) {
-                                    break
-                                }
-                                buffer.flip()
-                                digest.update(buffer)
-                            }
-                        }
-                    }
-                    digest.digest().also {
-                        fileCacheRepository.upsertCache(relativePath, lastChanged, it)
-                    }
-                }
-
-                else -> withContext(ioDispatcher) {
-                    file.calculateSha256().also {
-                        logger.trace("Calculated hash {}", it.toHexString())
-                        fileCacheRepository.upsertCache(relativePath, lastChanged, it)
-                    }
+            val sha256 = if (markerLoader != null) {
+                // findSha256(path, lastChanged) will return null when lastChanged not match
+                fileCacheRepository.findSha256(relativePath, lastChanged)?.also {
+                    logger.trace("Use cached hash {}", it.toHexString())
+                } ?: hashMarkerFiles(markerLoader, file, directory).also {
+                    fileCacheRepository.upsertCache(relativePath, lastChanged, it)
                 }
+            } else {
+                hashFile(file, relativePath, attributes)
             }.let(::ModelHash)
             scanSessionRepository.markFileSha(sha256)
 
@@ -99,6 +213,7 @@ class ModelScannerImpl(
                     scanSessionRepository.markMarkerModelPath(directoryPath)
 
                     scanSessionRepository.markModelPath(relativePath)
+                    models[Path.of(relativePath)] = sha256
                     if (modelRepository.exists(relativePath, sha256)) {
                         logger.trace("Already scanned marker file, skip processing directory.")
                         scanSessionRepository.markThumbnailSha(sha256)
@@ -110,10 +225,15 @@ class ModelScannerImpl(
 
                 fileHandler.isModelFile(file) -> {
                     scanSessionRepository.markModelPath(relativePath)
+                    models[Path.of(relativePath)] = sha256
 
                     if (modelRepository.exists(relativePath, sha256)) {
                         logger.trace("Already scanned model, skip processing model.")
                         scanSessionRepository.markThumbnailSha(sha256)
+                        if (fileHandler.canExtractEmbedThumbnail(file)) {
+                            // Models scanned by older versions have no scaled thumbnail yet
+                            updateScaledThumbnail(file, sha256)
+                        }
                         return
                     }
 
@@ -146,6 +266,7 @@ class ModelScannerImpl(
                             }
                         }
                         scanSessionRepository.markThumbnailSha(sha256)
+                        updateScaledThumbnail(file, sha256)
                     }
                 }
 
@@ -161,45 +282,162 @@ class ModelScannerImpl(
         }
     }
 
-    override suspend fun scan(fileHandler: FileHandler) {
-        database.transaction {
+    private fun walkFiles(dir: Path, fileHandler: FileHandler, onFile: (Path) -> Unit) {
+        Files.walkFileTree(dir, object : FileVisitor<Path> {
+            override fun preVisitDirectory(
+                dir: Path,
+                attrs: BasicFileAttributes,
+            ) = FileVisitResult.CONTINUE
+
+            override fun visitFileFailed(
+                file: Path,
+                exc: IOException?,
+            ) = FileVisitResult.CONTINUE
+
+            override fun postVisitDirectory(
+                dir: Path,
+                exc: IOException?,
+            ) = FileVisitResult.CONTINUE
+
+            override fun visitFile(
+                file: Path,
+                attrs: BasicFileAttributes,
+            ): FileVisitResult {
+                if (fileHandler.isFileToScan(file)) {
+                    onFile(file)
+                }
+                return FileVisitResult.CONTINUE
+            }
+        })
+    }
+
+    // Files of marker models are hashed together, so changing any of them changes the marker model
+    private fun findMarkerFile(fileHandler: FileHandler, dir: Path): Path? = try {
+        Files.list(dir).use { files ->
+            files.filter { fileHandler.getLoaderOfMarkedFile(it) != null }.findFirst().orElse(null)
+        }
+    } catch (ex: IOException) {
+        null
+    }
+
+    override suspend fun scan(
+        fileHandler: FileHandler,
+        onProgress: (committedFiles: Int) -> Unit,
+    ): Map<Path, ModelHash> {
+        val models = ConcurrentHashMap<Path, ModelHash>()
+        val startTime = System.nanoTime()
+        database.writeTransaction {
+            val committer = BatchCommitter(this, onProgress)
             coroutineScope {
                 scanSessionRepository.open()
 
-                Files.walkFileTree(modelDir, object : FileVisitor<Path> {
-                    override fun preVisitDirectory(
-                        dir: Path,
-                        attrs: BasicFileAttributes,
-                    ) = FileVisitResult.CONTINUE
-
-                    override fun visitFileFailed(
-                        file: Path,
-                        exc: IOException?,
-                    ) = FileVisitResult.CONTINUE
-
-                    override fun postVisitDirectory(
-                        dir: Path,
-                        exc: IOException?,
-                    ) = FileVisitResult.CONTINUE
-
-                    override fun visitFile(
-                        file: Path,
-                        attrs: BasicFileAttributes,
-                    ): FileVisitResult {
-                        if (!fileHandler.isFileToScan(file)) {
-                            return FileVisitResult.CONTINUE
+                walkFiles(modelDir, fileHandler) { file ->
+                    launch {
+                        handleFile(fileHandler, file, models)
+                        committer.fileDone()
+                    }
+                }
+            }
+            committer.commit()
+
+            // Rows not found are only deleted here, so readers never see a half-scanned library as missing models
+            scanSessionRepository.cleanup()
+            scanSessionRepository.close()
+
+            val statements = connection as? StatementCachingConnection
+            logger.info(
+                "Scanned {} files in {} ms, {} ms in database commits, {} statements prepared, {} reused",
+                committer.totalFiles,
+                (System.nanoTime() - startTime) / 1000000,
+                committer.commitTimeNs / 1000000,
+                statements?.preparedStatements,
+                statements?.reusedStatements,
+            )
+        }
+        return models
+    }
+
+    // Parsing whole models is slow, so it is done after scanning, and each result is committed on its own
+    override suspend fun updateComplexity(models: Map<Path, ModelHash>): Set<ModelHash> {
+        // Complexity is stored by hash, so each model is only parsed once
+        val missing = database.transaction {
+            models.entries
+                .distinctBy { (_, sha256) -> sha256 }
+                .filter { (_, sha256) -> !complexityRepository.exists(sha256) }
+        }
+        val updated = mutableSetOf<ModelHash>()
+        for ((path, sha256) in missing) {
+            val file = modelDir.resolve(path)
+            val complexity = try {
+                withContext(parseDispatcher) {
+                    ModelFileLoaders.probeAndLoad(file)?.model?.let(ModelComplexityCalculator::calculate)
+                }
+            } catch (ex: CancellationException) {
+                throw ex
+            } catch (ex: Exception) {
+                logger.warn("Failed to calculate model complexity: {}", file, ex)
+                null
+            } ?: continue
+            logger.trace("Calculated complexity {}", complexity)
+            database.transaction { complexityRepository.upsert(sha256, complexity) }
+            updated.add(sha256)
+        }
+        return updated
+    }
+
+    override suspend fun scanChanged(fileHandler: FileHandler, paths: Set<Path>): Map<Path, ModelHash?> {
+        val models = ConcurrentHashMap<Path, ModelHash>()
+        val removedModels = mutableSetOf<Path>()
+        database.writeTransaction {
+            coroutineScope {
+                scanSessionRepository.open()
+
+                val files = mutableSetOf<Path>()
+                for (path in paths) {
+                    if (!path.startsWith(modelDir)) {
+                        continue
+                    }
+                    when {
+                        Files.isDirectory(path) -> walkFiles(path, fileHandler) { files.add(it) }
+
+                        Files.isRegularFile(path) -> if (fileHandler.isFileToScan(path)) {
+                            files.add(path)
                         }
 
-                        launch {
-                            handleFile(fileHandler, file)
+                        else -> {
+                            val relativePath = modelDir.relativize(path).normalize().toString()
+                            logger.trace("Remove deleted path {}", relativePath)
+                            modelRepository.deleteUnder(relativePath).mapTo(removedModels) { Path.of(it) }
+                            animationRepository.deleteUnder(relativePath)
+                            fileCacheRepository.deleteUnder(relativePath)
                         }
-                        return FileVisitResult.CONTINUE
                     }
-                })
+                    // Files of a marker model can be anywhere under its directory. The cached hash of the marker file
+                    // is keyed on its own modification time only, so drop it to re-hash the model.
+                    generateSequence(path.parent) { it.parent }
+                        .takeWhile { it.startsWith(modelDir) }
+                        .firstNotNullOfOrNull { findMarkerFile(fileHandler, it) }
+                        ?.let { marker ->
+                            fileCacheRepository.deleteUnder(modelDir.relativize(marker).normalize().toString())
+                            files.add(marker)
+                        }
+                }
+
+                for (file in files) {
+                    launch {
+                        handleFile(fileHandler, file, models)
+                    }
+                }
             }
 
-            scanSessionRepository.cleanup()
+            scanSessionRepository.cleanupUnreferenced()
             scanSessionRepository.close()
         }
+        return buildMap {
+            for (path in removedModels) {
+                put(path, null)
+            }
+            putAll(models)
+        }
     }
 }
@@ -0,0 +1,63 @@
+package top.fifthlight.armorstand.manage.scan
+
+import net.minecraft.client.texture.NativeImage
+import top.fifthlight.armorstand.manage.model.ModelThumbnail
+import java.nio.ByteBuffer
+
+object ThumbnailScaler {
+    // Large enough for model icons on high GUI scales
+    const val MAX_SIZE = 128
+
+    fun fits(image: NativeImage) = image.width <= MAX_SIZE && image.height <= MAX_SIZE
+
+    // Decode the image and shrink it to fit in MAX_SIZE, encoded as PNG
+    fun scale(buffer: ByteBuffer): ModelThumbnail.Scaled = NativeImage.read(buffer).use { source ->
+        if (fits(source)) {
+            ModelThumbnail.Scaled(source.width, source.height, source.bytes)
+        } else {
+            scaleDown(source).use { target ->
+                ModelThumbnail.Scaled(target.width, target.height, target.bytes)
+            }
+        }
+    }
+
+    // Create a new image shrunk to fit in MAX_SIZE, keeping aspect ratio
+    fun scaleDown(source: NativeImage): NativeImage {
+        val scale = minOf(1f, MAX_SIZE.toFloat() / maxOf(source.width, source.height))
+        val width = (source.width * scale).toInt().coerceAtLeast(1)
+        val height = (source.height * scale).toInt().coerceAtLeast(1)
+        val target = NativeImage(width, height, false)
+        for (y in 0 until height) {
+            val sourceTop = y * source.height / height
+            val sourceBottom = maxOf((y + 1) * source.height / height, sourceTop + 1)
+            for (x in 0 until width) {
+                val sourceLeft = x * source.width / width
+                val sourceRight = maxOf((x + 1) * source.width / width, sourceLeft + 1)
+                target.setColorArgb(x, y, source.averageArgb(sourceLeft, sourceTop, sourceRight, sourceBottom))
+            }
+        }
+        return target
+    }
+
+    // Box filter, so small details are not dropped like nearest sampling does
+    private fun NativeImage.averageArgb(left: Int, top: Int, right: Int, bottom: Int): Int {
+        var alpha = 0L
+        var red = 0L
+        var green = 0L
+        var blue = 0L
+        for (y in top until bottom) {
+            for (x in left until right) {
+                val color = getColorArgb(x, y)
+                alpha += (color ushr 24) and 0xFF
+                red += (color ushr 16) and 0xFF
+                green += (color ushr 8) and 0xFF
+                blue += color and 0xFF
+            }
+        }
+        val count = (right - left).toLong() * (bottom - top)
+        return ((alpha / count).toInt() shl 24) or
+                ((red / count).toInt() shl 16) or
+                ((green / count).toInt() shl 8) or
+                (blue / count).toInt()
+    }
+}
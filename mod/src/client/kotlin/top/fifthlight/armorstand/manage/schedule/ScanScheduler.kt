@@ -7,13 +7,15 @@ import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.asStateFlow
 import kotlinx.coroutines.time.withTimeoutOrNull
 import org.slf4j.LoggerFactory
+import java.nio.file.Path
 import java.time.Duration
 import java.time.Instant
 import java.util.concurrent.atomic.AtomicLong
 import kotlin.time.measureTime
 
 class ScanScheduler(
-    private val onScan: suspend () -> Unit,
+    // changedPaths 为 null 时进行完整扫描，否则只扫描变化的路径
+    private val onScan: suspend (changedPaths: Set<Path>?) -> Unit,
     scope: CoroutineScope = CoroutineScope(SupervisorJob() + Dispatchers.Default),
     private val debounceMillis: Long = 100,
 ) {
@@ -24,6 +26,10 @@ class ScanScheduler(
     // 0 表示未计划；否则为下一次扫描的时间戳
     private val nextDeadline = AtomicLong(0L)
 
+    // 下一次扫描的内容，由 this 加锁保护
+    private var fullScanPending = false
+    private var pendingPaths = mutableSetOf<Path>()
+
     private val _lastScanTime = MutableStateFlow<Instant?>(null)
     val lastScanTime = _lastScanTime.asStateFlow()
 
@@ -50,12 +56,41 @@ class ScanScheduler(
     }
 
     /**
-     * 请求一次扫描：
+     * 请求一次完整扫描：
      * - 如果是立即扫描，将下个扫描时间设置为 now
      * - 如果不是立即扫描，将下一次扫描时间推进到 now + debounceMillis（如果已有更晚的计划，则保留更晚者）
      * - 发送信号唤醒等待协程以重新计算等待时长
      */
     fun scheduleScan(immediately: Boolean = false) {
+        synchronized(this) {
+            fullScanPending = true
+        }
+        schedule(immediately)
+    }
+
+    /**
+     * 请求一次增量扫描，只扫描变化的路径。防抖期间的多次请求会合并为一次扫描
+     */
+    fun scheduleScan(changedPaths: Collection<Path>) {
+        synchronized(this) {
+            pendingPaths.addAll(changedPaths)
+        }
+        schedule(immediately = false)
+    }
+
+    // 取出待扫描的内容：null 表示完整扫描
+    private fun takePending(): Set<Path>? = synchronized(this) {
+        val paths = pendingPaths
+        pendingPaths = mutableSetOf()
+        if (fullScanPending) {
+            fullScanPending = false
+            null
+        } else {
+            paths
+        }
+    }
+
+    private fun schedule(immediately: Boolean) {
         if (immediately) {
             nextDeadline.set(System.nanoTime())
         } else {
@@ -94,11 +129,16 @@ class ScanScheduler(
 
             // 到时间：执行一次扫描
             val startTime = System.nanoTime()
+            val changedPaths = takePending()
             try {
                 val time = measureTime {
-                    onScan()
+                    onScan(changedPaths)
+                }
+                if (changedPaths == null) {
+                    logger.info("Finish scanning models, took $time")
+                } else {
+                    logger.info("Finish scanning ${changedPaths.size} changed paths, took $time")
                 }
-                logger.info("Finish scanning models, took $time")
             } catch (ex: CancellationException) {
                 throw ex
             } catch (ex: Throwable) {
@@ -6,7 +6,7 @@ import java.sql.Connection
 class H2SchemaManager : SchemaManager {
     private val logger = LoggerFactory.getLogger(H2SchemaManager::class.java)
 
-    private val currentVersion = 3
+    private val currentVersion = 10
 
     // Minimum supported database version. Recreate the table if version smaller than this
     private val minSupportedVersion = 2
@@ -33,7 +33,92 @@ class H2SchemaManager : SchemaManager {
             "CREATE INDEX IF NOT EXISTS idx_model_name ON model(name)",
             "CREATE INDEX IF NOT EXISTS idx_model_lastChanged ON model(lastChanged)",
             "CREATE INDEX IF NOT EXISTS idx_favorite_favorite_at ON favorite(favorite_at DESC)"
-        )
+        ),
+        // 3 -> 4
+        3 to listOf(
+            // New table
+            """
+            CREATE TABLE IF NOT EXISTS model_complexity(
+                sha256 BINARY(32) PRIMARY KEY,
+                vertexCount INTEGER NOT NULL,
+                primitiveCount INTEGER NOT NULL,
+                jointCount INTEGER NOT NULL,
+                morphTargetCount INTEGER NOT NULL,
+                textureBytes BIGINT NOT NULL
+            )
+            """.trimIndent(),
+        ),
+        // 4 -> 5
+        4 to listOf(
+            "ALTER TABLE file ADD COLUMN size BIGINT NOT NULL DEFAULT -1",
+            "ALTER TABLE file ADD COLUMN fileKey VARCHAR",
+            "ALTER TABLE file ADD COLUMN fingerprint BIGINT",
+            // Marker models are hashed in a different way now
+            "DELETE FROM file",
+        ),
+        // 5 -> 6
+        5 to listOf(
+            "ALTER TABLE model ADD COLUMN searchName VARCHAR NOT NULL DEFAULT ''",
+            "UPDATE model SET searchName = LOWER(name)",
+            // New table
+            """
+            CREATE TABLE IF NOT EXISTS model_name_trigram(
+                trigram VARCHAR NOT NULL,
+                path VARCHAR NOT NULL,
+                PRIMARY KEY(trigram, path)
+            )
+            """.trimIndent(),
+            // Foreign key
+            """
+            ALTER TABLE model_name_trigram
+            ADD CONSTRAINT fk_model_name_trigram_path
+            FOREIGN KEY (path)
+            REFERENCES model(path)
+            ON DELETE CASCADE
+            """.trimIndent(),
+            // Fill trigrams of existing models
+            """
+            INSERT INTO model_name_trigram(trigram, path)
+            SELECT DISTINCT SUBSTRING(m.searchName, r.X, 3), m.path
+            FROM model m
+                JOIN SYSTEM_RANGE(1, 4096) r ON r.X <= CHAR_LENGTH(m.searchName) - 2
+            """.trimIndent(),
+            // Indices
+            "CREATE INDEX IF NOT EXISTS idx_model_name_trigram_path ON model_name_trigram(path)",
+        ),
+        // 6 -> 7
+        6 to listOf(
+            // New table
+            """
+            CREATE TABLE IF NOT EXISTS scaled_thumbnails(
+                sha256 BINARY(32) PRIMARY KEY,
+                width INTEGER NOT NULL,
+                height INTEGER NOT NULL,
+                data VARBINARY NOT NULL
+            )
+            """.trimIndent(),
+        ),
+        // 7 -> 8
+        7 to listOf(
+            "ALTER TABLE animation ADD COLUMN directory VARCHAR NOT NULL DEFAULT ''",
+            // Animations are upserted on every scan, so let the next scan fill the directories
+            "DELETE FROM animation",
+            // Indices
+            "CREATE INDEX IF NOT EXISTS idx_animation_directory ON animation(directory)",
+        ),
+        // 8 -> 9
+        8 to listOf(
+            // Fingerprints are 64-bit hashes now instead of CRC32C, so old ones can't be compared
+            "UPDATE file SET fingerprint = NULL",
+        ),
+        // 9 -> 10
+        9 to listOf(
+            // Listing pages seek on (sort key, path), so index the path after the sort key
+            "DROP INDEX IF EXISTS idx_model_name",
+            "DROP INDEX IF EXISTS idx_model_lastChanged",
+            "CREATE INDEX IF NOT EXISTS idx_model_name_path ON model(name, path)",
+            "CREATE INDEX IF NOT EXISTS idx_model_lastChanged_path ON model(lastChanged, path)",
+        ),
     )
 
     override fun maintainSchema(conn: Connection) {
@@ -90,6 +175,9 @@ class H2SchemaManager : SchemaManager {
             statement.addBatch("DROP TABLE IF EXISTS animation")
             statement.addBatch("DROP TABLE IF EXISTS embed_thumbnails")
             statement.addBatch("DROP TABLE IF EXISTS favorite")
+            statement.addBatch("DROP TABLE IF EXISTS model_complexity")
+            statement.addBatch("DROP TABLE IF EXISTS model_name_trigram")
+            statement.addBatch("DROP TABLE IF EXISTS scaled_thumbnails")
 
             // Create version table
             statement.addBatch("CREATE TABLE version (version INTEGER)")
@@ -100,6 +188,9 @@ class H2SchemaManager : SchemaManager {
                 CREATE TABLE file(
                   path VARCHAR PRIMARY KEY,
                   lastChanged BIGINT NOT NULL,
+                  size BIGINT NOT NULL DEFAULT -1,
+                  fileKey VARCHAR,
+                  fingerprint BIGINT,
                   sha256 BINARY(32) NOT NULL
                 )
             """.trimIndent()
@@ -109,15 +200,26 @@ class H2SchemaManager : SchemaManager {
                 CREATE TABLE model(
                   path VARCHAR PRIMARY KEY,
                   name VARCHAR NOT NULL,
+                  searchName VARCHAR NOT NULL DEFAULT '',
                   lastChanged BIGINT NOT NULL,
                   sha256 BINARY(32) NOT NULL
                 )
             """.trimIndent()
             )
+            statement.addBatch(
+                """
+                CREATE TABLE model_name_trigram(
+                  trigram VARCHAR NOT NULL,
+                  path VARCHAR NOT NULL,
+                  PRIMARY KEY(trigram, path)
+                )
+            """.trimIndent()
+            )
             statement.addBatch(
                 """
                 CREATE TABLE animation(
                   path VARCHAR PRIMARY KEY,
+                  directory VARCHAR NOT NULL DEFAULT '',
                   name VARCHAR NOT NULL,
                   lastChanged BIGINT NOT NULL,
                   sha256 BINARY(32) NOT NULL
@@ -134,6 +236,16 @@ class H2SchemaManager : SchemaManager {
                 )
             """.trimIndent()
             )
+            statement.addBatch(
+                """
+                CREATE TABLE scaled_thumbnails(
+                  sha256 BINARY(32) PRIMARY KEY,
+                  width INTEGER NOT NULL,
+                  height INTEGER NOT NULL,
+                  data VARBINARY NOT NULL
+                )
+            """.trimIndent()
+            )
             statement.addBatch(
                 """
                 CREATE TABLE favorite(
@@ -142,6 +254,18 @@ class H2SchemaManager : SchemaManager {
                 )
             """.trimIndent()
             )
+            statement.addBatch(
+                """
+                CREATE TABLE model_complexity(
+                  sha256 BINARY(32) PRIMARY KEY,
+                  vertexCount INTEGER NOT NULL,
+                  primitiveCount INTEGER NOT NULL,
+                  jointCount INTEGER NOT NULL,
+                  morphTargetCount INTEGER NOT NULL,
+                  textureBytes BIGINT NOT NULL
+                )
+            """.trimIndent()
+            )
             statement.addBatch(
                 """
                 ALTER TABLE favorite
@@ -150,11 +274,21 @@ class H2SchemaManager : SchemaManager {
                 ON DELETE CASCADE
             """.trimIndent()
             )
+            statement.addBatch(
+                """
+                ALTER TABLE model_name_trigram
+                ADD CONSTRAINT fk_model_name_trigram_path
+                FOREIGN KEY(path) REFERENCES model(path)
+                ON DELETE CASCADE
+            """.trimIndent()
+            )
 
             // Indices
-            statement.addBatch("CREATE INDEX idx_model_name ON model(name)")
-            statement.addBatch("CREATE INDEX idx_model_lastChanged ON model(lastChanged)")
+            statement.addBatch("CREATE INDEX idx_model_name_path ON model(name, path)")
+            statement.addBatch("CREATE INDEX idx_model_lastChanged_path ON model(lastChanged, path)")
             statement.addBatch("CREATE INDEX idx_favorite_favorite_at ON favorite(favorite_at DESC)")
+            statement.addBatch("CREATE INDEX idx_model_name_trigram_path ON model_name_trigram(path)")
+            statement.addBatch("CREATE INDEX idx_animation_directory ON animation(directory)")
             statement.executeBatch()
         }
 
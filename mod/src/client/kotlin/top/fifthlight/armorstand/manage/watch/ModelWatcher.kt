@@ -3,6 +3,10 @@ package top.fifthlight.armorstand.manage.watch
 import java.nio.file.Path
 
 interface ModelWatcher {
-    fun start(onChanged: (dir: Path) -> Unit)
+    /**
+     * @param onChanged called with changed files, created directories, and deleted paths
+     * @param onOverflow called when events are lost, so the whole directory should be rescanned
+     */
+    fun start(onChanged: (path: Path) -> Unit, onOverflow: () -> Unit)
     fun stop()
 }
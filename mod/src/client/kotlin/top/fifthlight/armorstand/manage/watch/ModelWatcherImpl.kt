@@ -18,15 +18,22 @@ class ModelWatcherImpl(
 
     private val watchService = FileSystems.getDefault().newWatchService()
     private val watchKeys = ConcurrentHashMap<WatchKey, Path>()
+
+    // Registered directories, to know whether a deleted path was a directory
+    private val directories = ConcurrentHashMap.newKeySet<Path>()
     private val running = AtomicBoolean(false)
 
     @Volatile
     private var onChangedCallback: (Path) -> Unit = {}
 
+    @Volatile
+    private var onOverflowCallback: () -> Unit = {}
+
     private var thread: Thread? = null
 
-    override fun start(onChanged: (dir: Path) -> Unit) {
+    override fun start(onChanged: (path: Path) -> Unit, onOverflow: () -> Unit) {
         onChangedCallback = onChanged
+        onOverflowCallback = onOverflow
         if (!running.compareAndSet(false, true)) {
             return
         }
@@ -46,6 +53,7 @@ class ModelWatcherImpl(
                     for (event in key.pollEvents()) {
                         val kind = event.kind()
                         if (kind == StandardWatchEventKinds.OVERFLOW) {
+                            onOverflowCallback()
                             continue
                         }
 
@@ -53,19 +61,30 @@ class ModelWatcherImpl(
                         val name = (event.context() as Path)
                         val child = dir.resolve(name)
 
-                        // Recursively register child directories
+                        // Recursively register child directories, and scan files moved in with them
                         if (kind == StandardWatchEventKinds.ENTRY_CREATE && Files.isDirectory(child)) {
                             registerAll(child)
+                            onChangedCallback(child)
+                            continue
                         }
 
                         when (kind) {
-                            StandardWatchEventKinds.ENTRY_CREATE, StandardWatchEventKinds.ENTRY_DELETE, StandardWatchEventKinds.ENTRY_MODIFY -> {
+                            StandardWatchEventKinds.ENTRY_CREATE, StandardWatchEventKinds.ENTRY_MODIFY -> {
                                 // Trigger callback
                                 if (Files.isRegularFile(child) && filter.test(child)) {
                                     onChangedCallback(child)
                                 }
                             }
 
+                            StandardWatchEventKinds.ENTRY_DELETE -> {
+                                if (directories.remove(child)) {
+                                    directories.removeIf { it.startsWith(child) }
+                                    onChangedCallback(child)
+                                } else if (filter.test(child)) {
+                                    onChangedCallback(child)
+                                }
+                            }
+
                             else -> {}
                         }
                     }
@@ -93,6 +112,7 @@ class ModelWatcherImpl(
         thread?.interrupt()
         // watchService will be cleaned in thread's finally block
         watchKeys.clear()
+        directories.clear()
     }
 
     private fun registerAll(start: Path) {
@@ -110,6 +130,7 @@ class ModelWatcherImpl(
                             StandardWatchEventKinds.ENTRY_DELETE
                         ).also { key ->
                             watchKeys[key] = dir
+                            directories.add(dir)
                         }
                     } catch (ex: IOException) {
                         logger.warn("Failed to register directory: {}", dir, ex)
@@ -0,0 +1,45 @@
+package top.fifthlight.armorstand.state
+
+import com.mojang.logging.LogUtils
+import top.fifthlight.armorstand.util.ModelHash
+import top.fifthlight.blazerod.model.animation.Animation
+import top.fifthlight.blazerod.model.formats.ModelFileLoaders
+import java.nio.file.Path
+
+/**
+ * Parsed animation clips keyed by file hash, so models sharing motion files, or loaded again after expiry, only need
+ * to bind the clips to their scenes. Files failed to parse are remembered too, until their content changes.
+ *
+ * All functions are thread-safe.
+ */
+object AnimationClipCache {
+    private val LOGGER = LogUtils.getLogger()
+    private const val MAX_ENTRIES = 64
+
+    private class Entry(val animation: Animation?)
+
+    private val entries = object : LinkedHashMap<ModelHash, Entry>(16, 0.75f, true) {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<ModelHash, Entry>) = size > MAX_ENTRIES
+    }
+
+    private fun parse(file: Path, directory: Path): Animation? = try {
+        ModelFileLoaders.probeAndLoad(file, directory)?.animations?.firstOrNull()
+    } catch (ex: Exception) {
+        LOGGER.warn("Failed to load animation file: $file", ex)
+        null
+    }
+
+    /**
+     * Get the first animation in [file]. Files without [hash], e.g. not scanned yet, are parsed without caching.
+     */
+    fun get(file: Path, directory: Path, hash: ModelHash?): Animation? {
+        if (hash == null) {
+            return parse(file, directory)
+        }
+        synchronized(entries) { entries[hash] }?.let { return it.animation }
+        // Parse outside the lock, a clip parsed twice by concurrent loads is harmless
+        val animation = parse(file, directory)
+        synchronized(entries) { entries[hash] = Entry(animation) }
+        return animation
+    }
+}
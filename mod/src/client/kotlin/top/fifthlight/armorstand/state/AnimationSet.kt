@@ -2,13 +2,14 @@ package top.fifthlight.armorstand.state
 
 import net.minecraft.util.Identifier
 import org.slf4j.LoggerFactory
+import top.fifthlight.armorstand.manage.ModelManagerHolder
+import top.fifthlight.armorstand.util.ModelHash
 import top.fifthlight.armorstand.util.ModelLoaders
 import top.fifthlight.blazerod.api.animation.AnimationItem
 import top.fifthlight.blazerod.api.animation.AnimationItemFactory
 import top.fifthlight.blazerod.api.animation.AnimationItemInstance
 import top.fifthlight.blazerod.api.animation.AnimationItemInstanceFactory
 import top.fifthlight.blazerod.api.resource.RenderScene
-import top.fifthlight.blazerod.model.formats.ModelFileLoaders
 import java.nio.file.Path
 import kotlin.io.path.extension
 import kotlin.io.path.isDirectory
@@ -144,7 +145,39 @@ data class FullAnimationSet(
 data object AnimationSetLoader {
     private val logger = LoggerFactory.getLogger(AnimationSetLoader::class.java)
 
-    fun load(
+    private class AnimationFile(
+        val path: Path,
+        val hash: ModelHash?,
+    )
+
+    // Look up the model index instead of listing the directory. Directories not indexed yet, e.g. created after the
+    // last scan, are listed directly.
+    private suspend fun findFiles(directory: Path): List<AnimationFile>? {
+        val modelDir = ModelManagerHolder.modelDir.toAbsolutePath().normalize()
+        val absoluteDirectory = directory.toAbsolutePath().normalize()
+        if (absoluteDirectory.startsWith(modelDir)) {
+            try {
+                val items = ModelManagerHolder.instance.getAnimationsInDirectory(modelDir.relativize(absoluteDirectory))
+                if (items.isNotEmpty()) {
+                    return items.map { AnimationFile(modelDir.resolve(it.path), it.hash) }
+                }
+            } catch (ex: Exception) {
+                logger.warn("Failed to query animations in directory: $directory", ex)
+            }
+        }
+        return try {
+            if (directory.isDirectory()) {
+                directory.listDirectoryEntries().map { AnimationFile(it, null) }
+            } else {
+                null
+            }
+        } catch (ex: Exception) {
+            logger.warn("Failed to list animation directory: $directory", ex)
+            null
+        }
+    }
+
+    suspend fun load(
         scene: RenderScene,
         animations: List<AnimationItem>?,
         directory: Path,
@@ -172,32 +205,23 @@ data object AnimationSetLoader {
         val custom: MutableMap<String, AnimationItem> = mutableMapOf()
         val itemActive: MutableMap<AnimationSet.ItemActiveKey, AnimationItem> = mutableMapOf()
 
-        val files = try {
-            if (directory.isDirectory()) {
-                directory.listDirectoryEntries()
-            } else {
-                null
-            }
-        } catch (ex: Exception) {
-            logger.warn("Failed to list animation directory: $directory", ex)
-            null
-        }
+        val files = findFiles(directory)
 
         // Try external file
         if (files != null) {
             for (file in files) {
-                val name = file.nameWithoutExtension
-                val extension = file.extension
+                val name = file.path.nameWithoutExtension
+                val extension = file.path.extension
                 if (extension !in ModelLoaders.animationExtensions) {
                     continue
                 }
 
+                // Parsed clips are shared, only binding to the scene is done for each load
                 fun load() = try {
-                    val result = ModelFileLoaders.probeAndLoad(file, directory)
-                    val animation = result?.animations?.firstOrNull() ?: return null
+                    val animation = AnimationClipCache.get(file.path, directory, file.hash) ?: return null
                     AnimationItemFactory.load(scene, animation)
                 } catch (ex: Exception) {
-                    logger.warn("Failed to load animation file: $file", ex)
+                    logger.warn("Failed to load animation file: ${file.path}", ex)
                     null
                 }
 
@@ -1,8 +1,8 @@
 package top.fifthlight.armorstand.state
 
-import kotlinx.coroutines.flow.collectLatest
+import com.mojang.logging.LogUtils
 import kotlinx.coroutines.flow.distinctUntilChanged
-import kotlinx.coroutines.flow.filterNotNull
+import kotlinx.coroutines.flow.drop
 import kotlinx.coroutines.flow.map
 import kotlinx.coroutines.launch
 import net.minecraft.client.MinecraftClient
@@ -15,6 +15,7 @@ import java.nio.file.Path
 import java.util.*
 
 object ClientModelPathManager {
+    private val LOGGER = LogUtils.getLogger()
     private val client = MinecraftClient.getInstance()
     var selfPath: Path? = null
         private set
@@ -30,13 +31,40 @@ object ClientModelPathManager {
                 .collect { selfPath = it }
         }
         ArmorStand.instance.scope.launch {
-            ModelManagerHolder.instance.lastUpdateTime.filterNotNull().collectLatest {
-                modelPaths.clear()
+            // Only re-resolve players using the changed hashes
+            ModelManagerHolder.instance.modelPathChanges.collect { changedHashes ->
                 ModelHashManager.getModelHashes().forEach { (uuid, hash) ->
-                    update(uuid, hash)
+                    if (hash in changedHashes) {
+                        update(uuid, hash)
+                    }
                 }
             }
         }
+        ArmorStand.instance.scope.launch {
+            // Players not resolved for unknown complexity can be resolved once it is calculated
+            ModelManagerHolder.instance.modelComplexityChanges.collect { changedHashes ->
+                ModelHashManager.getModelHashes().forEach { (uuid, hash) ->
+                    if (hash in changedHashes) {
+                        update(uuid, hash)
+                    }
+                }
+            }
+        }
+        ArmorStand.instance.scope.launch {
+            // Edited models are reloaded in place, as their paths don't change
+            ModelManagerHolder.instance.modelContentChanges.collect { paths ->
+                paths.forEach(ModelInstanceManager::reload)
+            }
+        }
+        ArmorStand.instance.scope.launch {
+            ConfigHolder.config
+                .map { it.otherModelComplexityLimit }
+                .distinctUntilChanged()
+                .drop(1)
+                .collect {
+                    ModelHashManager.getModelHashes().forEach { (uuid, hash) -> update(uuid, hash) }
+                }
+        }
     }
 
     suspend fun update(uuid: UUID, hash: ModelHash?) {
@@ -44,12 +72,24 @@ object ClientModelPathManager {
             modelPaths.remove(uuid)
             return
         }
-        val path = ModelManagerHolder.instance.getModelByHash(hash)?.path
-        if (path != null) {
-            modelPaths[uuid] = path
-        } else {
+        val path = ModelManagerHolder.instance.getModelPathByHash(hash)
+        if (path == null) {
             modelPaths.remove(uuid)
+            return
+        }
+        // Fall back to vanilla player for models over local limit. Complexity announced by other players is not
+        // trusted, use the one calculated from our own copy, and treat unknown complexity as over limit.
+        val limit = ConfigHolder.config.value.otherModelComplexityLimit
+        if (!limit.isUnlimited) {
+            val complexity = ModelManagerHolder.instance.getModelComplexity(hash)
+            if (complexity == null || complexity.exceeds(limit)) {
+                LOGGER.info("Model $hash of player $uuid is over complexity limit: $complexity")
+                modelPaths.remove(uuid)
+                return
+            }
         }
+        modelPaths[uuid] = path
+        ModelInstanceManager.prefetch(uuid)
     }
 
     fun getPath(uuid: UUID) = if (uuid == selfUuid) {
@@ -15,9 +15,11 @@ object ModelHashManager {
         ClientModelPathManager.update(uuid, hash)
     }
 
-    fun clearHash() = modelHashes.clear()
+    fun clearHash() {
+        modelHashes.clear()
+    }
 
     fun getHash(uuid: UUID) = modelHashes[uuid]
 
     fun getModelHashes(): Map<UUID, ModelHash> = modelHashes
-}
\ No newline at end of file
+}
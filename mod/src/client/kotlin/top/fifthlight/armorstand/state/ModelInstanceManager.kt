@@ -13,10 +13,13 @@ import top.fifthlight.blazerod.api.animation.AnimationItemFactory
 import top.fifthlight.blazerod.api.animation.AnimationItemInstanceFactory
 import top.fifthlight.blazerod.api.loader.ModelLoaderFactory
 import top.fifthlight.blazerod.api.refcount.RefCount
+import top.fifthlight.blazerod.api.resource.MemoryUsage
 import top.fifthlight.blazerod.api.resource.ModelInstance
 import top.fifthlight.blazerod.api.resource.ModelInstanceFactory
 import top.fifthlight.blazerod.api.resource.RenderScene
 import top.fifthlight.blazerod.model.Metadata
+import top.fifthlight.blazerod.model.Model
+import top.fifthlight.blazerod.model.ModelFileLoader
 import top.fifthlight.blazerod.model.formats.ModelFileLoaders
 import java.nio.file.Path
 import java.util.*
@@ -26,6 +29,23 @@ import kotlin.time.measureTimedValue
 object ModelInstanceManager {
     private val LOGGER = LogUtils.getLogger()
     const val INSTANCE_EXPIRE_NS: Long = 30L * 1000000000L
+
+    // Instances accessed within this time are visible, and their models are never evicted for memory budget
+    private const val INSTANCE_VISIBLE_NS: Long = 1000000000L
+    private const val BYTES_PER_MEGABYTE = 1024L * 1024L
+
+    private const val PARSE_PARALLELISM = 2
+    private const val LOAD_PARALLELISM = 1
+
+    // Loads not requested within this time are cancelled, e.g. player left view
+    private const val LOAD_REQUEST_TIMEOUT_NS: Long = 2L * 1000000000L
+
+    // Prefetched models not shown within this time are dropped
+    private const val PREFETCH_TIMEOUT_NS: Long = 30L * 1000000000L
+
+    // Players are checked against prefetch distance again in this interval, as they move around
+    private const val PREFETCH_CHECK_INTERVAL_NS: Long = 1000000000L
+    private var lastPrefetchCheckTime = 0L
     private val client = MinecraftClient.getInstance()
     private val selfUuid: UUID?
         get() = client.player?.uuid
@@ -37,6 +57,10 @@ object ModelInstanceManager {
     private val scope
         get() = ArmorStand.instance.scope
 
+    // Memory usage of loaded models and instances, updated on cleanup
+    var memoryUsage = MemoryUsage.EMPTY
+        private set
+
     private const val MAX_CACHE_FAVORITE_MODEL_ITEMS = 5
     val favoriteModelPaths = ArrayDeque<Path>()
 
@@ -78,22 +102,48 @@ object ModelInstanceManager {
         ) : RefCount by instance, ModelInstanceItem
     }
 
-    private suspend fun loadModel(path: Path): ModelCache = withContext(Dispatchers.Default) {
+    private class ParsedModel(
+        val modelPath: Path,
+        val result: ModelFileLoader.LoadResult,
+        val model: Model,
+    )
+
+    private suspend fun parseModel(path: Path): ParsedModel? = withContext(Dispatchers.Default) {
         val (result, duration) = measureTimedValue {
             val modelPath = modelDir.resolve(path).toAbsolutePath()
             val result = try {
                 ModelFileLoaders.probeAndLoad(modelPath)
             } catch (ex: Exception) {
                 LOGGER.warn("Model load failed", ex)
-                return@withContext ModelCache.Failed
-            } ?: return@withContext ModelCache.Failed
+                return@withContext null
+            } ?: return@withContext null
 
-            val model = result.model ?: return@withContext ModelCache.Failed
+            val model = result.model ?: return@withContext null
             LOGGER.info("Model metadata: ${result.metadata}")
+            ParsedModel(
+                modelPath = modelPath,
+                result = result,
+                model = model,
+            )
+        }
+        LOGGER.info("Model $path parsed, duration: $duration")
+        result
+    }
 
+    /**
+     * @param reloadable index resources by content so a reload can share them, which costs load time. See [reload].
+     */
+    private suspend fun loadScene(
+        path: Path,
+        parsed: ParsedModel,
+        previous: RenderScene? = null,
+        reloadable: Boolean = false,
+    ): ModelCache = withContext(Dispatchers.Default) {
+        val (result, duration) = measureTimedValue {
+            val modelPath = parsed.modelPath
             val scene = try {
                 val loader = ModelLoaderFactory.create()
-                loader.loadModel(model) ?: run {
+                loader.loadModel(parsed.model, previous, reloadable) ?: run {
                     LOGGER.warn("Model contains no scene")
                     return@withContext ModelCache.Failed
                 }
@@ -101,7 +151,7 @@ object ModelInstanceManager {
                 LOGGER.warn("Model scene load failed", ex)
                 return@withContext ModelCache.Failed
             }
-            val animations = result.animations?.map { AnimationItemFactory.load(scene, it) } ?: listOf()
+            val animations = parsed.result.animations?.map { AnimationItemFactory.load(scene, it) } ?: listOf()
 
             val defaultAnimationSet = AnimationSetLoader.load(scene, animations, defaultAnimationDir)
             val modelAnimation = modelPath.parent?.let { parentPath ->
@@ -118,7 +168,7 @@ object ModelInstanceManager {
             ModelCache.Loaded(
                 scene = scene,
                 animations = animations,
-                metadata = result.metadata,
+                metadata = parsed.result.metadata,
                 animationSet = modelAnimation,
             )
         }
@@ -126,18 +176,91 @@ object ModelInstanceManager {
         result
     }
 
-    private fun loadCache(path: Path): Deferred<ModelCache> = modelCaches.getOrPut(path) {
-        scope.async {
-            val item = loadModel(path)
-            (item as? ModelCache.Loaded)?.increaseReferenceCount()
-            item
+    val loadScheduler = ModelLoadScheduler(
+        scope = { scope },
+        parseParallelism = PARSE_PARALLELISM,
+        loadParallelism = LOAD_PARALLELISM,
+        requestTimeout = LOAD_REQUEST_TIMEOUT_NS,
+        prefetchTimeout = PREFETCH_TIMEOUT_NS,
+        parse = ::parseModel,
+        load = { path, parsed ->
+            // Own model is the one being edited most likely, others are reloaded without sharing resources
+            loadScene(path, parsed, reloadable = path == ClientModelPathManager.selfPath).also {
+                (it as? ModelCache.Loaded)?.increaseReferenceCount()
+            }
+        },
+        failedResult = ModelCache.Failed,
+        release = { (it as? ModelCache.Loaded)?.decreaseReferenceCount() },
+    )
+
+    private fun loadCache(path: Path, priority: Double, time: Long, pinned: Boolean): Deferred<ModelCache> {
+        // The scheduler forgets finished requests, so requesting a loaded model again would load a second copy
+        modelCaches[path]?.let { cache ->
+            if (cache.isCompleted && !cache.isCancelled) {
+                return cache
+            }
+        }
+        // Renews the request if still loading, the scheduler returns the same deferred then
+        val request = loadScheduler.request(path, priority, time, pinned)
+        modelCaches[path] = request
+        return request
+    }
+
+    /**
+     * Parse the model of player [uuid] in background, if it is within prefetch distance. Called when player's model
+     * path is resolved, and again in [cleanup] for players coming closer, so the model only needs to be uploaded when
+     * the player becomes visible.
+     */
+    fun prefetch(uuid: UUID) {
+        if (uuid == selfUuid || !ConfigHolder.config.value.showOtherPlayerModel) {
+            return
+        }
+        val distance = ConfigHolder.config.value.modelPrefetchDistance
+        if (distance <= 0) {
+            return
+        }
+        val path = ClientModelPathManager.getPath(uuid) ?: return
+        if (modelCaches[path]?.isCancelled == false) {
+            return
+        }
+        val self = client.player ?: return
+        val player = client.world?.getPlayerByUuid(uuid) ?: return
+        if (player.squaredDistanceTo(self) > distance.toDouble() * distance) {
+            return
+        }
+        loadScheduler.prefetch(path, System.nanoTime())
+    }
+
+    private fun createController(isSelf: Boolean, cache: ModelCache.Loaded): ModelController {
+        val scene = cache.scene
+        val vmcRunning = VmcMarionetteManager.state.value is VmcMarionetteManager.State.Running
+        val animationSet = FullAnimationSet.from(cache.animationSet)
+        val animation = cache.animations.firstOrNull()
+        return when {
+            isSelf && vmcRunning -> ModelController.Vmc(scene)
+
+            animationSet != null -> ModelController.LiveSwitched(
+                AnimationContextsFactory.create().base(),
+                scene,
+                animationSet,
+            )
+
+            animation != null -> ModelController.Predefined(
+                AnimationContextsFactory.create().base(),
+                AnimationItemInstanceFactory.of(animation),
+            )
+
+            else -> ModelController.LiveUpdated(scene)
         }
     }
 
     fun getSelfItem(load: Boolean) = selfUuid?.let { get(it, time = null, load = load) }
 
+    /**
+     * @param distance distance to the camera, for players on screen. Models of closer players are loaded first.
+     */
     @OptIn(ExperimentalCoroutinesApi::class)
-    fun get(uuid: UUID, time: Long?, load: Boolean = true): ModelInstanceItem? {
+    fun get(uuid: UUID, time: Long?, load: Boolean = true, distance: Double? = null): ModelInstanceItem? {
         val isSelf = uuid == selfUuid
         if (!isSelf && !ConfigHolder.config.value.showOtherPlayerModel) {
             return null
@@ -172,8 +295,13 @@ object ModelInstanceManager {
             return null
         }
 
-        val cacheDeferred = loadCache(path)
-        if (!cacheDeferred.isCompleted) {
+        val priority = when {
+            isSelf -> ModelLoadScheduler.PRIORITY_SELF
+            distance != null -> ModelLoadScheduler.visiblePriority(distance)
+            else -> ModelLoadScheduler.PRIORITY_BACKGROUND
+        }
+        val cacheDeferred = loadCache(path, priority, time ?: System.nanoTime(), pinned = isSelf)
+        if (!cacheDeferred.isCompleted || cacheDeferred.isCancelled) {
             return null
         }
         val newItem = when (val cache = cacheDeferred.getCompleted()) {
@@ -186,27 +314,7 @@ object ModelInstanceManager {
                     metadata = cache.metadata,
                     lastAccessTime = lastAccessTime,
                     instance = ModelInstanceFactory.of(scene),
-                    controller = run {
-                        val vmcRunning = VmcMarionetteManager.state.value is VmcMarionetteManager.State.Running
-                        val animationSet = FullAnimationSet.from(cache.animationSet)
-                        val animation = cache.animations.firstOrNull()
-                        when {
-                            isSelf && vmcRunning -> ModelController.Vmc(scene)
-
-                            animationSet != null -> ModelController.LiveSwitched(
-                                AnimationContextsFactory.create().base(),
-                                scene,
-                                animationSet,
-                            )
-
-                            animation != null -> ModelController.Predefined(
-                                AnimationContextsFactory.create().base(),
-                                AnimationItemInstanceFactory.of(animation),
-                            )
-
-                            else -> ModelController.LiveUpdated(scene)
-                        }
-                    },
+                    controller = createController(isSelf, cache),
                 ).also {
                     it.increaseReferenceCount()
                 }
@@ -219,18 +327,102 @@ object ModelInstanceManager {
         return newItem
     }
 
+    // Paths being reloaded, so edits during a reload don't start another one
+    private val reloadingPaths = mutableSetOf<Path>()
+
+    /**
+     * Reload the model at [path] after its file is edited, and swap instances showing it to the new scene. Textures
+     * and buffers not changed are shared with the old scene instead of uploaded again. Does nothing if the model is
+     * not loaded.
+     */
+    @OptIn(ExperimentalCoroutinesApi::class)
+    fun reload(path: Path) {
+        val cacheDeferred = modelCaches[path] ?: return
+        if (!cacheDeferred.isCompleted || cacheDeferred.isCancelled) {
+            return
+        }
+        val oldCache = cacheDeferred.getCompleted() as? ModelCache.Loaded ?: run {
+            // Nothing to reuse, just forget the failure and let it load again
+            modelCaches.remove(path)
+            modelInstanceItems.entries.removeIf { (_, item) -> item.path == path }
+            return
+        }
+        if (!reloadingPaths.add(path)) {
+            return
+        }
+        // Keep the old scene alive while loading, even if evicted meanwhile
+        oldCache.increaseReferenceCount()
+        scope.launch {
+            try {
+                val (newCache, duration) = measureTimedValue {
+                    val parsed = parseModel(path) ?: return@launch
+                    loadScene(path, parsed, oldCache.scene, reloadable = true) as? ModelCache.Loaded
+                        ?: return@launch
+                }
+                if (modelCaches[path] !== cacheDeferred) {
+                    // Evicted or replaced during reload, close the new scene as nothing references it
+                    newCache.increaseReferenceCount()
+                    newCache.decreaseReferenceCount()
+                    return@launch
+                }
+                newCache.increaseReferenceCount()
+                modelCaches[path] = CompletableDeferred(newCache)
+                oldCache.decreaseReferenceCount()
+                swapInstances(path, newCache)
+                LOGGER.info("Model $path reloaded, duration: $duration")
+            } finally {
+                oldCache.decreaseReferenceCount()
+                reloadingPaths.remove(path)
+            }
+        }
+    }
+
+    /**
+     * Replace instances of path with new ones of cache, keeping their access time. If the new scene has the same node
+     * layout, the pose, simulations and controller with its playback carry over, as indices in them are still valid.
+     * Otherwise a controller of the same type is created.
+     */
+    private fun swapInstances(path: Path, cache: ModelCache.Loaded) {
+        for (entry in modelInstanceItems.entries) {
+            val item = entry.value as? ModelInstanceItem.Model ?: continue
+            if (item.path != path) {
+                continue
+            }
+            val instance = ModelInstanceFactory.of(cache.scene)
+            val isSelf = entry.key == selfUuid
+            val controller = when {
+                instance.copyStateFrom(item.instance) -> item.controller
+                // Vmc controllers follow the running marionette, not the model animations
+                item.controller is ModelController.Vmc -> ModelController.Vmc(cache.scene)
+                else -> createController(isSelf, cache)
+            }
+            entry.setValue(
+                ModelInstanceItem.Model(
+                    path = path,
+                    animations = cache.animations,
+                    metadata = cache.metadata,
+                    lastAccessTime = item.lastAccessTime,
+                    instance = instance,
+                    controller = controller,
+                ).also {
+                    it.increaseReferenceCount()
+                }
+            )
+            item.decreaseReferenceCount()
+        }
+    }
+
     @OptIn(ExperimentalCoroutinesApi::class)
     fun cleanAll() {
+        loadScheduler.cancelAll()
         modelInstanceItems.values.forEach {
             (it as? ModelInstanceItem.Model)?.decreaseReferenceCount()
         }
         modelInstanceItems.clear()
         modelCaches.values.forEach { item ->
-            if (item.isCompleted) {
+            if (item.isCompleted && !item.isCancelled) {
                 val item = item.getCompleted() as? ModelCache.Loaded
                 item?.decreaseReferenceCount()
-            } else {
-                item.cancel()
             }
         }
         modelCaches.clear()
@@ -238,6 +430,11 @@ object ModelInstanceManager {
 
     @OptIn(ExperimentalCoroutinesApi::class)
     fun cleanup(time: Long) {
+        if (time - lastPrefetchCheckTime >= PREFETCH_CHECK_INTERVAL_NS) {
+            lastPrefetchCheckTime = time
+            ModelHashManager.getModelHashes().keys.forEach(::prefetch)
+        }
+        loadScheduler.update(time)
         val usedPaths = mutableSetOf<Path>()
 
         // cleaned unused model instances
@@ -272,6 +469,13 @@ object ModelInstanceManager {
 
         // cleaned unused model caches
         modelCaches.entries.removeIf { (path, item) ->
+            if (item.isCancelled) {
+                return@removeIf true
+            }
+            // Loading models are cancelled by the scheduler if no longer requested
+            if (!item.isCompleted) {
+                return@removeIf false
+            }
             if (path == ClientModelPathManager.selfPath) {
                 return@removeIf false
             }
@@ -285,5 +489,75 @@ object ModelInstanceManager {
             }
             remove
         }
+
+        evictOverBudget(time)
+    }
+
+    @OptIn(ExperimentalCoroutinesApi::class)
+    private fun evictOverBudget(time: Long) {
+        val config = ConfigHolder.config.value
+        val gpuBudget = config.modelGpuMemoryBudget * BYTES_PER_MEGABYTE
+        val heapBudget = config.modelHeapMemoryBudget * BYTES_PER_MEGABYTE
+        fun MemoryUsage.overBudget() = gpuBytes > gpuBudget || heapBytes > heapBudget
+
+        var usage = MemoryUsage.EMPTY
+        val selfPath = ClientModelPathManager.selfPath
+        val visiblePaths = mutableSetOf<Path>()
+        // Last access time of each model, from instances using it
+        val lastAccessTimes = mutableMapOf<Path, Long>()
+        for (item in modelInstanceItems.values) {
+            if (item !is ModelInstanceItem.Model) {
+                continue
+            }
+            usage += item.instance.memoryUsage
+            if (item.lastAccessTime == -1L || time - item.lastAccessTime <= INSTANCE_VISIBLE_NS) {
+                visiblePaths.add(item.path)
+            }
+            lastAccessTimes.merge(item.path, item.lastAccessTime, ::maxOf)
+        }
+        val loadedCaches = modelCaches.mapNotNull { (path, item) ->
+            if (item.isCompleted && !item.isCancelled) {
+                (item.getCompleted() as? ModelCache.Loaded)?.let { Pair(path, it) }
+            } else {
+                null
+            }
+        }
+        for ((_, cache) in loadedCaches) {
+            usage += cache.scene.memoryUsage
+        }
+        memoryUsage = usage
+        if (!usage.overBudget()) {
+            return
+        }
+
+        // Favorite models only kept loaded in advance, without any instance, go first, then least recently used ones
+        val candidates = loadedCaches
+            .filter { (path, _) -> path != selfPath && path !in visiblePaths }
+            .sortedWith(
+                compareBy<Pair<Path, ModelCache.Loaded>>(
+                    { (path, _) -> path !in favoriteModelPaths || path in lastAccessTimes },
+                    { (path, _) -> lastAccessTimes[path] ?: Long.MIN_VALUE },
+                )
+            )
+        for ((path, cache) in candidates) {
+            if (!usage.overBudget()) {
+                break
+            }
+            modelInstanceItems.entries.removeIf { (_, item) ->
+                if (item.path != path) {
+                    return@removeIf false
+                }
+                (item as? ModelInstanceItem.Model)?.let {
+                    usage -= it.instance.memoryUsage
+                    it.decreaseReferenceCount()
+                }
+                true
+            }
+            modelCaches.remove(path)
+            usage -= cache.scene.memoryUsage
+            cache.decreaseReferenceCount()
+            LOGGER.info("Evicted model $path, memory usage over budget")
+        }
+        memoryUsage = usage
     }
 }
@@ -0,0 +1,232 @@
+package top.fifthlight.armorstand.state
+
+import com.mojang.logging.LogUtils
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.CoroutineStart
+import kotlinx.coroutines.Deferred
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.launch
+import java.nio.file.Path
+import kotlin.coroutines.cancellation.CancellationException
+
+/**
+ * Schedules model loads by priority, with bounded parallelism for parsing and for scene (GPU) loading.
+ *
+ * A load is split into two stages, [parse] and [load]. Waiting requests enter each stage with lowest priority value
+ * first. Requests not renewed within [requestTimeout] are cancelled if they are still waiting or parsing, so players
+ * left view don't hold loading slots. Scene loading is never interrupted, as it owns GPU resources. Scenes still loading
+ * when [cancelAll] is called take their loading slots until they finish, and are given to [release] then.
+ *
+ * Requests can also be [prefetch]ed, which only runs [parse] in background, and waits for a real [request] to load the
+ * scene, so the slow part is done before the model becomes visible. Prefetched models expire after [prefetchTimeout].
+ *
+ * All functions should be called on the main thread, and [scope] should dispatch to the main thread too.
+ */
+class ModelLoadScheduler<P : Any, R>(
+    private val scope: () -> CoroutineScope,
+    private val parseParallelism: Int,
+    private val loadParallelism: Int,
+    private val requestTimeout: Long,
+    private val prefetchTimeout: Long,
+    // Return null if the model failed to parse, and the request will be completed with [failedResult]
+    private val parse: suspend (Path) -> P?,
+    private val load: suspend (Path, P) -> R,
+    private val failedResult: R,
+    // Called with results of cancelled requests, which nobody receives
+    private val release: (R) -> Unit,
+) {
+    companion object {
+        private val LOGGER = LogUtils.getLogger()
+
+        // Self model skips the parallelism limit, so it loads in constant time regardless of crowd size
+        const val PRIORITY_SELF = 0.0
+
+        // Players on screen, ordered by distance
+        fun visiblePriority(distance: Double) = 1.0 + distance
+
+        const val PRIORITY_BACKGROUND = Double.MAX_VALUE
+    }
+
+    private enum class Stage {
+        WAIT_PARSE,
+        PARSING,
+        WAIT_LOAD,
+        LOADING,
+    }
+
+    private inner class Request(val path: Path) {
+        val result = CompletableDeferred<R>()
+        var stage = Stage.WAIT_PARSE
+        var priority = PRIORITY_BACKGROUND
+
+        // Lowest priority requested since last update
+        var nextPriority = PRIORITY_BACKGROUND
+        var lastRequestTime = 0L
+        var pinned = false
+
+        // Prefetched requests stop at WAIT_LOAD until requested
+        var loadRequested = false
+        var parsed: P? = null
+        var job: Job? = null
+    }
+
+    private val requests = mutableMapOf<Path, Request>()
+    private var parsingCount = 0
+    private var loadingCount = 0
+
+    val pendingCount
+        get() = requests.size
+
+    /**
+     * Request the model at [path], or renew an existing request.
+     *
+     * @param pinned pinned requests are never cancelled by timeout.
+     */
+    fun request(path: Path, priority: Double, time: Long, pinned: Boolean = false): Deferred<R> {
+        val request = requests.getOrPut(path) {
+            Request(path).also {
+                it.priority = priority
+            }
+        }
+        request.nextPriority = minOf(request.nextPriority, priority)
+        request.priority = minOf(request.priority, priority)
+        request.lastRequestTime = time
+        request.pinned = request.pinned || pinned
+        request.loadRequested = true
+        schedule()
+        return request.result
+    }
+
+    /**
+     * Parse the model at [path] in background, without loading its scene, or renew an existing prefetch. Does nothing
+     * if already requested.
+     */
+    fun prefetch(path: Path, time: Long) {
+        requests[path]?.let { request ->
+            if (!request.loadRequested) {
+                request.lastRequestTime = time
+            }
+            return
+        }
+        requests[path] = Request(path).also {
+            it.lastRequestTime = time
+        }
+        schedule()
+    }
+
+    /**
+     * Refresh priorities, cancel stale requests and start waiting ones. Call it once per frame.
+     */
+    fun update(time: Long) {
+        requests.values.removeIf { request ->
+            val timeout = if (request.loadRequested) requestTimeout else prefetchTimeout
+            val stale = !request.pinned && request.stage != Stage.LOADING &&
+                    time - request.lastRequestTime > timeout
+            if (stale) {
+                LOGGER.info("Cancelled loading model ${request.path}, not requested anymore")
+                cancel(request)
+            } else {
+                request.priority = request.nextPriority
+                request.nextPriority = PRIORITY_BACKGROUND
+            }
+            stale
+        }
+        schedule()
+    }
+
+    fun cancelAll() {
+        requests.values.forEach(::cancel)
+        requests.clear()
+    }
+
+    // Slots of running jobs are freed by the jobs themselves, as they can still finish after cancelled
+    private fun cancel(request: Request) {
+        request.job?.cancel()
+        request.result.cancel()
+    }
+
+    // Cancelled requests are removed, and the path may be requested again with a new request
+    private fun isCurrent(request: Request) = requests[request.path] === request && request.result.isActive
+
+    private fun finish(request: Request, result: R) {
+        requests.remove(request.path, request)
+        request.result.complete(result)
+    }
+
+    // Priorities change every frame, so sort waiting requests on each schedule instead of keeping a heap
+    private fun waitingRequests(stage: Stage) = requests.values
+        .filter { it.stage == stage }
+        .sortedBy { it.priority }
+
+    private fun schedule() {
+        for (request in waitingRequests(Stage.WAIT_PARSE)) {
+            if (parsingCount >= parseParallelism && request.priority > PRIORITY_SELF) {
+                break
+            }
+            startParse(request)
+        }
+        for (request in waitingRequests(Stage.WAIT_LOAD)) {
+            if (!request.loadRequested) {
+                continue
+            }
+            if (loadingCount >= loadParallelism && request.priority > PRIORITY_SELF) {
+                break
+            }
+            startLoad(request)
+        }
+    }
+
+    private fun startParse(request: Request) {
+        request.stage = Stage.PARSING
+        parsingCount++
+        // Atomic start, so the slot is freed even if cancelled before started
+        request.job = scope().launch(start = CoroutineStart.ATOMIC) {
+            val parsed = try {
+                parse(request.path)
+            } catch (ex: CancellationException) {
+                throw ex
+            } catch (ex: Exception) {
+                LOGGER.warn("Model parse failed", ex)
+                null
+            } finally {
+                parsingCount--
+            }
+            if (!isCurrent(request)) {
+                return@launch
+            }
+            if (parsed == null) {
+                finish(request, failedResult)
+            } else {
+                request.parsed = parsed
+                request.stage = Stage.WAIT_LOAD
+            }
+            schedule()
+        }
+    }
+
+    private fun startLoad(request: Request) {
+        val parsed = request.parsed ?: error("Model ${request.path} not parsed")
+        request.parsed = null
+        request.stage = Stage.LOADING
+        loadingCount++
+        request.job = scope().launch(start = CoroutineStart.ATOMIC) {
+            val result = try {
+                load(request.path, parsed)
+            } catch (ex: CancellationException) {
+                throw ex
+            } catch (ex: Exception) {
+                LOGGER.warn("Model load failed", ex)
+                failedResult
+            } finally {
+                loadingCount--
+            }
+            if (isCurrent(request)) {
+                finish(request, result)
+            } else {
+                release(result)
+            }
+            schedule()
+        }
+    }
+}
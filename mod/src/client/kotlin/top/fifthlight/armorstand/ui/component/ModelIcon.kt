@@ -7,19 +7,10 @@ import net.minecraft.client.gui.DrawContext
 import net.minecraft.client.gui.Drawable
 import net.minecraft.client.gui.widget.ClickableWidget
 import net.minecraft.client.gui.widget.Widget
-import net.minecraft.client.texture.NativeImage
-import net.minecraft.client.texture.NativeImageBackedTexture
-import net.minecraft.client.texture.TextureManager
 import net.minecraft.util.Identifier
 import org.slf4j.LoggerFactory
-import top.fifthlight.armorstand.manage.ModelManagerHolder
 import top.fifthlight.armorstand.manage.model.ModelItem
-import top.fifthlight.armorstand.manage.model.ModelThumbnail
 import top.fifthlight.armorstand.util.ThreadExecutorDispatcher
-import top.fifthlight.blazerod.model.Texture
-import top.fifthlight.blazerod.model.util.readToBuffer
-import java.nio.channels.FileChannel
-import java.nio.file.Path
 import java.util.function.Consumer
 
 class ModelIcon(
@@ -61,117 +52,24 @@ class ModelIcon(
 
     override fun forEachChild(consumer: Consumer<ClickableWidget>) = Unit
 
-    private data class ModelTexture(
-        val textureManager: TextureManager,
-        val identifier: Identifier,
-        val texture: NativeImageBackedTexture,
-        val width: Int,
-        val height: Int,
-    ) : AutoCloseable {
-        private var closed = false
-
-        override fun close() {
-            if (closed) {
-                return
-            }
-            closed = true
-            textureManager.destroyTexture(identifier)
-        }
-    }
-
-    private sealed class ModelIconState : AutoCloseable {
-        override fun close() = Unit
-
+    private sealed class ModelIconState {
         data object Loading : ModelIconState()
         data object None : ModelIconState()
         data object Failed : ModelIconState()
         data class Loaded(
-            val icon: ModelTexture,
-        ) : ModelIconState() {
-            override fun close() = icon.close()
-        }
+            val icon: ModelIconAtlas.Icon,
+        ) : ModelIconState()
     }
 
     private val scope = CoroutineScope(ThreadExecutorDispatcher(MinecraftClient.getInstance()) + Job())
     private var iconState: ModelIconState = ModelIconState.Loading
-
-    private suspend fun loadIcon(
-        path: Path,
-        offsetAndLength: Pair<Long, Long>?,
-        readSizeLimit: Int = 32 * 1024 * 1024,
-        type: Texture.TextureType? = null,
-    ): ModelTexture {
-        val buffer = withContext(Dispatchers.IO) {
-            FileChannel.open(path).use {
-                offsetAndLength?.let { (offset, length) ->
-                    it.readToBuffer(
-                        offset = offset,
-                        length = length,
-                        readSizeLimit = readSizeLimit,
-                    )
-                } ?: it.readToBuffer(
-                    readSizeLimit = readSizeLimit,
-                )
-            }
-        }
-
-        val width: Int
-        val height: Int
-        val identifier = Identifier.of("armorstand", "models/${modelItem.hash}")
-        val texture = withContext(Dispatchers.Default) {
-            NativeImage.read(buffer)
-        }.use { image ->
-            width = image.width
-            height = image.height
-            NativeImageBackedTexture({ "Model icon for ${modelItem.hash}" }, image)
-        }
-        texture.setClamp(true)
-        texture.setFilter(true, false)
-        return try {
-            val textureManager = MinecraftClient.getInstance().textureManager
-            textureManager.registerTexture(identifier, texture)
-            ModelTexture(
-                textureManager = textureManager,
-                identifier = identifier,
-                texture = texture,
-                width = width,
-                height = height,
-            )
-        } catch (ex: Throwable) {
-            texture.close()
-            throw ex
-        }
-    }
+    private var acquired = false
 
     init {
         scope.launch {
-            val path = withContext(Dispatchers.IO) {
-                ModelManagerHolder.modelDir.resolve(modelItem.path).toAbsolutePath()
-            }
-            val thumbnail = ModelManagerHolder.instance.getModelThumbnail(modelItem)
             try {
-                when (thumbnail) {
-                    is ModelThumbnail.Embed -> {
-                        val icon = loadIcon(
-                            path = path,
-                            offsetAndLength = Pair(thumbnail.offset, thumbnail.length),
-                            type = thumbnail.type,
-                        )
-                        iconState = ModelIconState.Loaded(icon)
-                    }
-
-                    is ModelThumbnail.External -> {
-                        val icon = loadIcon(
-                            path = thumbnail.path,
-                            offsetAndLength = null,
-                        )
-                        iconState = ModelIconState.Loaded(icon)
-                    }
-
-                    ModelThumbnail.None -> {
-                        iconState = ModelIconState.None
-                    }
-                }
+                acquired = true
+                iconState = ModelIconAtlas.acquire(modelItem)?.let { ModelIconState.Loaded(it) } ?: ModelIconState.None
             } catch (ex: CancellationException) {
                 throw ex
             } catch (ex: Exception) {
@@ -206,6 +104,7 @@ class ModelIcon(
         when (val state = iconState) {
             is ModelIconState.Loaded -> {
                 val icon = state.icon
+                ModelIconAtlas.upload()
                 val iconAspect = icon.width.toFloat() / icon.height.toFloat()
                 val targetAspect = imageWidth.toFloat() / imageHeight.toFloat()
 
@@ -218,14 +117,14 @@ class ModelIcon(
                         icon.identifier,
                         left,
                         top + yOffset,
-                        0f,
-                        0f,
+                        icon.u.toFloat(),
+                        icon.v.toFloat(),
                         imageWidth,
                         scaledHeight,
                         icon.width,
                         icon.height,
-                        icon.width,
-                        icon.height,
+                        ModelIconAtlas.ATLAS_SIZE,
+                        ModelIconAtlas.ATLAS_SIZE,
                     )
 
                     context.drawGuiTexture(
@@ -245,14 +144,14 @@ class ModelIcon(
                         icon.identifier,
                         left + xOffset,
                         top,
-                        0f,
-                        0f,
+                        icon.u.toFloat(),
+                        icon.v.toFloat(),
                         scaledWidth,
                         imageHeight,
                         icon.width,
                         icon.height,
-                        icon.width,
-                        icon.height,
+                        ModelIconAtlas.ATLAS_SIZE,
+                        ModelIconAtlas.ATLAS_SIZE,
                     )
 
                     context.drawGuiTexture(
@@ -293,8 +192,13 @@ class ModelIcon(
     }
 
     override fun close() {
+        if (closed) {
+            return
+        }
         scope.cancel()
-        iconState.close()
+        if (acquired) {
+            ModelIconAtlas.release(modelItem.hash)
+        }
         closed = true
     }
 }
\ No newline at end of file
@@ -0,0 +1,210 @@
+package top.fifthlight.armorstand.ui.component
+
+import kotlinx.coroutines.*
+import net.minecraft.client.MinecraftClient
+import net.minecraft.client.texture.NativeImage
+import net.minecraft.client.texture.NativeImageBackedTexture
+import net.minecraft.util.Identifier
+import top.fifthlight.armorstand.manage.ModelManagerHolder
+import top.fifthlight.armorstand.manage.model.ModelItem
+import top.fifthlight.armorstand.manage.model.ModelThumbnail
+import top.fifthlight.armorstand.manage.scan.ThumbnailScaler
+import top.fifthlight.armorstand.util.ModelHash
+import top.fifthlight.armorstand.util.ThreadExecutorDispatcher
+import top.fifthlight.blazerod.model.util.readToBuffer
+import java.nio.ByteBuffer
+import java.nio.channels.FileChannel
+import java.nio.file.Path
+
+/**
+ * Model icons packed into a few shared textures. Icons in the same atlas use the same texture, so GUI rendering can
+ * draw them in one batch. Icons not used by any [ModelIcon] stay in the atlas until their slot is needed, so paging
+ * back and forth doesn't load them again.
+ *
+ * Only accessed on the client thread.
+ */
+object ModelIconAtlas {
+    private const val SLOT_SIZE = ThumbnailScaler.MAX_SIZE
+
+    // Transparent border between slots, so linear filtering doesn't bleed into neighbour icons
+    private const val SLOT_STRIDE = SLOT_SIZE + 2
+    private const val SLOTS_PER_ROW = 8
+    private const val SLOTS_PER_ATLAS = SLOTS_PER_ROW * SLOTS_PER_ROW
+    private const val MAX_ATLASES = 4
+    const val ATLAS_SIZE = SLOT_STRIDE * SLOTS_PER_ROW
+
+    private const val READ_SIZE_LIMIT = 32 * 1024 * 1024
+
+    class Icon(
+        val identifier: Identifier,
+        val u: Int,
+        val v: Int,
+        val width: Int,
+        val height: Int,
+    )
+
+    private class Atlas(index: Int) {
+        val identifier: Identifier = Identifier.of("armorstand", "model_icon_atlas/$index")
+        val texture = NativeImageBackedTexture({ "Model icon atlas $index" }, ATLAS_SIZE, ATLAS_SIZE, true)
+        val freeSlots = ArrayDeque((0 until SLOTS_PER_ATLAS).toList())
+        var dirty = false
+
+        init {
+            texture.setClamp(true)
+            texture.setFilter(true, false)
+            MinecraftClient.getInstance().textureManager.registerTexture(identifier, texture)
+        }
+    }
+
+    private class Slot(val atlas: Atlas, val index: Int) {
+        val x
+            get() = (index % SLOTS_PER_ROW) * SLOT_STRIDE + 1
+        val y
+            get() = (index / SLOTS_PER_ROW) * SLOT_STRIDE + 1
+    }
+
+    private class Entry(val load: Deferred<Icon?>) {
+        var slot: Slot? = null
+        var references = 0
+        var lastUsed = 0L
+    }
+
+    private val scope = CoroutineScope(ThreadExecutorDispatcher(MinecraftClient.getInstance()) + SupervisorJob())
+    private val atlases = mutableListOf<Atlas>()
+    private val entries = HashMap<ModelHash, Entry>()
+    private var useCounter = 0L
+
+    private suspend fun readImage(path: Path, offsetAndLength: Pair<Long, Long>?): NativeImage {
+        val buffer = withContext(Dispatchers.IO) {
+            FileChannel.open(path).use {
+                offsetAndLength?.let { (offset, length) ->
+                    it.readToBuffer(offset = offset, length = length, readSizeLimit = READ_SIZE_LIMIT)
+                } ?: it.readToBuffer(readSizeLimit = READ_SIZE_LIMIT)
+            }
+        }
+        return withContext(Dispatchers.Default) {
+            NativeImage.read(buffer)
+        }
+    }
+
+    private suspend fun loadImage(modelItem: ModelItem): NativeImage? {
+        val image = when (val thumbnail = ModelManagerHolder.instance.getModelThumbnail(modelItem)) {
+            is ModelThumbnail.Scaled -> withContext(Dispatchers.Default) {
+                NativeImage.read(ByteBuffer.allocateDirect(thumbnail.data.size).put(thumbnail.data).flip())
+            }
+
+            is ModelThumbnail.Embed -> {
+                val path = ModelManagerHolder.modelDir.resolve(modelItem.path).toAbsolutePath()
+                readImage(path, Pair(thumbnail.offset, thumbnail.length))
+            }
+
+            is ModelThumbnail.External -> readImage(thumbnail.path, null)
+
+            ModelThumbnail.None -> return null
+        }
+        if (ThumbnailScaler.fits(image)) {
+            return image
+        }
+        return image.use {
+            withContext(Dispatchers.Default) { ThumbnailScaler.scaleDown(it) }
+        }
+    }
+
+    // Take a free slot, or the least recently used slot not referenced by any icon
+    private fun allocateSlot(): Slot? {
+        for (atlas in atlases) {
+            atlas.freeSlots.removeFirstOrNull()?.let { return Slot(atlas, it) }
+        }
+        if (atlases.size < MAX_ATLASES) {
+            val atlas = Atlas(atlases.size)
+            atlases.add(atlas)
+            return Slot(atlas, atlas.freeSlots.removeFirst())
+        }
+        val (hash, entry) = entries.entries
+            .filter { (_, entry) -> entry.references == 0 && entry.slot != null }
+            .minByOrNull { (_, entry) -> entry.lastUsed }
+            ?.toPair()
+            ?: return null
+        entries.remove(hash)
+        return entry.slot
+    }
+
+    // Started by entryOf, after the entry is in place
+    private fun startLoad(modelItem: ModelItem) = scope.async(start = CoroutineStart.LAZY) {
+        val image = loadImage(modelItem) ?: return@async null
+        image.use {
+            val slot = allocateSlot() ?: throw IllegalStateException("No free slot in model icon atlas")
+            val target = slot.atlas.texture.image!!
+            // A reused slot may still hold a larger icon, clear it with its border
+            target.fillRect(slot.x - 1, slot.y - 1, SLOT_STRIDE, SLOT_STRIDE, 0)
+            for (y in 0 until image.height) {
+                for (x in 0 until image.width) {
+                    target.setColorArgb(slot.x + x, slot.y + y, image.getColorArgb(x, y))
+                }
+            }
+            slot.atlas.dirty = true
+            entries[modelItem.hash]?.slot = slot
+            Icon(
+                identifier = slot.atlas.identifier,
+                u = slot.x,
+                v = slot.y,
+                width = image.width,
+                height = image.height,
+            )
+        }
+    }
+
+    private fun entryOf(modelItem: ModelItem): Entry {
+        val entry = entries[modelItem.hash] ?: Entry(startLoad(modelItem)).also { entry ->
+            entries[modelItem.hash] = entry
+            // Forget failed or empty icons no one is waiting for, like prefetched ones, so they are loaded again
+            // next time. Referenced ones are forgotten in release.
+            entry.load.invokeOnCompletion {
+                if (entry.references == 0 && entry.slot == null && entries[modelItem.hash] === entry) {
+                    entries.remove(modelItem.hash)
+                }
+            }
+            entry.load.start()
+        }
+        entry.lastUsed = ++useCounter
+        return entry
+    }
+
+    /**
+     * Load the icon of the model, and keep it in the atlas until [release]. Returns null if the model has no thumbnail.
+     * Each call must be paired with a [release], even if it throws.
+     */
+    suspend fun acquire(modelItem: ModelItem): Icon? {
+        val entry = entryOf(modelItem)
+        entry.references++
+        return entry.load.await()
+    }
+
+    fun release(hash: ModelHash) {
+        val entry = entries[hash] ?: return
+        entry.references--
+        // Keep loaded icons for reuse, but forget failed or empty ones so they are loaded again next time
+        if (entry.references == 0 && entry.load.isCompleted && entry.slot == null) {
+            entries.remove(hash)
+        }
+    }
+
+    // Load icons in background, for pages likely to be shown next
+    fun prefetch(items: List<ModelItem>) {
+        for (item in items) {
+            if (item.hash !in entries) {
+                entryOf(item)
+            }
+        }
+    }
+
+    // Upload icons loaded since last frame
+    fun upload() {
+        for (atlas in atlases) {
+            if (atlas.dirty) {
+                atlas.texture.upload()
+                atlas.dirty = false
+            }
+        }
+    }
+}
@@ -1,6 +1,7 @@
 package top.fifthlight.armorstand.ui.model
 
 import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.FlowPreview
 import kotlinx.coroutines.flow.*
 import kotlinx.coroutines.launch
 import net.minecraft.client.MinecraftClient
@@ -9,10 +10,16 @@ import top.fifthlight.armorstand.config.ConfigHolder
 import top.fifthlight.armorstand.manage.ModelManager
 import top.fifthlight.armorstand.manage.ModelManagerHolder
 import top.fifthlight.armorstand.state.ModelInstanceManager
+import top.fifthlight.armorstand.ui.component.ModelIconAtlas
 import top.fifthlight.armorstand.ui.state.ConfigScreenState
 import java.nio.file.Path
 
+@OptIn(FlowPreview::class)
 class ConfigViewModel(scope: CoroutineScope) : ViewModel(scope) {
+    companion object {
+        private const val SEARCH_DEBOUNCE_MILLIS = 150L
+    }
+
     private val _uiState = MutableStateFlow(ConfigScreenState())
     val uiState = _uiState.asStateFlow()
 
@@ -41,7 +48,12 @@ class ConfigViewModel(scope: CoroutineScope) : ViewModel(scope) {
                 ModelManagerHolder.instance.scheduleScan(true)
                 ModelManagerHolder.instance.lastUpdateTime.first { it?.equals(prevScanTime) ?: false }
 
-                uiState.map(::SearchParam).distinctUntilChanged().collectLatest { param ->
+                var lastSearchString = uiState.value.searchString
+                uiState.map(::SearchParam).distinctUntilChanged().debounce { param ->
+                    // Wait for typing to pause before querying a new search string, but don't delay paging
+                    if (param.searchString == lastSearchString) 0 else SEARCH_DEBOUNCE_MILLIS
+                }.collectLatest { param ->
+                    lastSearchString = param.searchString
                     val searchStr = param.searchString.takeIf { it.isNotBlank() }
                     ModelManagerHolder.instance.lastUpdateTime.collectLatest {
                         val totalItems = ModelManagerHolder.instance.getTotalModels(searchStr)
@@ -73,6 +85,21 @@ class ConfigViewModel(scope: CoroutineScope) : ViewModel(scope) {
                                 _uiState.getAndUpdate { state ->
                                     state.copy(currentPageItems = items)
                                 }
+                                // Load icons of neighbour pages, so paging shows them at once
+                                for (neighbourOffset in listOf(offset + pageSize, offset - pageSize)) {
+                                    if (neighbourOffset !in 0 until totalItems) {
+                                        continue
+                                    }
+                                    ModelIconAtlas.prefetch(
+                                        ModelManagerHolder.instance.getModels(
+                                            offset = neighbourOffset,
+                                            length = pageSize,
+                                            search = searchStr,
+                                            order = param.order,
+                                            ascend = param.ascend,
+                                        )
+                                    )
+                                }
                             }
                         }
                     }
@@ -89,6 +116,12 @@ class ConfigViewModel(scope: CoroutineScope) : ViewModel(scope) {
                             hidePlayerArmor = config.hidePlayerArmor,
                             modelScale = config.modelScale,
                             thirdPersonDistanceScale = config.thirdPersonDistanceScale,
+                            physicsDistance = config.physicsDistance,
+                            modelGpuMemoryBudget = config.modelGpuMemoryBudget,
+                            modelHeapMemoryBudget = config.modelHeapMemoryBudget,
+                            modelPrefetchDistance = config.modelPrefetchDistance,
+                            otherModelVertexLimit = config.otherModelVertexLimit,
+                            otherModelTextureMemoryLimit = config.otherModelTextureMemoryLimit,
                         )
                     }
                 }
@@ -185,6 +218,42 @@ class ConfigViewModel(scope: CoroutineScope) : ViewModel(scope) {
         }
     }
 
+    fun updatePhysicsDistance(physicsDistance: Float) {
+        ConfigHolder.update {
+            copy(physicsDistance = physicsDistance)
+        }
+    }
+
+    fun updateModelGpuMemoryBudget(modelGpuMemoryBudget: Int) {
+        ConfigHolder.update {
+            copy(modelGpuMemoryBudget = modelGpuMemoryBudget)
+        }
+    }
+
+    fun updateModelHeapMemoryBudget(modelHeapMemoryBudget: Int) {
+        ConfigHolder.update {
+            copy(modelHeapMemoryBudget = modelHeapMemoryBudget)
+        }
+    }
+
+    fun updateModelPrefetchDistance(modelPrefetchDistance: Int) {
+        ConfigHolder.update {
+            copy(modelPrefetchDistance = modelPrefetchDistance)
+        }
+    }
+
+    fun updateOtherModelVertexLimit(otherModelVertexLimit: Int) {
+        ConfigHolder.update {
+            copy(otherModelVertexLimit = otherModelVertexLimit)
+        }
+    }
+
+    fun updateOtherModelTextureMemoryLimit(otherModelTextureMemoryLimit: Int) {
+        ConfigHolder.update {
+            copy(otherModelTextureMemoryLimit = otherModelTextureMemoryLimit)
+        }
+    }
+
     fun updateSearchString(searchString: String) {
         _uiState.getAndUpdate { state ->
             state.copy(searchString = searchString)
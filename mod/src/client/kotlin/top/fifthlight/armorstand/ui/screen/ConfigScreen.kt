@@ -238,6 +238,71 @@ class ConfigScreen(parent: Screen? = null) : ArmorStandScreen<ConfigScreen, Conf
         },
     )
 
+    private val physicsDistanceSlider = slider(
+        textFactory = { slider, text -> Text.translatable("armorstand.config.physics_distance", text) },
+        min = 0.0,
+        max = 128.0,
+        value = viewModel.uiState.map { it.physicsDistance.toDouble() },
+        onValueChanged = { userTriggered, value ->
+            viewModel.updatePhysicsDistance(value.toFloat())
+        },
+    )
+
+    private val modelGpuMemoryBudgetSlider = slider(
+        textFactory = { slider, text -> Text.translatable("armorstand.config.model_gpu_memory_budget", text) },
+        min = 64.0,
+        max = 8192.0,
+        decimalPlaces = 0,
+        value = viewModel.uiState.map { it.modelGpuMemoryBudget.toDouble() },
+        onValueChanged = { userTriggered, value ->
+            viewModel.updateModelGpuMemoryBudget(value.toInt())
+        },
+    )
+
+    private val modelHeapMemoryBudgetSlider = slider(
+        textFactory = { slider, text -> Text.translatable("armorstand.config.model_heap_memory_budget", text) },
+        min = 64.0,
+        max = 4096.0,
+        decimalPlaces = 0,
+        value = viewModel.uiState.map { it.modelHeapMemoryBudget.toDouble() },
+        onValueChanged = { userTriggered, value ->
+            viewModel.updateModelHeapMemoryBudget(value.toInt())
+        },
+    )
+
+    private val modelPrefetchDistanceSlider = slider(
+        textFactory = { slider, text -> Text.translatable("armorstand.config.model_prefetch_distance", text) },
+        min = 0.0,
+        max = 256.0,
+        decimalPlaces = 0,
+        value = viewModel.uiState.map { it.modelPrefetchDistance.toDouble() },
+        onValueChanged = { userTriggered, value ->
+            viewModel.updateModelPrefetchDistance(value.toInt())
+        },
+    )
+
+    private val otherModelVertexLimitSlider = slider(
+        textFactory = { slider, text -> Text.translatable("armorstand.config.other_model_vertex_limit", text) },
+        min = 0.0,
+        max = 2000.0,
+        decimalPlaces = 0,
+        value = viewModel.uiState.map { it.otherModelVertexLimit.toDouble() },
+        onValueChanged = { userTriggered, value ->
+            viewModel.updateOtherModelVertexLimit(value.toInt())
+        },
+    )
+
+    private val otherModelTextureMemoryLimitSlider = slider(
+        textFactory = { slider, text -> Text.translatable("armorstand.config.other_model_texture_memory_limit", text) },
+        min = 0.0,
+        max = 2048.0,
+        decimalPlaces = 0,
+        value = viewModel.uiState.map { it.otherModelTextureMemoryLimit.toDouble() },
+        onValueChanged = { userTriggered, value ->
+            viewModel.updateOtherModelTextureMemoryLimit(value.toInt())
+        },
+    )
+
     private val rendererSelectButton = ButtonWidget.builder(Text.translatable("armorstand.config.renderer_select")) {
         currentClient.setScreen(RendererSelectScreen(this))
     }.build()
@@ -301,6 +366,12 @@ class ConfigScreen(parent: Screen? = null) : ArmorStandScreen<ConfigScreen, Conf
                         hidePlayerShadowButton,
                         hidePlayerArmorButton,
                         thirdPersonDistanceScaleSlider,
+                        physicsDistanceSlider,
+                        modelGpuMemoryBudgetSlider,
+                        modelHeapMemoryBudgetSlider,
+                        modelPrefetchDistanceSlider,
+                        otherModelVertexLimitSlider,
+                        otherModelTextureMemoryLimitSlider,
                     ).forEach {
                         add(
                             it,
@@ -1,11 +1,14 @@
 package top.fifthlight.armorstand.ui.screen
 
+import net.minecraft.client.gui.DrawContext
 import net.minecraft.client.gui.screen.Screen
 import net.minecraft.client.gui.widget.ButtonWidget
 import net.minecraft.client.gui.widget.Positioner
 import net.minecraft.client.gui.widget.TextWidget
 import net.minecraft.screen.ScreenTexts
 import net.minecraft.text.Text
+import top.fifthlight.armorstand.config.ConfigHolder
+import top.fifthlight.armorstand.state.ModelInstanceManager
 import top.fifthlight.armorstand.ui.component.BorderLayout
 import top.fifthlight.armorstand.ui.component.LinearLayout
 
@@ -20,6 +23,22 @@ class DebugScreen(parent: Screen? = null) : BaseArmorStandScreen<DebugScreen>(
     private val debugTip by lazy {
         TextWidget(Text.translatable("armorstand.debug_screen.tip"), currentClient.textRenderer)
     }
+    private fun memoryUsageMessage(): Text {
+        val usage = ModelInstanceManager.memoryUsage
+        val config = ConfigHolder.config.value
+        fun Long.toMegabytes() = (this / (1024 * 1024)).toString()
+        return Text.translatable(
+            "armorstand.debug_screen.memory_usage",
+            usage.gpuBytes.toMegabytes(),
+            config.modelGpuMemoryBudget,
+            usage.heapBytes.toMegabytes(),
+            config.modelHeapMemoryBudget,
+        )
+    }
+    // Usage changes while the screen is open, so it takes the full width and is refreshed on each render
+    private val memoryUsageText by lazy {
+        TextWidget(width, currentClient.textRenderer.fontHeight, memoryUsageMessage(), currentClient.textRenderer)
+    }
     private val buttons = listOf(
         ButtonWidget.builder(Text.translatable("armorstand.debug_screen.database")) {
             currentClient.setScreen(DatabaseScreen(this@DebugScreen))
@@ -40,6 +59,7 @@ class DebugScreen(parent: Screen? = null) : BaseArmorStandScreen<DebugScreen>(
                 gap = 8
             ).apply {
                 add(debugTip, Positioner.create().apply { alignHorizontalCenter() })
+                add(memoryUsageText, Positioner.create().apply { alignHorizontalCenter() })
                 buttons.forEach { button ->
                     add(button, Positioner.create().apply { alignHorizontalCenter() })
                 }
@@ -58,4 +78,9 @@ class DebugScreen(parent: Screen? = null) : BaseArmorStandScreen<DebugScreen>(
         rootLayout.refreshPositions()
         rootLayout.forEachChild { addDrawableChild(it) }
     }
-}
\ No newline at end of file
+
+    override fun render(context: DrawContext, mouseX: Int, mouseY: Int, deltaTicks: Float) {
+        memoryUsageText.message = memoryUsageMessage()
+        super.render(context, mouseX, mouseY, deltaTicks)
+    }
+}
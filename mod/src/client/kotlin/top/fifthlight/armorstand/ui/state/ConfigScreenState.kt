@@ -14,6 +14,12 @@ data class ConfigScreenState(
     val hidePlayerArmor: Boolean = false,
     val modelScale: Float = 1f,
     val thirdPersonDistanceScale: Float = 1f,
+    val physicsDistance: Float = 32f,
+    val modelGpuMemoryBudget: Int = 1024,
+    val modelHeapMemoryBudget: Int = 512,
+    val modelPrefetchDistance: Int = 64,
+    val otherModelVertexLimit: Int = 0,
+    val otherModelTextureMemoryLimit: Int = 0,
     val currentModelMetadata: Metadata? = null,
     val searchString: String = "",
     val order: ModelManager.Order = ModelManager.Order.NAME,
@@ -1,22 +1,126 @@
 package top.fifthlight.armorstand.util
 
 import java.nio.ByteBuffer
+import java.nio.ByteOrder
 import java.nio.channels.FileChannel
 import java.nio.file.Path
 import java.security.MessageDigest
 
-internal fun Path.calculateSha256(): ByteArray {
-    val digest = MessageDigest.getInstance("SHA-256")
+private const val BUFFER_SIZE = 256 * 1024
+
+private val directBuffer = ThreadLocal.withInitial { ByteBuffer.allocateDirect(BUFFER_SIZE) }
+
+// Read through the pooled direct buffer instead of mapping, as mapped files stay locked on Windows until GC. Every
+// chunk but the last one fills the whole buffer.
+private inline fun Path.readContent(consumer: (ByteBuffer) -> Unit) {
     FileChannel.open(this).use { channel ->
-        val buffer = ByteBuffer.allocate(256 * 1024)
-        while (true) {
+        val buffer = directBuffer.get()
+        var eof = false
+        while (!eof) {
             buffer.clear()
-            if (channel.read(buffer) == -1) {
-                break
+            while (buffer.hasRemaining()) {
+                if (channel.read(buffer) == -1) {
+                    eof = true
+                    break
+                }
             }
             buffer.flip()
-            digest.update(buffer)
+            if (buffer.hasRemaining()) {
+                consumer(buffer)
+            }
+        }
+    }
+}
+
+/**
+ * Streaming XXH64 with seed 0. Every update but the last one must be a multiple of [STRIPE_SIZE] bytes, which holds
+ * for the chunks of [readContent].
+ */
+private class Xxh64 {
+    companion object {
+        private const val STRIPE_SIZE = 32
+        private val PRIME_1 = 0x9E3779B185EBCA87UL.toLong()
+        private val PRIME_2 = 0xC2B2AE3D27D4EB4FUL.toLong()
+        private const val PRIME_3 = 0x165667B19E3779F9L
+        private val PRIME_4 = 0x85EBCA77C2B2AE63UL.toLong()
+        private const val PRIME_5 = 0x27D4EB2F165667C5L
+
+        private fun round(acc: Long, input: Long) = (acc + input * PRIME_2).rotateLeft(31) * PRIME_1
+
+        private fun mergeRound(acc: Long, value: Long) = (acc xor round(0, value)) * PRIME_1 + PRIME_4
+    }
+
+    private var v1 = PRIME_1 + PRIME_2
+    private var v2 = PRIME_2
+    private var v3 = 0L
+    private var v4 = -PRIME_1
+    private var totalLength = 0L
+    private val tail = ByteBuffer.allocate(STRIPE_SIZE).order(ByteOrder.LITTLE_ENDIAN)
+
+    fun update(buffer: ByteBuffer) {
+        check(tail.position() == 0) { "Only the last update can be shorter than a stripe" }
+        val input = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN)
+        totalLength += input.remaining()
+        while (input.remaining() >= STRIPE_SIZE) {
+            v1 = round(v1, input.getLong())
+            v2 = round(v2, input.getLong())
+            v3 = round(v3, input.getLong())
+            v4 = round(v4, input.getLong())
+        }
+        tail.put(input)
+    }
+
+    fun digest(): Long {
+        var hash = if (totalLength >= STRIPE_SIZE) {
+            var hash = v1.rotateLeft(1) + v2.rotateLeft(7) + v3.rotateLeft(12) + v4.rotateLeft(18)
+            hash = mergeRound(hash, v1)
+            hash = mergeRound(hash, v2)
+            hash = mergeRound(hash, v3)
+            mergeRound(hash, v4)
+        } else {
+            PRIME_5
+        }
+        hash += totalLength
+
+        tail.flip()
+        while (tail.remaining() >= 8) {
+            hash = (hash xor round(0, tail.getLong())).rotateLeft(27) * PRIME_1 + PRIME_4
         }
+        if (tail.remaining() >= 4) {
+            hash = (hash xor (tail.getInt().toLong() and 0xFFFFFFFFL) * PRIME_1).rotateLeft(23) * PRIME_2 + PRIME_3
+        }
+        while (tail.hasRemaining()) {
+            hash = (hash xor (tail.get().toLong() and 0xFFL) * PRIME_5).rotateLeft(11) * PRIME_1
+        }
+
+        hash = (hash xor (hash ushr 33)) * PRIME_2
+        hash = (hash xor (hash ushr 29)) * PRIME_3
+        return hash xor (hash ushr 32)
     }
+}
+
+internal fun Path.calculateSha256(): ByteArray {
+    val digest = MessageDigest.getInstance("SHA-256")
+    readContent { digest.update(it) }
     return digest.digest()
-}
\ No newline at end of file
+}
+
+/**
+ * Fast non-cryptographic 64-bit fingerprint of file content, to check whether content changed before calculating
+ * SHA-256. Together with the file size, accidental collisions are negligible.
+ */
+internal fun Path.calculateFingerprint(): Long {
+    val hash = Xxh64()
+    readContent { hash.update(it) }
+    return hash.digest()
+}
+
+internal fun Path.calculateSha256AndFingerprint(): Pair<ByteArray, Long> {
+    val digest = MessageDigest.getInstance("SHA-256")
+    val hash = Xxh64()
+    readContent {
+        hash.update(it)
+        digest.update(it)
+    }
+    return Pair(digest.digest(), hash.digest())
+}
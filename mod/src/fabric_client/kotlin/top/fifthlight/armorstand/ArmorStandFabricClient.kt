@@ -16,7 +16,7 @@ import top.fifthlight.armorstand.config.ConfigHolder
 import top.fifthlight.armorstand.debug.ModelManagerDebugFrame
 import top.fifthlight.armorstand.event.ScreenEvents
 import top.fifthlight.armorstand.manage.ModelManagerHolder
-import top.fifthlight.armorstand.network.PlayerModelUpdateS2CPayload
+import top.fifthlight.armorstand.network.PlayerModelBatchUpdateS2CPayload
 import top.fifthlight.armorstand.state.ClientModelPathManager
 import top.fifthlight.armorstand.state.ModelHashManager
 import top.fifthlight.armorstand.state.ModelInstanceManager
@@ -113,9 +113,11 @@ object ArmorStandFabricClient : ArmorStandFabric(), ArmorStandClient, ClientModI
         ClientPlayConnectionEvents.DISCONNECT.register { handler, client ->
             ModelHashManager.clearHash()
         }
-        ClientPlayNetworking.registerGlobalReceiver(PlayerModelUpdateS2CPayload.ID) { payload, context ->
+        ClientPlayNetworking.registerGlobalReceiver(PlayerModelBatchUpdateS2CPayload.ID) { payload, context ->
             scope.launch {
-                ModelHashManager.putModelHash(payload.uuid, payload.modelHash)
+                for (entry in payload.entries) {
+                    ModelHashManager.putModelHash(entry.uuid, entry.modelHash)
+                }
             }
         }
         KeyBindingHelper.registerKeyBinding(configKeyBinding)
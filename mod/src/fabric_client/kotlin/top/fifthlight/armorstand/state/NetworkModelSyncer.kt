@@ -2,10 +2,13 @@ package top.fifthlight.armorstand.state
 
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.collectLatest
+import kotlinx.coroutines.flow.combine
 import kotlinx.coroutines.flow.distinctUntilChanged
 import kotlinx.coroutines.flow.map
+import kotlinx.coroutines.flow.onStart
 import kotlinx.coroutines.launch
 import net.fabricmc.fabric.api.client.networking.v1.ClientPlayConnectionEvents
+import net.fabricmc.fabric.api.client.networking.v1.ClientPlayNetworking
 import net.fabricmc.fabric.api.networking.v1.PacketSender
 import top.fifthlight.armorstand.ArmorStand
 import top.fifthlight.armorstand.config.ConfigHolder
@@ -24,18 +27,31 @@ object NetworkModelSyncer {
         }
         ArmorStand.instance.scope.launch {
             packetSender.collectLatest { sender ->
-                var hasSetModel = false
+                // Servers of older versions don't accept this payload
+                if (sender == null || !ClientPlayNetworking.canSend(ModelUpdateC2SPayload.ID)) {
+                    return@collectLatest
+                }
+                var announced: ModelUpdateC2SPayload? = null
+                // Complexity is calculated in background after scanning, so announce again once it is known
+                val complexityChanges = ModelManagerHolder.instance.modelComplexityChanges
+                    .map { }
+                    .onStart { emit(Unit) }
                 ConfigHolder.config
                     .map { Pair(it.modelPath, it.sendModelData) }
                     .distinctUntilChanged()
+                    .combine(complexityChanges) { config, _ -> config }
                     .collect { (modelPath, sendModelData) ->
                         if (sendModelData) {
                             val hash = modelPath?.let { ModelManagerHolder.instance.getModelByPath(it)?.hash }
-                            sender?.sendPacket(ModelUpdateC2SPayload(hash))
-                            hasSetModel = true
-                        } else if (hasSetModel) {
-                            sender?.sendPacket(ModelUpdateC2SPayload(null))
-                            hasSetModel = false
+                            val complexity = hash?.let { ModelManagerHolder.instance.getModelComplexity(it) }
+                            val payload = ModelUpdateC2SPayload(hash, complexity)
+                            if (payload != announced) {
+                                sender.sendPacket(payload)
+                                announced = payload
+                            }
+                        } else if (announced != null) {
+                            sender.sendPacket(ModelUpdateC2SPayload(null))
+                            announced = null
                         }
                     }
             }
@@ -2,50 +2,52 @@ package top.fifthlight.armorstand
 
 import net.fabricmc.api.ModInitializer
 import net.fabricmc.fabric.api.event.lifecycle.v1.ServerLifecycleEvents
+import net.fabricmc.fabric.api.event.lifecycle.v1.ServerTickEvents
+import net.fabricmc.fabric.api.networking.v1.EntityTrackingEvents
 import net.fabricmc.fabric.api.networking.v1.PayloadTypeRegistry
-import net.fabricmc.fabric.api.networking.v1.PlayerLookup
 import net.fabricmc.fabric.api.networking.v1.ServerPlayConnectionEvents
 import net.fabricmc.fabric.api.networking.v1.ServerPlayNetworking
-import net.minecraft.server.MinecraftServer
+import net.minecraft.server.network.ServerPlayerEntity
 import top.fifthlight.armorstand.network.ModelUpdateC2SPayload
-import top.fifthlight.armorstand.network.PlayerModelUpdateS2CPayload
+import top.fifthlight.armorstand.network.PlayerModelBatchUpdateS2CPayload
+import top.fifthlight.armorstand.server.ServerConfig
 import top.fifthlight.armorstand.server.ServerModelPathManager
 
 abstract class ArmorStandFabric : ArmorStand, ModInitializer {
-    private var server: MinecraftServer? = null
-
     override fun onInitialize() {
         ArmorStand.instance = this
-        PayloadTypeRegistry.playS2C().register(PlayerModelUpdateS2CPayload.ID, PlayerModelUpdateS2CPayload.CODEC)
+        PayloadTypeRegistry.playS2C().register(
+            PlayerModelBatchUpdateS2CPayload.ID,
+            PlayerModelBatchUpdateS2CPayload.CODEC,
+        )
         PayloadTypeRegistry.playC2S().register(ModelUpdateC2SPayload.ID, ModelUpdateC2SPayload.CODEC)
 
-        ServerModelPathManager.onUpdateListener = { uuid, hash ->
-            server?.let { server ->
-                val payload = PlayerModelUpdateS2CPayload(uuid, hash)
-                for (player in PlayerLookup.all(server)) {
-                    if (player.uuid == uuid) {
-                        continue
-                    }
+        ServerTickEvents.END_SERVER_TICK.register { server ->
+            for ((uuid, payloads) in ServerModelPathManager.flush()) {
+                val player = server.playerManager.getPlayer(uuid) ?: continue
+                for (payload in payloads) {
                     ServerPlayNetworking.send(player, payload)
                 }
             }
         }
-        ServerPlayConnectionEvents.JOIN.register { handler, sender, server ->
-            for ((uuid, hash) in ServerModelPathManager.getModels()) {
-                if (handler.player.uuid == uuid) {
-                    continue
-                }
-                sender.sendPacket(PlayerModelUpdateS2CPayload(uuid, hash))
+        EntityTrackingEvents.START_TRACKING.register { trackedEntity, player ->
+            if (trackedEntity is ServerPlayerEntity) {
+                ServerModelPathManager.startTracking(player.uuid, trackedEntity.uuid)
+            }
+        }
+        EntityTrackingEvents.STOP_TRACKING.register { trackedEntity, player ->
+            if (trackedEntity is ServerPlayerEntity) {
+                ServerModelPathManager.stopTracking(player.uuid, trackedEntity.uuid)
             }
         }
         ServerPlayConnectionEvents.DISCONNECT.register { handler, server ->
-            ServerModelPathManager.update(handler.player.uuid, null)
+            ServerModelPathManager.removePlayer(handler.player.uuid)
         }
         ServerPlayNetworking.registerGlobalReceiver(ModelUpdateC2SPayload.ID) { payload, context ->
-            ServerModelPathManager.update(context.player().uuid, payload.modelHash)
+            ServerModelPathManager.update(context.player().uuid, payload.modelHash, payload.complexity)
         }
         ServerLifecycleEvents.SERVER_STARTING.register { server ->
-            this.server = server
+            ServerConfig.load(server.runDirectory.resolve("config"))
         }
         ServerLifecycleEvents.SERVER_STOPPED.register {
             ServerModelPathManager.clear()
@@ -5,21 +5,29 @@ import net.minecraft.network.codec.PacketCodec
 import net.minecraft.network.codec.PacketCodecs
 import net.minecraft.network.packet.CustomPayload
 import net.minecraft.util.Identifier
+import top.fifthlight.armorstand.util.ModelComplexity
 import top.fifthlight.armorstand.util.ModelHash
 import java.util.*
 import kotlin.jvm.optionals.getOrNull
 
 data class ModelUpdateC2SPayload(
     val modelHash: ModelHash?,
+    // Null if the model is not scanned yet, or failed to parse
+    val complexity: ModelComplexity? = null,
 ) : CustomPayload {
     companion object {
-        private val PAYLOAD_ID = Identifier.of("armorstand", "model_update")
+        // Not the model_update of older versions, which has no complexity. Payloads have no versioning, so peers of
+        // older versions just ignore this payload instead of failing to decode it.
+        private val PAYLOAD_ID = Identifier.of("armorstand", "model_complexity_update")
         val ID = CustomPayload.Id<ModelUpdateC2SPayload>(PAYLOAD_ID)
-        val CODEC: PacketCodec<ByteBuf, ModelUpdateC2SPayload> = PacketCodecs.optional(ModelHash.CODEC).xmap(
-            { ModelUpdateC2SPayload(it.getOrNull()) },
+        val CODEC: PacketCodec<ByteBuf, ModelUpdateC2SPayload> = PacketCodec.tuple(
+            PacketCodecs.optional(ModelHash.CODEC),
             { Optional.ofNullable(it.modelHash) },
+            PacketCodecs.optional(ModelComplexity.CODEC),
+            { Optional.ofNullable(it.complexity) },
+            { modelHash, complexity -> ModelUpdateC2SPayload(modelHash.getOrNull(), complexity.getOrNull()) },
         )
     }
 
     override fun getId() = ID
-}
\ No newline at end of file
+}
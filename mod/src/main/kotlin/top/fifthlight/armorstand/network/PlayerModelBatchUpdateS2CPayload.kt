@@ -0,0 +1,54 @@
+package top.fifthlight.armorstand.network
+
+import net.minecraft.network.PacketByteBuf
+import net.minecraft.network.codec.PacketCodec
+import net.minecraft.network.codec.PacketCodecs
+import net.minecraft.network.packet.CustomPayload
+import net.minecraft.util.Identifier
+import net.minecraft.util.Uuids
+import top.fifthlight.armorstand.util.ModelComplexity
+import top.fifthlight.armorstand.util.ModelHash
+import java.util.*
+import kotlin.jvm.optionals.getOrNull
+
+data class PlayerModelBatchUpdateS2CPayload(
+    val entries: List<Entry>,
+) : CustomPayload {
+    data class Entry(
+        val uuid: UUID,
+        // Null means the player has no model, or left
+        val modelHash: ModelHash?,
+        // As announced by the player, clients check their own copy of the model instead
+        val complexity: ModelComplexity? = null,
+    ) {
+        companion object {
+            val CODEC: PacketCodec<PacketByteBuf, Entry> = PacketCodec.tuple(
+                Uuids.PACKET_CODEC,
+                Entry::uuid,
+                PacketCodecs.optional(ModelHash.CODEC),
+                { Optional.ofNullable(it.modelHash) },
+                PacketCodecs.optional(ModelComplexity.CODEC),
+                { Optional.ofNullable(it.complexity) },
+                { uuid, modelHash, complexity -> Entry(uuid, modelHash.getOrNull(), complexity.getOrNull()) },
+            )
+        }
+    }
+
+    companion object {
+        private val PAYLOAD_ID = Identifier.of("armorstand", "player_model_batch_update")
+        val ID = CustomPayload.Id<PlayerModelBatchUpdateS2CPayload>(PAYLOAD_ID)
+
+        // About 70 bytes per entry, keep payloads far below the custom payload size limit
+        const val MAX_ENTRIES = 1024
+
+        val CODEC: PacketCodec<PacketByteBuf, PlayerModelBatchUpdateS2CPayload> = PacketCodec.tuple(
+            Entry.CODEC.collect(PacketCodecs.toList(MAX_ENTRIES)),
+            PlayerModelBatchUpdateS2CPayload::entries,
+            ::PlayerModelBatchUpdateS2CPayload,
+        )
+
+        fun split(entries: List<Entry>) = entries.chunked(MAX_ENTRIES).map(::PlayerModelBatchUpdateS2CPayload)
+    }
+
+    override fun getId() = ID
+}
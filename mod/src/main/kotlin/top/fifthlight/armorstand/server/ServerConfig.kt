@@ -0,0 +1,77 @@
+package top.fifthlight.armorstand.server
+
+import com.mojang.logging.LogUtils
+import top.fifthlight.armorstand.util.ModelComplexity
+import java.nio.file.Path
+import java.util.*
+import kotlin.io.path.createDirectories
+import kotlin.io.path.exists
+import kotlin.io.path.inputStream
+import kotlin.io.path.outputStream
+
+/**
+ * Server side config, stored in config/armorstand-server.properties of the server directory.
+ *
+ * Models announced with complexity over the limits are rejected, and other players see the vanilla player instead.
+ * If any limit is set, models announced without complexity are rejected too.
+ */
+object ServerConfig {
+    private val LOGGER = LogUtils.getLogger()
+    private const val FILE_NAME = "armorstand-server.properties"
+    private const val BYTES_PER_MEGABYTE = 1024L * 1024L
+
+    var complexityLimit = ModelComplexity.UNLIMITED
+        private set
+
+    fun load(configDir: Path) {
+        val file = configDir.resolve(FILE_NAME)
+        val properties = Properties()
+        try {
+            if (file.exists()) {
+                file.inputStream().use { properties.load(it) }
+            }
+        } catch (ex: Exception) {
+            LOGGER.warn("Failed to read server config", ex)
+        }
+
+        fun readLong(key: String) = properties.getProperty(key)?.trim()?.toLongOrNull()?.coerceAtLeast(0) ?: 0L
+        complexityLimit = ModelComplexity(
+            vertexCount = readLong("max_vertices").toInt(),
+            primitiveCount = readLong("max_primitives").toInt(),
+            jointCount = readLong("max_joints").toInt(),
+            morphTargetCount = readLong("max_morph_targets").toInt(),
+            textureBytes = readLong("max_texture_memory_mib") * BYTES_PER_MEGABYTE,
+        )
+        LOGGER.info("Model complexity limit: $complexityLimit")
+
+        if (!file.exists()) {
+            save(file)
+        }
+    }
+
+    private fun save(file: Path) {
+        val properties = Properties()
+        properties.setProperty("max_vertices", complexityLimit.vertexCount.toString())
+        properties.setProperty("max_primitives", complexityLimit.primitiveCount.toString())
+        properties.setProperty("max_joints", complexityLimit.jointCount.toString())
+        properties.setProperty("max_morph_targets", complexityLimit.morphTargetCount.toString())
+        properties.setProperty(
+            "max_texture_memory_mib",
+            (complexityLimit.textureBytes / BYTES_PER_MEGABYTE).toString(),
+        )
+        try {
+            file.parent.createDirectories()
+            file.outputStream().use {
+                properties.store(it, "ArmorStand model complexity limits, 0 means unlimited")
+            }
+        } catch (ex: Exception) {
+            LOGGER.warn("Failed to write server config", ex)
+        }
+    }
+
+    fun accepts(complexity: ModelComplexity?) = when {
+        complexityLimit.isUnlimited -> true
+        complexity == null -> false
+        else -> !complexity.exceeds(complexityLimit)
+    }
+}
@@ -1,24 +1,127 @@
 package top.fifthlight.armorstand.server
 
+import com.mojang.logging.LogUtils
+import top.fifthlight.armorstand.network.PlayerModelBatchUpdateS2CPayload
+import top.fifthlight.armorstand.util.ModelComplexity
 import top.fifthlight.armorstand.util.ModelHash
 import java.util.*
 
+/**
+ * Server side store of player model hashes.
+ *
+ * Changes are coalesced and sent once per tick by [flush]. Each viewer only receives hashes of the players it is
+ * tracking, and a hash is sent when the player enters viewer's tracking range or changes model while tracked.
+ *
+ * Models over [ServerConfig.complexityLimit] are rejected as if the player has no model.
+ *
+ * All functions are thread-safe, as payload handlers and tracking events may be called from different threads.
+ */
 object ServerModelPathManager {
-    private val _models = mutableMapOf<UUID, ModelHash>()
-    var onUpdateListener: ((UUID, ModelHash?) -> Unit)? = null
+    private val LOGGER = LogUtils.getLogger()
+    private val models = mutableMapOf<UUID, ModelHash>()
+    private val complexities = mutableMapOf<UUID, ModelComplexity>()
+    private val viewers = mutableMapOf<UUID, Viewer>()
 
-    fun update(uuid: UUID, hash: ModelHash?) {
-        if (hash == null) {
-            _models.remove(uuid)
+    // Players changed model since last flush
+    private val dirtyPlayers = mutableSetOf<UUID>()
+
+    private class Viewer {
+        val tracking = mutableSetOf<UUID>()
+
+        // Hashes last sent to this viewer, so entering tracking range again won't send the same hash
+        val sent = mutableMapOf<UUID, ModelHash>()
+        val pending = mutableSetOf<UUID>()
+    }
+
+    private fun viewer(uuid: UUID) = viewers.getOrPut(uuid, ::Viewer)
+
+    fun update(uuid: UUID, hash: ModelHash?, complexity: ModelComplexity?) = synchronized(this) {
+        if (hash != null && !ServerConfig.accepts(complexity)) {
+            LOGGER.info("Rejected model $hash of player $uuid, complexity $complexity over limit")
+            models.remove(uuid)
+            complexities.remove(uuid)
+        } else if (hash == null) {
+            models.remove(uuid)
+            complexities.remove(uuid)
         } else {
-            _models[uuid] = hash
+            models[uuid] = hash
+            if (complexity == null) {
+                complexities.remove(uuid)
+            } else {
+                complexities[uuid] = complexity
+            }
+        }
+        dirtyPlayers.add(uuid)
+    }
+
+    fun startTracking(viewer: UUID, target: UUID) = synchronized(this) {
+        if (viewer == target) {
+            return@synchronized
         }
-        onUpdateListener?.let { it(uuid, hash) }
+        val state = viewer(viewer)
+        state.tracking.add(target)
+        state.pending.add(target)
     }
 
-    fun getModels(): Map<UUID, ModelHash> = _models
+    fun stopTracking(viewer: UUID, target: UUID) = synchronized(this) {
+        val state = viewers[viewer] ?: return@synchronized
+        state.tracking.remove(target)
+        state.pending.remove(target)
+    }
+
+    fun removePlayer(uuid: UUID) = synchronized(this) {
+        viewers.remove(uuid)
+        models.remove(uuid)
+        complexities.remove(uuid)
+        dirtyPlayers.add(uuid)
+    }
+
+    fun getModels(): Map<UUID, ModelHash> = synchronized(this) { models.toMap() }
+
+    /**
+     * Collect changes since last flush, and return the payloads to send for each viewer. Call it once per tick.
+     */
+    fun flush(): Map<UUID, List<PlayerModelBatchUpdateS2CPayload>> = synchronized(this) {
+        if (dirtyPlayers.isNotEmpty()) {
+            for (state in viewers.values) {
+                for (uuid in dirtyPlayers) {
+                    // Viewers out of range still get removals of the hash they know
+                    if (uuid in state.tracking || (uuid !in models && uuid in state.sent)) {
+                        state.pending.add(uuid)
+                    }
+                }
+            }
+            dirtyPlayers.clear()
+        }
+        buildMap {
+            for ((viewerUuid, state) in viewers) {
+                if (state.pending.isEmpty()) {
+                    continue
+                }
+                val entries = state.pending.mapNotNull { uuid ->
+                    val hash = models[uuid]
+                    if (state.sent[uuid] == hash) {
+                        return@mapNotNull null
+                    }
+                    if (hash == null) {
+                        state.sent.remove(uuid)
+                    } else {
+                        state.sent[uuid] = hash
+                    }
+                    PlayerModelBatchUpdateS2CPayload.Entry(uuid, hash, hash?.let { complexities[uuid] })
+                }
+                state.pending.clear()
+                if (entries.isNotEmpty()) {
+                    put(viewerUuid, PlayerModelBatchUpdateS2CPayload.split(entries))
+                }
+            }
+        }
+    }
 
-    fun clear() {
-        _models.clear()
+    fun clear() = synchronized(this) {
+        models.clear()
+        complexities.clear()
+        viewers.clear()
+        dirtyPlayers.clear()
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,49 @@
+package top.fifthlight.armorstand.util
+
+import io.netty.buffer.ByteBuf
+import net.minecraft.network.codec.PacketCodec
+import net.minecraft.network.codec.PacketCodecs
+
+/**
+ * Rendering cost of a model, computed when scanning models and announced together with the model hash.
+ *
+ * When used as a limit, fields of 0 mean unlimited.
+ */
+data class ModelComplexity(
+    val vertexCount: Int,
+    val primitiveCount: Int,
+    val jointCount: Int,
+    val morphTargetCount: Int,
+    // Decoded size of textures, in bytes
+    val textureBytes: Long,
+) {
+    companion object {
+        val UNLIMITED = ModelComplexity(0, 0, 0, 0, 0)
+
+        val CODEC: PacketCodec<ByteBuf, ModelComplexity> = PacketCodec.tuple(
+            PacketCodecs.VAR_INT,
+            ModelComplexity::vertexCount,
+            PacketCodecs.VAR_INT,
+            ModelComplexity::primitiveCount,
+            PacketCodecs.VAR_INT,
+            ModelComplexity::jointCount,
+            PacketCodecs.VAR_INT,
+            ModelComplexity::morphTargetCount,
+            PacketCodecs.VAR_LONG,
+            ModelComplexity::textureBytes,
+            ::ModelComplexity,
+        )
+    }
+
+    val isUnlimited
+        get() = this == UNLIMITED
+
+    fun exceeds(limit: ModelComplexity): Boolean {
+        fun exceeds(value: Long, limit: Long) = limit > 0 && value > limit
+        return exceeds(vertexCount.toLong(), limit.vertexCount.toLong()) ||
+                exceeds(primitiveCount.toLong(), limit.primitiveCount.toLong()) ||
+                exceeds(jointCount.toLong(), limit.jointCount.toLong()) ||
+                exceeds(morphTargetCount.toLong(), limit.morphTargetCount.toLong()) ||
+                exceeds(textureBytes, limit.textureBytes)
+    }
+}
@@ -21,7 +21,7 @@ import top.fifthlight.armorstand.config.ConfigHolder
 import top.fifthlight.armorstand.debug.ModelManagerDebugFrame
 import top.fifthlight.armorstand.event.ScreenEvents
 import top.fifthlight.armorstand.manage.ModelManagerHolder
-import top.fifthlight.armorstand.network.PlayerModelUpdateS2CPayload
+import top.fifthlight.armorstand.network.PlayerModelBatchUpdateS2CPayload
 import top.fifthlight.armorstand.state.ClientModelPathManager
 import top.fifthlight.armorstand.state.ModelHashManager
 import top.fifthlight.armorstand.state.ModelInstanceManager
@@ -168,9 +168,11 @@ object ArmorStandNeoForgeClient : ArmorStandNeoForge(), ArmorStandClient {
         event.registrar("armorstand")
             .versioned(ModInfo.MOD_VERSION)
             .optional()
-            .playToClient(PlayerModelUpdateS2CPayload.ID, PlayerModelUpdateS2CPayload.CODEC) { payload, context ->
+            .playToClient(PlayerModelBatchUpdateS2CPayload.ID, PlayerModelBatchUpdateS2CPayload.CODEC) { payload, context ->
                 scope.launch {
-                    ModelHashManager.putModelHash(payload.uuid, payload.modelHash)
+                    for (entry in payload.entries) {
+                        ModelHashManager.putModelHash(entry.uuid, entry.modelHash)
+                    }
                 }
             }
     }
@@ -12,18 +12,27 @@ object NetworkModelSyncer {
         }
         ArmorStand.instance.scope.launch {
             packetSender.collectLatest { sender ->
-                var hasSetModel = false
+                var announced: ModelUpdateC2SPayload? = null
+                // Complexity is calculated in background after scanning, so announce again once it is known
+                val complexityChanges = ModelManagerHolder.instance.modelComplexityChanges
+                    .map { }
+                    .onStart { emit(Unit) }
                 ConfigHolder.config
                     .map { Pair(it.modelPath, it.sendModelData) }
                     .distinctUntilChanged()
+                    .combine(complexityChanges) { config, _ -> config }
                     .collect { (modelPath, sendModelData) ->
                         if (sendModelData) {
                             val hash = modelPath?.let { ModelManagerHolder.instance.getModelByPath(it)?.hash }
-                            sender?.sendPacket(ModelUpdateC2SPayload(hash))
-                            hasSetModel = true
-                        } else if (hasSetModel) {
+                            val complexity = hash?.let { ModelManagerHolder.instance.getModelComplexity(it) }
+                            val payload = ModelUpdateC2SPayload(hash, complexity)
+                            if (payload != announced) {
+                                sender?.sendPacket(payload)
+                                announced = payload
+                            }
+                        } else if (announced != null) {
                             sender?.sendPacket(ModelUpdateC2SPayload(null))
-                            hasSetModel = false
+                            announced = null
                         }
                     }
             }
@@ -1,21 +1,20 @@
 package top.fifthlight.armorstand
 
-import net.minecraft.server.MinecraftServer
 import net.minecraft.server.network.ServerPlayerEntity
 import net.neoforged.bus.api.SubscribeEvent
 import net.neoforged.neoforge.common.NeoForge
 import net.neoforged.neoforge.event.entity.player.PlayerEvent
 import net.neoforged.neoforge.event.server.ServerStartingEvent
 import net.neoforged.neoforge.event.server.ServerStoppedEvent
+import net.neoforged.neoforge.event.tick.ServerTickEvent
 import net.neoforged.neoforge.network.PacketDistributor
 import net.neoforged.neoforge.network.event.RegisterPayloadHandlersEvent
 import top.fifthlight.armorstand.network.ModelUpdateC2SPayload
-import top.fifthlight.armorstand.network.PlayerModelUpdateS2CPayload
+import top.fifthlight.armorstand.network.PlayerModelBatchUpdateS2CPayload
+import top.fifthlight.armorstand.server.ServerConfig
 import top.fifthlight.armorstand.server.ServerModelPathManager
 
 abstract class ArmorStandNeoForge : ArmorStand {
-    private var server: MinecraftServer? = null
-
     companion object {
         lateinit var instance: ArmorStandNeoForge
     }
@@ -24,22 +23,20 @@ abstract class ArmorStandNeoForge : ArmorStand {
         ArmorStand.instance = this
         instance = this
 
-        ServerModelPathManager.onUpdateListener = { uuid, hash ->
-            server?.let { server ->
-                val payload = PlayerModelUpdateS2CPayload(uuid, hash)
-                server.playerManager.playerList.forEach { player ->
-                    if (player.uuid == uuid) {
-                        return@let
+        NeoForge.EVENT_BUS.register(object {
+            @SubscribeEvent
+            fun onServerTick(event: ServerTickEvent.Post) {
+                for ((uuid, payloads) in ServerModelPathManager.flush()) {
+                    val player = event.server.playerManager.getPlayer(uuid) ?: continue
+                    for (payload in payloads) {
+                        PacketDistributor.sendToPlayer(player, payload)
                     }
-                    PacketDistributor.sendToPlayer(player, payload)
                 }
             }
-        }
 
-        NeoForge.EVENT_BUS.register(object {
             @SubscribeEvent
             fun onServerStarting(event: ServerStartingEvent) {
-                this@ArmorStandNeoForge.server = event.server
+                ServerConfig.load(event.server.runDirectory.resolve("config"))
             }
 
             @SubscribeEvent
@@ -48,17 +45,21 @@ abstract class ArmorStandNeoForge : ArmorStand {
             }
 
             @SubscribeEvent
-            fun onPlayerJoined(event: PlayerEvent.PlayerLoggedInEvent) {
-                val player = event.entity
-                if (player !is ServerPlayerEntity) {
+            fun onStartTracking(event: PlayerEvent.StartTracking) {
+                val target = event.target
+                if (target !is ServerPlayerEntity) {
                     return
                 }
-                for ((uuid, hash) in ServerModelPathManager.getModels()) {
-                    if (player.uuid == uuid) {
-                        continue
-                    }
-                    PacketDistributor.sendToPlayer(player, PlayerModelUpdateS2CPayload(uuid, hash))
+                ServerModelPathManager.startTracking(event.entity.uuid, target.uuid)
+            }
+
+            @SubscribeEvent
+            fun onStopTracking(event: PlayerEvent.StopTracking) {
+                val target = event.target
+                if (target !is ServerPlayerEntity) {
+                    return
                 }
+                ServerModelPathManager.stopTracking(event.entity.uuid, target.uuid)
             }
 
             @SubscribeEvent
@@ -67,7 +68,7 @@ abstract class ArmorStandNeoForge : ArmorStand {
                 if (player !is ServerPlayerEntity) {
                     return
                 }
-                ServerModelPathManager.update(player.uuid, null)
+                ServerModelPathManager.removePlayer(player.uuid)
             }
         })
     }
@@ -76,9 +77,9 @@ abstract class ArmorStandNeoForge : ArmorStand {
         event.registrar("armorstand")
             .versioned(ModInfo.MOD_VERSION)
             .optional()
-            .playToClient(PlayerModelUpdateS2CPayload.ID, PlayerModelUpdateS2CPayload.CODEC)
+            .playToClient(PlayerModelBatchUpdateS2CPayload.ID, PlayerModelBatchUpdateS2CPayload.CODEC)
             .playToServer(ModelUpdateC2SPayload.ID, ModelUpdateC2SPayload.CODEC) { payload, context ->
-                ServerModelPathManager.update(context.player().uuid, payload.modelHash)
+                ServerModelPathManager.update(context.player().uuid, payload.modelHash, payload.complexity)
             }
     }
 }
\ No newline at end of file
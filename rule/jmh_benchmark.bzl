@@ -0,0 +1,49 @@
+load("@rules_java//java:defs.bzl", "java_binary", "java_plugin")
+load("@rules_kotlin//kotlin:jvm.bzl", "kt_jvm_library")
+
+# @maven_jmh is not pinned yet, so benchmarks are kept out of //... until maven_jmh_install.json is generated
+_TAGS = ["manual"]
+
+def _kt_jmh_benchmark_impl(name, visibility, srcs, deps, runtime_deps, jvm_flags):
+    java_plugin(
+        name = name + "_generator",
+        processor_class = "org.openjdk.jmh.generators.BenchmarkProcessor",
+        tags = _TAGS,
+        deps = [
+            "@maven_jmh//:org_openjdk_jmh_jmh_core",
+            "@maven_jmh//:org_openjdk_jmh_jmh_generator_annprocess",
+        ],
+    )
+
+    kt_jvm_library(
+        name = name + "_lib",
+        srcs = srcs,
+        plugins = [":" + name + "_generator"],
+        tags = _TAGS,
+        deps = ([] if not deps else deps) + [
+            "@maven_jmh//:org_openjdk_jmh_jmh_core",
+        ],
+    )
+
+    # Run with -- <JMH options>, results are written to jmh-result.json in working directory by default
+    java_binary(
+        name = name,
+        visibility = visibility,
+        main_class = "org.openjdk.jmh.Main",
+        args = ["-rf", "json"],
+        jvm_flags = jvm_flags,
+        tags = _TAGS,
+        runtime_deps = ([] if not runtime_deps else runtime_deps) + [
+            ":" + name + "_lib",
+        ],
+    )
+
+kt_jmh_benchmark = macro(
+    implementation = _kt_jmh_benchmark_impl,
+    attrs = {
+        "srcs": attr.label_list(allow_files = True),
+        "deps": attr.label_list(),
+        "runtime_deps": attr.label_list(),
+        "jvm_flags": attr.string_list(),
+    }
+)